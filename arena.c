@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "arena.h"
+
+/* Bloque de la arena; los datos empiezan alineados justo después */
+typedef struct BloqueArena {
+    struct BloqueArena *siguiente;
+    size_t tamano;
+    size_t usado;
+    size_t relleno;     /* Lleva la cabecera a 32 bytes */
+} BloqueArena;
+
+typedef struct {
+    BloqueArena *primero;
+    BloqueArena *actual;
+    size_t usadoTurno;              /* Bytes pedidos desde el último reinicio */
+    unsigned long asignacionesInicio; /* asignacionesHilo() al empezar el turno */
+} ArenaHilo;
+
+static __thread ArenaHilo arena = {NULL, NULL, 0, 0};
+
+/* Estadísticas de todos los hilos (atómicas) */
+static unsigned long turnos = 0;
+static unsigned long bytesTotales = 0;
+static unsigned long bytesMaximo = 0;
+static unsigned long bloquesPedidos = 0;
+static unsigned long asignacionesTurnos = 0;
+static unsigned long asignacionesMaximo = 0;
+
+static void actualizarMaximo(unsigned long *maximo, unsigned long valor) {
+    unsigned long actual = __atomic_load_n(maximo, __ATOMIC_RELAXED);
+    while (valor > actual &&
+           !__atomic_compare_exchange_n(maximo, &actual, valor, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+#ifdef CONTAR_ASIGNACIONES
+
+/* Las funciones de glibc a las que se delega */
+extern void *__libc_malloc(size_t tamano);
+extern void *__libc_calloc(size_t numero, size_t tamano);
+extern void *__libc_realloc(void *puntero, size_t tamano);
+
+static __thread unsigned long contadorAsignaciones = 0;
+
+void *malloc(size_t tamano) {
+    contadorAsignaciones++;
+    return __libc_malloc(tamano);
+}
+
+void *calloc(size_t numero, size_t tamano) {
+    contadorAsignaciones++;
+    return __libc_calloc(numero, tamano);
+}
+
+void *realloc(void *puntero, size_t tamano) {
+    contadorAsignaciones++;
+    return __libc_realloc(puntero, tamano);
+}
+
+unsigned long asignacionesHilo(void) {
+    return contadorAsignaciones;
+}
+
+#else
+
+unsigned long asignacionesHilo(void) {
+    return 0;
+}
+
+#endif /* CONTAR_ASIGNACIONES */
+
+static BloqueArena* nuevoBloque(size_t minimo) {
+    size_t tamano = minimo > TAMANO_BLOQUE_ARENA ? minimo : TAMANO_BLOQUE_ARENA;
+    BloqueArena *bloque = (BloqueArena*)malloc(sizeof(BloqueArena) + tamano);
+
+    if (bloque == NULL) {
+        printf("Error: No se pudo ampliar la arena del turno\n");
+        return NULL;
+    }
+    bloque->siguiente = NULL;
+    bloque->tamano = tamano;
+    bloque->usado = 0;
+    __atomic_add_fetch(&bloquesPedidos, 1, __ATOMIC_RELAXED);
+    return bloque;
+}
+
+void* reservarArena(size_t bytes) {
+    bytes = (bytes + ALINEACION_ARENA - 1) & ~(size_t)(ALINEACION_ARENA - 1);
+
+    if (arena.actual == NULL) {
+        arena.primero = arena.actual = nuevoBloque(bytes);
+        if (arena.actual == NULL) {
+            return NULL;
+        }
+    }
+
+    /* Pasar a los bloques siguientes (de turnos anteriores) hasta que quepa */
+    while (arena.actual->tamano - arena.actual->usado < bytes) {
+        if (arena.actual->siguiente == NULL) {
+            BloqueArena *bloque = nuevoBloque(bytes);
+            if (bloque == NULL) {
+                return NULL;
+            }
+            arena.actual->siguiente = bloque;
+        }
+        arena.actual = arena.actual->siguiente;
+        arena.actual->usado = 0;
+    }
+
+    void *memoria = (unsigned char*)(arena.actual + 1) + arena.actual->usado;
+    arena.actual->usado += bytes;
+    arena.usadoTurno += bytes;
+    return memoria;
+}
+
+Carta* cartasTemporales(int numCartas) {
+    return numCartas > 0 ? (Carta*)reservarArena(numCartas * sizeof(Carta)) : NULL;
+}
+
+Apeada* apeadasTemporales(int numApeadas) {
+    return numApeadas > 0 ? (Apeada*)reservarArena(numApeadas * sizeof(Apeada)) : NULL;
+}
+
+void iniciarTurnoArena(void) {
+    arena.asignacionesInicio = asignacionesHilo();
+}
+
+void reiniciarArena(void) {
+    unsigned long asignaciones = asignacionesHilo() - arena.asignacionesInicio;
+
+    __atomic_add_fetch(&turnos, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bytesTotales, arena.usadoTurno, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&asignacionesTurnos, asignaciones, __ATOMIC_RELAXED);
+    actualizarMaximo(&bytesMaximo, arena.usadoTurno);
+    actualizarMaximo(&asignacionesMaximo, asignaciones);
+
+    if (arena.primero != NULL) {
+        arena.primero->usado = 0;
+    }
+    arena.actual = arena.primero;
+    arena.usadoTurno = 0;
+}
+
+void liberarArenaHilo(void) {
+    BloqueArena *bloque = arena.primero;
+
+    while (bloque != NULL) {
+        BloqueArena *siguiente = bloque->siguiente;
+        free(bloque);
+        bloque = siguiente;
+    }
+    arena.primero = arena.actual = NULL;
+    arena.usadoTurno = 0;
+}
+
+void imprimirEstadisticasArena(void) {
+    if (turnos == 0) {
+        return;
+    }
+    printf("\nArena de turno: %lu turnos, %.1f bytes de media por turno, máximo %lu, %lu bloques pedidos\n",
+           turnos, (double)bytesTotales / turnos, bytesMaximo, bloquesPedidos);
+#ifdef CONTAR_ASIGNACIONES
+    printf("Asignaciones por turno (malloc/calloc/realloc): %.2f de media, máximo %lu\n",
+           (double)asignacionesTurnos / turnos, asignacionesMaximo);
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include "jugadores.h"
+
+/* Arena por hilo para la memoria temporal de un turno.
+ *
+ * Cada hilo tiene su propia arena (sin candados): pedir memoria solo avanza
+ * un desplazamiento dentro de un bloque, y reiniciarArena, que se llama al
+ * pasar el turno, vuelve a empezar desde el principio sin liberar nada. Los
+ * bloques se piden con malloc la primera vez que hacen falta y se reutilizan
+ * en los turnos siguientes, así que un turno normal no llama a malloc.
+ *
+ * Lo que se pide aquí deja de ser válido al reiniciar la arena: las apeadas
+ * candidatas, por ejemplo, deben copiarse a la mesa antes de pasar el turno.
+ *
+ * Compilando con -DCONTAR_ASIGNACIONES se cuentan además todas las llamadas
+ * a malloc, calloc y realloc del proceso, por hilo, y el informe muestra
+ * cuántas hubo por turno */
+
+#define TAMANO_BLOQUE_ARENA (64 * 1024)
+#define ALINEACION_ARENA    16
+
+/* Memoria sin inicializar, alineada a ALINEACION_ARENA, o NULL */
+void* reservarArena(size_t bytes);
+
+/* Arreglos temporales con tipo: cartas (manos de trabajo) y apeadas candidatas */
+Carta* cartasTemporales(int numCartas);
+Apeada* apeadasTemporales(int numApeadas);
+
+/* Principio de turno: empezar a contar las asignaciones del hilo */
+void iniciarTurnoArena(void);
+
+/* Fin de turno: registrar el uso del turno y vaciar la arena del hilo */
+void reiniciarArena(void);
+
+/* Liberar los bloques de la arena del hilo (al terminar el hilo) */
+void liberarArenaHilo(void);
+
+/* Llamadas a malloc/calloc/realloc hechas por este hilo hasta ahora
+ * (siempre 0 si no se compiló con CONTAR_ASIGNACIONES) */
+unsigned long asignacionesHilo(void);
+
+/* Turnos, memoria usada por turno y asignaciones por turno */
+void imprimirEstadisticasArena(void);
+
+#endif /* ARENA_H */
@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "banca.h"
+#include "mazo.h"
+#include "candados.h"
+
+static int barajasPartida = BARAJAS_POR_DEFECTO;
+
+static void bloquearBanca(Banca *banca) {
+    if (banca->candado != NULL) {
+        BLOQUEAR(banca->candado);
+    }
+}
+
+static void desbloquearBanca(Banca *banca) {
+    if (banca->candado != NULL) {
+        DESBLOQUEAR(banca->candado);
+    }
+}
+
+/* xorshift64*: cada banca lleva su propio estado */
+static uint64_t aleatorioBanca(uint64_t *estado) {
+    uint64_t x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* Fisher-Yates sobre un arreglo contiguo */
+static void barajarCartas(Carta *cartas, int numCartas, uint64_t *semilla) {
+    for (int i = numCartas - 1; i > 0; i--) {
+        int j = (int)(aleatorioBanca(semilla) % (uint64_t)(i + 1));
+        Carta temp = cartas[i];
+        cartas[i] = cartas[j];
+        cartas[j] = temp;
+    }
+}
+
+void inicializarBanca(Banca *banca, pthread_mutex_t *candado) {
+    memset(banca, 0, sizeof(Banca));
+    banca->candado = candado;
+    banca->semilla = 1;
+}
+
+void liberarBanca(Banca *banca) {
+    pthread_mutex_t *candado = banca->candado;
+
+    free(banca->anillo);
+    inicializarBanca(banca, candado);
+}
+
+bool generarZapato(Banca *banca, int numBarajas, uint64_t semilla) {
+    static const char palos[] = {'C', 'D', 'T', 'E'};  /* Corazones, Diamantes, Tréboles, Espadas */
+    int total, capacidad = 1;
+
+    if (numBarajas < 1 || numBarajas > MAX_BARAJAS) {
+        printf("Error: Número de barajas inválido: %d\n", numBarajas);
+        return false;
+    }
+    total = numBarajas * CARTAS_POR_BARAJA;
+    while (capacidad < total) {
+        capacidad *= 2;
+    }
+
+    bloquearBanca(banca);
+
+    /* Una sola reserva: el anillo y, detrás, la pila de descartes */
+    if (banca->anillo == NULL || banca->mascara + 1 < capacidad) {
+        Carta *memoria = malloc(2 * (size_t)capacidad * sizeof(Carta));
+        if (memoria == NULL) {
+            desbloquearBanca(banca);
+            printf("Error: No se pudo asignar memoria para la banca\n");
+            return false;
+        }
+        free(banca->anillo);
+        banca->anillo = memoria;
+        banca->descartes = memoria + capacidad;
+        banca->mascara = capacidad - 1;
+    }
+
+    if (semilla == 0) {
+        semilla = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+    }
+    banca->semilla = semilla != 0 ? semilla : 1;
+
+    /* Escribir las barajas directamente en el anillo, desde la posición 0 */
+    int n = 0;
+    for (int baraja = 0; baraja < numBarajas; baraja++) {
+        for (int palo = 0; palo < NUM_PALOS; palo++) {
+            for (int valor = 1; valor <= NUM_VALORES; valor++) {
+                banca->anillo[n].valor = valor;
+                banca->anillo[n].palo = palos[palo];
+                banca->anillo[n].esComodin = false;
+                n++;
+            }
+        }
+        for (int i = 0; i < COMODINES_POR_BARAJA; i++) {
+            banca->anillo[n].valor = 0;
+            banca->anillo[n].palo = 'J';  /* Joker */
+            banca->anillo[n].esComodin = true;
+            n++;
+        }
+    }
+    barajarCartas(banca->anillo, n, &banca->semilla);
+
+    banca->inicio = 0;
+    banca->totalCartas = total;
+    banca->numBarajas = numBarajas;
+    banca->rebarajes = 0;
+    __atomic_store_n(&banca->numDescartes, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&banca->numCartas, n, __ATOMIC_RELEASE);
+
+    desbloquearBanca(banca);
+    return true;
+}
+
+/* Barajar la pila de descartes y ponerla debajo de las cartas del anillo
+ * (con el candado tomado). descartarBanca garantiza que caben */
+static void rebarajarDescartes(Banca *banca) {
+    int capacidad = banca->mascara + 1;
+    int n = banca->numDescartes;
+    int fin = (banca->inicio + banca->numCartas) & banca->mascara;
+    int primera = n < capacidad - fin ? n : capacidad - fin;
+
+    barajarCartas(banca->descartes, n, &banca->semilla);
+    memcpy(banca->anillo + fin, banca->descartes, primera * sizeof(Carta));
+    memcpy(banca->anillo, banca->descartes + primera, (n - primera) * sizeof(Carta));
+
+    banca->rebarajes++;
+    __atomic_store_n(&banca->numDescartes, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&banca->numCartas, banca->numCartas + n, __ATOMIC_RELEASE);
+}
+
+int robarBanca(Banca *banca, Carta *destino, int n) {
+    if (n <= 0) {
+        return 0;
+    }
+
+    bloquearBanca(banca);
+
+    if (banca->numCartas < n && banca->rebarajarDescartes && banca->numDescartes > 0) {
+        rebarajarDescartes(banca);
+    }
+
+    /* Hasta dos tramos: del inicio al final del anillo y desde la posición 0 */
+    int capacidad = banca->mascara + 1;
+    int cuantas = n < banca->numCartas ? n : banca->numCartas;
+    int primera = cuantas < capacidad - banca->inicio ? cuantas : capacidad - banca->inicio;
+
+    memcpy(destino, banca->anillo + banca->inicio, primera * sizeof(Carta));
+    memcpy(destino + primera, banca->anillo, (cuantas - primera) * sizeof(Carta));
+    banca->inicio = (banca->inicio + cuantas) & banca->mascara;
+    __atomic_store_n(&banca->numCartas, banca->numCartas - cuantas, __ATOMIC_RELEASE);
+
+    desbloquearBanca(banca);
+    return cuantas;
+}
+
+bool devolverBanca(Banca *banca, const Carta *cartas, int n) {
+    if (n <= 0) {
+        return n == 0;
+    }
+
+    bloquearBanca(banca);
+
+    if (banca->anillo == NULL || banca->numCartas + banca->numDescartes + n > banca->mascara + 1) {
+        desbloquearBanca(banca);
+        printf("Error: Las cartas devueltas no caben en la banca\n");
+        return false;
+    }
+
+    int capacidad = banca->mascara + 1;
+    int inicio = (banca->inicio - n) & banca->mascara;
+    int primera = n < capacidad - inicio ? n : capacidad - inicio;
+
+    memcpy(banca->anillo + inicio, cartas, primera * sizeof(Carta));
+    memcpy(banca->anillo, cartas + primera, (n - primera) * sizeof(Carta));
+    banca->inicio = inicio;
+    __atomic_store_n(&banca->numCartas, banca->numCartas + n, __ATOMIC_RELEASE);
+
+    desbloquearBanca(banca);
+    return true;
+}
+
+bool descartarBanca(Banca *banca, const Carta *cartas, int n) {
+    if (n <= 0) {
+        return n == 0;
+    }
+
+    bloquearBanca(banca);
+
+    /* Entre el anillo y los descartes nunca hay más cartas que capacidad, así
+     * que rebarajar siempre cabe */
+    if (banca->anillo == NULL || banca->numCartas + banca->numDescartes + n > banca->mascara + 1) {
+        desbloquearBanca(banca);
+        printf("Error: Los descartes no caben en la banca\n");
+        return false;
+    }
+
+    memcpy(banca->descartes + banca->numDescartes, cartas, n * sizeof(Carta));
+    __atomic_store_n(&banca->numDescartes, banca->numDescartes + n, __ATOMIC_RELEASE);
+
+    desbloquearBanca(banca);
+    return true;
+}
+
+void configurarRebarajeBanca(Banca *banca, bool rebarajar) {
+    bloquearBanca(banca);
+    __atomic_store_n(&banca->rebarajarDescartes, rebarajar, __ATOMIC_RELEASE);
+    desbloquearBanca(banca);
+}
+
+int cartasEnBanca(const Banca *banca) {
+    int cartas = __atomic_load_n(&banca->numCartas, __ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(&banca->rebarajarDescartes, __ATOMIC_ACQUIRE)) {
+        cartas += __atomic_load_n(&banca->numDescartes, __ATOMIC_ACQUIRE);
+    }
+    return cartas;
+}
+
+int copiarCartasBanca(Banca *banca, Carta *destino, int maxCartas) {
+    int copiadas = 0;
+
+    bloquearBanca(banca);
+    for (int i = 0; i < banca->numCartas && copiadas < maxCartas; i++) {
+        destino[copiadas++] = banca->anillo[(banca->inicio + i) & banca->mascara];
+    }
+    for (int i = 0; i < banca->numDescartes && copiadas < maxCartas; i++) {
+        destino[copiadas++] = banca->descartes[i];
+    }
+    desbloquearBanca(banca);
+    return copiadas;
+}
+
+size_t memoriaBanca(const Banca *banca) {
+    return banca->anillo != NULL ? 2 * (size_t)(banca->mascara + 1) * sizeof(Carta) : 0;
+}
+
+int cartasRepartoBanca(int totalCartas, int numJugadores) {
+    if (numJugadores <= 0) {
+        return 0;
+    }
+
+    int cartas = (totalCartas * 2) / (3 * numJugadores);
+    return cartas < MAX_CARTAS_MAZO / 2 ? cartas : MAX_CARTAS_MAZO / 2;
+}
+
+void configurarBarajas(int numBarajas) {
+    if (numBarajas < 1) {
+        numBarajas = 1;
+    } else if (numBarajas > MAX_BARAJAS) {
+        numBarajas = MAX_BARAJAS;
+    }
+    barajasPartida = numBarajas;
+}
+
+int barajasConfiguradas(void) {
+    return barajasPartida;
+}
+
+/* --- Banco de pruebas --- */
+
+#define LOTE_BANCO_BANCA        8     /* Cartas por robo en el modo por lotes */
+#define HILOS_BANCO_BANCA       4
+#define OPERACIONES_HILO_BANCA  200000
+
+static double segundosDesde(const struct timespec *inicio) {
+    struct timespec fin;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - inicio->tv_sec) + (fin.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/* Índice de una carta para contar copias: palo y valor, o el último para comodines */
+static int indiceCarta(Carta carta) {
+    static const char palos[] = "CDTE";
+
+    if (carta.esComodin) {
+        return NUM_PALOS * NUM_VALORES;
+    }
+    const char *palo = strchr(palos, carta.palo);
+    if (palo == NULL || carta.palo == '\0' || carta.valor < 1 || carta.valor > NUM_VALORES) {
+        return -1;
+    }
+    return (int)(palo - palos) * NUM_VALORES + carta.valor - 1;
+}
+
+/* Comprobar (sin hilos activos) que entre el anillo y los descartes está el
+ * zapato entero: numBarajas copias de cada natural y sus comodines */
+static bool comprobarZapato(const Banca *banca) {
+    int copias[NUM_PALOS * NUM_VALORES + 1] = {0};
+
+    if (banca->numCartas + banca->numDescartes != banca->totalCartas) {
+        printf("Error: La banca tiene %d cartas y %d descartes de un zapato de %d\n",
+               banca->numCartas, banca->numDescartes, banca->totalCartas);
+        return false;
+    }
+    for (int i = 0; i < banca->numCartas; i++) {
+        int indice = indiceCarta(banca->anillo[(banca->inicio + i) & banca->mascara]);
+        if (indice < 0) {
+            printf("Error: Carta inválida en la banca\n");
+            return false;
+        }
+        copias[indice]++;
+    }
+    for (int i = 0; i < banca->numDescartes; i++) {
+        int indice = indiceCarta(banca->descartes[i]);
+        if (indice < 0) {
+            printf("Error: Carta inválida en los descartes\n");
+            return false;
+        }
+        copias[indice]++;
+    }
+    for (int i = 0; i < NUM_PALOS * NUM_VALORES; i++) {
+        if (copias[i] != banca->numBarajas) {
+            printf("Error: %d copias de una carta natural en lugar de %d\n", copias[i], banca->numBarajas);
+            return false;
+        }
+    }
+    if (copias[NUM_PALOS * NUM_VALORES] != banca->numBarajas * COMODINES_POR_BARAJA) {
+        printf("Error: %d comodines en lugar de %d\n", copias[NUM_PALOS * NUM_VALORES],
+               banca->numBarajas * COMODINES_POR_BARAJA);
+        return false;
+    }
+    return true;
+}
+
+/* Vaciar el zapato numRondas veces robando de lote en lote y devolviendo
+ * todo a los descartes; cada ronda empieza con un rebaraje. Devuelve las
+ * cartas robadas */
+static long vaciarZapato(Banca *banca, Carta *robadas, int numRondas, int lote) {
+    long total = 0;
+
+    for (int r = 0; r < numRondas; r++) {
+        int n = 0, robo;
+        while ((robo = robarBanca(banca, robadas + n, lote)) > 0) {
+            n += robo;
+        }
+        descartarBanca(banca, robadas, n);
+        total += n;
+    }
+    return total;
+}
+
+typedef struct {
+    Banca *banca;
+    uint64_t semilla;
+    long robadas;
+} TrabajoBanca;
+
+/* Robar lotes de 1 a LOTE_BANCO_BANCA cartas y descartarlas enseguida */
+static void* hiloBancoBanca(void *arg) {
+    TrabajoBanca *trabajo = (TrabajoBanca*)arg;
+    Carta mano[LOTE_BANCO_BANCA];
+
+    for (int i = 0; i < OPERACIONES_HILO_BANCA; i++) {
+        int n = 1 + (int)(aleatorioBanca(&trabajo->semilla) % LOTE_BANCO_BANCA);
+        int robadas = robarBanca(trabajo->banca, mano, n);
+        descartarBanca(trabajo->banca, mano, robadas);
+        trabajo->robadas += robadas;
+    }
+    return NULL;
+}
+
+bool ejecutarBancoBanca(int numRondas) {
+    pthread_mutex_t candado = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t hilos[HILOS_BANCO_BANCA];
+    TrabajoBanca trabajos[HILOS_BANCO_BANCA];
+    struct timespec inicio;
+    Banca banca;
+    Carta *robadas;
+    bool correcto = true;
+
+    if (numRondas <= 0) {
+        printf("Número de rondas inválido\n");
+        return false;
+    }
+
+    inicializarBanca(&banca, &candado);
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    if (!generarZapato(&banca, barajasConfiguradas(), 12345)) {
+        return false;
+    }
+    double segundosZapato = segundosDesde(&inicio);
+    robadas = malloc(banca.totalCartas * sizeof(Carta));
+    if (robadas == NULL) {
+        printf("Error: No se pudo preparar el banco de la banca\n");
+        liberarBanca(&banca);
+        return false;
+    }
+    configurarRebarajeBanca(&banca, true);
+
+    printf("Banco de la banca: zapato de %d barajas (%d cartas, %zu bytes) generado en %.1f us, %d rondas\n",
+           banca.numBarajas, banca.totalCartas, memoriaBanca(&banca), segundosZapato * 1e6, numRondas);
+
+    /* Carta a carta (como comía la banca anterior) y en lotes, con el candado */
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    long cartas = vaciarZapato(&banca, robadas, numRondas, 1);
+    double segundosUna = segundosDesde(&inicio);
+    correcto = correcto && comprobarZapato(&banca);
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    long cartasLote = vaciarZapato(&banca, robadas, numRondas, LOTE_BANCO_BANCA);
+    double segundosLote = segundosDesde(&inicio);
+    correcto = correcto && comprobarZapato(&banca);
+
+    printf("  de 1 en 1:   %10.0f cartas/s\n", cartas / (segundosUna > 0 ? segundosUna : 1e-9));
+    printf("  lotes de %d:  %10.0f cartas/s (%.1fx)\n", LOTE_BANCO_BANCA,
+           cartasLote / (segundosLote > 0 ? segundosLote : 1e-9),
+           segundosLote > 0 ? (segundosUna / cartas) / (segundosLote / cartasLote) : 0.0);
+
+    /* Varios hilos robando y descartando sobre la misma banca */
+    int rebarajesPrevios = banca.rebarajes;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    int creados = 0;
+    for (int i = 0; i < HILOS_BANCO_BANCA; i++) {
+        trabajos[i].banca = &banca;
+        trabajos[i].semilla = 0x9E3779B97F4A7C15ULL * (i + 1);
+        trabajos[i].robadas = 0;
+        if (pthread_create(&hilos[creados], NULL, hiloBancoBanca, &trabajos[i]) == 0) {
+            creados++;
+        }
+    }
+    long robadasHilos = 0;
+    for (int i = 0; i < creados; i++) {
+        pthread_join(hilos[i], NULL);
+        robadasHilos += trabajos[i].robadas;
+    }
+    double segundosHilos = segundosDesde(&inicio);
+    correcto = correcto && comprobarZapato(&banca);
+
+    printf("  %d hilos:     %10.0f cartas/s, %d rebarajes de los descartes\n", creados,
+           robadasHilos / (segundosHilos > 0 ? segundosHilos : 1e-9), banca.rebarajes - rebarajesPrevios);
+    printf("  zapato %s\n", correcto ? "completo tras todas las pruebas" : "INCORRECTO");
+
+    free(robadas);
+    liberarBanca(&banca);
+    return correcto;
+}
@@ -0,0 +1,93 @@
+#ifndef BANCA_H
+#define BANCA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "jugadores.h"
+
+/* Banca: las cartas que quedan por comer.
+ *
+ * Las cartas viven en un anillo de capacidad potencia de 2 que se reserva una
+ * sola vez al generar el zapato: las K barajas se escriben y se barajan
+ * directamente en él, sin pasar por un Mazo ni ampliar nada carta a carta.
+ * Se roba de arriba y se devuelve arriba; los descartes esperan en su propio
+ * arreglo y, si la banca lo permite, cuando el anillo no alcanza se barajan y
+ * entran por abajo. robarBanca saca n cartas con una sola toma del candado,
+ * así que repartir una mano entera cuesta lo mismo que comer una ficha.
+ *
+ * El candado es opcional (NULL en el torneo, que tiene un solo hilo). El
+ * número de cartas se publica con escrituras atómicas, de modo que
+ * cartasEnBanca puede leerse sin tomarlo */
+
+#define BARAJAS_POR_DEFECTO   2    /* 2 barajas + 4 comodines: 108 cartas */
+#define MAX_BARAJAS           16
+#define CARTAS_POR_BARAJA     54   /* 52 naturales + 2 comodines */
+#define COMODINES_POR_BARAJA  2
+
+typedef struct Banca {
+    Carta *anillo;              /* Capacidad potencia de 2 */
+    int mascara;                /* Capacidad - 1 */
+    int inicio;                 /* Posición de la carta de arriba */
+    int numCartas;              /* Cartas en el anillo (atómico) */
+    Carta *descartes;           /* Pila de descartes: segunda mitad de la misma reserva */
+    int numDescartes;           /* (atómico) */
+    int totalCartas;            /* Cartas del zapato generado */
+    int numBarajas;
+    bool rebarajarDescartes;    /* Si los descartes vuelven a la banca al agotarse */
+    int rebarajes;              /* Veces que se rebarajaron los descartes */
+    uint64_t semilla;           /* Generador propio: rand() no es seguro entre hilos */
+    pthread_mutex_t *candado;   /* NULL si solo la usa un hilo */
+} Banca;
+
+/* Dejar la banca vacía, sin memoria, protegida por candado (o NULL) */
+void inicializarBanca(Banca *banca, pthread_mutex_t *candado);
+void liberarBanca(Banca *banca);
+
+/* Generar un zapato de numBarajas barajas mezcladas directamente en el
+ * anillo, reutilizando su memoria si ya alcanza. Descarta lo que hubiera.
+ * Con semilla 0 se toma una de rand(). Devuelve false si no hubo memoria */
+bool generarZapato(Banca *banca, int numBarajas, uint64_t semilla);
+
+/* Robar hasta n cartas de arriba, en destino, con una sola toma del candado.
+ * Si no alcanzan y se rebarajan descartes, primero entran los descartes.
+ * Devuelve cuántas se robaron */
+int robarBanca(Banca *banca, Carta *destino, int n);
+
+/* Devolver n cartas a la parte de arriba en el orden en que se robaron
+ * (cartas[0] queda arriba), deshaciendo un robo. false si no caben */
+bool devolverBanca(Banca *banca, const Carta *cartas, int n);
+
+/* Dejar n cartas en la pila de descartes. false si no caben */
+bool descartarBanca(Banca *banca, const Carta *cartas, int n);
+
+/* Activar o desactivar el rebaraje de los descartes */
+void configurarRebarajeBanca(Banca *banca, bool rebarajar);
+
+/* Cartas que se pueden robar: las del anillo y, si se rebarajan, los
+ * descartes. Se puede llamar sin el candado */
+int cartasEnBanca(const Banca *banca);
+
+/* Copiar en destino todas las cartas de la banca, las del anillo (de arriba
+ * abajo) y después los descartes, con una sola toma del candado. Devuelve
+ * cuántas se copiaron (a lo sumo maxCartas) */
+int copiarCartasBanca(Banca *banca, Carta *destino, int maxCartas);
+
+/* Memoria reservada por la banca, en bytes */
+size_t memoriaBanca(const Banca *banca);
+
+/* Cartas de la mano inicial de cada jugador con un zapato de totalCartas:
+ * 2/3 del zapato repartidos, sin pasar de la mitad de MAX_CARTAS_MAZO para
+ * que la mano quepa en los arreglos de tamaño fijo al comer */
+int cartasRepartoBanca(int totalCartas, int numJugadores);
+
+/* Barajas de los zapatos de la partida (--barajas), acotadas a 1..MAX_BARAJAS */
+void configurarBarajas(int numBarajas);
+int barajasConfiguradas(void);
+
+/* Banco de pruebas: numRondas rondas que vacían el zapato carta a carta y en
+ * lotes, y una prueba de varios hilos que roban y descartan con rebaraje,
+ * comprobando que no se pierde ni se duplica ninguna carta */
+bool ejecutarBancoBanca(int numRondas);
+
+#endif /* BANCA_H */
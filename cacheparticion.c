@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <string.h>
+#include "cacheparticion.h"
+#include "utilidades.h"
+
+/* Una jugada compacta ocupa 32 bits:
+ *   bit 0      1 = grupo, 0 = escalera
+ *   bits 1-2   palo (escalera)
+ *   grupo:     bits 3-6 palos con carta natural, bits 7-9 comodines, bits 10-13 valor
+ *   escalera:  bits 3-6 primer valor, bits 7-10 longitud, bits 11-23 posiciones con comodín */
+
+typedef struct {
+    uint32_t version;                        /* Seqlock: impar mientras se escribe, 0 = vacía */
+    uint32_t edad;                           /* Reloj de la caché en el último uso */
+    uint64_t clave[4];
+    int16_t puntos;
+    int16_t cartas;
+    uint8_t numJugadas;
+    uint32_t jugadas[MAX_JUGADAS_CACHE];
+} EntradaCache;
+
+static EntradaCache cache[TAMANO_CACHE_PARTICION];
+
+/* Contadores (atómicos, compartidos por todos los hilos) */
+static unsigned long aciertos = 0;
+static unsigned long fallos = 0;
+static unsigned long inserciones = 0;
+static unsigned long desalojos = 0;
+static unsigned long colisionesEscritura = 0;   /* Otro hilo escribía la ranura */
+
+/* Reloj de los usos, para elegir la víctima dentro del conjunto */
+static uint32_t reloj = 0;
+
+/* Primera ranura del conjunto de la clave */
+static EntradaCache* conjuntoClave(const uint64_t clave[4]) {
+    uint64_t h = clave[0] * 0xD6E8FEB86659FD93ULL;
+    h = (h ^ (h >> 32) ^ clave[1]) * 0xD6E8FEB86659FD93ULL;
+    h = (h ^ (h >> 32) ^ clave[2]) * 0xD6E8FEB86659FD93ULL;
+    h = (h ^ (h >> 32) ^ clave[3]) * 0xD6E8FEB86659FD93ULL;
+    return &cache[(h >> (64 - BITS_CONJUNTOS_CACHE)) * VIAS_CACHE_PARTICION];
+}
+
+static void marcarUso(EntradaCache *entrada) {
+    __atomic_store_n(&entrada->edad, __atomic_add_fetch(&reloj, 1, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+static void contar(unsigned long *contador) {
+    __atomic_add_fetch(contador, 1, __ATOMIC_RELAXED);
+}
+
+static uint32_t codificarJugada(const JugadaParticion *jugada) {
+    uint32_t codigo = 0;
+
+    if (jugada->esGrupo) {
+        int valor = 0;
+        int comodines = 0;
+        uint32_t palos = 0;
+
+        for (int i = 0; i < jugada->numCartas; i++) {
+            if (jugada->cartas[i].esComodin) {
+                comodines++;
+            } else {
+                valor = jugada->cartas[i].valor;
+                palos |= 1u << indicePaloParticion(jugada->cartas[i].palo);
+            }
+        }
+        codigo = 1u | (palos << 3) | ((uint32_t)comodines << 7) | ((uint32_t)valor << 10);
+    } else {
+        int inicio = 0;
+        uint32_t mascaraComodines = 0;
+
+        for (int i = 0; i < jugada->numCartas; i++) {
+            if (jugada->cartas[i].esComodin) {
+                mascaraComodines |= 1u << i;
+            } else if (inicio == 0) {
+                inicio = jugada->cartas[i].valor - i;
+            }
+        }
+        codigo = ((uint32_t)indicePaloParticion(jugada->palo) << 1) | ((uint32_t)inicio << 3) |
+                 ((uint32_t)jugada->numCartas << 7) | (mascaraComodines << 11);
+    }
+
+    return codigo;
+}
+
+static void decodificarJugada(uint32_t codigo, JugadaParticion *jugada) {
+    Carta comodin = {0, 'J', true};
+
+    jugada->numCartas = 0;
+    jugada->puntos = 0;
+    jugada->esGrupo = (codigo & 1u) != 0;
+    jugada->palo = palosParticion[(codigo >> 1) & 3u];
+
+    if (jugada->esGrupo) {
+        int valor = (int)((codigo >> 10) & 15u);
+        int comodines = (int)((codigo >> 7) & 7u);
+
+        for (int p = 0; p < NUM_PALOS_PARTICION; p++) {
+            if (codigo & (1u << (3 + p))) {
+                Carta carta = {valor, palosParticion[p], false};
+                jugada->cartas[jugada->numCartas++] = carta;
+            }
+        }
+        for (int c = 0; c < comodines; c++) {
+            jugada->cartas[jugada->numCartas++] = comodin;
+        }
+    } else {
+        int inicio = (int)((codigo >> 3) & 15u);
+        int longitud = (int)((codigo >> 7) & 15u);
+
+        for (int i = 0; i < longitud; i++) {
+            if (codigo & (1u << (11 + i))) {
+                jugada->cartas[jugada->numCartas++] = comodin;
+            } else {
+                Carta carta = {inicio + i, jugada->palo, false};
+                jugada->cartas[jugada->numCartas++] = carta;
+            }
+        }
+    }
+
+    for (int i = 0; i < jugada->numCartas; i++) {
+        jugada->puntos += calcularPuntosCarta(jugada->cartas[i]);
+    }
+}
+
+/* Copiar la ranura si tiene la clave y nadie la escribía durante la copia */
+static bool leerRanura(EntradaCache *entrada, const uint64_t clave[4], EntradaCache *copia) {
+    uint32_t antes = __atomic_load_n(&entrada->version, __ATOMIC_ACQUIRE);
+    if (antes == 0 || (antes & 1u)) {
+        return false;
+    }
+
+    memcpy(copia, entrada, sizeof(EntradaCache));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t despues = __atomic_load_n(&entrada->version, __ATOMIC_RELAXED);
+
+    /* Si la ranura cambió durante la copia se trata como un fallo, sin reintentar */
+    return antes == despues && memcmp(copia->clave, clave, sizeof(copia->clave)) == 0 &&
+           copia->numJugadas <= MAX_JUGADAS_CACHE;
+}
+
+bool buscarParticionCache(const uint64_t clave[4], ParticionMano *resultado) {
+    EntradaCache *conjunto = conjuntoClave(clave);
+    EntradaCache copia;
+    int via = 0;
+
+    while (via < VIAS_CACHE_PARTICION && !leerRanura(&conjunto[via], clave, &copia)) {
+        via++;
+    }
+    if (via == VIAS_CACHE_PARTICION) {
+        contar(&fallos);
+        return false;
+    }
+    marcarUso(&conjunto[via]);
+
+    resultado->numJugadas = copia.numJugadas;
+    resultado->puntos = copia.puntos;
+    resultado->cartas = copia.cartas;
+    resultado->exacto = true;
+    resultado->nodos = 0;
+    for (int i = 0; i < copia.numJugadas; i++) {
+        decodificarJugada(copia.jugadas[i], &resultado->jugadas[i]);
+    }
+
+    contar(&aciertos);
+    return true;
+}
+
+void guardarParticionCache(const uint64_t clave[4], const ParticionMano *particion) {
+    if (!particion->exacto || particion->numJugadas > MAX_JUGADAS_CACHE) {
+        return;
+    }
+
+    /* La ranura de la misma clave si ya está; si no, una libre o la usada
+     * hace más tiempo */
+    EntradaCache *conjunto = conjuntoClave(clave);
+    EntradaCache *entrada = NULL;
+    for (int v = 0; v < VIAS_CACHE_PARTICION; v++) {
+        uint32_t versionVia = __atomic_load_n(&conjunto[v].version, __ATOMIC_RELAXED);
+        if (versionVia == 0 || memcmp(conjunto[v].clave, clave, sizeof(conjunto[v].clave)) == 0) {
+            entrada = &conjunto[v];
+            break;
+        }
+        if (entrada == NULL || (int32_t)(__atomic_load_n(&conjunto[v].edad, __ATOMIC_RELAXED) -
+                                         __atomic_load_n(&entrada->edad, __ATOMIC_RELAXED)) < 0) {
+            entrada = &conjunto[v];
+        }
+    }
+    uint32_t version = __atomic_load_n(&entrada->version, __ATOMIC_RELAXED);
+
+    /* Tomar la ranura; si otro hilo la está escribiendo, no esperar */
+    if ((version & 1u) ||
+        !__atomic_compare_exchange_n(&entrada->version, &version, version + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        contar(&colisionesEscritura);
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (version != 0 && memcmp(entrada->clave, clave, sizeof(entrada->clave)) != 0) {
+        contar(&desalojos);
+    }
+
+    memcpy(entrada->clave, clave, sizeof(entrada->clave));
+    entrada->puntos = (int16_t)particion->puntos;
+    entrada->cartas = (int16_t)particion->cartas;
+    entrada->numJugadas = (uint8_t)particion->numJugadas;
+    for (int i = 0; i < particion->numJugadas; i++) {
+        entrada->jugadas[i] = codificarJugada(&particion->jugadas[i]);
+    }
+
+    marcarUso(entrada);
+    __atomic_store_n(&entrada->version, version + 2, __ATOMIC_RELEASE);
+    contar(&inserciones);
+}
+
+void contadoresCacheParticion(unsigned long *aciertosCache, unsigned long *fallosCache) {
+    *aciertosCache = __atomic_load_n(&aciertos, __ATOMIC_RELAXED);
+    *fallosCache = __atomic_load_n(&fallos, __ATOMIC_RELAXED);
+}
+
+void imprimirEstadisticasCacheParticion(void) {
+    unsigned long consultas = aciertos + fallos;
+    int ocupadas = 0;
+
+    if (consultas == 0) {
+        return;
+    }
+
+    for (int i = 0; i < TAMANO_CACHE_PARTICION; i++) {
+        if (__atomic_load_n(&cache[i].version, __ATOMIC_RELAXED) != 0) {
+            ocupadas++;
+        }
+    }
+
+    printf("Caché de particiones: %lu consultas, %lu aciertos (%.1f%%), %lu fallos, "
+           "%lu inserciones, %lu desalojos, %lu escrituras descartadas, %d/%d ranuras ocupadas "
+           "(%d vías)\n",
+           consultas, aciertos, 100.0 * aciertos / consultas, fallos,
+           inserciones, desalojos, colisionesEscritura, ocupadas, TAMANO_CACHE_PARTICION, VIAS_CACHE_PARTICION);
+}
@@ -0,0 +1,48 @@
+#ifndef CACHEPARTICION_H
+#define CACHEPARTICION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "particion.h"
+
+/* Caché de transposición para resolverParticion.
+ *
+ * La clave es la firma canónica de la mano (conteo por palo y valor, más
+ * comodines) junto con el objetivo, así que dos manos con las mismas cartas
+ * en distinto orden comparten entrada. Se guarda la partición en una forma
+ * compacta (una palabra por jugada) con sus puntos y cartas.
+ *
+ * Es una tabla de tamaño fijo compartida por todos los hilos y por todas
+ * las partidas del proceso, asociativa por conjuntos: la clave elige un
+ * conjunto de VIAS_CACHE_PARTICION ranuras y, si no hay una libre, se
+ * desaloja la usada hace más tiempo (cada ranura guarda la edad de su
+ * último uso). Así una clave no echa a otra solo por caer en la misma
+ * ranura, y las particiones que se repiten entre partidas se quedan. Los
+ * conjuntos se pueden cambiar al compilar (-DBITS_CONJUNTOS_CACHE=N); en un
+ * torneo casi todos los fallos son de manos que no se habían visto, así
+ * que más conjuntos apenas suben los aciertos.
+ *
+ * Cada ranura lleva su propio seqlock: quien escribe lo toma con un CAS (si
+ * otro hilo ya escribe esa ranura, se descarta la inserción) y quien lee
+ * reintenta como fallo si la versión cambió, de modo que nadie se bloquea */
+
+#ifndef BITS_CONJUNTOS_CACHE
+#define BITS_CONJUNTOS_CACHE   12
+#endif
+#define VIAS_CACHE_PARTICION   4
+#define TAMANO_CACHE_PARTICION ((1 << BITS_CONJUNTOS_CACHE) * VIAS_CACHE_PARTICION)
+#define MAX_JUGADAS_CACHE      12   /* Particiones más largas no se guardan */
+
+/* Buscar una partición; devuelve true y la reconstruye en resultado si está */
+bool buscarParticionCache(const uint64_t clave[4], ParticionMano *resultado);
+
+/* Guardar una partición exacta (se ignora si no cabe en la forma compacta) */
+void guardarParticionCache(const uint64_t clave[4], const ParticionMano *particion);
+
+/* Aciertos y fallos acumulados (para la tasa de cada partida del torneo) */
+void contadoresCacheParticion(unsigned long *aciertos, unsigned long *fallos);
+
+/* Mostrar aciertos, fallos, desalojos y ocupación */
+void imprimirEstadisticasCacheParticion(void);
+
+#endif /* CACHEPARTICION_H */
@@ -0,0 +1,367 @@
+#define _GNU_SOURCE
+#include "candados.h"
+
+#ifdef PERFILAR_CANDADOS
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "jugadores.h"
+#include "juego.h"
+
+/* Candados conocidos: los tres globales y los registrados */
+#define NUM_CANDADOS      (3 + MAX_CANDADOS)
+#define NUM_CUBETAS       40   /* Cubetas log2 de nanosegundos (hasta ~18 minutos) */
+#define MAX_SITIOS        16   /* Sitios de llamada distintos por candado y por hilo */
+#define SITIOS_REPORTE    5    /* Sitios que se muestran por candado en el reporte */
+
+/* Un candado o un arreglo de candados consecutivos que se cuentan juntos */
+typedef struct {
+    const char *primero;
+    int cantidad;
+    size_t tamano;
+    const char *nombre;
+} CandadoConocido;
+
+static CandadoConocido candadosConocidos[NUM_CANDADOS] = {
+    {(const char *)&mutexBanca, 1, sizeof(pthread_mutex_t), "mutexBanca"},
+    {(const char *)&mutexTabla, 1, sizeof(pthread_mutex_t), "mutexTabla"},
+    {(const char *)&mutexJuego, 1, sizeof(pthread_mutex_t), "mutexJuego"}
+};
+static int numCandados = 3;   /* Se publica después de llenar la entrada */
+
+/* Estadísticas de un sitio de llamada */
+typedef struct {
+    void *direccion;           /* Dirección de retorno de quien llamó a BLOQUEAR */
+    uint64_t adquisiciones;
+    uint64_t esperaTotal;      /* ns bloqueado en este sitio */
+} SitioCandado;
+
+/* Estadísticas de un candado vistas desde un hilo */
+typedef struct {
+    uint64_t adquisiciones;
+    uint64_t contenciones;     /* Veces que el candado ya estaba tomado */
+    uint64_t esperaTotal;      /* ns esperando para adquirir */
+    uint64_t esperaMaxima;
+    uint64_t retencionTotal;   /* ns con el candado tomado */
+    uint64_t retencionMaxima;
+    uint64_t histEspera[NUM_CUBETAS];
+    uint64_t histRetencion[NUM_CUBETAS];
+    SitioCandado sitios[MAX_SITIOS];
+    int numSitios;
+    uint64_t inicioRetencion;  /* Marca de tiempo de la adquisición en curso */
+} EstadisticasCandado;
+
+/* Bloque de estadísticas de un hilo; se enlaza en una lista global para el reporte
+ * y nunca se libera, para que sobreviva a la terminación del hilo */
+typedef struct PerfilHilo {
+    EstadisticasCandado candados[NUM_CANDADOS];
+    struct PerfilHilo *siguiente;
+} PerfilHilo;
+
+static PerfilHilo *listaPerfiles = NULL;
+static pthread_mutex_t mutexRegistro = PTHREAD_MUTEX_INITIALIZER;
+static __thread PerfilHilo *perfilLocal = NULL;
+
+static uint64_t ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cubetaDe(uint64_t ns) {
+    int cubeta = 0;
+    while (ns > 1 && cubeta < NUM_CUBETAS - 1) {
+        ns >>= 1;
+        cubeta++;
+    }
+    return cubeta;
+}
+
+static int indiceCandado(const void *candado) {
+    const char *direccion = candado;
+    int conocidos = __atomic_load_n(&numCandados, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < conocidos; i++) {
+        const CandadoConocido *c = &candadosConocidos[i];
+        if (direccion >= c->primero && direccion < c->primero + (size_t)c->cantidad * c->tamano) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void registrarCandados(const void *primero, int cantidad, size_t tamano, const char *nombre) {
+    pthread_mutex_lock(&mutexRegistro);
+    if (indiceCandado(primero) < 0 && numCandados < NUM_CANDADOS) {
+        CandadoConocido *c = &candadosConocidos[numCandados];
+        c->primero = primero;
+        c->cantidad = cantidad;
+        c->tamano = tamano;
+        c->nombre = nombre;
+        __atomic_store_n(&numCandados, numCandados + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&mutexRegistro);
+}
+
+static PerfilHilo *obtenerPerfilLocal(void) {
+    if (perfilLocal == NULL) {
+        PerfilHilo *perfil = calloc(1, sizeof(PerfilHilo));
+        if (perfil == NULL) {
+            return NULL;
+        }
+        pthread_mutex_lock(&mutexRegistro);
+        perfil->siguiente = listaPerfiles;
+        listaPerfiles = perfil;
+        pthread_mutex_unlock(&mutexRegistro);
+        perfilLocal = perfil;
+    }
+    return perfilLocal;
+}
+
+static void acumularSitio(EstadisticasCandado *est, void *direccion, uint64_t adquisiciones, uint64_t espera) {
+    for (int i = 0; i < est->numSitios; i++) {
+        if (est->sitios[i].direccion == direccion) {
+            est->sitios[i].adquisiciones += adquisiciones;
+            est->sitios[i].esperaTotal += espera;
+            return;
+        }
+    }
+    if (est->numSitios < MAX_SITIOS) {
+        est->sitios[est->numSitios].direccion = direccion;
+        est->sitios[est->numSitios].adquisiciones = adquisiciones;
+        est->sitios[est->numSitios].esperaTotal = espera;
+        est->numSitios++;
+    }
+}
+
+/* Registrar una adquisición: la espera desde inicio, si hubo contención y
+ * el sitio de llamada */
+static void registrarAdquisicion(EstadisticasCandado *est, uint64_t inicio, bool contencion, void *sitio) {
+    uint64_t adquirido = ahoraNs();
+    uint64_t espera = adquirido - inicio;
+
+    if (contencion) {
+        est->contenciones++;
+    }
+    est->adquisiciones++;
+    est->esperaTotal += espera;
+    if (espera > est->esperaMaxima) {
+        est->esperaMaxima = espera;
+    }
+    est->histEspera[cubetaDe(espera)]++;
+    acumularSitio(est, sitio, 1, espera);
+    est->inicioRetencion = adquirido;
+}
+
+/* Registrar cuánto tiempo se retuvo un candado (antes de soltarlo) */
+static void registrarLiberacion(const void *candado) {
+    int indice = indiceCandado(candado);
+
+    if (indice >= 0 && perfilLocal != NULL && perfilLocal->candados[indice].inicioRetencion != 0) {
+        EstadisticasCandado *est = &perfilLocal->candados[indice];
+        uint64_t retencion = ahoraNs() - est->inicioRetencion;
+
+        est->retencionTotal += retencion;
+        if (retencion > est->retencionMaxima) {
+            est->retencionMaxima = retencion;
+        }
+        est->histRetencion[cubetaDe(retencion)]++;
+        est->inicioRetencion = 0;
+    }
+}
+
+/* Estadísticas del candado en el hilo, o NULL si no es uno conocido */
+static EstadisticasCandado *estadisticasDe(const void *candado) {
+    int indice = indiceCandado(candado);
+    PerfilHilo *perfil = indice >= 0 ? obtenerPerfilLocal() : NULL;
+
+    return perfil != NULL ? &perfil->candados[indice] : NULL;
+}
+
+/* Bloquear midiendo la espera; noinline para que __builtin_return_address(0)
+ * apunte al código que usó BLOQUEAR */
+__attribute__((noinline))
+void perfilBloquear(pthread_mutex_t *mutex) {
+    EstadisticasCandado *est = estadisticasDe(mutex);
+
+    if (est == NULL) {
+        pthread_mutex_lock(mutex);
+        return;
+    }
+
+    uint64_t inicio = ahoraNs();
+    bool contencion = pthread_mutex_trylock(mutex) != 0;
+    if (contencion) {
+        pthread_mutex_lock(mutex);
+    }
+    registrarAdquisicion(est, inicio, contencion, __builtin_return_address(0));
+}
+
+/* Desbloquear registrando cuánto tiempo se retuvo el candado */
+void perfilDesbloquear(pthread_mutex_t *mutex) {
+    registrarLiberacion(mutex);
+    pthread_mutex_unlock(mutex);
+}
+
+/* Lo mismo para los rwlock, en lectura o en escritura. Cada hilo cuenta
+ * sus propias retenciones, así que varios lectores a la vez no se pisan */
+__attribute__((noinline))
+void perfilBloquearLectura(pthread_rwlock_t *candado) {
+    EstadisticasCandado *est = estadisticasDe(candado);
+
+    if (est == NULL) {
+        pthread_rwlock_rdlock(candado);
+        return;
+    }
+
+    uint64_t inicio = ahoraNs();
+    bool contencion = pthread_rwlock_tryrdlock(candado) != 0;
+    if (contencion) {
+        pthread_rwlock_rdlock(candado);
+    }
+    registrarAdquisicion(est, inicio, contencion, __builtin_return_address(0));
+}
+
+__attribute__((noinline))
+void perfilBloquearEscritura(pthread_rwlock_t *candado) {
+    EstadisticasCandado *est = estadisticasDe(candado);
+
+    if (est == NULL) {
+        pthread_rwlock_wrlock(candado);
+        return;
+    }
+
+    uint64_t inicio = ahoraNs();
+    bool contencion = pthread_rwlock_trywrlock(candado) != 0;
+    if (contencion) {
+        pthread_rwlock_wrlock(candado);
+    }
+    registrarAdquisicion(est, inicio, contencion, __builtin_return_address(0));
+}
+
+void perfilDesbloquearRW(pthread_rwlock_t *candado) {
+    registrarLiberacion(candado);
+    pthread_rwlock_unlock(candado);
+}
+
+static void imprimirHistograma(const char *titulo, const uint64_t *hist) {
+    uint64_t maximo = 0;
+    for (int i = 0; i < NUM_CUBETAS; i++) {
+        if (hist[i] > maximo) maximo = hist[i];
+    }
+    if (maximo == 0) {
+        return;
+    }
+
+    printf("    %s:\n", titulo);
+    for (int i = 0; i < NUM_CUBETAS; i++) {
+        if (hist[i] == 0) continue;
+        int barra = (int)(hist[i] * 40 / maximo);
+        printf("      < %10llu ns %8llu ", 1ULL << (i + 1), (unsigned long long)hist[i]);
+        for (int j = 0; j < barra; j++) putchar('#');
+        putchar('\n');
+    }
+}
+
+/* Combinar las estadísticas de todos los hilos y mostrar los candados
+ * ordenados por tiempo total bloqueado */
+void imprimirReporteCandados(void) {
+    EstadisticasCandado total[NUM_CANDADOS];
+    int orden[NUM_CANDADOS];
+    int conocidos = __atomic_load_n(&numCandados, __ATOMIC_ACQUIRE);
+
+    memset(total, 0, sizeof(total));
+
+    pthread_mutex_lock(&mutexRegistro);
+    for (PerfilHilo *p = listaPerfiles; p != NULL; p = p->siguiente) {
+        for (int c = 0; c < NUM_CANDADOS; c++) {
+            EstadisticasCandado *origen = &p->candados[c];
+            EstadisticasCandado *destino = &total[c];
+
+            destino->adquisiciones += origen->adquisiciones;
+            destino->contenciones += origen->contenciones;
+            destino->esperaTotal += origen->esperaTotal;
+            destino->retencionTotal += origen->retencionTotal;
+            if (origen->esperaMaxima > destino->esperaMaxima) destino->esperaMaxima = origen->esperaMaxima;
+            if (origen->retencionMaxima > destino->retencionMaxima) destino->retencionMaxima = origen->retencionMaxima;
+            for (int i = 0; i < NUM_CUBETAS; i++) {
+                destino->histEspera[i] += origen->histEspera[i];
+                destino->histRetencion[i] += origen->histRetencion[i];
+            }
+            for (int s = 0; s < origen->numSitios; s++) {
+                acumularSitio(destino, origen->sitios[s].direccion,
+                              origen->sitios[s].adquisiciones, origen->sitios[s].esperaTotal);
+            }
+        }
+    }
+    pthread_mutex_unlock(&mutexRegistro);
+
+    /* Ordenar los candados por tiempo total bloqueado (mayor primero) */
+    for (int c = 0; c < conocidos; c++) {
+        orden[c] = c;
+    }
+    for (int i = 0; i < conocidos - 1; i++) {
+        for (int j = 0; j < conocidos - i - 1; j++) {
+            if (total[orden[j]].esperaTotal < total[orden[j + 1]].esperaTotal) {
+                int temp = orden[j];
+                orden[j] = orden[j + 1];
+                orden[j + 1] = temp;
+            }
+        }
+    }
+
+    printf("\n=== PERFIL DE CANDADOS (ordenado por tiempo bloqueado) ===\n");
+    printf("%-18s %10s %10s %14s %12s %14s %12s\n",
+           "Candado", "Adquis.", "Contenc.", "Espera (us)", "Máx (us)", "Retención (us)", "Máx (us)");
+    for (int i = 0; i < conocidos; i++) {
+        EstadisticasCandado *est = &total[orden[i]];
+        printf("%-18s %10llu %10llu %14.1f %12.1f %14.1f %12.1f\n",
+               candadosConocidos[orden[i]].nombre,
+               (unsigned long long)est->adquisiciones,
+               (unsigned long long)est->contenciones,
+               est->esperaTotal / 1000.0, est->esperaMaxima / 1000.0,
+               est->retencionTotal / 1000.0, est->retencionMaxima / 1000.0);
+    }
+
+    for (int i = 0; i < conocidos; i++) {
+        EstadisticasCandado *est = &total[orden[i]];
+        if (est->adquisiciones == 0) continue;
+
+        printf("\n  %s\n", candadosConocidos[orden[i]].nombre);
+        imprimirHistograma("Espera", est->histEspera);
+        imprimirHistograma("Retención", est->histRetencion);
+
+        /* Sitios de llamada con más tiempo bloqueado */
+        printf("    Sitios de llamada (binario+desplazamiento, para addr2line -e):\n");
+        for (int mostrados = 0; mostrados < SITIOS_REPORTE && mostrados < est->numSitios; mostrados++) {
+            int mejor = mostrados;
+            for (int k = mostrados + 1; k < est->numSitios; k++) {
+                if (est->sitios[k].esperaTotal > est->sitios[mejor].esperaTotal) {
+                    mejor = k;
+                }
+            }
+            SitioCandado temp = est->sitios[mostrados];
+            est->sitios[mostrados] = est->sitios[mejor];
+            est->sitios[mejor] = temp;
+
+            Dl_info info;
+            void *direccion = est->sitios[mostrados].direccion;
+            if (dladdr(direccion, &info) && info.dli_fname != NULL) {
+                printf("      %s+0x%lx", info.dli_fname,
+                       (unsigned long)((char *)direccion - (char *)info.dli_fbase));
+            } else {
+                printf("      %p", direccion);
+            }
+            printf(": %llu adquisiciones, %.1f us bloqueado\n",
+                   (unsigned long long)est->sitios[mostrados].adquisiciones,
+                   est->sitios[mostrados].esperaTotal / 1000.0);
+        }
+    }
+    printf("==========================================================\n");
+}
+
+#endif /* PERFILAR_CANDADOS */
@@ -0,0 +1,64 @@
+#ifndef CANDADOS_H
+#define CANDADOS_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/* Capa de instrumentación para los candados del juego: los mutex globales
+ * (mutexBanca, mutexTabla y mutexJuego; la mesa no usa candados, ver mesa.h)
+ * y los que cada módulo registra con REGISTRAR_CANDADOS (los de la memoria,
+ * los slabs y la traza de memoria).
+ *
+ * Todo el código bloquea los mutex con BLOQUEAR/DESBLOQUEAR y los rwlock con
+ * BLOQUEAR_LECTURA/BLOQUEAR_ESCRITURA/DESBLOQUEAR_RW. Al compilar con
+ * -DPERFILAR_CANDADOS cada adquisición de un candado conocido registra el
+ * tiempo de espera, el tiempo de retención, si hubo contención y el sitio de
+ * llamada en histogramas propios de cada hilo; imprimirReporteCandados() los
+ * combina al final del juego. Sin la bandera las macros son las llamadas de
+ * pthread directas y el registro y el reporte son funciones vacías, así que
+ * no hay ningún costo. */
+
+/* Candados que se pueden registrar además de los tres globales */
+#define MAX_CANDADOS 16
+
+/* Registrar un candado, o un arreglo de ellos que se reporta como uno solo
+ * (por ejemplo, las franjas de la tabla de páginas) */
+#define REGISTRAR_CANDADOS(candados, cantidad, nombre) \
+    registrarCandados((candados), (cantidad), sizeof(*(candados)), (nombre))
+
+#ifdef PERFILAR_CANDADOS
+
+void registrarCandados(const void *primero, int cantidad, size_t tamano, const char *nombre);
+void perfilBloquear(pthread_mutex_t *mutex);
+void perfilDesbloquear(pthread_mutex_t *mutex);
+void perfilBloquearLectura(pthread_rwlock_t *candado);
+void perfilBloquearEscritura(pthread_rwlock_t *candado);
+void perfilDesbloquearRW(pthread_rwlock_t *candado);
+void imprimirReporteCandados(void);
+
+#define BLOQUEAR(m)           perfilBloquear(m)
+#define DESBLOQUEAR(m)        perfilDesbloquear(m)
+#define BLOQUEAR_LECTURA(c)   perfilBloquearLectura(c)
+#define BLOQUEAR_ESCRITURA(c) perfilBloquearEscritura(c)
+#define DESBLOQUEAR_RW(c)     perfilDesbloquearRW(c)
+
+#else
+
+#define BLOQUEAR(m)           pthread_mutex_lock(m)
+#define DESBLOQUEAR(m)        pthread_mutex_unlock(m)
+#define BLOQUEAR_LECTURA(c)   pthread_rwlock_rdlock(c)
+#define BLOQUEAR_ESCRITURA(c) pthread_rwlock_wrlock(c)
+#define DESBLOQUEAR_RW(c)     pthread_rwlock_unlock(c)
+
+static inline void registrarCandados(const void *primero, int cantidad, size_t tamano, const char *nombre) {
+    (void)primero;
+    (void)cantidad;
+    (void)tamano;
+    (void)nombre;
+}
+
+static inline void imprimirReporteCandados(void) {}
+
+#endif /* PERFILAR_CANDADOS */
+
+#endif /* CANDADOS_H */
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "especulacion.h"
+#include "instantanea.h"
+#include "juego.h"
+#include "mazo.h"
+#include "particion.h"
+
+/* Estado del hilo de especulación */
+static pthread_t hiloEspeculacion;
+static pthread_mutex_t mutexEspeculacion = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condEspeculacion = PTHREAD_COND_INITIALIZER;
+static bool hiloActivo = false;
+static bool detener = false;
+static Jugador *pendiente = NULL;     /* Jugador cuyo cálculo se pidió */
+static int idCalculando = -1;         /* Jugador cuyo cálculo está en curso */
+
+/* Un resultado por jugador, para que pedir el del siguiente no borre el del
+ * jugador que está a punto de empezar su turno */
+static Especulacion resultados[MAX_JUGADORES];
+static bool hayResultado[MAX_JUGADORES];
+
+/* Copias de trabajo; solo las usa el hilo de especulación */
+static TablaApeadas mesaCopia;
+static Carta manoCopia[MAX_CARTAS_INSTANTANEA];
+
+/* Estadísticas */
+static int consultas = 0;
+static int aciertos = 0;
+static int fallosMesa = 0;          /* La mesa cambió después del cálculo */
+static int fallosMano = 0;          /* La mano del jugador cambió */
+static int fallosSinResultado = 0;  /* No se predijo a este jugador */
+static int fallosTarde = 0;         /* El cálculo aún no había terminado */
+static double ahorradoTotalUs = 0;
+
+static double ahoraUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Calcular las jugadas del jugador sobre copias de su mano y de la mesa */
+static void calcularEspeculacion(Jugador *jugador, Especulacion *resultado) {
+    double inicio = ahoraUs();
+    int numCartas;
+    int numApeadas;
+
+    resultado->idJugador = jugador->id;
+    resultado->primeraApeada = jugador->primeraApeada;
+    resultado->puedeApearse = false;
+    resultado->numCandidatas = 0;
+    resultado->truncada = false;
+
+    numCartas = copiarManoJugador(jugador, manoCopia, MAX_CARTAS_INSTANTANEA,
+                                  &resultado->secuenciaMano);
+    numApeadas = capturarMesa(&mesaCopia, &resultado->versionMesa);
+
+    if (!resultado->primeraApeada) {
+        resultado->puedeApearse = evaluarApertura(manoCopia, numCartas);
+    } else {
+        /* verificarApeada solo lee la mano (su resumen), así que basta con una
+         * vista sobre la copia con el resumen recalculado */
+        Jugador vista = *jugador;
+        vista.mano.cartas = manoCopia;
+        vista.mano.numCartas = numCartas;
+        vista.mano.capacidad = MAX_CARTAS_INSTANTANEA;
+        recalcularResumenMazo(&vista.mano);
+        vista.bcp = NULL;
+
+        for (int i = 0; i < numApeadas && !resultado->truncada; i++) {
+            if (!verificarApeada(&vista, apeadaEnTabla(&mesaCopia, i))) {
+                continue;
+            }
+            if (resultado->numCandidatas < MAX_APEADAS) {
+                resultado->candidatas[resultado->numCandidatas++] = i;
+            } else {
+                resultado->truncada = true;
+            }
+        }
+    }
+
+    resultado->tiempoCalculoUs = ahoraUs() - inicio;
+}
+
+/* Hilo que espera solicitudes y calcula fuera del turno en curso */
+static void *funcionHiloEspeculacion(void *arg) {
+    Especulacion calculada;
+
+    (void)arg;
+
+    pthread_mutex_lock(&mutexEspeculacion);
+    while (true) {
+        while (pendiente == NULL && !detener) {
+            pthread_cond_wait(&condEspeculacion, &mutexEspeculacion);
+        }
+        if (detener) {
+            break;
+        }
+
+        Jugador *jugador = pendiente;
+        pendiente = NULL;
+        idCalculando = jugador->id;
+        hayResultado[jugador->id] = false;
+        pthread_mutex_unlock(&mutexEspeculacion);
+
+        calcularEspeculacion(jugador, &calculada);
+
+        pthread_mutex_lock(&mutexEspeculacion);
+        resultados[jugador->id] = calculada;
+        hayResultado[jugador->id] = true;
+        idCalculando = -1;
+    }
+    pthread_mutex_unlock(&mutexEspeculacion);
+
+    liberarMemoParticionHilo();
+    return NULL;
+}
+
+/* Iniciar el hilo de especulación */
+bool iniciarEspeculacion(void) {
+    detener = false;
+    pendiente = NULL;
+    idCalculando = -1;
+    memset(hayResultado, 0, sizeof(hayResultado));
+
+    if (pthread_create(&hiloEspeculacion, NULL, funcionHiloEspeculacion, NULL) != 0) {
+        printf("Error al crear el hilo de especulación\n");
+        return false;
+    }
+
+    hiloActivo = true;
+    return true;
+}
+
+/* Pedir el cálculo adelantado para un jugador */
+void solicitarEspeculacion(Jugador *jugador) {
+    if (!hiloActivo || jugador == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexEspeculacion);
+    pendiente = jugador;
+    pthread_cond_signal(&condEspeculacion);
+    pthread_mutex_unlock(&mutexEspeculacion);
+}
+
+/* Tomar el resultado del jugador si la mesa y la mano no cambiaron */
+bool tomarEspeculacion(Jugador *jugador, Especulacion *resultado) {
+    bool valido = false;
+
+    if (!hiloActivo) {
+        return false;
+    }
+
+    pthread_mutex_lock(&mutexEspeculacion);
+    consultas++;
+
+    if (!hayResultado[jugador->id]) {
+        if (idCalculando == jugador->id) {
+            fallosTarde++;
+        } else {
+            fallosSinResultado++;
+        }
+    } else {
+        /* El resultado se consume: los cambios de este turno lo invalidan */
+        *resultado = resultados[jugador->id];
+        hayResultado[jugador->id] = false;
+
+        if (resultado->versionMesa != obtenerVersionMesa()) {
+            fallosMesa++;
+        } else if (resultado->secuenciaMano != __atomic_load_n(&jugador->secuenciaMano, __ATOMIC_ACQUIRE) ||
+                   resultado->primeraApeada != jugador->primeraApeada) {
+            fallosMano++;
+        } else {
+            aciertos++;
+            ahorradoTotalUs += resultado->tiempoCalculoUs;
+            valido = true;
+        }
+    }
+    pthread_mutex_unlock(&mutexEspeculacion);
+
+    return valido;
+}
+
+/* Detener el hilo y mostrar las estadísticas */
+void detenerEspeculacion(void) {
+    if (!hiloActivo) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexEspeculacion);
+    detener = true;
+    pthread_cond_signal(&condEspeculacion);
+    pthread_mutex_unlock(&mutexEspeculacion);
+
+    pthread_join(hiloEspeculacion, NULL);
+    hiloActivo = false;
+    liberarTablaApeadas(&mesaCopia);
+
+    if (consultas > 0) {
+        printf("\nEspeculación: %d turnos, %d aciertos (%.1f%%); fallos: %d por cambio de mesa, "
+               "%d por cambio de mano, %d sin predicción, %d tardíos\n",
+               consultas, aciertos, 100.0 * aciertos / consultas,
+               fallosMesa, fallosMano, fallosSinResultado, fallosTarde);
+        printf("Latencia ahorrada: %.1f us por turno (%.1f us por acierto)\n",
+               ahorradoTotalUs / consultas, aciertos > 0 ? ahorradoTotalUs / aciertos : 0.0);
+    }
+}
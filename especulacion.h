@@ -0,0 +1,39 @@
+#ifndef ESPECULACION_H
+#define ESPECULACION_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "mesa.h"
+
+/* Búsqueda de jugadas adelantada para el jugador que probablemente tiene el
+ * próximo turno. Un hilo la calcula sobre una copia de la mesa y de la mano
+ * mientras el turno actual sigue en curso; al empezar su turno, el jugador
+ * solo la reutiliza si la versión de la mesa y el seqlock de su mano siguen
+ * siendo los mismos con los que se calculó */
+typedef struct {
+    int idJugador;
+    unsigned int versionMesa;     /* Versión de la mesa usada en el cálculo */
+    unsigned int secuenciaMano;   /* Seqlock de la mano con el que se leyó */
+    bool primeraApeada;           /* Si el jugador ya se había apeado */
+    bool puedeApearse;            /* Resultado de evaluarApertura (antes de apearse) */
+    int candidatas[MAX_APEADAS];  /* Apeadas donde verificarApeada es verdadero (las primeras) */
+    int numCandidatas;
+    bool truncada;                /* Había más candidatas de las que caben: se
+                                   * busca en toda la mesa */
+    double tiempoCalculoUs;       /* Tiempo que costó el cálculo */
+} Especulacion;
+
+/* Iniciar el hilo que calcula las jugadas por adelantado */
+bool iniciarEspeculacion(void);
+
+/* Pedir el cálculo para un jugador; solo avisa al hilo */
+void solicitarEspeculacion(Jugador *jugador);
+
+/* Tomar el resultado precalculado del jugador si sigue siendo válido con la
+ * mesa y la mano actuales. Devuelve false si no hay resultado utilizable */
+bool tomarEspeculacion(Jugador *jugador, Especulacion *resultado);
+
+/* Detener el hilo y mostrar la tasa de aciertos y la latencia ahorrada */
+void detenerEspeculacion(void);
+
+#endif /* ESPECULACION_H */
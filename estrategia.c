@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "estrategia.h"
+#include "juego.h"
+#include "particion.h"
+#include "mcts.h"
+
+/* Decisiones que se miden */
+typedef enum {
+    DEC_TURNO,
+    DEC_APERTURA,
+    DEC_EMBONE,
+    DEC_NUEVA_APEADA,
+    DEC_COMER,
+    NUM_DECISIONES
+} TipoDecision;
+
+static const char *nombresDecision[NUM_DECISIONES] = {"turno", "apertura", "embone", "nueva apeada", "comer"};
+
+/* Contadores por estrategia y tipo de decisión (atómicos: cada jugador
+ * decide en su propio hilo) */
+typedef struct {
+    unsigned long decisiones[NUM_DECISIONES];
+    unsigned long nanosegundos[NUM_DECISIONES];
+} EstadisticasEstrategia;
+
+static EstadisticasEstrategia estadisticas[MAX_ESTRATEGIAS];
+
+/* Estrategia configurada para cada jugador (NULL = por defecto) */
+static const Estrategia *estrategiasJugadores[MAX_JUGADORES];
+
+/* --- Estrategia base: el comportamiento original --- */
+
+/* Bajar la partición con más puntos */
+static Apeada* aperturaBase(Jugador *jugador, int *numApeadas) {
+    return crearApeadas(jugador, numApeadas);
+}
+
+/* Primera apeada de la mesa donde encaje alguna carta */
+static int emboneBase(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices) {
+    for (int c = 0; c < numIndices; c++) {
+        if (verificarApeada(jugador, apeadaEnTabla(mesa, indices[c]))) {
+            return indices[c];
+        }
+    }
+    return -1;
+}
+
+/* Bajar la partición que deja menos cartas en la mano */
+static Apeada* nuevaApeadaBase(Jugador *jugador, int *numApeadas) {
+    return crearApeadas(jugador, numApeadas);
+}
+
+static bool comerBase(Jugador *jugador, const Banca *banca) {
+    (void)jugador;
+    return cartasEnBanca(banca) > 0;
+}
+
+/* --- Estrategia reservada: enseña lo mínimo a los rivales --- */
+
+#define RESERVADA_CARTAS_RESTANTES 3   /* Baja todo si la mano queda con esto o menos */
+#define RESERVADA_MANO_LLENA       20  /* ... o si la mano ya tiene esto o más */
+
+static int compararJugadasPorPuntos(const void *a, const void *b) {
+    return ((const JugadaParticion*)b)->puntos - ((const JugadaParticion*)a)->puntos;
+}
+
+/* Abrir solo con las jugadas de más puntos que alcanzan los 30 */
+static Apeada* aperturaReservada(Jugador *jugador, int *numApeadas) {
+    ParticionMano particion;
+    int usadas = 0;
+    int puntos = 0;
+
+    *numApeadas = 0;
+    resolverParticionFirma(&jugador->mano.resumen.firma, OBJ_MAX_PUNTOS, &particion);
+    if (particion.puntos < 30) {
+        return NULL;
+    }
+
+    qsort(particion.jugadas, particion.numJugadas, sizeof(JugadaParticion), compararJugadasPorPuntos);
+    while (usadas < particion.numJugadas && puntos < 30) {
+        puntos += particion.jugadas[usadas++].puntos;
+    }
+    particion.numJugadas = usadas;
+    particion.puntos = puntos;
+
+    return crearApeadasDeParticion(jugador, &particion, numApeadas);
+}
+
+/* Preferir embones con cartas naturales; el comodín se guarda para el final */
+static int emboneReservada(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices) {
+    for (int c = 0; c < numIndices; c++) {
+        if (verificarApeadaSinComodin(jugador, apeadaEnTabla(mesa, indices[c]))) {
+            return indices[c];
+        }
+    }
+    if (jugador->mano.numCartas <= RESERVADA_CARTAS_RESTANTES) {
+        return emboneBase(jugador, mesa, indices, numIndices);
+    }
+    return -1;
+}
+
+/* Bajar apeadas nuevas solo si casi vacían la mano o si la mano es muy grande */
+static Apeada* nuevaApeadaReservada(Jugador *jugador, int *numApeadas) {
+    ParticionMano particion;
+
+    *numApeadas = 0;
+    if (!resolverParticionFirma(&jugador->mano.resumen.firma, OBJ_MAX_CARTAS, &particion)) {
+        return NULL;
+    }
+
+    if (jugador->mano.numCartas - particion.cartas > RESERVADA_CARTAS_RESTANTES &&
+        jugador->mano.numCartas < RESERVADA_MANO_LLENA) {
+        return NULL;
+    }
+
+    return crearApeadasDeParticion(jugador, &particion, numApeadas);
+}
+
+static const Estrategia estrategiaBase = {
+    "base", "Baja todo lo posible y embona en la primera apeada que encaje",
+    NULL, aperturaBase, emboneBase, nuevaApeadaBase, comerBase, NULL, NULL
+};
+
+static const Estrategia estrategiaReservada = {
+    "reservada", "Abre con lo justo, guarda los comodines y retiene apeadas nuevas",
+    NULL, aperturaReservada, emboneReservada, nuevaApeadaReservada, comerBase, NULL, NULL
+};
+
+static const Estrategia *const estrategias[] = {
+    &estrategiaBase,
+    &estrategiaReservada,
+    &estrategiaMcts,
+};
+
+#define NUM_ESTRATEGIAS ((int)(sizeof(estrategias) / sizeof(estrategias[0])))
+
+static int indiceEstrategia(const Estrategia *estrategia) {
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        if (estrategias[i] == estrategia) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+const Estrategia* buscarEstrategia(const char *nombre) {
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        if (strcmp(estrategias[i]->nombre, nombre) == 0) {
+            return estrategias[i];
+        }
+    }
+    return NULL;
+}
+
+const Estrategia* estrategiaPorDefecto(void) {
+    return estrategias[0];
+}
+
+int numEstrategias(void) {
+    return NUM_ESTRATEGIAS;
+}
+
+const Estrategia* obtenerEstrategia(int indice) {
+    if (indice < 0 || indice >= NUM_ESTRATEGIAS) {
+        return NULL;
+    }
+    return estrategias[indice];
+}
+
+/* Lista separada por comas, una estrategia por jugador en orden de id. Si
+ * hay menos nombres que jugadores, se repite el último */
+bool configurarEstrategias(const char *lista) {
+    char copia[256];
+    int id = 0;
+
+    strncpy(copia, lista, sizeof(copia) - 1);
+    copia[sizeof(copia) - 1] = '\0';
+
+    for (char *nombre = strtok(copia, ","); nombre != NULL; nombre = strtok(NULL, ",")) {
+        const Estrategia *estrategia = buscarEstrategia(nombre);
+        if (estrategia == NULL) {
+            printf("Estrategia desconocida: '%s'. Disponibles:", nombre);
+            for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+                printf(" %s", estrategias[i]->nombre);
+            }
+            printf("\n");
+            return false;
+        }
+        if (id >= MAX_JUGADORES) {
+            printf("Hay más estrategias que jugadores posibles (%d)\n", MAX_JUGADORES);
+            return false;
+        }
+        estrategiasJugadores[id++] = estrategia;
+    }
+
+    for (; id > 0 && id < MAX_JUGADORES; id++) {
+        estrategiasJugadores[id] = estrategiasJugadores[id - 1];
+    }
+    return true;
+}
+
+const Estrategia* estrategiaJugador(int idJugador) {
+    if (idJugador >= 0 && idJugador < MAX_JUGADORES && estrategiasJugadores[idJugador] != NULL) {
+        return estrategiasJugadores[idJugador];
+    }
+    return estrategiaPorDefecto();
+}
+
+bool hayEstrategiasConfiguradas(void) {
+    return estrategiasJugadores[0] != NULL;
+}
+
+/* --- Medición --- */
+
+static const Estrategia* estrategiaDe(const Jugador *jugador) {
+    return jugador->estrategia != NULL ? jugador->estrategia : estrategiaPorDefecto();
+}
+
+static long ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void registrarDecision(const Estrategia *estrategia, TipoDecision tipo, long inicio) {
+    EstadisticasEstrategia *e = &estadisticas[indiceEstrategia(estrategia)];
+    __atomic_add_fetch(&e->decisiones[tipo], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&e->nanosegundos[tipo], (unsigned long)(ahoraNs() - inicio), __ATOMIC_RELAXED);
+}
+
+double decidirInicioTurno(Jugador *jugador, const VistaPartida *vista) {
+    const Estrategia *estrategia = estrategiaDe(jugador);
+    if (estrategia->iniciarTurno == NULL) {
+        return 0.0;
+    }
+
+    long inicio = ahoraNs();
+    estrategia->iniciarTurno(jugador, vista);
+    registrarDecision(estrategia, DEC_TURNO, inicio);
+    return (ahoraNs() - inicio) / 1e6;
+}
+
+Apeada* decidirApertura(Jugador *jugador, int *numApeadas) {
+    const Estrategia *estrategia = estrategiaDe(jugador);
+    long inicio = ahoraNs();
+    Apeada *resultado = estrategia->elegirApertura(jugador, numApeadas);
+    registrarDecision(estrategia, DEC_APERTURA, inicio);
+    return resultado;
+}
+
+int decidirEmbone(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices) {
+    const Estrategia *estrategia = estrategiaDe(jugador);
+    long inicio = ahoraNs();
+    int resultado = estrategia->elegirEmbone(jugador, mesa, indices, numIndices);
+    registrarDecision(estrategia, DEC_EMBONE, inicio);
+    return resultado;
+}
+
+Apeada* decidirNuevaApeada(Jugador *jugador, int *numApeadas) {
+    const Estrategia *estrategia = estrategiaDe(jugador);
+    long inicio = ahoraNs();
+    Apeada *resultado = estrategia->elegirNuevaApeada(jugador, numApeadas);
+    registrarDecision(estrategia, DEC_NUEVA_APEADA, inicio);
+    return resultado;
+}
+
+bool decidirComer(Jugador *jugador, const Banca *banca) {
+    const Estrategia *estrategia = estrategiaDe(jugador);
+    long inicio = ahoraNs();
+    bool resultado = estrategia->decidirComer(jugador, banca);
+    registrarDecision(estrategia, DEC_COMER, inicio);
+    return resultado;
+}
+
+void reiniciarEstadisticasEstrategias(void) {
+    memset(estadisticas, 0, sizeof(estadisticas));
+}
+
+void imprimirEstadisticasEstrategias(void) {
+    bool encabezado = false;
+
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        EstadisticasEstrategia *e = &estadisticas[i];
+        unsigned long total = 0;
+        unsigned long totalNs = 0;
+
+        for (int d = 0; d < NUM_DECISIONES; d++) {
+            total += e->decisiones[d];
+            totalNs += e->nanosegundos[d];
+        }
+        if (total == 0) {
+            continue;
+        }
+
+        if (!encabezado) {
+            printf("\nLatencia de decisión por estrategia (media en us):\n");
+            encabezado = true;
+        }
+        printf("  %-10s %8lu decisiones, %8.2f us", estrategias[i]->nombre, total, totalNs / 1000.0 / total);
+        for (int d = 0; d < NUM_DECISIONES; d++) {
+            if (e->decisiones[d] > 0) {
+                printf(" | %s %.2f", nombresDecision[d], e->nanosegundos[d] / 1000.0 / e->decisiones[d]);
+            }
+        }
+        printf("\n");
+
+        if (estrategias[i]->imprimirEstadisticas != NULL) {
+            estrategias[i]->imprimirEstadisticas();
+        }
+    }
+}
+
+void liberarEstrategias(void) {
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        if (estrategias[i]->liberar != NULL) {
+            estrategias[i]->liberar();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ESTRATEGIA_H
+#define ESTRATEGIA_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "tablaapeadas.h"
+#include "banca.h"
+
+/* Estrategias de juego intercambiables.
+ *
+ * realizarTurno aplica las reglas (30 puntos para la primera apeada, turno
+ * acotado por tiempo, comer al no poder jugar) y delega cada decisión en la
+ * estrategia del jugador a través de las funciones decidir*, que además
+ * miden cuánto tarda cada decisión. La estrategia "base" reproduce el
+ * comportamiento original del juego */
+
+#define MAX_ESTRATEGIAS 8
+
+/* Lo que un jugador puede ver de la partida al empezar su turno. En el juego
+ * con hilos la mesa es la de la transacción del turno, que nadie más modifica */
+typedef struct {
+    const Jugador *jugadores;   /* Todos los jugadores (de los rivales solo se
+                                   deben mirar numCartas y primeraApeada) */
+    int numJugadores;
+    const TablaApeadas *mesa;
+    int cartasBanca;
+} VistaPartida;
+
+typedef struct Estrategia {
+    const char *nombre;
+    const char *descripcion;
+
+    /* Al empezar el turno, antes de las demás decisiones (puede ser NULL) */
+    void (*iniciarTurno)(Jugador *jugador, const VistaPartida *vista);
+
+    /* Primera apeada (ya se sabe que la mano llega a 30 puntos): devuelve las
+     * apeadas creadas, con sus cartas ya quitadas de la mano, o NULL. El
+     * arreglo va en la arena del turno (arena.h), no se libera */
+    Apeada* (*elegirApertura)(Jugador *jugador, int *numApeadas);
+
+    /* Apeada de la mesa donde hacer un embone, entre las indicadas, o -1 */
+    int (*elegirEmbone)(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices);
+
+    /* Apeadas nuevas después de la primera, o NULL para no bajar ninguna */
+    Apeada* (*elegirNuevaApeada)(Jugador *jugador, int *numApeadas);
+
+    /* Si comer una ficha de la banca cuando no hubo jugada */
+    bool (*decidirComer)(Jugador *jugador, const Banca *banca);
+
+    /* Estadísticas propias y liberación de recursos (pueden ser NULL) */
+    void (*imprimirEstadisticas)(void);
+    void (*liberar)(void);
+} Estrategia;
+
+/* Estrategias disponibles */
+const Estrategia* buscarEstrategia(const char *nombre);
+const Estrategia* estrategiaPorDefecto(void);
+int numEstrategias(void);
+const Estrategia* obtenerEstrategia(int indice);
+
+/* Estrategia elegida para cada jugador desde la línea de comandos */
+bool configurarEstrategias(const char *lista);
+const Estrategia* estrategiaJugador(int idJugador);
+bool hayEstrategiasConfiguradas(void);
+
+/* Llamadas a la estrategia del jugador, con medición de latencia.
+ * decidirInicioTurno devuelve los milisegundos que tardó */
+double decidirInicioTurno(Jugador *jugador, const VistaPartida *vista);
+Apeada* decidirApertura(Jugador *jugador, int *numApeadas);
+int decidirEmbone(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices);
+Apeada* decidirNuevaApeada(Jugador *jugador, int *numApeadas);
+bool decidirComer(Jugador *jugador, const Banca *banca);
+
+/* Decisiones y latencia media de cada estrategia usada */
+void imprimirEstadisticasEstrategias(void);
+void reiniciarEstadisticasEstrategias(void);
+
+/* Liberar los recursos de las estrategias (hilos de búsqueda, etc.) */
+void liberarEstrategias(void);
+
+#endif /* ESTRATEGIA_H */
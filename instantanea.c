@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "instantanea.h"
+#include "candados.h"
+#include "utilidades.h"
+#include "mazo.h"
+#include "zobrist.h"
+
+/* Estado del hilo de instantáneas */
+static pthread_t hiloInstantaneas;
+static pthread_mutex_t mutexSolicitud = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condSolicitud = PTHREAD_COND_INITIALIZER;
+static bool hiloActivo = false;
+static bool detener = false;
+static int rondaSolicitada = 0;      /* 0 = sin solicitud pendiente */
+
+static Jugador *jugadoresVivos = NULL;
+static int numJugadoresVivos = 0;
+
+/* La instantánea solo la usa el hilo de instantáneas */
+static Instantanea instantanea;
+
+/* Capturas que se repiten como máximo hasta obtener un corte consistente,
+ * con una pausa entre ellas para que termine el turno en curso */
+#define MAX_INTENTOS_INSTANTANEA 50
+#define PAUSA_INTENTO_US         1000
+
+/* Estadísticas de tiempos */
+static int numInstantaneas = 0;
+static int numRepetidas = 0;           /* Con el mismo hash que la anterior: sin historial */
+static int numReintentos = 0;          /* Capturas repetidas por un cambio durante la copia */
+static int numSinCuadrar = 0;          /* Sin corte consistente tras MAX_INTENTOS_INSTANTANEA */
+static double pausaTotalUs = 0;        /* Tiempo que el planificador pasa en solicitarInstantanea */
+static double capturaTotalUs = 0;      /* Tiempo de copia del estado */
+static double serializacionTotalMs = 0; /* Tiempo de escritura de archivos */
+
+static double ahoraUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Leer la mano de un jugador con su seqlock */
+int copiarManoJugador(Jugador *jugador, Carta *destino, int maxCartas, unsigned int *secuencia) {
+    unsigned int antes, despues;
+    int numCartas;
+
+    do {
+        antes = __atomic_load_n(&jugador->secuenciaMano, __ATOMIC_ACQUIRE);
+        if (antes & 1) {
+            /* El jugador está modificando su mano */
+            continue;
+        }
+
+        numCartas = jugador->mano.numCartas;
+        if (numCartas > maxCartas) {
+            numCartas = maxCartas;
+        }
+        if (numCartas > 0 && jugador->mano.cartas != NULL) {
+            memcpy(destino, jugador->mano.cartas, numCartas * sizeof(Carta));
+        } else {
+            numCartas = 0;
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        despues = __atomic_load_n(&jugador->secuenciaMano, __ATOMIC_RELAXED);
+    } while ((antes & 1) || antes != despues);
+
+    if (secuencia != NULL) {
+        *secuencia = antes;
+    }
+    return numCartas;
+}
+
+/* Compartir los bloques de la mesa publicada (las escaleras llevan sus
+ * cartas dentro); la versión no cambia mientras se tiene su referencia */
+int capturarMesa(TablaApeadas *destino, unsigned int *version) {
+    int numApeadas = 0;
+    const TablaApeadas *mesa = adquirirMesa(version);
+
+    if (compartirTablaApeadas(destino, mesa)) {
+        numApeadas = destino->numApeadas;
+    }
+    soltarMesa(mesa);
+
+    return numApeadas;
+}
+
+/* Cartas de las apeadas de la mesa */
+static int cartasEnMesa(const TablaApeadas *mesa) {
+    int total = 0;
+
+    for (int i = 0; i < mesa->numApeadas; i++) {
+        const Apeada *apeada = apeadaEnTabla(mesa, i);
+        total += apeada->esGrupo ? apeada->jugada.grupo.numCartas : apeada->jugada.escalera.numCartas;
+    }
+    return total;
+}
+
+/* Una pasada de copias; devuelve true si nada cambió durante ella */
+static bool copiarEstado(Instantanea *inst, Jugador *jugadores, int numJugadores) {
+    unsigned int versionMesa;
+    unsigned int secuencias[MAX_JUGADORES];
+    bool consistente;
+
+    /* Mesa: copia de las apeadas */
+    capturarMesa(&inst->mesa, &versionMesa);
+
+    BLOQUEAR(&mutexBanca);
+    inst->cartasBanca = cartasEnBanca(obtenerBanca());
+    DESBLOQUEAR(&mutexBanca);
+
+    /* Jugadores: la mano se lee con el seqlock de cada uno */
+    inst->numJugadores = numJugadores;
+    for (int i = 0; i < numJugadores; i++) {
+        Jugador *copia = &inst->jugadores[i];
+
+        *copia = jugadores[i];
+        copia->mano.numCartas = copiarManoJugador(&jugadores[i], inst->cartasManos[i],
+                                                  MAX_CARTAS_INSTANTANEA, &secuencias[i]);
+        copia->mano.cartas = inst->cartasManos[i];
+        copia->mano.capacidad = MAX_CARTAS_INSTANTANEA;
+        recalcularResumenMazo(&copia->mano);
+
+        if (jugadores[i].bcp != NULL) {
+            inst->bcpJugadores[i] = *jugadores[i].bcp;
+            copia->bcp = &inst->bcpJugadores[i];
+        }
+    }
+
+    /* Tabla de procesos */
+    BLOQUEAR(&mutexTabla);
+    copiarTablaProc(&inst->tabla, inst->bcpTabla);
+    DESBLOQUEAR(&mutexTabla);
+
+    /* Nada se publicó en la mesa, la banca ni las manos mientras se copiaban */
+    BLOQUEAR(&mutexBanca);
+    consistente = cartasEnBanca(obtenerBanca()) == inst->cartasBanca;
+    int totalCartas = obtenerBanca()->totalCartas;
+    DESBLOQUEAR(&mutexBanca);
+    consistente = consistente && obtenerVersionMesa() == versionMesa;
+    for (int i = 0; i < numJugadores && consistente; i++) {
+        consistente = __atomic_load_n(&jugadores[i].secuenciaMano, __ATOMIC_ACQUIRE) == secuencias[i];
+    }
+
+    /* Y ninguna carta a medio camino: una que sale de la mano antes de que
+     * se publique la mesa que la recibe no está en ningún sitio */
+    int cartas = inst->cartasBanca + cartasEnMesa(&inst->mesa);
+    for (int i = 0; i < numJugadores; i++) {
+        cartas += inst->jugadores[i].mano.numCartas;
+    }
+    return consistente && cartas == totalCartas;
+}
+
+/* Capturar el estado actual en una instantánea, repitiendo la copia hasta
+ * que sea un corte consistente */
+int capturarInstantanea(Instantanea *inst, Jugador *jugadores, int numJugadores, int numRonda) {
+    inst->numRonda = numRonda;
+
+    for (int intento = 1; intento <= MAX_INTENTOS_INSTANTANEA; intento++) {
+        if (copiarEstado(inst, jugadores, numJugadores)) {
+            inst->hash = hashPartida(inst->jugadores, inst->numJugadores, inst->mesa.hash, inst->cartasBanca);
+            return intento;
+        }
+        usleep(PAUSA_INTENTO_US);
+    }
+
+    inst->hash = hashPartida(inst->jugadores, inst->numJugadores, inst->mesa.hash, inst->cartasBanca);
+    return -MAX_INTENTOS_INSTANTANEA;
+}
+
+/* Hilo que espera solicitudes, captura y serializa fuera del planificador */
+static void *funcionHiloInstantaneas(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&mutexSolicitud);
+    while (true) {
+        while (rondaSolicitada == 0 && !detener) {
+            pthread_cond_wait(&condSolicitud, &mutexSolicitud);
+        }
+        if (rondaSolicitada == 0 && detener) {
+            break;
+        }
+
+        int numRonda = rondaSolicitada;
+        rondaSolicitada = 0;
+        pthread_mutex_unlock(&mutexSolicitud);
+
+        uint64_t hashAnterior = instantanea.hash;
+        double inicio = ahoraUs();
+        int intentos = capturarInstantanea(&instantanea, jugadoresVivos, numJugadoresVivos, numRonda);
+        double capturada = ahoraUs();
+
+        /* El estado de la partida es el mismo que en la anterior: basta con
+         * comparar los hashes para no repetir la ronda en el historial */
+        bool repetida = numInstantaneas > 0 && instantanea.hash == hashAnterior;
+        if (!repetida) {
+            registrarHistorialMesa(instantanea.numRonda, instantanea.jugadores, instantanea.numJugadores,
+                                   &instantanea.mesa, instantanea.cartasBanca);
+        }
+        imprimirEstadisticasDeTabla(&instantanea.tabla);
+        double serializada = ahoraUs();
+
+        pthread_mutex_lock(&mutexSolicitud);
+        numInstantaneas++;
+        numRepetidas += repetida;
+        numReintentos += (intentos > 0 ? intentos : -intentos) - 1;
+        numSinCuadrar += intentos < 0;
+        capturaTotalUs += capturada - inicio;
+        serializacionTotalMs += (serializada - capturada) / 1000.0;
+    }
+    pthread_mutex_unlock(&mutexSolicitud);
+
+    return NULL;
+}
+
+/* Iniciar el hilo de instantáneas */
+bool iniciarInstantaneas(Jugador *jugadores, int numJugadores) {
+    jugadoresVivos = jugadores;
+    numJugadoresVivos = numJugadores;
+    detener = false;
+    rondaSolicitada = 0;
+
+    if (pthread_create(&hiloInstantaneas, NULL, funcionHiloInstantaneas, NULL) != 0) {
+        printf("Error al crear el hilo de instantáneas\n");
+        return false;
+    }
+
+    hiloActivo = true;
+    return true;
+}
+
+/* Pedir una instantánea; el planificador solo paga el aviso */
+void solicitarInstantanea(int numRonda) {
+    double inicio = ahoraUs();
+
+    if (!hiloActivo) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexSolicitud);
+    /* Si la anterior aún no se atendió, se reemplaza por la más reciente */
+    rondaSolicitada = numRonda;
+    pthread_cond_signal(&condSolicitud);
+    pausaTotalUs += ahoraUs() - inicio;
+    pthread_mutex_unlock(&mutexSolicitud);
+}
+
+/* Detener el hilo y mostrar los tiempos medidos */
+void detenerInstantaneas(void) {
+    if (!hiloActivo) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexSolicitud);
+    detener = true;
+    pthread_cond_signal(&condSolicitud);
+    pthread_mutex_unlock(&mutexSolicitud);
+
+    pthread_join(hiloInstantaneas, NULL);
+    hiloActivo = false;
+    liberarTablaApeadas(&instantanea.mesa);
+
+    if (numInstantaneas > 0) {
+        printf("\nInstantáneas: %d (%d sin cambios en la partida), pausa media del planificador: %.1f us, "
+               "captura media: %.1f us, serialización media: %.2f ms\n",
+               numInstantaneas, numRepetidas, pausaTotalUs / numInstantaneas,
+               capturaTotalUs / numInstantaneas, serializacionTotalMs / numInstantaneas);
+        printf("Capturas repetidas por un turno en curso: %d; instantáneas sin corte consistente: %d\n",
+               numReintentos, numSinCuadrar);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "mesa.h"
+#include "procesos.h"
+#include "juego.h"
+
+/* Máximo de cartas que puede haber en una mano (mazo completo) */
+#define MAX_CARTAS_INSTANTANEA 108
+
+/* Copia consistente del estado del juego. Se captura con memcpy bajo los
+ * candados de cada componente (mesa, banca, tabla de procesos) y con el
+ * seqlock de cada mano, y se serializa después sin tocar el estado vivo.
+ * Como cada componente tiene su candado, la captura se repite si algo
+ * cambió mientras se copiaba (ver capturarInstantanea) */
+typedef struct {
+    int numRonda;
+
+    /* Mesa: sus bloques se reutilizan de una captura a la siguiente */
+    TablaApeadas mesa;
+    int cartasBanca;
+
+    /* Jugadores: mano.cartas apunta a cartasManos y bcp a bcpJugadores */
+    Jugador jugadores[MAX_JUGADORES];
+    int numJugadores;
+    Carta cartasManos[MAX_JUGADORES][MAX_CARTAS_INSTANTANEA];
+    BCP bcpJugadores[MAX_JUGADORES];
+
+    /* Tabla de procesos: procesos[i] apunta a bcpTabla[i] */
+    TablaProc tabla;
+    BCP bcpTabla[10];
+
+    /* Zobrist de manos, mesa y banca (hashPartida): si no cambió desde la
+     * instantánea anterior, la ronda no se vuelve a escribir en el historial */
+    uint64_t hash;
+} Instantanea;
+
+/* Capturar el estado actual en una instantánea (tiempo O(estado), solo copias),
+ * repitiendo la copia hasta que registre un mismo instante de la partida: la
+ * versión de la mesa, la banca y el seqlock de cada mano iguales antes y
+ * después, y las cartas de manos, mesa y banca sumando el zapato. Devuelve
+ * los intentos que hicieron falta, en negativo si ninguno fue consistente */
+int capturarInstantanea(Instantanea *inst, Jugador *jugadores, int numJugadores, int numRonda);
+
+/* Compartir en destino las apeadas de la versión publicada de la mesa, sin
+ * copiarlas ni tomar candados (ver mesa.h). Devuelve el número de apeadas (0 si no hubo memoria) y, si version no es
+ * NULL, la versión copiada */
+int capturarMesa(TablaApeadas *destino, unsigned int *version);
+
+/* Leer la mano de un jugador con su seqlock; devuelve el número de cartas copiadas y,
+ * si secuencia no es NULL, el valor del seqlock con el que se leyó */
+int copiarManoJugador(Jugador *jugador, Carta *destino, int maxCartas, unsigned int *secuencia);
+
+/* Iniciar el hilo que captura y serializa instantáneas en segundo plano */
+bool iniciarInstantaneas(Jugador *jugadores, int numJugadores);
+
+/* Pedir una instantánea de la ronda indicada; solo avisa al hilo (microsegundos) */
+void solicitarInstantanea(int numRonda);
+
+/* Detener el hilo, esperando a que termine la serialización en curso */
+void detenerInstantaneas(void);
+
+#endif /* INSTANTANEA_H */
@@ -11,6 +11,17 @@
 #include "procesos.h"
 #include "utilidades.h"
 #include "memoria.h"
+#include "candados.h"
+#include "instantanea.h"
+#include "especulacion.h"
+#include "particion.h"
+#include "mazo.h"
+#include "estrategia.h"
+#include "arena.h"
+#include "reacomodo.h"
+#include "panel.h"
+#include "validador.h"
+#include "slab.h"
 #define _DEFAULT_SOURCE
 
 
@@ -69,91 +80,28 @@ bool inicializarJuego(int cantidadJugadores) {
 
 // Repartir fichas a los jugadores
 void repartirFichas() {
-    // Crear el mazo completo (2 barajas + 4 comodines)
-    Mazo mazoCompleto;
+    Banca *banca = obtenerBanca();
+    Carta mano[MAX_CARTAS_MAZO];
 
-    // Inicializar a valores seguros
-    mazoCompleto.cartas = NULL;
-    mazoCompleto.numCartas = 0;
-    mazoCompleto.capacidad = 0;
-
-    crearMazoCompleto(&mazoCompleto);
-    
-    // Verificar si se creó correctamente
-    if (mazoCompleto.cartas == NULL) {
-        printf("Error: No se pudo crear el mazo completo\n");
+    // Generar el zapato (K barajas mezcladas) directamente en la banca
+    if (!generarZapato(banca, barajasConfiguradas(), 0)) {
+        printf("Error: No se pudo crear el zapato de la banca\n");
         return;
     }
-
-    // Mezclar el mazo
-    mezclarMazo(&mazoCompleto);
     
     // Calcular cuántas cartas repartir a cada jugador (2/3 del total)
-    int cartasTotales = mazoCompleto.numCartas;
-    int cartasPorJugador = (cartasTotales * 2) / (3 * numJugadores);
+    int cartasPorJugador = cartasRepartoBanca(banca->totalCartas, numJugadores);
     
-    // Repartir a cada jugador
+    // Repartir a cada jugador con un solo robo por mano. La mano empieza en su
+    // búfer en línea y, si alguna vez crece más, pasa a memoria dinámica una
+    // sola vez (ver mazo.h). El resto de cartas se quedan en la banca
     for (int i = 0; i < numJugadores; i++) {
-        for (int j = 0; j < cartasPorJugador && mazoCompleto.numCartas > 0; j++) {
-            // Tomar la última carta del mazo
-            Carta carta = mazoCompleto.cartas[mazoCompleto.numCartas - 1];
-            mazoCompleto.numCartas--;
-            
-            // Añadir a la mano del jugador
-            if (jugadores[i].mano.numCartas >= jugadores[i].mano.capacidad) {
-                int nuevaCapacidad = jugadores[i].mano.capacidad == 0 ? cartasPorJugador : jugadores[i].mano.capacidad * 2;
-                Carta *nuevasCartas = realloc(jugadores[i].mano.cartas, nuevaCapacidad * sizeof(Carta));
-                
-                // Verificar si realloc tuvo éxito
-                if (nuevasCartas == NULL) {
-                    printf("Error: No se pudo reasignar memoria para la mano del jugador %d\n", i);
-                    continue; // Saltamos esta carta
-                }
-                
-                jugadores[i].mano.cartas = nuevasCartas;
-                jugadores[i].mano.capacidad = nuevaCapacidad;
-            }
-            
-            jugadores[i].mano.cartas[jugadores[i].mano.numCartas] = carta;
-            jugadores[i].mano.numCartas++;
+        int robadas = robarBanca(banca, mano, cartasPorJugador);
+        if (!agregarCartasMazo(&jugadores[i].mano, mano, robadas)) {
+            printf("Error: No se pudo repartir la mano del jugador %d\n", i);
+            devolverBanca(banca, mano, robadas);
         }
     }
-    
-    // El resto de cartas van a la banca
-    Mazo *banca = obtenerBanca();
-    if (banca == NULL) {
-        printf("Error: No se pudo obtener la banca\n");
-        // Liberar memoria antes de salir
-        if (mazoCompleto.cartas != NULL) {
-            free(mazoCompleto.cartas);
-        }
-        return;
-    }
-
-    for (int i = 0; i < mazoCompleto.numCartas; i++) {
-        if (banca->numCartas >= banca->capacidad) {
-            int nuevaCapacidad = banca->capacidad == 0 ? mazoCompleto.numCartas : banca->capacidad * 2;
-            Carta *nuevasCartas = realloc(banca->cartas, nuevaCapacidad * sizeof(Carta));
-            
-            // Verificar si realloc tuvo éxito
-            if (nuevasCartas == NULL) {
-                printf("Error: No se pudo reasignar memoria para la banca\n");
-                break; // Salimos del bucle
-            }
-            
-            banca->cartas = nuevasCartas;
-            banca->capacidad = nuevaCapacidad;
-        }
-        
-        banca->cartas[banca->numCartas] = mazoCompleto.cartas[i];
-        banca->numCartas++;
-    }
-    
-    // Liberar el mazo completo
-    if (mazoCompleto.cartas != NULL) {
-        free(mazoCompleto.cartas);
-        mazoCompleto.cartas = NULL;
-    }
 }
 
 // Iniciar el juego, creando los hilos de los jugadores
@@ -166,6 +114,12 @@ void iniciarJuego() {
         }
     }
     
+    // Hilo que serializa el historial y las estadísticas fuera del planificador
+    iniciarInstantaneas(jugadores, numJugadores);
+    
+    // Hilo que adelanta la búsqueda de jugadas del próximo jugador
+    iniciarEspeculacion();
+    
     // Iniciar el bucle principal del juego (hilo juego)
     bucleJuego();
 }
@@ -210,6 +164,12 @@ void bucleJuego() {
         // Asignar turno al jugador seleccionado
         asignarTurno(siguienteJugador);
         
+        // Mientras juega, calcular en otro núcleo las jugadas del que probablemente sigue
+        int jugadorPrevisto = predecirSiguienteJugador(siguienteJugador);
+        if (jugadorPrevisto != -1) {
+            solicitarEspeculacion(&jugadores[jugadorPrevisto]);
+        }
+        
         // Esperar a que el jugador termine su turno o se agote su tiempo
         esperarFinTurno(siguienteJugador);
         
@@ -223,11 +183,9 @@ void bucleJuego() {
         int tiempoTranscurrido = (ahora - ultimaActualizacion) * 1000 / CLOCKS_PER_SEC;
         
         if (tiempoTranscurrido >= INTERVALO_ACTUALIZACION) {
-            // Registrar el historial de esta ronda
-            registrarHistorial(numRonda, jugadores, numJugadores);
-            
-            // Actualizar estadísticas
-            imprimirEstadisticasTabla();
+            // Registrar el historial y las estadísticas de esta ronda: el hilo de
+            // instantáneas copia el estado y escribe los archivos sin detener al planificador
+            solicitarInstantanea(numRonda);
             
             // Resetear el temporizador
             ultimaActualizacion = ahora;
@@ -237,6 +195,9 @@ void bucleJuego() {
         usleep(10000);  // 10ms
     }
     
+    // El panel deja la terminal a los mensajes de cierre
+    detenerPanel();
+    
     // Esperar a que todos los hilos de jugadores terminen
     printf("Esperando a que terminen los hilos de los jugadores...\n");
     
@@ -276,6 +237,22 @@ void bucleJuego() {
         }
     }
     
+    // Terminar la última serialización pendiente antes de los resultados
+    detenerInstantaneas();
+    detenerEspeculacion();
+    imprimirEstadisticasParticion();
+    imprimirEstadisticasReacomodo();
+    imprimirEstadisticasEstrategias();
+    imprimirEstadisticasArena();
+    imprimirEstadisticasValidacion();
+    imprimirEstadisticasSlab();
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    printf("\nMesa: %d apeadas en %d bloques de %d, %zu bytes\n", mesa->numApeadas,
+           mesa->numBloques, APEADAS_POR_BLOQUE, memoriaTablaApeadas(mesa));
+    soltarMesa(mesa);
+    printf("Banca: %d de %d cartas (%d barajas), %zu bytes\n", cartasEnBanca(obtenerBanca()),
+           obtenerBanca()->totalCartas, obtenerBanca()->numBarajas, memoriaBanca(obtenerBanca()));
+    
     // Mostrar resultados finales
     mostrarResultados();
     
@@ -316,6 +293,34 @@ int seleccionarJugadorRR() {
     return -1;  // No hay jugadores disponibles
 }
 
+// Predecir el jugador del próximo turno con la regla del planificador,
+// mientras el actual juega. En FCFS es el primero LISTO de la cola después
+// del actual; si todos los demás están en E/S, el que sale antes de ella,
+// que es el primero que vuelve a estar LISTO (si el actual repite, su
+// jugada cambia la mesa o la mano y no hay predicción que valga). En Round
+// Robin es el siguiente que no ha terminado, aunque esté en E/S: el turno
+// le llega igual y lo juega al recibirlo
+int predecirSiguienteJugador(int idJugadorActual) {
+    int primeroEnSalir = -1;
+    
+    for (int i = 1; i < numJugadores; i++) {
+        int idx = (idJugadorActual + i) % numJugadores;
+        
+        if (jugadores[idx].terminado) {
+            continue;
+        }
+        if (algoritmoActual != ALG_FCFS || jugadores[idx].estado == LISTO) {
+            return idx;
+        }
+        if (jugadores[idx].estado == ESPERA_ES &&
+            (primeroEnSalir == -1 || jugadores[idx].tiempoES < jugadores[primeroEnSalir].tiempoES)) {
+            primeroEnSalir = idx;
+        }
+    }
+    
+    return primeroEnSalir;
+}
+
 // Asignar turno a un jugador
 // En juego.c - Necesitamos modificar la función asignarTurno
 void asignarTurno(int idJugador) {
@@ -348,7 +353,7 @@ void asignarTurno(int idJugador) {
     // Marcar como turno actual
     jugadores[idJugador].turnoActual = true;
     
-    printf("Turno asignado al Jugador %d por %d ms\n", idJugador, jugadores[idJugador].tiempoTurno);
+    imprimirRegistro(REGISTRO_DETALLE, "Turno asignado al Jugador %d por %d ms\n", idJugador, jugadores[idJugador].tiempoTurno);
 }
 // Esperar a que un jugador termine su turno
 void esperarFinTurno(int idJugador) {
@@ -374,7 +379,7 @@ void esperarFinTurno(int idJugador) {
             // Forzar fin de turno por tiempo agotado
             jugadores[idJugador].tiempoRestante = 0;
             jugadores[idJugador].turnoActual = false;
-            printf("Tiempo agotado para Jugador %d\n", idJugador);
+            imprimirRegistro(REGISTRO_DETALLE, "Tiempo agotado para Jugador %d\n", idJugador);
             break;
         }
         
@@ -391,25 +396,38 @@ void cambiarAlgoritmo(int nuevoAlgoritmo) {
         return;
     }
     
+    BLOQUEAR(&mutexJuego);
     algoritmoActual = nuevoAlgoritmo;
+    DESBLOQUEAR(&mutexJuego);
     
     const char *nombres[] = {"FCFS", "Round Robin"};
-    printf("Algoritmo cambiado a: %s\n", nombres[algoritmoActual]);
+    imprimirRegistro(REGISTRO_RESUMEN, "Algoritmo cambiado a: %s\n", nombres[algoritmoActual]);
     
     // Explicar el comportamiento del quantum dinámico si se cambió a Round Robin
     if (nuevoAlgoritmo == ALG_RR) {
-        printf("Usando quantum dinámico basado en el número de cartas:\n");
-        printf("  - Base: 1000ms + 100ms por carta\n");
-        printf("  - Mínimo: 1500ms, Máximo: 5000ms\n");
+        imprimirRegistro(REGISTRO_RESUMEN, "Usando quantum dinámico basado en el número de cartas:\n"
+                                           "  - Base: 1000ms + 100ms por carta\n"
+                                           "  - Mínimo: 1500ms, Máximo: 5000ms\n");
     }
 }
 
+// Copiar el estado del planificador (para el panel)
+void obtenerEstadoPlanificador(int *algoritmo, int *quantumActual, int *jugadorEnTurno) {
+    BLOQUEAR(&mutexJuego);
+    *algoritmo = algoritmoActual;
+    *quantumActual = quantum;
+    *jugadorEnTurno = jugadorActual;
+    DESBLOQUEAR(&mutexJuego);
+}
+
 // Finalizar el juego con un ganador
 void finalizarJuego(int idJugadorGanador) {
     // Establecer las variables que controlan el bucle principal
+    BLOQUEAR(&mutexJuego);
     hayGanador = true;
     idGanador = idJugadorGanador;
     juegoEnCurso = false;
+    DESBLOQUEAR(&mutexJuego);
     
     // Registrar evento importante
     if (idJugadorGanador >= 0) {
@@ -436,7 +454,7 @@ void finalizarJuego(int idJugadorGanador) {
         jugadores[i].turnoActual = false;
         
         // NUEVO: Liberar la memoria asignada a cada jugador
-        liberarMemoria(i);
+        liberarMemoriaES(i);
         
         // Actualizar estado a BLOQUEADO
         actualizarEstadoJugador(&jugadores[i], BLOQUEADO);
@@ -526,8 +544,11 @@ void liberarJuego() {
         liberarJugador(&jugadores[i]);
         
         
-        liberarMemoria(i);
+        liberarMemoriaES(i);
     }
+    // Lo que liberó este hilo quedó en sus magazines: sin ello los slabs
+    // siguen ocupando la memoria
+    devolverSlabsVacios();
     
 
     liberarMesa();
@@ -535,6 +556,9 @@ void liberarJuego() {
  
     liberarTabla();
     
+    // Detener los hilos de búsqueda de las estrategias
+    liberarEstrategias();
+    
 
     imprimirEstadoMemoria();
     imprimirEstadoMemoriaVirtual();
@@ -542,25 +566,13 @@ void liberarJuego() {
     printf("Todos los recursos liberados correctamente.\n");
 }
 
+// Obtener los jugadores de la partida
+Jugador* obtenerJugadores(int *cantidad) {
+    *cantidad = numJugadores;
+    return jugadores;
+}
+
+// Los puntos de la mano se mantienen en su resumen al añadir y quitar cartas
 int calcularPuntosMano(Mazo *mano) {
-    int total = 0;
-    
-    for (int i = 0; i < mano->numCartas; i++) {
-        Carta carta = mano->cartas[i];
-        
-        if (carta.esComodin) {
-            total += 20;  // Los comodines valen 20 puntos
-        } else {
-        
-            if (carta.valor >= 11) {  
-                total += 10;
-            } else if (carta.valor == 1) {  
-                total += 15;
-            } else {
-                total += carta.valor;
-            }
-        }
-    }
-    
-    return total;
+    return mano->resumen.puntos;
 }
\ No newline at end of file
@@ -2,10 +2,14 @@
 #define JUEGO_H
 
 #include <stdbool.h>
+#include <pthread.h>
 #include "jugadores.h"
 
 #define MAX_JUGADORES 4
 
+// Mutex del estado global del juego (ganador, algoritmo actual)
+extern pthread_mutex_t mutexJuego;
+
 // Algoritmos de planificación
 #define ALG_FCFS 0
 #define ALG_RR 1
@@ -28,6 +32,9 @@ int seleccionarJugadorFCFS();
 // Seleccionar el próximo jugador según Round Robin
 int seleccionarJugadorRR();
 
+// Predecir qué jugador tendrá el próximo turno
+int predecirSiguienteJugador(int idJugadorActual);
+
 // Asignar turno a un jugador
 void asignarTurno(int idJugador);
 
@@ -37,6 +44,9 @@ void esperarFinTurno(int idJugador);
 // Cambiar el algoritmo de planificación
 void cambiarAlgoritmo(int nuevoAlgoritmo);
 
+// Algoritmo de planificación, quantum del último turno y jugador en turno
+void obtenerEstadoPlanificador(int *algoritmo, int *quantumActual, int *jugadorEnTurno);
+
 // Finalizar el juego con un ganador
 void finalizarJuego(int idJugadorGanador);
 
@@ -49,6 +59,9 @@ void mostrarResultados();
 // Liberar recursos del juego
 void liberarJuego();
 
+// Obtener los jugadores de la partida
+Jugador* obtenerJugadores(int *cantidad);
+
 // Calcular los puntos totales de una mano
 int calcularPuntosMano(Mazo *mano);
 
@@ -7,16 +7,31 @@
 #include <pthread.h>
 #include "jugadores.h"
 #include "mesa.h"
+#include "tablaapeadas.h"
 #include "procesos.h"
 #include "utilidades.h"
 #include "memoria.h"
+#include "candados.h"
+#include "especulacion.h"
+#include "particion.h"
+#include "mazo.h"
+#include "estrategia.h"
+#include "arena.h"
+#include "reacomodo.h"
+#include "banca.h"
+#include "zobrist.h"
+#include "validador.h"
+#include "slab.h"
 #define _DEFAULT_SOURCE
 
-/* Mutex para acceso a recursos compartidos */
-pthread_mutex_t mutexApeadas = PTHREAD_MUTEX_INITIALIZER;
+/* Mutex para acceso a recursos compartidos (la mesa va por versiones, ver mesa.h) */
 pthread_mutex_t mutexBanca = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t mutexTabla = PTHREAD_MUTEX_INITIALIZER;
 
+static void registrarAperturaFallida(Jugador *jugador);
+static bool agregarApeadasJugador(TransaccionMesa *transaccion, Apeada *nuevasApeadas, int numApeadas);
+static void imprimirManoJugador(const char *titulo, Jugador *jugador);
+
 /* Inicializa un jugador con sus valores por defecto */
 void inicializarJugador(Jugador *jugador, int id) {
     jugador->id = id;
@@ -28,11 +43,13 @@ void inicializarJugador(Jugador *jugador, int id) {
     jugador->turnoActual = false;
     jugador->puntosTotal = 0;
     jugador->terminado = false;
+    jugador->secuenciaMano = 0;
     
     /* Inicializar el mazo del jugador */
-    jugador->mano.cartas = NULL;
-    jugador->mano.numCartas = 0;
-    jugador->mano.capacidad = 0;
+    inicializarMazo(&jugador->mano);
+    
+    /* Estrategia elegida en la línea de comandos (o la base) */
+    jugador->estrategia = estrategiaJugador(id);
     
     /* Crear y asociar el BCP */
     jugador->bcp = crearBCP(id);
@@ -46,9 +63,9 @@ void *funcionHiloJugador(void *arg) {
     Jugador *jugador = (Jugador *)arg;
     
     /* Registrar en tabla de procesos que el hilo ha iniciado */
-    pthread_mutex_lock(&mutexTabla);
+    BLOQUEAR(&mutexTabla);
     registrarProcesoEnTabla(jugador->id, PROC_BLOQUEADO);
-    pthread_mutex_unlock(&mutexTabla);
+    DESBLOQUEAR(&mutexTabla);
     
     /* Bucle principal del jugador */
     while (!jugador->terminado && !juegoTerminado()) {
@@ -88,22 +105,36 @@ void *funcionHiloJugador(void *arg) {
         /* Cambiar estado a EJECUCION */
         actualizarEstadoJugador(jugador, EJECUCION);
         
-        /* Obtener referencia a las apeadas y banca */
-        Apeada *apeadas = obtenerApeadas();
-        int numApeadas = obtenerNumApeadas();
-        Mazo *banca = obtenerBanca();
+        /* Obtener referencia a la banca; la mesa la toma el turno */
+        Banca *banca = obtenerBanca();
         
         /* Realizar el turno */
-        bool turnoCompletado = realizarTurno(jugador, apeadas, numApeadas, banca);
+        bool turnoCompletado = realizarTurno(jugador, banca);
         
         /* Si el jugador no pudo completar su turno en el tiempo asignado */
         if (!turnoCompletado) {
-            printf("Jugador %d se quedó sin tiempo en su turno\n", jugador->id);
+            imprimirRegistro(REGISTRO_DETALLE, "Jugador %d se quedó sin tiempo en su turno\n", jugador->id);
+        }
+        
+        /* Hashes del estado tras el turno: comparar dos registros es
+         * comparar estas líneas (ver compararTrazasHash) */
+        uint64_t hashMesa = obtenerHashMesa();
+        registrarEvento("Hash jugador %d mano %016llx mesa %016llx banca %d", jugador->id,
+                        (unsigned long long)hashMazo(&jugador->mano), (unsigned long long)hashMesa,
+                        cartasEnBanca(banca));
+        
+        /* Con --validar, comprobar la partida entera tras cada turno */
+        if (validacionActiva()) {
+            int numTodos;
+            Jugador *todos = obtenerJugadores(&numTodos);
+            const TablaApeadas *mesaPublicada = adquirirMesa(NULL);
+            comprobarTurno(todos, numTodos, mesaPublicada, banca, jugador->id);
+            soltarMesa(mesaPublicada);
         }
         
         /* Verificar si el jugador ha terminado sus cartas */
-        if (jugador->mano.numCartas == 0 && banca->numCartas == 0) {
-            printf("¡Jugador %d ha ganado!\n", jugador->id);
+        if (jugador->mano.numCartas == 0 && cartasEnBanca(banca) == 0) {
+            imprimirRegistro(REGISTRO_RESUMEN, "¡Jugador %d ha ganado!\n", jugador->id);
             jugador->terminado = true;
             finalizarJuego(jugador->id);
         }
@@ -112,79 +143,103 @@ void *funcionHiloJugador(void *arg) {
         pasarTurno(jugador);
     }
     
-    pthread_mutex_lock(&mutexTabla);
+    BLOQUEAR(&mutexTabla);
     registrarProcesoEnTabla(jugador->id, PROC_TERMINADO);
-    pthread_mutex_unlock(&mutexTabla);
+    DESBLOQUEAR(&mutexTabla);
     /* Registrar en tabla de procesos que el hilo ha terminado */
-    printf("Hilo del Jugador %d ha terminado correctamente\n", jugador->id);
+    imprimirRegistro(REGISTRO_RESUMEN, "Hilo del Jugador %d ha terminado correctamente\n", jugador->id);
+    liberarArenaHilo();
+    liberarMemoParticionHilo();
+    liberarReacomodoHilo();
+    vaciarMagazinesHilo();
     
     return NULL;
 }
 
 /* Realizar el turno del jugador */
-bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banca) {
+bool realizarTurno(Jugador *jugador, Banca *banca) {
     int i;
-    char cartaStr[50];
     clock_t inicio;
     int tiempoTranscurrido;
     bool turnoCompletado = false;
     bool hizoJugada = false;
+    Especulacion especulacion;
+    bool usarEspeculacion;
+    TransaccionMesa transaccion;
+    TablaApeadas *mesa;
     
-    printf("\n--- Jugador %d está ejecutando su turno ---\n", jugador->id);
+    imprimirRegistro(REGISTRO_DETALLE, "\n--- Jugador %d está ejecutando su turno ---\n", jugador->id);
+    iniciarTurnoArena();
     
     /* Verificar si tiene tiempo suficiente */
     if (jugador->tiempoRestante <= 0) {
-        printf("Jugador %d no tiene tiempo suficiente para su turno\n", jugador->id);
+        imprimirRegistro(REGISTRO_DETALLE, "Jugador %d no tiene tiempo suficiente para su turno\n", jugador->id);
         return false;
     }
     
+    /* El turno trabaja en una transacción: la mesa es una copia que nadie más
+     * ve hasta confirmarla, y la mano se puede devolver a como empezó */
+    if (!iniciarTransaccionMesa(&transaccion, jugador)) {
+        return false;
+    }
+    mesa = transaccion.mesa;
+    
+    /* Planificación del turno propia de la estrategia (la búsqueda MCTS); su
+     * tiempo real se descuenta del quantum */
+    int numTodos;
+    Jugador *todos = obtenerJugadores(&numTodos);
+    VistaPartida vista = {todos, numTodos, mesa, cartasEnBanca(banca)};
+    jugador->tiempoRestante -= (int)decidirInicioTurno(jugador, &vista);
+    
     /* Tiempo de inicio del turno */
     inicio = clock();
     
+    /* Jugadas calculadas por adelantado durante el turno anterior, si la mesa
+     * y la mano siguen igual. Solo sirven para la primera búsqueda del turno */
+    usarEspeculacion = tomarEspeculacion(jugador, &especulacion);
+    
     /* Mostrar mano actual del jugador */
-    printf("Mano del Jugador %d (%d cartas):\n", jugador->id, jugador->mano.numCartas);
-    for (i = 0; i < jugador->mano.numCartas; i++) {
-        printf("  %d. %s\n", i+1, obtenerNombreCarta(jugador->mano.cartas[i], cartaStr));
+    if (REGISTRO_ACTIVO(REGISTRO_DETALLE)) {
+        imprimirManoJugador("Mano", jugador);
     }
     
     /* Intentar realizar jugadas mientras tenga tiempo */
     while ((clock() - inicio) * 1000 / CLOCKS_PER_SEC < jugador->tiempoRestante) {
         /* Si es la primera vez que se apea */
         if (!jugador->primeraApeada) {
-            colorAzul();
-            printf("Jugador %d intenta hacer su primera apeada (necesita 30+ puntos)\n", jugador->id);
-            colorReset();
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AZUL, "Jugador %d intenta hacer su primera apeada (necesita 30+ puntos)\n", jugador->id);
             
             /* Verificar si puede apearse con 30 puntos o más */
-            if (puedeApearse(jugador)) {
-                /* Crear una nueva apeada */
-                Apeada *nuevaApeada = crearApeada(jugador);
+            bool puede;
+            if (usarEspeculacion) {
+                puede = especulacion.puedeApearse;
+                if (!puede) {
+                    registrarAperturaFallida(jugador);
+                }
+            } else {
+                puede = puedeApearse(jugador);
+            }
+            usarEspeculacion = false;
+            
+            if (puede) {
+                /* La estrategia decide qué apeadas bajar */
+                int numNuevas;
+                iniciarEscrituraMano(jugador);
+                Apeada *nuevasApeadas = decidirApertura(jugador, &numNuevas);
+                finalizarEscrituraMano(jugador);
                 
-                if (nuevaApeada != NULL) {
-                    /* Añadir la apeada a la mesa */
-                    pthread_mutex_lock(&mutexApeadas);
-                    if (agregarApeada(nuevaApeada)) {
-                        colorVerde();
-                        printf("¡Jugador %d ha realizado su primera apeada!\n", jugador->id);
-                        colorReset();
+                if (nuevasApeadas != NULL) {
+                    /* Añadir las apeadas a la mesa; si alguna falla se
+                     * deshace el turno y las cartas vuelven a la mano */
+                    if (agregarApeadasJugador(&transaccion, nuevasApeadas, numNuevas)) {
+                        imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "¡Jugador %d ha realizado su primera apeada (%d jugadas)!\n", jugador->id, numNuevas);
                         jugador->primeraApeada = true;
                         hizoJugada = true;
-                        
-                        /* Liberar memoria de la nueva apeada (ya está copiada en la mesa) */
-                        free(nuevaApeada);
                     } else {
-                        colorRojo();
-                        printf("Error: No se pudo agregar la apeada a la mesa\n");
-                        colorReset();
-                        
-                        /* Aquí habría que devolver las cartas al jugador, pero por simplicidad no lo hacemos */
-                        free(nuevaApeada);
+                        deshacerTransaccionMesa(&transaccion);
                     }
-                    pthread_mutex_unlock(&mutexApeadas);
                 } else {
-                    colorRojo();
-                    printf("Jugador %d no pudo formar una apeada con 30+ puntos\n", jugador->id);
-                    colorReset();
+                    imprimirRegistroColor(REGISTRO_DETALLE, COLOR_ROJO, "Jugador %d no pudo formar una apeada con 30+ puntos\n", jugador->id);
                     
                     /* Actualizar BCP con intento fallido */
                     if (jugador->bcp != NULL) {
@@ -195,91 +250,111 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
                     }
                     
                     registrarEvento("Jugador %d realizó una jugada en una apeada", jugador->id);
-        
+                    
+                    confirmarTransaccionMesa(&transaccion);
                     return true;
                 }
             } else {
-                colorAmarillo();
-                printf("Jugador %d no tiene cartas para hacer su primera apeada\n", jugador->id);
-                colorReset();
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Jugador %d no tiene cartas para hacer su primera apeada\n", jugador->id);
             }
         } else {
             /* Ya se apeó anteriormente, buscar jugadas posibles */
-            colorAzul();
-            printf("Jugador %d busca jugadas en las apeadas existentes\n", jugador->id);
-            colorReset();
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AZUL, "Jugador %d busca jugadas en las apeadas existentes\n", jugador->id);
             
-            /* Mutex para acceder a las apeadas */
-            pthread_mutex_lock(&mutexApeadas);
-            
-            /* Buscar en cada apeada si puede hacer embones o modificar */
+            /* La estrategia elige la apeada del embone; con un resultado
+             * especulado válido solo se le ofrecen las candidatas (si no
+             * se quedaron sin sitio; entonces, toda la mesa) */
             bool hizoBusqueda = false;
-            for (i = 0; i < numApeadas; i++) {
-                /* Verificar si puede hacer jugada en esta apeada */
-                if (verificarApeada(jugador, &apeadas[i])) {
-                    colorVerde();
-                    printf("Jugador %d puede modificar la apeada %d\n", jugador->id, i);
-                    colorReset();
-                    
-                    /* Realizar jugada en esta apeada */
-                    if (realizarJugadaApeada(jugador, &apeadas[i])) {
-                        colorVerde();
-                        printf("¡Jugador %d ha realizado una jugada en la apeada %d!\n", jugador->id, i);
-                        colorReset();
-                        hizoJugada = true;
-                        hizoBusqueda = true;
-                        break;
-                    }
+            int numIndices = 0;
+            int *indices = (int*)reservarArena((mesa->numApeadas + 1) * sizeof(int));
+            if (indices != NULL && usarEspeculacion && !especulacion.truncada) {
+                memcpy(indices, especulacion.candidatas, especulacion.numCandidatas * sizeof(int));
+                numIndices = especulacion.numCandidatas;
+            } else if (indices != NULL) {
+                for (int c = 0; c < mesa->numApeadas; c++) {
+                    indices[numIndices++] = c;
+                }
+            }
+            
+            i = decidirEmbone(jugador, mesa, indices, numIndices);
+            if (i >= 0) {
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Jugador %d puede modificar la apeada %d\n", jugador->id, i);
+                
+                /* Realizar jugada en esta apeada (si su bloque se comparte
+                 * con la mesa publicada, antes se copia) */
+                uint64_t hashAnterior = hashApeada(apeadaEnTabla(mesa, i));
+                Apeada *apeada = escribirApeada(&transaccion, i);
+                iniciarEscrituraMano(jugador);
+                bool jugadaRealizada = apeada != NULL && realizarJugadaApeada(jugador, apeada);
+                finalizarEscrituraMano(jugador);
+                
+                if (jugadaRealizada) {
+                    apeadaModificada(&transaccion, i, hashAnterior);
+                    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "¡Jugador %d ha realizado una jugada en la apeada %d!\n", jugador->id, i);
+                    hizoJugada = true;
+                    hizoBusqueda = true;
                 }
             }
             
+            usarEspeculacion = false;
+            
             /* Si no encontró ninguna apeada que modificar, intentar crear una nueva */
             if (!hizoBusqueda && jugador->mano.numCartas > 0) {
-                colorAzul();
-                printf("Jugador %d intenta crear una nueva apeada\n", jugador->id);
-                colorReset();
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AZUL, "Jugador %d intenta crear una nueva apeada\n", jugador->id);
                 
-                /* Crear una nueva apeada */
-                Apeada *nuevaApeada = crearApeada(jugador);
+                /* La estrategia decide si bajar apeadas nuevas y cuáles */
+                int numNuevas;
+                iniciarEscrituraMano(jugador);
+                Apeada *nuevasApeadas = decidirNuevaApeada(jugador, &numNuevas);
+                finalizarEscrituraMano(jugador);
                 
-                if (nuevaApeada != NULL) {
-                    /* Añadir la apeada a la mesa */
-                    if (agregarApeada(nuevaApeada)) {
-                        colorVerde();
-                        printf("¡Jugador %d ha creado una nueva apeada!\n", jugador->id);
-                        colorReset();
+                if (nuevasApeadas != NULL) {
+                    /* Añadir las apeadas a la mesa */
+                    if (agregarApeadasJugador(&transaccion, nuevasApeadas, numNuevas)) {
+                        imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "¡Jugador %d ha creado %d apeadas nuevas!\n", jugador->id, numNuevas);
                         hizoJugada = true;
-                        
-                        /* Liberar memoria de la nueva apeada (ya está copiada en la mesa) */
-                        free(nuevaApeada);
                     } else {
-                        colorRojo();
-                        printf("Error: No se pudo agregar la apeada a la mesa\n");
-                        colorReset();
-                        
-                        /* Aquí habría que devolver las cartas al jugador, pero por simplicidad no lo hacemos */
-                        free(nuevaApeada);
+                        deshacerTransaccionMesa(&transaccion);
                     }
                 }
             }
             
-            pthread_mutex_unlock(&mutexApeadas);
+            /* Último recurso: rehacer la mesa entera con cartas de la mano
+             * (si el turno no se acaba de deshacer) */
+            if (transaccion.activa && !hizoJugada && jugador->mano.numCartas > 0 && mesa->numApeadas > 0) {
+                int numNuevas;
+                iniciarEscrituraMano(jugador);
+                Apeada *nuevasApeadas = crearApeadasDeReacomodo(jugador, mesa, &numNuevas);
+                finalizarEscrituraMano(jugador);
+                
+                if (nuevasApeadas != NULL) {
+                    if (reemplazarApeadas(&transaccion, nuevasApeadas, numNuevas)) {
+                        imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "¡Jugador %d ha reacomodado la mesa en %d apeadas!\n", jugador->id, numNuevas);
+                        hizoJugada = true;
+                    } else {
+                        /* Las cartas que salieron de la mano vuelven con ella */
+                        deshacerTransaccionMesa(&transaccion);
+                    }
+                }
+            }
         }
         
         /* Si no pudo hacer ninguna jugada, comer ficha si hay disponibles */
         if (!hizoJugada) {
-            colorAmarillo();
-            printf("Jugador %d no pudo hacer jugada, intenta comer ficha\n", jugador->id);
-            colorReset();
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Jugador %d no pudo hacer jugada, intenta comer ficha\n", jugador->id);
             
-            pthread_mutex_lock(&mutexBanca);
+            /* Las jugadas del turno se publican antes de comer: lo que se
+             * come ya no forma parte de la transacción */
+            confirmarTransaccionMesa(&transaccion);
             
-            if (banca->numCartas > 0) {
+            /* mutexBanca solo se toma dentro de comerFicha, para robar: la
+             * decisión y la ampliación de la mano van sin él */
+            if (cartasEnBanca(banca) > 0 && decidirComer(jugador, banca)) {
+                iniciarEscrituraMano(jugador);
                 bool comio = comerFicha(jugador, banca);
+                finalizarEscrituraMano(jugador);
                 if (comio) {
-                    colorVerde();
-                    printf("Jugador %d comió una ficha. Entrando en E/S\n", jugador->id);
-                    colorReset();
+                    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "Jugador %d comió una ficha. Entrando en E/S\n", jugador->id);
                     
                     /* Actualizar BCP */
                     if (jugador->bcp != NULL) {
@@ -288,20 +363,18 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
                     }
                     
                     /* Entrar en estado de E/S después de comer */
-                    pthread_mutex_unlock(&mutexBanca);
                     entrarEsperaES(jugador);
                     turnoCompletado = true;
                     break;
                 }
+            } else if (cartasEnBanca(banca) > 0) {
+                /* La estrategia prefiere no comer */
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Jugador %d decide no comer ficha\n", jugador->id);
             } else {
                 /* No hay fichas para comer y no puede hacer jugada */
-                colorRojo();
-                printf("Jugador %d no puede hacer jugada y no hay fichas para comer\n", jugador->id);
-                colorReset();
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_ROJO, "Jugador %d no puede hacer jugada y no hay fichas para comer\n", jugador->id);
             }
             
-            pthread_mutex_unlock(&mutexBanca);
-            
             /* Si no pudo hacer jugada ni comer, terminar el turno */
             turnoCompletado = true;
             break;
@@ -310,9 +383,7 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
         /* Si hizo alguna jugada, verificar si terminó sus cartas */
         if (hizoJugada) {
             if (jugador->mano.numCartas == 0) {
-                colorVerde();
-                printf("¡Jugador %d se ha quedado sin cartas!\n", jugador->id);
-                colorReset();
+                imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "¡Jugador %d se ha quedado sin cartas!\n", jugador->id);
                 turnoCompletado = true;
                 break;
             }
@@ -321,9 +392,7 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
             hizoJugada = false;
         } else {
             /* Si no pudo hacer jugada, terminar el turno */
-            colorAmarillo();
-            printf("Jugador %d no pudo hacer ninguna jugada, fin del turno\n", jugador->id);
-            colorReset();
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Jugador %d no pudo hacer ninguna jugada, fin del turno\n", jugador->id);
             turnoCompletado = true;
             break;
         }
@@ -332,6 +401,9 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
         usleep(10000);  /* 10ms */
     }
     
+    /* Publicar las jugadas del turno (sin efecto si ya se publicaron o se deshicieron) */
+    confirmarTransaccionMesa(&transaccion);
+    
     /* Actualizar tiempo restante */
     tiempoTranscurrido = (clock() - inicio) * 1000 / CLOCKS_PER_SEC;
     jugador->tiempoRestante -= tiempoTranscurrido;
@@ -339,9 +411,7 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
     /* Si el tiempo llegó a 0, actualizar BCP con turno perdido */
     if (jugador->tiempoRestante <= 0) {
         jugador->tiempoRestante = 0;
-        colorAmarillo();
-        printf("Jugador %d se quedó sin tiempo en su turno\n", jugador->id);
-        colorReset();
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Jugador %d se quedó sin tiempo en su turno\n", jugador->id);
         
         /* Actualizar BCP */
         if (jugador->bcp != NULL) {
@@ -351,1015 +421,493 @@ bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banc
     }
     
     /* Mostrar mano final del jugador */
-    printf("Mano final del Jugador %d (%d cartas):\n", jugador->id, jugador->mano.numCartas);
-    for (i = 0; i < jugador->mano.numCartas; i++) {
-        printf("  %d. %s\n", i+1, obtenerNombreCarta(jugador->mano.cartas[i], cartaStr));
+    if (REGISTRO_ACTIVO(REGISTRO_DETALLE)) {
+        imprimirManoJugador("Mano final", jugador);
+        printf("--- Fin del turno del Jugador %d (tiempo restante: %d ms) ---\n", 
+               jugador->id, jugador->tiempoRestante);
     }
     
-    printf("--- Fin del turno del Jugador %d (tiempo restante: %d ms) ---\n", 
-           jugador->id, jugador->tiempoRestante);
-    
     return turnoCompletado;
 }
 
+/* Mostrar la mano en un solo printf, para que las líneas de otros hilos no se
+ * intercalen entre sus cartas */
+static void imprimirManoJugador(const char *titulo, Jugador *jugador) {
+    char texto[4096];
+    char cartaStr[50];
+    int usado = snprintf(texto, sizeof(texto), "%s del Jugador %d (%d cartas):\n",
+                         titulo, jugador->id, jugador->mano.numCartas);
+    
+    for (int i = 0; i < jugador->mano.numCartas && usado < (int)sizeof(texto); i++) {
+        usado += snprintf(texto + usado, sizeof(texto) - usado, "  %d. %s\n",
+                          i + 1, obtenerNombreCarta(jugador->mano.cartas[i], cartaStr));
+    }
+    fputs(texto, stdout);
+}
+
+/* Actualizar el BCP cuando el jugador no alcanza los 30 puntos */
+static void registrarAperturaFallida(Jugador *jugador) {
+    if (jugador->bcp != NULL) {
+        jugador->bcp->intentosFallidos++;
+        actualizarBCPJugador(jugador);
+    }
+}
+
 /* Verificar si el jugador puede hacer su primera apeada */
 bool puedeApearse(Jugador *jugador) {
-    /* Para apearse por primera vez, se necesitan 30 puntos o más */
-    Carta *cartas;
-    int maxPuntos = 0;
-    int i, j, k;
-    Carta grupo[4];
-    int numCartasGrupo;
-    int puntosGrupo;
-    bool paloRepetido;
-    int comodinesDisponibles;
-    Carta escaleraTemp[13];
-    int numCartasEscalera;
-    int inicioEscalera, finEscalera;
-    int longitudEscalera;
-    int huecos;
-    int longitudFinal;
-    int puntosEscalera;
-    
     /* Verificar si ya se ha apeado antes */
     if (jugador->primeraApeada) {
         return true;  /* Ya se ha apeado antes, no necesita 30 puntos */
     }
     
-    /* Ordenar cartas por palo y valor para facilitar la búsqueda */
-    cartas = (Carta*)malloc(jugador->mano.numCartas * sizeof(Carta));
-    if (cartas == NULL) {
-        printf("Error: No se pudo asignar memoria para las cartas\n");
-        return false;
+    /* La mejor apertura se guarda en el resumen de la mano hasta que esta cambie */
+    if (obtenerMejorApertura(&jugador->mano) >= 30) {
+        return true;
     }
     
-    memcpy(cartas, jugador->mano.cartas, jugador->mano.numCartas * sizeof(Carta));
+    registrarAperturaFallida(jugador);
+    return false;
+}
+
+/* Ver si la mejor partición de la mano en apeadas suma 30 puntos o más.
+ * No modifica nada fuera de la función, así que también sirve sobre copias
+ * de la mano */
+bool evaluarApertura(const Carta *mano, int numCartas) {
+    ParticionMano particion;
     
-    /* Ordenar por palo y luego por valor */
-    for (i = 0; i < jugador->mano.numCartas - 1; i++) {
-        for (j = 0; j < jugador->mano.numCartas - i - 1; j++) {
-            if (cartas[j].palo > cartas[j+1].palo || 
-                (cartas[j].palo == cartas[j+1].palo && cartas[j].valor > cartas[j+1].valor)) {
-                Carta temp = cartas[j];
-                cartas[j] = cartas[j+1];
-                cartas[j+1] = temp;
-            }
-        }
+    if (numCartas <= 0) {
+        return false;
     }
     
-    /* Buscar grupos (ternas o cuaternas) */
-    for (i = 1; i <= 13; i++) {  /* Valores del 1 al 13 */
-        numCartasGrupo = 0;
-        puntosGrupo = 0;
-        
-        for (j = 0; j < jugador->mano.numCartas && numCartasGrupo < 4; j++) {
-            if (!cartas[j].esComodin && cartas[j].valor == i) {
-                /* Verificar que no haya dos cartas del mismo palo */
-                paloRepetido = false;
-                for (k = 0; k < numCartasGrupo; k++) {
-                    if (grupo[k].palo == cartas[j].palo) {
-                        paloRepetido = true;
-                        break;
-                    }
-                }
-                
-                if (!paloRepetido) {
-                    grupo[numCartasGrupo] = cartas[j];
-                    numCartasGrupo++;
-                    
-                    /* Calcular puntos */
-                    if (cartas[j].valor >= 11) {  /* J, Q, K */
-                        puntosGrupo += 10;
-                    } else if (cartas[j].valor == 1) {  /* As */
-                        puntosGrupo += 15;
-                    } else {
-                        puntosGrupo += cartas[j].valor;
-                    }
-                }
-            }
-        }
-        
-        /* Añadir comodines si es necesario para completar una terna */
-        comodinesDisponibles = 0;
-        for (j = 0; j < jugador->mano.numCartas; j++) {
-            if (cartas[j].esComodin) {
-                comodinesDisponibles++;
-            }
-        }
-        
-        /* Si tenemos 2 cartas y un comodín, podemos formar una terna */
-        if (numCartasGrupo == 2 && comodinesDisponibles >= 1) {
-            numCartasGrupo++;
-            puntosGrupo += 20;  /* Valor del comodín */
-            comodinesDisponibles--;
-        }
-        
-        /* Verificar si es un grupo válido (terna o cuaterna) */
-        if (numCartasGrupo >= 3) {
-            maxPuntos += puntosGrupo;
-            
-            /* Si ya tenemos 30 puntos o más, podemos apearnos */
-            if (maxPuntos >= 30) {
-                free(cartas);
-                return true;
-            }
+    resolverParticion(mano, numCartas, OBJ_MAX_PUNTOS, &particion);
+    return particion.puntos >= 30;
+}
+
+/* Valor de un grupo de la mesa (el de su primera carta natural) */
+static int valorGrupoApeada(const Grupo *grupo) {
+    for (int i = 0; i < grupo->numCartas; i++) {
+        if (!grupo->cartas[i].esComodin) {
+            return grupo->cartas[i].valor;
         }
     }
+    return 0;
+}
+
+/* Palo (índice en la firma) de una carta de la mano que completa el grupo, o -1 */
+static int paloParaGrupo(const Mazo *mano, const Grupo *grupo, int valorGrupo) {
+    unsigned int palosGrupo = 0;
+    int i;
     
-    /* Buscar escaleras (tres o más cartas consecutivas del mismo palo) */
-    for (char palo = 'C'; palo <= 'T'; palo++) {
-        /* Seleccionar cartas del mismo palo */
-        numCartasEscalera = 0;
-        
-        for (j = 0; j < jugador->mano.numCartas; j++) {
-            if (!cartas[j].esComodin && cartas[j].palo == palo) {
-                escaleraTemp[numCartasEscalera] = cartas[j];
-                numCartasEscalera++;
-            }
+    for (i = 0; i < grupo->numCartas; i++) {
+        int palo = indicePaloParticion(grupo->cartas[i].palo);
+        if (!grupo->cartas[i].esComodin && palo >= 0) {
+            palosGrupo |= 1u << palo;
         }
-        
-        /* Ordenar por valor */
-        for (i = 0; i < numCartasEscalera - 1; i++) {
-            for (j = 0; j < numCartasEscalera - i - 1; j++) {
-                if (escaleraTemp[j].valor > escaleraTemp[j+1].valor) {
-                    Carta temp = escaleraTemp[j];
-                    escaleraTemp[j] = escaleraTemp[j+1];
-                    escaleraTemp[j+1] = temp;
-                }
-            }
+    }
+    
+    for (i = 0; i < NUM_PALOS; i++) {
+        if (!(palosGrupo & (1u << i)) && tieneValorPaloMazo(mano, i, valorGrupo)) {
+            return i;
         }
-        
-        /* Buscar secuencias */
-        inicioEscalera = 0;
-        while (inicioEscalera < numCartasEscalera) {
-            finEscalera = inicioEscalera;
-            
-            /* Encontrar el final de la secuencia */
-            while (finEscalera + 1 < numCartasEscalera && 
-                   escaleraTemp[finEscalera + 1].valor == escaleraTemp[finEscalera].valor + 1) {
-                finEscalera++;
-            }
-            
-            /* Verificar si es una escalera válida (3 o más cartas) */
-            longitudEscalera = finEscalera - inicioEscalera + 1;
-            
-            /* Ver si podemos completar con comodines */
-            comodinesDisponibles = 0;
-            for (j = 0; j < jugador->mano.numCartas; j++) {
-                if (cartas[j].esComodin) {
-                    comodinesDisponibles++;
-                }
-            }
-            
-            /* Calcular huecos en la escalera */
-            huecos = 0;
-            for (j = inicioEscalera; j < finEscalera; j++) {
-                huecos += escaleraTemp[j+1].valor - escaleraTemp[j].valor - 1;
-            }
-            
-            /* Verificar si podemos llenar los huecos con comodines */
-            longitudFinal = longitudEscalera;
-            if (huecos <= comodinesDisponibles) {
-                longitudFinal += huecos;
-                comodinesDisponibles -= huecos;
+    }
+    return -1;
+}
+
+/* Valores natural mínimo y máximo de una escalera de la mesa */
+static void extremosEscalera(const Escalera *escalera, int *valorMinimo, int *valorMaximo) {
+    *valorMinimo = INT_MAX;
+    *valorMaximo = INT_MIN;
+    
+    for (int i = 0; i < escalera->numCartas; i++) {
+        if (!escalera->cartas[i].esComodin) {
+            if (escalera->cartas[i].valor < *valorMinimo) {
+                *valorMinimo = escalera->cartas[i].valor;
             }
-            
-            /* Si la escalera es válida (3 o más cartas), calcular puntos */
-            if (longitudFinal >= 3) {
-                puntosEscalera = 0;
-                
-                /* Calcular puntos de la escalera */
-                for (j = inicioEscalera; j <= finEscalera; j++) {
-                    if (escaleraTemp[j].valor >= 11) {  /* J, Q, K */
-                        puntosEscalera += 10;
-                    } else if (escaleraTemp[j].valor == 1) {  /* As */
-                        puntosEscalera += 15;
-                    } else {
-                        puntosEscalera += escaleraTemp[j].valor;
-                    }
-                }
-                
-                /* Añadir puntos de los comodines */
-                puntosEscalera += huecos * 20;
-                
-                maxPuntos += puntosEscalera;
-                
-                /* Si ya tenemos 30 puntos o más, podemos apearnos */
-                if (maxPuntos >= 30) {
-                    free(cartas);
-                    return true;
-                }
+            if (escalera->cartas[i].valor > *valorMaximo) {
+                *valorMaximo = escalera->cartas[i].valor;
             }
-            
-            /* Continuar con la siguiente secuencia */
-            inicioEscalera = finEscalera + 1;
         }
     }
-    
-    free(cartas);
-    
-    /* Actualizar BCP con intento fallido */
-    if (jugador->bcp != NULL) {
-        jugador->bcp->intentosFallidos++;
-        actualizarBCPJugador(jugador);
-    }
-    
-    return false;  /* No se encontraron combinaciones que sumen 30 puntos o más */
 }
 
-/* Verificar si una apeada puede ser modificada por un jugador */
-bool verificarApeada(Jugador *jugador, Apeada *apeada) {
-    int i, j;
-    int valorGrupo;
-    char paloEscalera;
-    int valorMinimo, valorMaximo;
-    Carta *carta;
-    bool paloRepetido;
-    Grupo *grupo;
-    Escalera *escalera;
-    
-    /* Esta función verifica si el jugador puede modificar la apeada */
+/* Ver si la mano tiene una carta que encaje en la apeada. Las cartas de la
+ * mano se consultan en el resumen del mazo, sin recorrerla */
+static bool puedeEmbonar(const Mazo *mano, Apeada *apeada, bool permitirComodin) {
+    bool hayComodin = permitirComodin && mano->resumen.firma.comodines > 0;
     
     if (apeada->esGrupo) {
         /* Es un grupo (terna o cuaterna) */
-        grupo = &apeada->jugada.grupo;
+        Grupo *grupo = &apeada->jugada.grupo;
         
         /* Si ya es una cuaterna, no se puede modificar */
         if (grupo->numCartas >= 4) {
             return false;
         }
         
-        /* Buscar si el jugador tiene una carta del mismo valor y diferente palo */
-        valorGrupo = grupo->cartas[0].valor;
-        
-        for (i = 0; i < jugador->mano.numCartas; i++) {
-            carta = &jugador->mano.cartas[i];
-            
-            /* Verificar si es del mismo valor */
-            if (!carta->esComodin && carta->valor == valorGrupo) {
-                /* Verificar que no haya una carta del mismo palo en el grupo */
-                paloRepetido = false;
-                for (j = 0; j < grupo->numCartas; j++) {
-                    if (grupo->cartas[j].palo == carta->palo) {
-                        paloRepetido = true;
-                        break;
-                    }
-                }
-                
-                if (!paloRepetido) {
-                    return true;  /* Puede añadir esta carta al grupo */
-                }
-            }
-        }
-        
-        /* Verificar si tiene un comodín */
-        for (i = 0; i < jugador->mano.numCartas; i++) {
-            if (jugador->mano.cartas[i].esComodin) {
-                return true;  /* Puede añadir un comodín al grupo */
-            }
-        }
-        
-    } else {
-        /* Es una escalera */
-        escalera = &apeada->jugada.escalera;
-        paloEscalera = escalera->palo;
-        
-        /* Verificar si puede añadir cartas al principio o al final de la escalera */
-        if (escalera->numCartas > 0) {
-            valorMinimo = INT_MAX;
-            valorMaximo = INT_MIN;
-            
-            /* Encontrar los valores mínimo y máximo de la escalera */
-            for (i = 0; i < escalera->numCartas; i++) {
-                if (!escalera->cartas[i].esComodin) {
-                    if (escalera->cartas[i].valor < valorMinimo) {
-                        valorMinimo = escalera->cartas[i].valor;
-                    }
-                    if (escalera->cartas[i].valor > valorMaximo) {
-                        valorMaximo = escalera->cartas[i].valor;
-                    }
-                }
-            }
-            
-            /* Verificar si tiene una carta que pueda añadir al principio (valor - 1) */
-            if (valorMinimo > 1) {  /* No se puede añadir antes del As (1) */
-                for (i = 0; i < jugador->mano.numCartas; i++) {
-                    carta = &jugador->mano.cartas[i];
-                    if (!carta->esComodin && carta->palo == paloEscalera && carta->valor == valorMinimo - 1) {
-                        return true;  /* Puede añadir esta carta al principio */
-                    }
-                }
-            }
-            
-            /* Verificar si tiene una carta que pueda añadir al final (valor + 1) */
-            if (valorMaximo < 13) {  /* No se puede añadir después del Rey (13) */
-                for (i = 0; i < jugador->mano.numCartas; i++) {
-                    carta = &jugador->mano.cartas[i];
-                    if (!carta->esComodin && carta->palo == paloEscalera && carta->valor == valorMaximo + 1) {
-                        return true;  /* Puede añadir esta carta al final */
-                    }
-                }
-            }
-            
-            /* Verificar si tiene un comodín */
-            for (i = 0; i < jugador->mano.numCartas; i++) {
-                if (jugador->mano.cartas[i].esComodin) {
-                    return true;  /* Puede añadir un comodín a la escalera */
-                }
-            }
-        }
+        /* Una carta del mismo valor y de un palo que no esté en el grupo, o un comodín */
+        return paloParaGrupo(mano, grupo, valorGrupoApeada(grupo)) >= 0 || hayComodin;
     }
     
-    return false;  /* No puede modificar la apeada */
+    /* Es una escalera */
+    Escalera *escalera = &apeada->jugada.escalera;
+    int palo = indicePaloParticion(escalera->palo);
+    int valorMinimo, valorMaximo;
+    
+    if (escalera->numCartas <= 0 || escalera->numCartas >= MAX_CARTAS_ESCALERA) {
+        return false;
+    }
+    
+    extremosEscalera(escalera, &valorMinimo, &valorMaximo);
+    
+    /* Carta anterior al mínimo (no antes del As), posterior al máximo (no
+     * después del Rey) o un comodín */
+    return (valorMinimo > 1 && tieneValorPaloMazo(mano, palo, valorMinimo - 1)) ||
+           (valorMaximo < 13 && tieneValorPaloMazo(mano, palo, valorMaximo + 1)) ||
+           hayComodin;
+}
+
+/* Verificar si una apeada puede ser modificada por un jugador */
+bool verificarApeada(Jugador *jugador, Apeada *apeada) {
+    return puedeEmbonar(&jugador->mano, apeada, true);
+}
+
+/* Igual, pero solo con cartas naturales (sin gastar un comodín) */
+bool verificarApeadaSinComodin(Jugador *jugador, Apeada *apeada) {
+    return puedeEmbonar(&jugador->mano, apeada, false);
+}
+
+/* Ver si cabe una carta más en la escalera */
+static bool ampliarEscalera(Escalera *escalera) {
+    return escalera->numCartas < MAX_CARTAS_ESCALERA;
 }
 
 /* Realizar una jugada en una apeada */
 bool realizarJugadaApeada(Jugador *jugador, Apeada *apeada) {
-    int i, j;
-    int valorGrupo;
-    Carta *carta;
-    bool paloRepetido;
-    Grupo *grupo;
-    Escalera *escalera;
-    char paloEscalera;
-    int valorMinimo = INT_MAX;
-    int valorMaximo = INT_MIN;
-    int nuevaCapacidad;
-    
-    /* Esta función realiza la jugada en la apeada seleccionada */
+    Mazo *mano = &jugador->mano;
+    Carta comodin = {0, 'J', true};
+    int indice;
+    
+    /* Esta función realiza la jugada en la apeada seleccionada. El orden de
+     * la mano no importa, así que la carta se quita en O(1) */
     
     if (apeada->esGrupo) {
         /* Es un grupo (terna o cuaterna) */
-        grupo = &apeada->jugada.grupo;
+        Grupo *grupo = &apeada->jugada.grupo;
+        int valorGrupo = valorGrupoApeada(grupo);
         
         /* Si ya es una cuaterna, no se puede modificar */
         if (grupo->numCartas >= 4) {
             return false;
         }
         
-        /* Buscar si el jugador tiene una carta del mismo valor y diferente palo */
-        valorGrupo = grupo->cartas[0].valor;
-        
-        for (i = 0; i < jugador->mano.numCartas; i++) {
-            carta = &jugador->mano.cartas[i];
-            
-            /* Verificar si es del mismo valor */
-            if (!carta->esComodin && carta->valor == valorGrupo) {
-                /* Verificar que no haya una carta del mismo palo en el grupo */
-                paloRepetido = false;
-                for (j = 0; j < grupo->numCartas; j++) {
-                    if (grupo->cartas[j].palo == carta->palo) {
-                        paloRepetido = true;
-                        break;
-                    }
-                }
-                
-                if (!paloRepetido) {
-                    /* Añadir la carta al grupo */
-                    grupo->cartas[grupo->numCartas] = *carta;
-                    grupo->numCartas++;
-                    
-                    /* Eliminar la carta de la mano del jugador */
-                    for (j = i; j < jugador->mano.numCartas - 1; j++) {
-                        jugador->mano.cartas[j] = jugador->mano.cartas[j+1];
-                    }
-                    jugador->mano.numCartas--;
-                    
-                    return true;
-                }
-            }
+        /* Buscar una carta del mismo valor y diferente palo; si no, un comodín */
+        int palo = paloParaGrupo(mano, grupo, valorGrupo);
+        if (palo >= 0) {
+            Carta carta = {valorGrupo, palosParticion[palo], false};
+            indice = buscarCartaMazo(mano, carta);
+        } else {
+            indice = buscarCartaMazo(mano, comodin);
         }
         
-        /* Verificar si tiene un comodín */
-        for (i = 0; i < jugador->mano.numCartas; i++) {
-            if (jugador->mano.cartas[i].esComodin) {
-                /* Añadir el comodín al grupo */
-                grupo->cartas[grupo->numCartas] = jugador->mano.cartas[i];
-                grupo->numCartas++;
-                
-                /* Eliminar el comodín de la mano del jugador */
-                for (j = i; j < jugador->mano.numCartas - 1; j++) {
-                    jugador->mano.cartas[j] = jugador->mano.cartas[j+1];
-                }
-                jugador->mano.numCartas--;
-                
-                return true;
-            }
+        if (indice < 0) {
+            return false;
         }
         
-    } else {
-        /* Es una escalera */
-        escalera = &apeada->jugada.escalera;
-        paloEscalera = escalera->palo;
+        /* Pasar la carta de la mano al grupo */
+        grupo->cartas[grupo->numCartas] = quitarCartaMazoRapido(mano, indice);
+        grupo->numCartas++;
+        return true;
+    }
+    
+    /* Es una escalera */
+    Escalera *escalera = &apeada->jugada.escalera;
+    int palo = indicePaloParticion(escalera->palo);
+    int valorMinimo, valorMaximo;
+    
+    if (escalera->numCartas <= 0) {
+        return false;
+    }
+    
+    extremosEscalera(escalera, &valorMinimo, &valorMaximo);
+    
+    /* Carta que puede ir al principio (valor - 1) */
+    if (valorMinimo > 1 && tieneValorPaloMazo(mano, palo, valorMinimo - 1)) {
+        Carta carta = {valorMinimo - 1, escalera->palo, false};
+        indice = buscarCartaMazo(mano, carta);
         
-        /* Verificar si puede añadir cartas al principio o al final de la escalera */
-        if (escalera->numCartas > 0) {
-            /* Encontrar los valores mínimo y máximo de la escalera */
-            for (i = 0; i < escalera->numCartas; i++) {
-                if (!escalera->cartas[i].esComodin) {
-                    if (escalera->cartas[i].valor < valorMinimo) {
-                        valorMinimo = escalera->cartas[i].valor;
-                    }
-                    if (escalera->cartas[i].valor > valorMaximo) {
-                        valorMaximo = escalera->cartas[i].valor;
-                    }
-                }
-            }
-            
-            /* Verificar si tiene una carta que pueda añadir al principio (valor - 1) */
-            if (valorMinimo > 1) {  /* No se puede añadir antes del As (1) */
-                for (i = 0; i < jugador->mano.numCartas; i++) {
-                    carta = &jugador->mano.cartas[i];
-                    if (!carta->esComodin && carta->palo == paloEscalera && carta->valor == valorMinimo - 1) {
-                        /* Añadir la carta al principio de la escalera */
-                        if (escalera->numCartas >= escalera->capacidad) {
-                            /* Ampliar capacidad si es necesario */
-                            nuevaCapacidad = escalera->capacidad == 0 ? 13 : escalera->capacidad * 2;
-                            escalera->cartas = realloc(escalera->cartas, nuevaCapacidad * sizeof(Carta));
-                            
-                            if (escalera->cartas == NULL) {
-                                printf("Error: No se pudo ampliar la capacidad de la escalera\n");
-                                return false;
-                            }
-                            
-                            escalera->capacidad = nuevaCapacidad;
-                        }
-                        
-                        /* Desplazar todas las cartas una posición */
-                        for (j = escalera->numCartas; j > 0; j--) {
-                            escalera->cartas[j] = escalera->cartas[j-1];
-                        }
-                        
-                        /* Añadir la nueva carta al principio */
-                        escalera->cartas[0] = *carta;
-                        escalera->numCartas++;
-                        
-                        /* Eliminar la carta de la mano del jugador */
-                        for (j = i; j < jugador->mano.numCartas - 1; j++) {
-                            jugador->mano.cartas[j] = jugador->mano.cartas[j+1];
-                        }
-                        jugador->mano.numCartas--;
-                        
-                        return true;
-                    }
-                }
-            }
-            
-            /* Verificar si tiene una carta que pueda añadir al final (valor + 1) */
-            if (valorMaximo < 13) {  /* No se puede añadir después del Rey (13) */
-                for (i = 0; i < jugador->mano.numCartas; i++) {
-                    carta = &jugador->mano.cartas[i];
-                    if (!carta->esComodin && carta->palo == paloEscalera && carta->valor == valorMaximo + 1) {
-                        /* Añadir la carta al final de la escalera */
-                        if (escalera->numCartas >= escalera->capacidad) {
-                            /* Ampliar capacidad si es necesario */
-                            nuevaCapacidad = escalera->capacidad == 0 ? 13 : escalera->capacidad * 2;
-                            escalera->cartas = realloc(escalera->cartas, nuevaCapacidad * sizeof(Carta));
-                            
-                            if (escalera->cartas == NULL) {
-                                printf("Error: No se pudo ampliar la capacidad de la escalera\n");
-                                return false;
-                            }
-                            
-                            escalera->capacidad = nuevaCapacidad;
-                        }
-                        
-                        /* Añadir la nueva carta al final */
-                        escalera->cartas[escalera->numCartas] = *carta;
-                        escalera->numCartas++;
-                        
-                        /* Eliminar la carta de la mano del jugador */
-                        for (j = i; j < jugador->mano.numCartas - 1; j++) {
-                            jugador->mano.cartas[j] = jugador->mano.cartas[j+1];
-                        }
-                        jugador->mano.numCartas--;
-                        
-                        return true;
-                    }
-                }
-            }
-            
-            /* Verificar si tiene un comodín */
-            for (i = 0; i < jugador->mano.numCartas; i++) {
-                if (jugador->mano.cartas[i].esComodin) {
-                    /* Añadir el comodín al final de la escalera */
-                    if (escalera->numCartas >= escalera->capacidad) {
-                        /* Ampliar capacidad si es necesario */
-                        nuevaCapacidad = escalera->capacidad == 0 ? 13 : escalera->capacidad * 2;
-                        escalera->cartas = realloc(escalera->cartas, nuevaCapacidad * sizeof(Carta));
-                        
-                        if (escalera->cartas == NULL) {
-                            printf("Error: No se pudo ampliar la capacidad de la escalera\n");
-                            return false;
-                        }
-                        
-                        escalera->capacidad = nuevaCapacidad;
-                    }
-                    
-                    /* Añadir el comodín al final (podría ser al principio también) */
-                    escalera->cartas[escalera->numCartas] = jugador->mano.cartas[i];
-                    escalera->numCartas++;
-                    
-                    /* Eliminar el comodín de la mano del jugador */
-                    for (j = i; j < jugador->mano.numCartas - 1; j++) {
-                        jugador->mano.cartas[j] = jugador->mano.cartas[j+1];
-                    }
-                    jugador->mano.numCartas--;
-                    
-                    return true;
-                }
+        if (indice >= 0 && ampliarEscalera(escalera)) {
+            /* Desplazar todas las cartas una posición y añadirla al principio */
+            for (int j = escalera->numCartas; j > 0; j--) {
+                escalera->cartas[j] = escalera->cartas[j-1];
             }
+            escalera->cartas[0] = quitarCartaMazoRapido(mano, indice);
+            escalera->numCartas++;
+            return true;
+        }
+    }
+    
+    /* Carta que puede ir al final (valor + 1) */
+    if (valorMaximo < 13 && tieneValorPaloMazo(mano, palo, valorMaximo + 1)) {
+        Carta carta = {valorMaximo + 1, escalera->palo, false};
+        indice = buscarCartaMazo(mano, carta);
+        
+        if (indice >= 0 && ampliarEscalera(escalera)) {
+            escalera->cartas[escalera->numCartas] = quitarCartaMazoRapido(mano, indice);
+            escalera->numCartas++;
+            return true;
         }
     }
     
+    /* Comodín al final (podría ser al principio también) */
+    indice = buscarCartaMazo(mano, comodin);
+    if (indice >= 0 && ampliarEscalera(escalera)) {
+        escalera->cartas[escalera->numCartas] = quitarCartaMazoRapido(mano, indice);
+        escalera->numCartas++;
+        return true;
+    }
+    
     return false;  /* No se pudo realizar ninguna jugada */
 }
 
-/* Crear una nueva apeada a partir de las cartas del jugador */
-Apeada* crearApeada(Jugador *jugador) {
-    int i, j, k;
-    Carta grupoTemp[4];
-    int numCartasGrupo;
-    int indiceMano[4];
-    int indiceComodin;
-    int indiceReal;
-    Apeada *nuevaApeada;
-    Carta escaleraTemp[13];
-    int numCartasEscalera;
-    int indicesMano[13];
-    int inicioEscalera, finEscalera;
-    int longitudEscalera;
-    int indicesAEliminar[13];
-    int temp;
-    int huecos;
-    int comodinesDisponibles;
-    int indicesComodines[4];
-    int longitudFinal;
-    int indiceEscalera;
-    int comodinesUsados;
-    int huecoActual;
-    int indice;
-    bool paloRepetido = false;
+/* Posición de una carta igual a la dada que no esté ya marcada en usadas, o -1 */
+static int buscarCartaLibre(const Mazo *mano, Carta carta, const bool *usadas) {
+    int indice = buscarCartaMazo(mano, carta);
     
-    /* Esta función crea una nueva apeada a partir de las cartas del jugador */
+    if (indice < 0) {
+        return -1;
+    }
+    
+    for (int i = indice; i < mano->numCartas && i < MAX_CARTAS_MAZO; i++) {
+        const Carta *actual = &mano->cartas[i];
+        bool igual = carta.esComodin ? actual->esComodin
+                                     : (!actual->esComodin && actual->valor == carta.valor && actual->palo == carta.palo);
+        if (igual && !usadas[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Crear las apeadas de la mejor partición de la mano del jugador.
+ * Antes de la primera apeada se buscan los puntos (y deben ser 30 o más);
+ * después, deshacerse del mayor número de cartas. Devuelve un arreglo de
+ * *numApeadas apeadas (o NULL) y quita sus cartas de la mano */
+Apeada* crearApeadas(Jugador *jugador, int *numApeadas) {
+    ParticionMano particion;
+    
+    *numApeadas = 0;
+    
+    ObjetivoParticion objetivo = jugador->primeraApeada ? OBJ_MAX_CARTAS : OBJ_MAX_PUNTOS;
+    if (!resolverParticionFirma(&jugador->mano.resumen.firma, objetivo, &particion)) {
+        return NULL;  /* No hay ninguna apeada posible */
+    }
     
     /* Verificar si el jugador puede apearse */
-    if (!jugador->primeraApeada && !puedeApearse(jugador)) {
+    if (!jugador->primeraApeada && particion.puntos < 30) {
         return NULL;  /* No puede apearse por primera vez (menos de 30 puntos) */
     }
     
-    /* Buscar grupos (ternas o cuaternas) */
-    for (i = 1; i <= 13; i++) {  /* Valores del 1 al 13 */
-        /* Buscar cartas del mismo valor */
-        numCartasGrupo = 0;
+    return crearApeadasDeParticion(jugador, &particion, numApeadas);
+}
+
+/* Crear las apeadas de todas las jugadas de una partición de la mano y quitar
+ * sus cartas. Devuelve un arreglo de *numApeadas apeadas (o NULL) en la
+ * arena del turno, que deja de valer al pasar el turno */
+Apeada* crearApeadasDeParticion(Jugador *jugador, const ParticionMano *particion, int *numApeadas) {
+    Apeada *nuevasApeadas;
+    bool usadas[MAX_CARTAS_MAZO] = {false};
+    int indices[MAX_CARTAS_MAZO];
+    int numIndices = 0;
+    int i, j;
+    
+    *numApeadas = 0;
+    
+    if (particion->numJugadas <= 0) {
+        return NULL;
+    }
+    
+    /* Las apeadas viven en la arena del turno hasta que pasan a la mesa */
+    nuevasApeadas = apeadasTemporales(particion->numJugadas);
+    if (nuevasApeadas == NULL) {
+        printf("Error: No se pudo asignar memoria para las apeadas\n");
+        return NULL;
+    }
+    
+    for (i = 0; i < particion->numJugadas; i++) {
+        const JugadaParticion *jugada = &particion->jugadas[i];
+        Apeada *apeada = &nuevasApeadas[*numApeadas];
         
-        for (j = 0; j < jugador->mano.numCartas && numCartasGrupo < 4; j++) {
-            if (!jugador->mano.cartas[j].esComodin && jugador->mano.cartas[j].valor == i) {
-                /* Verificar que no haya dos cartas del mismo palo */
-                paloRepetido = false;
-                for (k = 0; k < numCartasGrupo; k++) {
-                    if (grupoTemp[k].palo == jugador->mano.cartas[j].palo) {
-                        paloRepetido = true;
-                        break;
-                    }
-                }
-                
-                if (!paloRepetido) {
-                    grupoTemp[numCartasGrupo] = jugador->mano.cartas[j];
-                    indiceMano[numCartasGrupo] = j;
-                    numCartasGrupo++;
-                }
-            }
-        }
+        apeada->esGrupo = jugada->esGrupo;
+        apeada->puntos = jugada->puntos;
+        apeada->idJugador = jugador->id;
         
-        /* Si encontramos 3 o 4 cartas, podemos formar un grupo válido */
-        if (numCartasGrupo >= 3) {
-            nuevaApeada = (Apeada*)malloc(sizeof(Apeada));
-            if (nuevaApeada == NULL) {
-                printf("Error: No se pudo asignar memoria para la apeada\n");
-                return NULL;
-            }
-            
-            nuevaApeada->esGrupo = true;
-            nuevaApeada->jugada.grupo.numCartas = numCartasGrupo;
-            nuevaApeada->idJugador = jugador->id;
-            
-            /* Copiar las cartas al grupo */
-            for (j = 0; j < numCartasGrupo; j++) {
-                nuevaApeada->jugada.grupo.cartas[j] = grupoTemp[j];
-            }
-            
-            /* Calcular puntos */
-            nuevaApeada->puntos = 0;
-            for (j = 0; j < numCartasGrupo; j++) {
-                if (grupoTemp[j].valor >= 11) {  /* J, Q, K */
-                    nuevaApeada->puntos += 10;
-                } else if (grupoTemp[j].valor == 1) {  /* As */
-                    nuevaApeada->puntos += 15;
-                } else {
-                    nuevaApeada->puntos += grupoTemp[j].valor;
-                }
-            }
-            
-            /* Eliminar las cartas de la mano del jugador (de atrás hacia adelante) */
-            for (j = numCartasGrupo - 1; j >= 0; j--) {
-                for (k = indiceMano[j]; k < jugador->mano.numCartas - 1; k++) {
-                    jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                }
-                jugador->mano.numCartas--;
-            }
-            
-            /* Actualizar BCP */
-            if (jugador->bcp != NULL) {
-                jugador->bcp->vecesApeo++;
-                actualizarBCPJugador(jugador);
+        if (jugada->esGrupo) {
+            apeada->jugada.grupo.numCartas = jugada->numCartas;
+            memcpy(apeada->jugada.grupo.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+        } else {
+            if (jugada->numCartas > MAX_CARTAS_ESCALERA) {
+                continue;  /* Las cartas de esta jugada se quedan en la mano */
             }
-            
-            return nuevaApeada;
+            memcpy(apeada->jugada.escalera.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+            apeada->jugada.escalera.numCartas = jugada->numCartas;
+            apeada->jugada.escalera.palo = jugada->palo;
         }
         
-        /* Intentar formar una terna con 2 cartas + 1 comodín */
-        if (numCartasGrupo == 2) {
-            /* Buscar un comodín */
-            indiceComodin = -1;
-            for (j = 0; j < jugador->mano.numCartas; j++) {
-                if (jugador->mano.cartas[j].esComodin) {
-                    indiceComodin = j;
-                    break;
-                }
-            }
-            
-            if (indiceComodin != -1) {
-                nuevaApeada = (Apeada*)malloc(sizeof(Apeada));
-                if (nuevaApeada == NULL) {
-                    printf("Error: No se pudo asignar memoria para la apeada\n");
-                    return NULL;
-                }
-                
-                nuevaApeada->esGrupo = true;
-                nuevaApeada->jugada.grupo.numCartas = 3;
-                nuevaApeada->idJugador = jugador->id;
-                
-                /* Copiar las 2 cartas normales */
-                for (j = 0; j < 2; j++) {
-                    nuevaApeada->jugada.grupo.cartas[j] = grupoTemp[j];
-                }
-                
-                /* Añadir el comodín */
-                nuevaApeada->jugada.grupo.cartas[2] = jugador->mano.cartas[indiceComodin];
-                
-                /* Calcular puntos */
-                nuevaApeada->puntos = 0;
-                for (j = 0; j < 2; j++) {
-                    if (grupoTemp[j].valor >= 11) {  /* J, Q, K */
-                        nuevaApeada->puntos += 10;
-                    } else if (grupoTemp[j].valor == 1) {  /* As */
-                        nuevaApeada->puntos += 15;
-                    } else {
-                        nuevaApeada->puntos += grupoTemp[j].valor;
-                    }
-                }
-                nuevaApeada->puntos += 20;  /* Valor del comodín */
-                
-                /* Eliminar las cartas de la mano del jugador (de atrás hacia adelante) */
-                /* Primero el comodín */
-                for (k = indiceComodin; k < jugador->mano.numCartas - 1; k++) {
-                    jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                }
-                jugador->mano.numCartas--;
-                
-                /* Luego las cartas normales (de atrás hacia adelante) */
-                for (j = 1; j >= 0; j--) {
-                    /* Ajustar el índice si el comodín estaba antes */
-                    indiceReal = indiceMano[j];
-                    if (indiceComodin < indiceReal) {
-                        indiceReal--;
-                    }
-                    
-                    for (k = indiceReal; k < jugador->mano.numCartas - 1; k++) {
-                        jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                    }
-                    jugador->mano.numCartas--;
-                }
-                
-                /* Actualizar BCP */
-                if (jugador->bcp != NULL) {
-                    jugador->bcp->vecesApeo++;
-                    actualizarBCPJugador(jugador);
-                }
-                
-                return nuevaApeada;
+        /* Marcar las cartas de la mano que se van a quitar */
+        for (j = 0; j < jugada->numCartas; j++) {
+            int indice = buscarCartaLibre(&jugador->mano, jugada->cartas[j], usadas);
+            if (indice >= 0) {
+                usadas[indice] = true;
+                indices[numIndices++] = indice;
             }
         }
+        (*numApeadas)++;
+    }
+    
+    /* Quitar todas las cartas de una vez, con una sola compactación */
+    quitarCartasMazo(&jugador->mano, indices, numIndices, NULL);
+    
+    if (*numApeadas == 0) {
+        return NULL;
     }
     
-    /* Buscar escaleras (tres o más cartas consecutivas del mismo palo) */
-    for (char palo = 'C'; palo <= 'T'; palo++) {
-        /* Seleccionar cartas del mismo palo */
-        numCartasEscalera = 0;
+    /* Actualizar BCP */
+    if (jugador->bcp != NULL) {
+        jugador->bcp->vecesApeo += *numApeadas;
+        actualizarBCPJugador(jugador);
+    }
+    
+    return nuevasApeadas;
+}
+
+/* Rehacer toda la mesa con cartas de la mano (ver reacomodo.h). Devuelve
+ * las *numNuevas apeadas que sustituyen a las de la mesa, en la arena del
+ * turno, y quita de la mano las cartas que pasan a ellas; NULL si no hay un
+ * reacomodo que baje alguna carta. mesa es la de la transacción del turno */
+Apeada* crearApeadasDeReacomodo(Jugador *jugador, const TablaApeadas *mesa, int *numNuevas) {
+    Reacomodo *reacomodo;
+    Apeada *nuevasApeadas;
+    bool usadas[MAX_CARTAS_MAZO] = {false};
+    int indices[MAX_CARTAS_MAZO];
+    int numIndices = 0;
+    int i;
+    
+    *numNuevas = 0;
+    
+    /* El resultado es grande para la pila de un hilo de jugador */
+    reacomodo = (Reacomodo*)reservarArena(sizeof(Reacomodo));
+    if (reacomodo == NULL ||
+        !buscarReacomodo(mesa, &jugador->mano, TIEMPO_REACOMODO_MS, 1, reacomodo)) {
+        return NULL;
+    }
+    
+    nuevasApeadas = apeadasTemporales(reacomodo->numJugadas);
+    if (nuevasApeadas == NULL) {
+        printf("Error: No se pudo asignar memoria para las apeadas\n");
+        return NULL;
+    }
+    
+    for (i = 0; i < reacomodo->numJugadas; i++) {
+        const JugadaParticion *jugada = &reacomodo->jugadas[i];
+        Apeada *apeada = &nuevasApeadas[i];
         
-        for (j = 0; j < jugador->mano.numCartas; j++) {
-            if (!jugador->mano.cartas[j].esComodin && jugador->mano.cartas[j].palo == palo) {
-                escaleraTemp[numCartasEscalera] = jugador->mano.cartas[j];
-                indicesMano[numCartasEscalera] = j;
-                numCartasEscalera++;
-            }
-        }
+        memset(apeada, 0, sizeof(Apeada));
+        apeada->esGrupo = jugada->esGrupo;
+        apeada->puntos = jugada->puntos;
+        apeada->idJugador = jugador->id;
         
-        /* Ordenar por valor */
-        for (i = 0; i < numCartasEscalera - 1; i++) {
-            for (j = 0; j < numCartasEscalera - i - 1; j++) {
-                if (escaleraTemp[j].valor > escaleraTemp[j+1].valor) {
-                    /* Intercambiar cartas */
-                    Carta tempCarta = escaleraTemp[j];
-                    escaleraTemp[j] = escaleraTemp[j+1];
-                    escaleraTemp[j+1] = tempCarta;
-                    
-                    /* Intercambiar índices */
-                    int tempIndice = indicesMano[j];
-                    indicesMano[j] = indicesMano[j+1];
-                    indicesMano[j+1] = tempIndice;
-                }
-            }
+        if (jugada->esGrupo) {
+            apeada->jugada.grupo.numCartas = jugada->numCartas;
+            memcpy(apeada->jugada.grupo.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+        } else {
+            memcpy(apeada->jugada.escalera.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+            apeada->jugada.escalera.numCartas = jugada->numCartas;
+            apeada->jugada.escalera.palo = jugada->palo;
         }
         
-        /* Buscar secuencias */
-        inicioEscalera = 0;
-        while (inicioEscalera < numCartasEscalera) {
-            finEscalera = inicioEscalera;
-            
-            /* Encontrar el final de la secuencia */
-            while (finEscalera + 1 < numCartasEscalera && 
-                   escaleraTemp[finEscalera + 1].valor == escaleraTemp[finEscalera].valor + 1) {
-                finEscalera++;
-            }
-            
-            /* Verificar si es una escalera válida (3 o más cartas) */
-            longitudEscalera = finEscalera - inicioEscalera + 1;
-            
-            /* Si la escalera tiene al menos 3 cartas, es válida */
-            if (longitudEscalera >= 3) {
-                nuevaApeada = (Apeada*)malloc(sizeof(Apeada));
-                if (nuevaApeada == NULL) {
-                    printf("Error: No se pudo asignar memoria para la apeada\n");
-                    return NULL;
-                }
-                
-                nuevaApeada->esGrupo = false;
-                nuevaApeada->idJugador = jugador->id;
-                
-                /* Crear la escalera */
-                nuevaApeada->jugada.escalera.capacidad = longitudEscalera;
-                nuevaApeada->jugada.escalera.numCartas = longitudEscalera;
-                nuevaApeada->jugada.escalera.palo = palo;
-                nuevaApeada->jugada.escalera.cartas = (Carta*)malloc(longitudEscalera * sizeof(Carta));
-                
-                if (nuevaApeada->jugada.escalera.cartas == NULL) {
-                    printf("Error: No se pudo asignar memoria para las cartas de la escalera\n");
-                    free(nuevaApeada);
+        /* La mesa se sustituye entera: una sola apeada inválida anula el reacomodo */
+        if (!validarApeada(apeada)) {
+            return NULL;
+        }
+    }
+    
+    /* Marcar las cartas de la mano que pasan a la mesa */
+    for (int p = 0; p < NUM_PALOS; p++) {
+        for (int v = 0; v < NUM_VALORES; v++) {
+            Carta carta = {v + 1, palosParticion[p], false};
+            for (int c = 0; c < reacomodo->deMano.conteo[p][v]; c++) {
+                int indice = buscarCartaLibre(&jugador->mano, carta, usadas);
+                if (indice < 0) {
                     return NULL;
                 }
-                
-                /* Copiar las cartas a la escalera */
-                for (j = 0; j < longitudEscalera; j++) {
-                    nuevaApeada->jugada.escalera.cartas[j] = escaleraTemp[inicioEscalera + j];
-                }
-                
-                /* Calcular puntos */
-                nuevaApeada->puntos = 0;
-                for (j = 0; j < longitudEscalera; j++) {
-                    if (escaleraTemp[inicioEscalera + j].valor >= 11) {  /* J, Q, K */
-                        nuevaApeada->puntos += 10;
-                    } else if (escaleraTemp[inicioEscalera + j].valor == 1) {  /* As */
-                        nuevaApeada->puntos += 15;
-                    } else {
-                        nuevaApeada->puntos += escaleraTemp[inicioEscalera + j].valor;
-                    }
-                }
-                
-                /* Eliminar las cartas de la mano del jugador (de atrás hacia adelante) */
-                for (j = 0; j < longitudEscalera; j++) {
-                    indicesAEliminar[j] = indicesMano[inicioEscalera + j];
-                }
-                
-                /* Ordenar índices de mayor a menor para eliminar correctamente */
-                for (i = 0; i < longitudEscalera - 1; i++) {
-                    for (j = 0; j < longitudEscalera - i - 1; j++) {
-                        if (indicesAEliminar[j] < indicesAEliminar[j+1]) {
-                            temp = indicesAEliminar[j];
-                            indicesAEliminar[j] = indicesAEliminar[j+1];
-                            indicesAEliminar[j+1] = temp;
-                        }
-                    }
-                }
-                
-                /* Eliminar las cartas */
-                for (j = 0; j < longitudEscalera; j++) {
-                    indice = indicesAEliminar[j];
-                    for (k = indice; k < jugador->mano.numCartas - 1; k++) {
-                        jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                    }
-                    jugador->mano.numCartas--;
-                }
-                
-                /* Actualizar BCP */
-                if (jugador->bcp != NULL) {
-                    jugador->bcp->vecesApeo++;
-                    actualizarBCPJugador(jugador);
-                }
-                
-                return nuevaApeada;
+                usadas[indice] = true;
+                indices[numIndices++] = indice;
             }
-            
-            /* Intentar completar la escalera con comodines */
-            huecos = 0;
-            
-            /* Calcular huecos entre cartas */
-            for (j = inicioEscalera; j < finEscalera; j++) {
-                huecos += escaleraTemp[j+1].valor - escaleraTemp[j].valor - 1;
-            }
-            
-            /* Verificar si hay comodines disponibles para llenar los huecos */
-            comodinesDisponibles = 0;
-            
-            for (j = 0; j < jugador->mano.numCartas; j++) {
-                if (jugador->mano.cartas[j].esComodin && comodinesDisponibles < 4) {
-                    indicesComodines[comodinesDisponibles] = j;
-                    comodinesDisponibles++;
-                }
-            }
-            
-            /* Si tenemos suficientes comodines para hacer una escalera válida */
-            if (longitudEscalera + comodinesDisponibles >= 3 && huecos <= comodinesDisponibles) {
-                longitudFinal = longitudEscalera + huecos;
-                
-                nuevaApeada = (Apeada*)malloc(sizeof(Apeada));
-                if (nuevaApeada == NULL) {
-                    printf("Error: No se pudo asignar memoria para la apeada\n");
-                    return NULL;
-                }
-                
-                nuevaApeada->esGrupo = false;
-                nuevaApeada->idJugador = jugador->id;
-                
-                /* Crear la escalera */
-                nuevaApeada->jugada.escalera.capacidad = longitudFinal;
-                nuevaApeada->jugada.escalera.numCartas = longitudFinal;
-                nuevaApeada->jugada.escalera.palo = palo;
-                nuevaApeada->jugada.escalera.cartas = (Carta*)malloc(longitudFinal * sizeof(Carta));
-                
-                // Al liberar memoria, siempre verifica y establece a NULL
-                if (nuevaApeada != NULL) {
-                    free(nuevaApeada);
-                    nuevaApeada = NULL;
-                }
+        }
+    }
+    for (int c = 0; c < reacomodo->deMano.comodines; c++) {
+        Carta comodin = {0, 'J', true};
+        int indice = buscarCartaLibre(&jugador->mano, comodin, usadas);
+        if (indice < 0) {
+            return NULL;
+        }
+        usadas[indice] = true;
+        indices[numIndices++] = indice;
+    }
+    
+    quitarCartasMazo(&jugador->mano, indices, numIndices, NULL);
+    *numNuevas = reacomodo->numJugadas;
+    
+    if (jugador->bcp != NULL) {
+        jugador->bcp->vecesApeo++;
+        actualizarBCPJugador(jugador);
+    }
+    
+    return nuevasApeadas;
+}
 
-                if (nuevaApeada != NULL && nuevaApeada->jugada.escalera.cartas == NULL) {
-                    if (nuevaApeada->jugada.escalera.cartas != NULL) {
-                        free(nuevaApeada->jugada.escalera.cartas);
-                    }
-                    free(nuevaApeada);
-                    return NULL;
-                }
-                
-                /* Copiar las cartas a la escalera, insertando comodines donde corresponda */
-                indiceEscalera = 0;
-                comodinesUsados = 0;
-                
-                for (j = inicioEscalera; j <= finEscalera; j++) {
-                    /* Si es la primera carta o la siguiente en secuencia, añadirla directamente */
-                    if (j == inicioEscalera || escaleraTemp[j].valor == escaleraTemp[j-1].valor + 1) {
-                        nuevaApeada->jugada.escalera.cartas[indiceEscalera] = escaleraTemp[j];
-                        indiceEscalera++;
-                    } else {
-                        /* Insertar comodines para llenar los huecos */
-                        huecoActual = escaleraTemp[j].valor - escaleraTemp[j-1].valor - 1;
-                        
-                        for (k = 0; k < huecoActual; k++) {
-                            nuevaApeada->jugada.escalera.cartas[indiceEscalera] = jugador->mano.cartas[indicesComodines[comodinesUsados]];
-                            indiceEscalera++;
-                            comodinesUsados++;
-                        }
-                        
-                        /* Luego añadir la carta actual */
-                        nuevaApeada->jugada.escalera.cartas[indiceEscalera] = escaleraTemp[j];
-                        indiceEscalera++;
-                    }
-                }
-                
-                /* Calcular puntos */
-                nuevaApeada->puntos = 0;
-                for (j = 0; j < longitudEscalera; j++) {
-                    if (escaleraTemp[inicioEscalera + j].valor >= 11) {  /* J, Q, K */
-                        nuevaApeada->puntos += 10;
-                    } else if (escaleraTemp[inicioEscalera + j].valor == 1) {  /* As */
-                        nuevaApeada->puntos += 15;
-                    } else {
-                        nuevaApeada->puntos += escaleraTemp[inicioEscalera + j].valor;
-                    }
-                }
-                nuevaApeada->puntos += comodinesUsados * 20;  /* Valor de los comodines */
-                
-                /* Eliminar los comodines de la mano del jugador (de atrás hacia adelante) */
-                for (j = comodinesUsados - 1; j >= 0; j--) {
-                    indice = indicesComodines[j];
-                    for (k = indice; k < jugador->mano.numCartas - 1; k++) {
-                        jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                    }
-                    jugador->mano.numCartas--;
-                    
-                    /* Ajustar los índices restantes */
-                    for (k = j + 1; k < comodinesUsados; k++) {
-                        if (indicesComodines[k] > indice) {
-                            indicesComodines[k]--;
-                        }
-                    }
-                }
-                
-                /* Eliminar las cartas normales de la mano del jugador (de atrás hacia adelante) */
-                for (j = 0; j < longitudEscalera; j++) {
-                    indicesAEliminar[j] = indicesMano[inicioEscalera + j];
-                }
-                
-                /* Ordenar índices de mayor a menor para eliminar correctamente */
-                for (i = 0; i < longitudEscalera - 1; i++) {
-                    for (j = 0; j < longitudEscalera - i - 1; j++) {
-                        if (indicesAEliminar[j] < indicesAEliminar[j+1]) {
-                            temp = indicesAEliminar[j];
-                            indicesAEliminar[j] = indicesAEliminar[j+1];
-                            indicesAEliminar[j+1] = temp;
-                        }
-                    }
-                }
-                
-                /* Eliminar las cartas, ajustando índices por los comodines ya eliminados */
-                for (j = 0; j < longitudEscalera; j++) {
-                    indice = indicesAEliminar[j];
-                    
-                    /* Ajustar el índice basado en los comodines eliminados */
-                    for (k = 0; k < comodinesUsados; k++) {
-                        if (indicesComodines[k] < indice) {
-                            indice--;
-                        }
-                    }
-                    
-                    for (k = indice; k < jugador->mano.numCartas - 1; k++) {
-                        jugador->mano.cartas[k] = jugador->mano.cartas[k+1];
-                    }
-                    jugador->mano.numCartas--;
-                }
-                
-                /* Actualizar BCP */
-                if (jugador->bcp != NULL) {
-                    jugador->bcp->vecesApeo++;
-                    actualizarBCPJugador(jugador);
-                }
-                
-                return nuevaApeada;
-            }
-            
-            /* Continuar con la siguiente secuencia */
-            inicioEscalera = finEscalera + 1;
+/* Añadir a la mesa de la transacción las apeadas creadas. Si la mesa no
+ * acepta alguna devuelve false: el turno se deshace entero y sus cartas
+ * vuelven a la mano con deshacerTransaccionMesa */
+static bool agregarApeadasJugador(TransaccionMesa *transaccion, Apeada *nuevasApeadas, int numApeadas) {
+    for (int i = 0; i < numApeadas; i++) {
+        if (!agregarApeada(transaccion, &nuevasApeadas[i])) {
+            imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: No se pudo agregar la apeada a la mesa\n");
+            return false;
         }
     }
     
-    return NULL;  /* No se pudo crear ninguna apeada */
+    /* El arreglo es de la arena del turno: las apeadas ya están copiadas en la mesa */
+    return true;
 }
 
 /* Comer una ficha de la banca */
-bool comerFicha(Jugador *jugador, Mazo *banca) {
+bool comerFicha(Jugador *jugador, Banca *banca) {
     char cartaStr[50];
+    Carta carta;
     
-    if (banca->numCartas <= 0) {
+    /* Los arreglos por posición de la mano (usadas, índices) son de
+     * MAX_CARTAS_MAZO: con varias barajas la mano no puede pasar de ahí */
+    if (jugador->mano.numCartas >= MAX_CARTAS_MAZO) {
         return false;
     }
     
-    /* Tomar una carta de la banca */
-    Carta carta = banca->cartas[banca->numCartas - 1];
-    banca->numCartas--;
-    
-    /* Añadir carta a la mano del jugador */
-    if (jugador->mano.numCartas >= jugador->mano.capacidad) {
-        /* Ampliar capacidad si es necesario */
-        int nuevaCapacidad = jugador->mano.capacidad == 0 ? 10 : jugador->mano.capacidad * 2;
-        Carta *nuevasCartas = realloc(jugador->mano.cartas, nuevaCapacidad * sizeof(Carta));
-        
-        if (nuevasCartas == NULL) {
-            /* No se pudo ampliar, devolver la carta a la banca */
-            banca->numCartas++;
-            return false;
-        }
-        
-        jugador->mano.cartas = nuevasCartas;
-        jugador->mano.capacidad = nuevaCapacidad;
+    /* Ampliar la mano antes de robar, así nunca se reserva memoria con
+     * mutexBanca tomado y después ya no hay que devolver la carta */
+    if (!reservarMazo(&jugador->mano, jugador->mano.numCartas + 1)) {
+        return false;
     }
     
-    /* Añadir la carta al mazo del jugador */
-    jugador->mano.cartas[jugador->mano.numCartas] = carta;
-    jugador->mano.numCartas++;
+    /* Tomar una carta de la banca (una sola toma de mutexBanca) */
+    if (robarBanca(banca, &carta, 1) == 0) {
+        return false;
+    }
+    agregarCartaMazo(&jugador->mano, carta);
     
-    obtenerNombreCarta(carta, cartaStr);
-    printf("Jugador %d comió una ficha: %s\n", jugador->id, cartaStr);
+    if (REGISTRO_ACTIVO(REGISTRO_DETALLE)) {
+        obtenerNombreCarta(carta, cartaStr);
+        printf("Jugador %d comió una ficha: %s\n", jugador->id, cartaStr);
+    }
     
     return true;
 }
@@ -1377,12 +925,12 @@ void actualizarEstadoJugador(Jugador *jugador, EstadoJugador nuevoEstado) {
     actualizarBCPJugador(jugador);
     
     /* Actualizar en la tabla de procesos */
-    pthread_mutex_lock(&mutexTabla);
+    BLOQUEAR(&mutexTabla);
     actualizarProcesoEnTabla(jugador->id, nuevoEstado);
-    pthread_mutex_unlock(&mutexTabla);
+    DESBLOQUEAR(&mutexTabla);
     
     /* Mostrar cambio de estado */
-    printf("Jugador %d cambió a estado: %s\n", jugador->id, estados[nuevoEstado]);
+    imprimirRegistro(REGISTRO_DETALLE, "Jugador %d cambió a estado: %s\n", jugador->id, estados[nuevoEstado]);
     
     /* Registrar el cambio de estado en el log */
     registrarEvento("Jugador %d cambió de estado: %s -> %s", 
@@ -1393,6 +941,9 @@ void actualizarEstadoJugador(Jugador *jugador, EstadoJugador nuevoEstado) {
 void pasarTurno(Jugador *jugador) {
     jugador->turnoActual = false;
     
+    /* Lo pedido a la arena durante el turno ya no se usa */
+    reiniciarArena();
+    
     /* Cambiar a estado LISTO o ESPERA_ES según corresponda */
     if (jugador->estado != ESPERA_ES) {
         actualizarEstadoJugador(jugador, LISTO);
@@ -1405,9 +956,7 @@ void entrarEsperaES(Jugador *jugador) {
     jugador->tiempoES = (rand() % 5000 + 1000);
     actualizarEstadoJugador(jugador, ESPERA_ES);
     
-    colorMagenta();
-    printf("Jugador %d entró en E/S por %d ms\n", jugador->id, jugador->tiempoES);
-    colorReset();
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_MAGENTA, "Jugador %d entró en E/S por %d ms\n", jugador->id, jugador->tiempoES);
     
     /* Registrar evento de E/S */
     registrarEvento("Jugador %d entró en E/S por %d ms", jugador->id, jugador->tiempoES);
@@ -1420,13 +969,9 @@ void entrarEsperaES(Jugador *jugador) {
     
     /* NUEVO: Asignar memoria para este proceso en E/S */
     if (asignarMemoriaES(jugador->id)) {
-        colorVerde();
-        printf("Jugador %d: Memoria asignada para operación E/S\n", jugador->id);
-        colorReset();
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Jugador %d: Memoria asignada para operación E/S\n", jugador->id);
     } else {
-        colorRojo();
-        printf("Jugador %d: Error al asignar memoria para operación E/S\n", jugador->id);
-        colorReset();
+        imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Jugador %d: Error al asignar memoria para operación E/S\n", jugador->id);
     }
     
     /* NUEVO: Simular accesos a páginas */
@@ -1445,9 +990,7 @@ void salirEsperaES(Jugador *jugador) {
     jugador->tiempoES = 0;
     actualizarEstadoJugador(jugador, LISTO);
     
-    colorMagenta();
-    printf("Jugador %d salió de E/S\n", jugador->id);
-    colorReset();
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_MAGENTA, "Jugador %d salió de E/S\n", jugador->id);
     
     /* Registrar evento */
     registrarEvento("Jugador %d salió de E/S", jugador->id);
@@ -1459,7 +1002,7 @@ void salirEsperaES(Jugador *jugador) {
     }
     
     /* NUEVO: Liberar la memoria que se asignó para la operación E/S */
-    liberarMemoria(jugador->id);
+    liberarMemoriaES(jugador->id);
 }
 
 /* Actualizar el BCP del jugador */
@@ -1480,10 +1023,7 @@ void actualizarBCPJugador(Jugador *jugador) {
 
 /* Liberar recursos del jugador */
 void liberarJugador(Jugador *jugador) {
-    if (jugador->mano.cartas != NULL) {
-        free(jugador->mano.cartas);
-        jugador->mano.cartas = NULL;
-    }
+    liberarMazo(&jugador->mano);
     
     if (jugador->bcp != NULL) {
         liberarBCP(jugador->bcp);
@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <stdint.h>
 #include "procesos.h"
 
 /* Estructura de una carta/ficha */
@@ -19,11 +20,13 @@ typedef struct {
     int numCartas;       /* Número de cartas en el grupo */
 } Grupo;
 
-/* Estructura para una escalera */
+#define MAX_CARTAS_ESCALERA 13   /* Del As al Rey */
+
+/* Estructura para una escalera. Las cartas van dentro de la apeada, así que
+ * copiar una apeada (a la mesa, a una instantánea) copia también sus cartas */
 typedef struct {
-    Carta *cartas;       /* Arreglo dinámico de cartas */
+    Carta cartas[MAX_CARTAS_ESCALERA];
     int numCartas;       /* Número de cartas en la escalera */
-    int capacidad;       /* Capacidad actual del arreglo */
     char palo;           /* El palo de la escalera */
 } Escalera;
 
@@ -38,11 +41,35 @@ typedef struct {
     int idJugador;       /* ID del jugador que realizó la jugada */
 } Apeada;
 
+#define NUM_PALOS   4    /* C, D, T, E */
+#define NUM_VALORES 13   /* As a Rey */
+
+/* Firma de un conjunto de cartas: copias de cada palo y valor, y comodines */
+typedef struct {
+    uint8_t conteo[NUM_PALOS][NUM_VALORES];
+    uint8_t comodines;
+} FirmaMano;
+
+/* Datos derivados de un mazo. Las funciones de mazo.c los actualizan en O(1)
+ * con cada carta que entra o sale, así que no hace falta recorrer el mazo */
+typedef struct {
+    FirmaMano firma;                   /* Copias por palo y valor, y comodines */
+    uint8_t conteoValor[NUM_VALORES];  /* Copias de cada valor en cualquier palo */
+    uint16_t mascaraPalo[NUM_PALOS];   /* Bit v-1 activo si hay algún v de ese palo */
+    int puntos;                        /* Suma de calcularPuntosCarta del mazo */
+    int mejorApertura;                 /* Puntos de la mejor partición (-1 = por calcular) */
+    uint64_t hash;                     /* Zobrist de las cartas (ver zobrist.h) */
+} ResumenMazo;
+
+#define CAPACIDAD_EN_LINEA_MAZO 64   /* Cartas que caben sin pedir memoria */
+
 /* Estructura para el mazo de cartas de un jugador */
 typedef struct {
-    Carta *cartas;       /* Arreglo dinámico de cartas */
+    Carta *cartas;       /* enLinea, o memoria dinámica si no cupo (ver mazo.h) */
     int numCartas;       /* Número actual de cartas */
-    int capacidad;       /* Capacidad actual del arreglo dinámico */
+    int capacidad;       /* Capacidad actual del arreglo */
+    ResumenMazo resumen; /* Agregados de las cartas (ver mazo.h) */
+    Carta enLinea[CAPACIDAD_EN_LINEA_MAZO];
 } Mazo;
 
 /* Definición de estados de los jugadores */
@@ -56,6 +83,12 @@ typedef enum {
 /* Declaración adelantada de BCP para evitar dependencias circulares */
 struct BCP;
 
+/* Declaraciones adelantadas de estrategia.h, particion.h, tablaapeadas.h y banca.h */
+struct Estrategia;
+struct ParticionMano;
+struct TablaApeadas;
+struct Banca;
+
 /* Estructura principal del jugador */
 typedef struct {
     int id;                  /* ID único del jugador */
@@ -70,28 +103,45 @@ typedef struct {
     BCP *bcp;        /* Bloque de Control de Proceso asociado */
     int puntosTotal;         /* Puntos totales acumulados */
     bool terminado;          /* Indica si el jugador ha terminado sus cartas */
+    unsigned int secuenciaMano; /* Seqlock de la mano (impar mientras se modifica) */
+    const struct Estrategia *estrategia; /* Decisiones de juego (ver estrategia.h) */
 } Jugador;
 
+/* Seqlock de la mano: solo el hilo del jugador la modifica, y los lectores
+ * (instantáneas) reintentan la copia si la secuencia era impar o cambió */
+static inline void iniciarEscrituraMano(Jugador *jugador) {
+    __atomic_store_n(&jugador->secuenciaMano, jugador->secuenciaMano + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void finalizarEscrituraMano(Jugador *jugador) {
+    __atomic_store_n(&jugador->secuenciaMano, jugador->secuenciaMano + 1, __ATOMIC_RELEASE);
+}
+
 /* Declaraciones de funciones externas */
 bool juegoTerminado(void);
-Apeada* obtenerApeadas(void);
 int obtenerNumApeadas(void);
-Mazo* obtenerBanca(void);
+struct Banca* obtenerBanca(void);
+Jugador* obtenerJugadores(int *cantidad);
 void finalizarJuego(int idJugador);
 
 /* Funciones para manejo de jugadores */
 void inicializarJugador(Jugador *jugador, int id);
 void *funcionHiloJugador(void *arg);
-bool realizarTurno(Jugador *jugador, Apeada *apeadas, int numApeadas, Mazo *banca);
+bool realizarTurno(Jugador *jugador, struct Banca *banca);
 
 /* Funciones para verificar y realizar jugadas */
 bool verificarApeada(Jugador *jugador, Apeada *apeada);
+bool verificarApeadaSinComodin(Jugador *jugador, Apeada *apeada);
 bool puedeApearse(Jugador *jugador);
+bool evaluarApertura(const Carta *mano, int numCartas);
 bool realizarJugadaApeada(Jugador *jugador, Apeada *apeada);
-Apeada* crearApeada(Jugador *jugador);
+Apeada* crearApeadas(Jugador *jugador, int *numApeadas);
+Apeada* crearApeadasDeParticion(Jugador *jugador, const struct ParticionMano *particion, int *numApeadas);
+Apeada* crearApeadasDeReacomodo(Jugador *jugador, const struct TablaApeadas *mesa, int *numNuevas);
 
 /* Funciones para operaciones básicas */
-bool comerFicha(Jugador *jugador, Mazo *banca);
+bool comerFicha(Jugador *jugador, struct Banca *banca);
 void actualizarEstadoJugador(Jugador *jugador, EstadoJugador nuevoEstado);
 void pasarTurno(Jugador *jugador);
 void entrarEsperaES(Jugador *jugador);
@@ -102,7 +152,6 @@ void liberarJugador(Jugador *jugador);
 void actualizarBCPJugador(Jugador *jugador);
 
 /* Mutex externos */
-extern pthread_mutex_t mutexApeadas;
 extern pthread_mutex_t mutexBanca;
 extern pthread_mutex_t mutexTabla;
 
@@ -0,0 +1,503 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lotemanos.h"
+#include "particion.h"
+#include "mazo.h"
+#include "mesa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOTE_X86 1
+#endif
+
+#define ALINEACION_LOTE 32
+#define PUNTOS_COMODIN  20
+#define PUNTOS_APERTURA 30
+
+/* Puntos de una carta natural por valor, igual que calcularPuntosCarta */
+static const int16_t puntosValor[NUM_VALORES] = {15, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+
+static const char *nombresImplementacion[NUM_IMPLEMENTACIONES_LOTE] = {"escalar", "sse4.1", "avx2"};
+
+bool crearLoteManos(LoteManos *lote, int numManos) {
+    int capacidad = (numManos + ANCHO_LOTE - 1) / ANCHO_LOTE * ANCHO_LOTE;
+    int carriles16 = NUM_PALOS + NUM_VALORES + 1 + 3;  /* Entradas y resultados de 16 bits */
+    size_t bytes = (size_t)capacidad * (carriles16 * sizeof(uint16_t) + sizeof(uint8_t) + sizeof(FirmaMano));
+    unsigned char *memoria;
+
+    memset(lote, 0, sizeof(LoteManos));
+    if (numManos <= 0) {
+        printf("Error: Un lote necesita al menos una mano\n");
+        return false;
+    }
+
+    bytes = (bytes + ALINEACION_LOTE - 1) / ALINEACION_LOTE * ALINEACION_LOTE;
+    memoria = aligned_alloc(ALINEACION_LOTE, bytes);
+    if (memoria == NULL) {
+        printf("Error: No se pudo asignar memoria para el lote de manos\n");
+        return false;
+    }
+    memset(memoria, 0, bytes);
+
+    /* Cada carril ocupa capacidad * 2 bytes, múltiplo de 32: todos quedan alineados */
+    uint16_t *carril = (uint16_t*)memoria;
+    for (int p = 0; p < NUM_PALOS; p++, carril += capacidad) {
+        lote->mascaraPalo[p] = carril;
+    }
+    for (int v = 0; v < NUM_VALORES; v++, carril += capacidad) {
+        lote->conteoValor[v] = carril;
+    }
+    lote->comodines = carril;
+    carril += capacidad;
+    lote->puntos = carril;
+    carril += capacidad;
+    lote->mejorGrupo = carril;
+    carril += capacidad;
+    lote->mejorEscalera = carril;
+    carril += capacidad;
+    lote->firmas = (FirmaMano*)carril;
+    lote->apertura = (uint8_t*)(lote->firmas + capacidad);
+
+    lote->capacidad = capacidad;
+    lote->memoria = memoria;
+    return true;
+}
+
+void liberarLoteManos(LoteManos *lote) {
+    free(lote->memoria);
+    memset(lote, 0, sizeof(LoteManos));
+}
+
+void vaciarLoteManos(LoteManos *lote) {
+    /* Los carriles de relleno deben quedar a cero para los vectores */
+    for (int p = 0; p < NUM_PALOS; p++) {
+        memset(lote->mascaraPalo[p], 0, lote->numManos * sizeof(uint16_t));
+    }
+    for (int v = 0; v < NUM_VALORES; v++) {
+        memset(lote->conteoValor[v], 0, lote->numManos * sizeof(uint16_t));
+    }
+    memset(lote->comodines, 0, lote->numManos * sizeof(uint16_t));
+    lote->numManos = 0;
+    lote->dudosas = 0;
+}
+
+int agregarManoLote(LoteManos *lote, const Mazo *mano) {
+    const ResumenMazo *resumen = &mano->resumen;
+    int i = lote->numManos;
+
+    if (i >= lote->capacidad) {
+        return -1;
+    }
+    for (int p = 0; p < NUM_PALOS; p++) {
+        lote->mascaraPalo[p][i] = resumen->mascaraPalo[p];
+    }
+    for (int v = 0; v < NUM_VALORES; v++) {
+        lote->conteoValor[v][i] = resumen->conteoValor[v];
+    }
+    lote->comodines[i] = resumen->firma.comodines;
+    lote->firmas[i] = resumen->firma;
+    lote->numManos++;
+    return i;
+}
+
+/* --- Criba por carriles ---
+ *
+ * Las tres versiones hacen lo mismo. Para cada valor v: d = palos con v, y
+ * el grupo usa hasta 4 - d comodines (vale si d >= 1 y d + comodines >= 3).
+ * Para cada palo, la escalera natural que acaba en v suma sus puntos
+ * mientras el bit siga activo; vale desde 3 cartas */
+
+static inline uint8_t decidirApertura(int puntos, int grupo, int escalera) {
+    if (grupo >= PUNTOS_APERTURA || escalera >= PUNTOS_APERTURA) {
+        return APERTURA_SI;
+    }
+    return puntos < PUNTOS_APERTURA ? APERTURA_NO : APERTURA_DUDOSA;
+}
+
+static void cribarEscalar(LoteManos *lote) {
+    for (int i = 0; i < lote->numManos; i++) {
+        int comodines = lote->comodines[i];
+        int puntos = comodines * PUNTOS_COMODIN;
+        int grupo = 0;
+        int escalera = 0;
+
+        for (int v = 0; v < NUM_VALORES; v++) {
+            int d = 0;
+            puntos += lote->conteoValor[v][i] * puntosValor[v];
+            for (int p = 0; p < NUM_PALOS; p++) {
+                d += (lote->mascaraPalo[p][i] >> v) & 1;
+            }
+            int usados = comodines < 4 - d ? comodines : 4 - d;
+            if (d >= 1 && d + usados >= 3) {
+                int valor = d * puntosValor[v] + usados * PUNTOS_COMODIN;
+                grupo = valor > grupo ? valor : grupo;
+            }
+        }
+
+        for (int p = 0; p < NUM_PALOS; p++) {
+            int largo = 0, suma = 0;
+            for (int v = 0; v < NUM_VALORES; v++) {
+                if ((lote->mascaraPalo[p][i] >> v) & 1) {
+                    largo++;
+                    suma += puntosValor[v];
+                } else {
+                    largo = 0;
+                    suma = 0;
+                }
+                if (largo >= 3 && suma > escalera) {
+                    escalera = suma;
+                }
+            }
+        }
+
+        lote->puntos[i] = (uint16_t)puntos;
+        lote->mejorGrupo[i] = (uint16_t)grupo;
+        lote->mejorEscalera[i] = (uint16_t)escalera;
+        lote->apertura[i] = decidirApertura(puntos, grupo, escalera);
+    }
+}
+
+#ifdef LOTE_X86
+
+__attribute__((target("sse4.1")))
+static void cribarSse41(LoteManos *lote) {
+    const __m128i uno = _mm_set1_epi16(1);
+    const __m128i dos = _mm_set1_epi16(2);
+    const __m128i cuatro = _mm_set1_epi16(4);
+    const __m128i cero = _mm_setzero_si128();
+    const __m128i puntosComodin = _mm_set1_epi16(PUNTOS_COMODIN);
+    const __m128i apertura = _mm_set1_epi16(PUNTOS_APERTURA - 1);
+
+    for (int i = 0; i < lote->numManos; i += 8) {
+        __m128i mascara[NUM_PALOS];
+        for (int p = 0; p < NUM_PALOS; p++) {
+            mascara[p] = _mm_load_si128((const __m128i*)&lote->mascaraPalo[p][i]);
+        }
+        __m128i comodines = _mm_load_si128((const __m128i*)&lote->comodines[i]);
+        __m128i puntos = _mm_mullo_epi16(comodines, puntosComodin);
+        __m128i grupo = cero;
+        __m128i escalera = cero;
+
+        for (int v = 0; v < NUM_VALORES; v++) {
+            __m128i pv = _mm_set1_epi16(puntosValor[v]);
+            __m128i conteo = _mm_load_si128((const __m128i*)&lote->conteoValor[v][i]);
+            puntos = _mm_add_epi16(puntos, _mm_mullo_epi16(conteo, pv));
+
+            __m128i d = cero;
+            for (int p = 0; p < NUM_PALOS; p++) {
+                d = _mm_add_epi16(d, _mm_and_si128(_mm_srli_epi16(mascara[p], v), uno));
+            }
+            __m128i usados = _mm_min_epi16(comodines, _mm_sub_epi16(cuatro, d));
+            __m128i valido = _mm_and_si128(_mm_cmpgt_epi16(d, cero),
+                                           _mm_cmpgt_epi16(_mm_add_epi16(d, usados), dos));
+            __m128i valor = _mm_add_epi16(_mm_mullo_epi16(d, pv), _mm_mullo_epi16(usados, puntosComodin));
+            grupo = _mm_max_epi16(grupo, _mm_blendv_epi8(cero, valor, valido));
+        }
+
+        for (int p = 0; p < NUM_PALOS; p++) {
+            __m128i largo = cero, suma = cero;
+            for (int v = 0; v < NUM_VALORES; v++) {
+                __m128i activo = _mm_cmpeq_epi16(_mm_and_si128(_mm_srli_epi16(mascara[p], v), uno), uno);
+                largo = _mm_and_si128(activo, _mm_add_epi16(largo, uno));
+                suma = _mm_and_si128(activo, _mm_add_epi16(suma, _mm_set1_epi16(puntosValor[v])));
+                escalera = _mm_max_epi16(escalera, _mm_blendv_epi8(cero, suma, _mm_cmpgt_epi16(largo, dos)));
+            }
+        }
+
+        /* Apertura: SI si grupo o escalera >= 30, NO si puntos < 30, si no DUDOSA */
+        __m128i si = _mm_or_si128(_mm_cmpgt_epi16(grupo, apertura), _mm_cmpgt_epi16(escalera, apertura));
+        __m128i no = _mm_cmpgt_epi16(_mm_set1_epi16(PUNTOS_APERTURA), puntos);
+        __m128i decision = _mm_blendv_epi8(_mm_blendv_epi8(_mm_set1_epi16(APERTURA_DUDOSA), cero, no), uno, si);
+
+        _mm_store_si128((__m128i*)&lote->puntos[i], puntos);
+        _mm_store_si128((__m128i*)&lote->mejorGrupo[i], grupo);
+        _mm_store_si128((__m128i*)&lote->mejorEscalera[i], escalera);
+        _mm_storel_epi64((__m128i*)&lote->apertura[i], _mm_packus_epi16(decision, cero));
+    }
+}
+
+__attribute__((target("avx2")))
+static void cribarAvx2(LoteManos *lote) {
+    const __m256i uno = _mm256_set1_epi16(1);
+    const __m256i dos = _mm256_set1_epi16(2);
+    const __m256i cuatro = _mm256_set1_epi16(4);
+    const __m256i cero = _mm256_setzero_si256();
+    const __m256i puntosComodin = _mm256_set1_epi16(PUNTOS_COMODIN);
+    const __m256i apertura = _mm256_set1_epi16(PUNTOS_APERTURA - 1);
+
+    for (int i = 0; i < lote->numManos; i += 16) {
+        __m256i mascara[NUM_PALOS];
+        for (int p = 0; p < NUM_PALOS; p++) {
+            mascara[p] = _mm256_load_si256((const __m256i*)&lote->mascaraPalo[p][i]);
+        }
+        __m256i comodines = _mm256_load_si256((const __m256i*)&lote->comodines[i]);
+        __m256i puntos = _mm256_mullo_epi16(comodines, puntosComodin);
+        __m256i grupo = cero;
+        __m256i escalera = cero;
+
+        for (int v = 0; v < NUM_VALORES; v++) {
+            __m256i pv = _mm256_set1_epi16(puntosValor[v]);
+            __m256i conteo = _mm256_load_si256((const __m256i*)&lote->conteoValor[v][i]);
+            puntos = _mm256_add_epi16(puntos, _mm256_mullo_epi16(conteo, pv));
+
+            __m256i d = cero;
+            for (int p = 0; p < NUM_PALOS; p++) {
+                d = _mm256_add_epi16(d, _mm256_and_si256(_mm256_srli_epi16(mascara[p], v), uno));
+            }
+            __m256i usados = _mm256_min_epi16(comodines, _mm256_sub_epi16(cuatro, d));
+            __m256i valido = _mm256_and_si256(_mm256_cmpgt_epi16(d, cero),
+                                              _mm256_cmpgt_epi16(_mm256_add_epi16(d, usados), dos));
+            __m256i valor = _mm256_add_epi16(_mm256_mullo_epi16(d, pv), _mm256_mullo_epi16(usados, puntosComodin));
+            grupo = _mm256_max_epi16(grupo, _mm256_and_si256(valor, valido));
+        }
+
+        for (int p = 0; p < NUM_PALOS; p++) {
+            __m256i largo = cero, suma = cero;
+            for (int v = 0; v < NUM_VALORES; v++) {
+                __m256i activo = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_srli_epi16(mascara[p], v), uno), uno);
+                largo = _mm256_and_si256(activo, _mm256_add_epi16(largo, uno));
+                suma = _mm256_and_si256(activo, _mm256_add_epi16(suma, _mm256_set1_epi16(puntosValor[v])));
+                escalera = _mm256_max_epi16(escalera, _mm256_and_si256(suma, _mm256_cmpgt_epi16(largo, dos)));
+            }
+        }
+
+        __m256i si = _mm256_or_si256(_mm256_cmpgt_epi16(grupo, apertura), _mm256_cmpgt_epi16(escalera, apertura));
+        __m256i no = _mm256_cmpgt_epi16(_mm256_set1_epi16(PUNTOS_APERTURA), puntos);
+        __m256i decision = _mm256_blendv_epi8(_mm256_andnot_si256(no, _mm256_set1_epi16(APERTURA_DUDOSA)), uno, si);
+
+        _mm256_store_si256((__m256i*)&lote->puntos[i], puntos);
+        _mm256_store_si256((__m256i*)&lote->mejorGrupo[i], grupo);
+        _mm256_store_si256((__m256i*)&lote->mejorEscalera[i], escalera);
+        /* packus mezcla las mitades de 128 bits; se reordenan antes de guardar */
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(decision, cero), 0xD8);
+        _mm_storeu_si128((__m128i*)&lote->apertura[i], _mm256_castsi256_si128(bytes));
+    }
+}
+
+#endif /* LOTE_X86 */
+
+static bool disponible(ImplementacionLote implementacion) {
+    switch (implementacion) {
+        case LOTE_ESCALAR:
+            return true;
+#ifdef LOTE_X86
+        case LOTE_SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case LOTE_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+ImplementacionLote implementacionLote(void) {
+    static int elegida = -1;    /* Se decide una vez; todos los hilos llegan al mismo valor */
+
+    if (elegida < 0) {
+        int mejor = LOTE_ESCALAR;
+        for (int i = NUM_IMPLEMENTACIONES_LOTE - 1; i > LOTE_ESCALAR; i--) {
+            if (disponible((ImplementacionLote)i)) {
+                mejor = i;
+                break;
+            }
+        }
+        __atomic_store_n(&elegida, mejor, __ATOMIC_RELAXED);
+    }
+    return (ImplementacionLote)__atomic_load_n(&elegida, __ATOMIC_RELAXED);
+}
+
+const char* nombreImplementacionLote(ImplementacionLote implementacion) {
+    if (implementacion < 0 || implementacion >= NUM_IMPLEMENTACIONES_LOTE) {
+        return "?";
+    }
+    return nombresImplementacion[implementacion];
+}
+
+/* Resolver las manos dudosas con la partición exacta */
+static void resolverDudosas(LoteManos *lote) {
+    ParticionMano particion;
+
+    lote->dudosas = 0;
+    for (int i = 0; i < lote->numManos; i++) {
+        if (lote->apertura[i] != APERTURA_DUDOSA) {
+            continue;
+        }
+        lote->dudosas++;
+        bool hay = resolverParticionFirma(&lote->firmas[i], OBJ_MAX_PUNTOS, &particion);
+        lote->apertura[i] = hay && particion.puntos >= PUNTOS_APERTURA ? APERTURA_SI : APERTURA_NO;
+    }
+}
+
+static void cribar(LoteManos *lote, ImplementacionLote implementacion) {
+    switch (implementacion) {
+#ifdef LOTE_X86
+        case LOTE_AVX2:
+            cribarAvx2(lote);
+            break;
+        case LOTE_SSE41:
+            cribarSse41(lote);
+            break;
+#endif
+        default:
+            cribarEscalar(lote);
+            break;
+    }
+}
+
+bool evaluarLoteManosCon(LoteManos *lote, ImplementacionLote implementacion) {
+    if (!disponible(implementacion)) {
+        return false;
+    }
+    cribar(lote, implementacion);
+    resolverDudosas(lote);
+    return true;
+}
+
+void evaluarLoteManos(LoteManos *lote) {
+    evaluarLoteManosCon(lote, implementacionLote());
+}
+
+/* --- Banco de pruebas --- */
+
+#define CARTAS_MANO_BANCO_LOTE  14
+#define REPETICIONES_BANCO_LOTE 20
+
+static double segundosDesde(const struct timespec *inicio) {
+    struct timespec fin;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - inicio->tv_sec) + (fin.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/* Llenar el lote con manos repartidas de mazos completos barajados */
+static bool generarManos(LoteManos *lote, int numManos) {
+    Mazo mazo, mano;
+    unsigned int semilla = 12345;
+
+    inicializarMazo(&mazo);
+    inicializarMazo(&mano);
+    crearMazoCompleto(&mazo);
+
+    for (int m = 0; m < numManos; m++) {
+        /* Fisher-Yates parcial: solo las cartas de la mano */
+        while (mano.numCartas > 0) {
+            quitarCartaMazoRapido(&mano, mano.numCartas - 1);
+        }
+        for (int c = 0; c < CARTAS_MANO_BANCO_LOTE; c++) {
+            int j = c + rand_r(&semilla) % (mazo.numCartas - c);
+            Carta temporal = mazo.cartas[c];
+            mazo.cartas[c] = mazo.cartas[j];
+            mazo.cartas[j] = temporal;
+            agregarCartaMazo(&mano, mazo.cartas[c]);
+        }
+        if (agregarManoLote(lote, &mano) < 0) {
+            liberarMazo(&mazo);
+            liberarMazo(&mano);
+            return false;
+        }
+    }
+
+    liberarMazo(&mazo);
+    liberarMazo(&mano);
+    return true;
+}
+
+bool ejecutarBancoLote(int numManos) {
+    LoteManos lote;
+    uint16_t *referencia;
+    uint8_t *aperturaReferencia;
+    struct timespec inicio;
+
+    if (numManos <= 0) {
+        printf("Número de manos inválido\n");
+        return false;
+    }
+    if (!crearLoteManos(&lote, numManos)) {
+        return false;
+    }
+    referencia = malloc(3 * lote.capacidad * sizeof(uint16_t));
+    aperturaReferencia = malloc(lote.capacidad);
+    if (referencia == NULL || aperturaReferencia == NULL || !generarManos(&lote, numManos)) {
+        printf("Error: No se pudo preparar el banco de manos\n");
+        free(referencia);
+        free(aperturaReferencia);
+        liberarLoteManos(&lote);
+        return false;
+    }
+
+    printf("Banco de manos: %d manos de %d cartas, %d repeticiones, implementación elegida: %s\n",
+           numManos, CARTAS_MANO_BANCO_LOTE, REPETICIONES_BANCO_LOTE,
+           nombreImplementacionLote(implementacionLote()));
+
+    /* Coste por mano del camino de siempre, la partición exacta de cada una;
+     * se mide antes de que la caché de particiones tenga estas manos */
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int i = 0; i < numManos; i++) {
+        ParticionMano particion;
+        resolverParticionFirma(&lote.firmas[i], OBJ_MAX_PUNTOS, &particion);
+    }
+    double segundosExactas = segundosDesde(&inicio);
+
+    /* Referencia: escalar con la partición exacta para las dudosas */
+    cribar(&lote, LOTE_ESCALAR);
+    memcpy(referencia, lote.puntos, numManos * sizeof(uint16_t));
+    memcpy(referencia + lote.capacidad, lote.mejorGrupo, numManos * sizeof(uint16_t));
+    memcpy(referencia + 2 * lote.capacidad, lote.mejorEscalera, numManos * sizeof(uint16_t));
+    int seguras = 0;
+    for (int i = 0; i < numManos; i++) {
+        seguras += lote.apertura[i] != APERTURA_DUDOSA;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    resolverDudosas(&lote);
+    double segundosExacta = segundosDesde(&inicio);
+    memcpy(aperturaReferencia, lote.apertura, numManos);
+
+    /* La criba no puede contradecir a la partición exacta de ninguna mano */
+    int errores = 0;
+    for (int i = 0; i < numManos; i++) {
+        ParticionMano particion;
+        bool hay = resolverParticionFirma(&lote.firmas[i], OBJ_MAX_PUNTOS, &particion);
+        errores += (hay && particion.puntos >= PUNTOS_APERTURA) != (aperturaReferencia[i] == APERTURA_SI);
+    }
+
+    int abren = 0;
+    for (int i = 0; i < numManos; i++) {
+        abren += aperturaReferencia[i] == APERTURA_SI;
+    }
+    printf("Criba: %d manos (%.1f%%) decididas en los carriles, %d abren; %d dudosas resueltas "
+           "con la partición exacta en %.1f ms; %d discrepancias con la partición\n",
+           seguras, 100.0 * seguras / numManos, abren, numManos - seguras, segundosExacta * 1000, errores);
+
+    for (int impl = 0; impl < NUM_IMPLEMENTACIONES_LOTE; impl++) {
+        if (!disponible((ImplementacionLote)impl)) {
+            printf("  %-8s no disponible en esta CPU\n", nombreImplementacionLote(impl));
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        for (int r = 0; r < REPETICIONES_BANCO_LOTE; r++) {
+            cribar(&lote, (ImplementacionLote)impl);
+        }
+        double segundos = segundosDesde(&inicio);
+
+        bool iguales = memcmp(lote.puntos, referencia, numManos * sizeof(uint16_t)) == 0 &&
+                       memcmp(lote.mejorGrupo, referencia + lote.capacidad, numManos * sizeof(uint16_t)) == 0 &&
+                       memcmp(lote.mejorEscalera, referencia + 2 * lote.capacidad, numManos * sizeof(uint16_t)) == 0;
+        resolverDudosas(&lote);
+        iguales = iguales && memcmp(lote.apertura, aperturaReferencia, numManos) == 0;
+
+        printf("  %-8s %12.0f manos/s en la criba, %s\n", nombreImplementacionLote(impl),
+               (double)numManos * REPETICIONES_BANCO_LOTE / segundos,
+               iguales ? "resultados iguales al escalar" : "RESULTADOS DISTINTOS");
+    }
+
+    printf("  %-8s %12.0f manos/s con la partición exacta de cada mano\n", "exacta",
+           numManos / segundosExactas);
+
+    free(referencia);
+    free(aperturaReferencia);
+    liberarLoteManos(&lote);
+    return true;
+}
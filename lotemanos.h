@@ -0,0 +1,83 @@
+#ifndef LOTEMANOS_H
+#define LOTEMANOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "jugadores.h"
+
+/* Evaluación de muchas manos a la vez.
+ *
+ * Las manos se guardan como estructura de arreglos: por cada palo, un carril
+ * con la máscara de valores de cada mano (bit v-1), por cada valor, un
+ * carril con sus copias, y un carril de comodines; son los datos del
+ * ResumenMazo traspuestos. Así una instrucción AVX2 procesa 16 manos y una
+ * SSE4.1, 8. Para cada mano se calcula:
+ *   - puntos: lo mismo que calcularPuntosMano;
+ *   - mejorGrupo: el grupo de más puntos (con comodines hasta 4 cartas);
+ *   - mejorEscalera: la escalera de más puntos sin comodines;
+ *   - apertura: si la mano puede hacer la primera apeada (30+ puntos).
+ *
+ * La apertura se decide en los carriles cuando es segura (un grupo o una
+ * escalera ya llega a 30, o la mano entera no llega); el resto de manos, las
+ * dudosas, se resuelve con la partición exacta de particion.c. La versión
+ * vectorial se elige al ejecutar según la CPU, con una versión escalar que
+ * da los mismos resultados en cualquier máquina */
+
+#define ANCHO_LOTE 16   /* Manos por vector AVX2; la capacidad es múltiplo */
+
+typedef enum {
+    LOTE_ESCALAR,
+    LOTE_SSE41,
+    LOTE_AVX2,
+    NUM_IMPLEMENTACIONES_LOTE
+} ImplementacionLote;
+
+/* Valores del carril de apertura */
+#define APERTURA_NO      0
+#define APERTURA_SI      1
+#define APERTURA_DUDOSA  2   /* Solo entre la criba y la partición exacta */
+
+typedef struct {
+    int numManos;
+    int capacidad;
+    /* Entradas */
+    uint16_t *mascaraPalo[NUM_PALOS];
+    uint16_t *conteoValor[NUM_VALORES];
+    uint16_t *comodines;
+    /* Resultados */
+    uint16_t *puntos;
+    uint16_t *mejorGrupo;
+    uint16_t *mejorEscalera;
+    uint8_t *apertura;
+    int dudosas;            /* Manos resueltas con la partición exacta */
+    /* Firma completa de cada mano, solo para las dudosas */
+    FirmaMano *firmas;
+    void *memoria;          /* Un solo bloque alineado para todos los carriles */
+} LoteManos;
+
+/* Reservar un lote para numManos manos. Devuelve false si no hay memoria */
+bool crearLoteManos(LoteManos *lote, int numManos);
+void liberarLoteManos(LoteManos *lote);
+
+/* Vaciar el lote sin liberar la memoria */
+void vaciarLoteManos(LoteManos *lote);
+
+/* Añadir una mano al lote desde su resumen. Devuelve su posición o -1 si no cabe */
+int agregarManoLote(LoteManos *lote, const Mazo *mano);
+
+/* Evaluar todas las manos con la mejor implementación de esta CPU */
+void evaluarLoteManos(LoteManos *lote);
+
+/* Evaluar con una implementación concreta; false si la CPU no la tiene */
+bool evaluarLoteManosCon(LoteManos *lote, ImplementacionLote implementacion);
+
+/* Implementación que usa evaluarLoteManos y su nombre */
+ImplementacionLote implementacionLote(void);
+const char* nombreImplementacionLote(ImplementacionLote implementacion);
+
+/* Banco de pruebas: numManos manos al azar evaluadas con cada implementación
+ * disponible, en manos por segundo, comprobando que coinciden entre sí y con
+ * la partición exacta */
+bool ejecutarBancoLote(int numManos);
+
+#endif /* LOTEMANOS_H */
@@ -13,6 +13,18 @@
 #include "procesos.h"
 #include "utilidades.h"
 #include "memoria.h"
+#include "candados.h"
+#include "estrategia.h"
+#include "torneo.h"
+#include "mcts.h"
+#include "reacomodo.h"
+#include "lotemanos.h"
+#include "panel.h"
+#include "banca.h"
+#include "zobrist.h"
+#include "validador.h"
+#include "slab.h"
+#include "trazamemoria.h"
 #define _DEFAULT_SOURCE
 
 /* Función para leer una tecla sin bloqueo */
@@ -54,6 +66,12 @@ void *monitorTeclas(void *arg) {
         } else if (tecla == '5') {
             // NUEVO: Cambiar a algoritmo de memoria Mapa de Bits (para particionamiento)
              cambiarAlgoritmoMemoria(ALG_MAPA_BITS);
+        } else if (tecla == '6') {
+            // Cambiar al sistema de compañeros (buddy)
+            cambiarAlgoritmoMemoria(ALG_BUDDY);
+        } else if (tecla == 'p' || tecla == 'P') {
+            // Pasar a la siguiente política de reemplazo de páginas
+            cambiarPoliticaReemplazo((gestorMemoria.politicaReemplazo + 1) % NUM_POLITICAS_REEMPLAZO);
         }
          else if (tecla == 'm' || tecla == 'M') {
             // Mostrar estado de la memoria
@@ -99,7 +117,8 @@ void mostrarInformacion(void) {
     // NUEVO: Información sobre algoritmos de memoria
     printf("ALGORITMOS DE GESTIÓN DE MEMORIA:\n");
     printf("- Ajuste Óptimo: Utiliza la partición más pequeña que pueda contener el proceso\n");
-    printf("- LRU (Least Recently Used): Reemplaza la página menos usada recientemente\n\n");
+    printf("- LRU (Least Recently Used): Reemplaza la página menos usada recientemente\n");
+    printf("- Sistema de Compañeros: Bloques de potencias de dos que se parten y fusionan con su compañero\n\n");
     
     colorVerde();
     printf("CONTROLES:\n");
@@ -107,27 +126,291 @@ void mostrarInformacion(void) {
     printf("- Presione '2' para cambiar a algoritmo de CPU Round Robin\n");
     printf("- Presione '3' para cambiar a algoritmo de memoria Ajuste Óptimo\n");
     printf("- Presione '4' para cambiar a algoritmo de memoria LRU\n");
+    printf("- Presione '5' para cambiar a algoritmo de memoria Mapa de Bits\n");
+    printf("- Presione '6' para cambiar a algoritmo de memoria Sistema de Compañeros\n");
+    printf("- Presione 'p' para pasar a la siguiente política de reemplazo (LRU, Reloj, NFU, WSClock)\n");
     printf("- Presione 'm' para mostrar el estado actual de la memoria\n");
     printf("- Presione 'q' para salir del juego\n\n");
     colorReset();
+    
+    printf("OPCIONES DE LÍNEA DE COMANDOS:\n");
+    printf("- [jugadores]              Número de jugadores (1-%d)\n", MAX_JUGADORES);
+    printf("- --estrategias a,b,...    Estrategia de cada jugador (");
+    for (int i = 0; i < numEstrategias(); i++) {
+        printf("%s%s", i > 0 ? ", " : "", obtenerEstrategia(i)->nombre);
+    }
+    printf(")\n");
+    printf("- --hilos-mcts N           Hilos de búsqueda de la estrategia mcts (por defecto, los núcleos)\n");
+    printf("- --torneo N               Jugar N partidas sin interfaz y comparar las estrategias\n");
+    printf("- --bench-reacomodo N      Medir el reacomodo de la mesa en N mesas sintéticas\n");
+    printf("- --hilos-reacomodo N      Hilos del modo paralelo del banco de reacomodo (por defecto 4)\n");
+    printf("- --bench-manos N          Medir la evaluación por lotes de N manos (escalar, SSE4.1, AVX2)\n");
+    printf("- --barajas K              Barajas del zapato de la banca (1-%d, por defecto %d)\n",
+           MAX_BARAJAS, BARAJAS_POR_DEFECTO);
+    printf("- --bench-banca N          Medir N rondas de robo de la banca, de una en una y en lotes\n");
+    printf("- --validar                Validar las apeadas y la conservación de las cartas tras cada turno\n");
+    printf("- --bench-validador N      Medir N validaciones de una partida sintética entera\n");
+    printf("- --bench-memoria N        Medir N asignaciones y liberaciones con cada algoritmo de memoria\n");
+    printf("- --bench-reemplazo N      Medir N accesos a páginas con cada política de reemplazo\n");
+    printf("- --tlb N[xV]              TLB de N entradas y V vías (por defecto %dx%d; 0, sin TLB)\n", ENTRADAS_TLB, VIAS_TLB);
+    printf("- --bench-tlb N            Medir N accesos a páginas con varias TLB\n");
+    printf("- --tabla-paginas TIPO     Tabla de páginas: lineal (por defecto), radix2, radix4 o invertida\n");
+    printf("- --bench-tabla-paginas N  Medir N accesos con cada tabla de páginas, en un espacio denso y uno disperso\n");
+    printf("- --bench-contencion-memoria N  Medir N operaciones de memoria por hilo con 1 a 8 hilos a la vez\n");
+    printf("- --sin-slab               Pedir la memoria de E/S directamente al algoritmo, sin slabs\n");
+    printf("- --bench-slab N           Medir N peticiones de E/S con slabs y directas al algoritmo\n");
+    printf("- --grabar-memoria ARCHIVO Grabar en una traza binaria las llamadas a la memoria de la partida\n");
+    printf("- --reproducir-memoria ARCHIVO  Reproducir una traza con cada algoritmo y política (y Belady)\n");
+    printf("- --generar-traza-memoria ARCHIVO N  Escribir una traza sintética de N eventos\n");
+    printf("- --semilla N              Semilla de los zapatos (por defecto, la hora)\n");
+    printf("- --traza ARCHIVO          Con --torneo, escribir los hashes del estado de cada turno\n");
+    printf("- --comparar-trazas A B    Comparar dos trazas de hashes (o dos juego.log) turno a turno\n");
+    printf("- --registro NIVEL         Mensajes por consola: silencio, resumen o detalle\n");
+    printf("                           (por defecto, resumen; silencio con el panel)\n");
+    printf("- --panel / --sin-panel    Panel de la partida (por defecto, si la salida es una terminal)\n");
+    printf("- --fps N                  Cuadros por segundo del panel (por defecto %d, máximo %d)\n\n",
+           FPS_PANEL, MAX_FPS_PANEL);
 }
 
 /* Función principal */
 int main(int argc, char *argv[]) {
     int numJugadores = 4; /* Por defecto 4 jugadores según el enunciado */
+    int partidasTorneo = 0;
+    int mesasReacomodo = 0;
+    int hilosReacomodo = 4;
+    int manosLote = 0;
+    int rondasBanca = 0;
+    int rondasValidador = 0;
+    int operacionesMemoria = 0;
+    int operacionesSlab = 0;
+    int accesosReemplazo = 0;
+    int accesosTLB = 0;
+    int accesosTabla = 0;
+    int operacionesContencion = 0;
+    unsigned int semilla = (unsigned int)time(NULL);
+    const char *trazaA = NULL, *trazaB = NULL;
+    const char *grabacionMemoria = NULL, *reproduccionMemoria = NULL, *trazaSintetica = NULL;
+    long eventosSinteticos = 0;
+    bool usarPanel = isatty(STDOUT_FILENO);
+    bool nivelElegido = false;
+    int fpsPanel = FPS_PANEL;
     int opcion;
     
     /* Procesar argumentos de línea de comandos */
-    if (argc > 1) {
-        numJugadores = atoi(argv[1]);
-        if (numJugadores <= 0 || numJugadores > MAX_JUGADORES) {
-            printf("Número de jugadores inválido. Debe ser entre 1 y %d\n", MAX_JUGADORES);
-            return EXIT_FAILURE;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--estrategias") == 0 && i + 1 < argc) {
+            if (!configurarEstrategias(argv[++i])) {
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--hilos-mcts") == 0 && i + 1 < argc) {
+            configurarHilosMcts(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--torneo") == 0 && i + 1 < argc) {
+            partidasTorneo = atoi(argv[++i]);
+            if (partidasTorneo <= 0) {
+                printf("Número de partidas inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-reacomodo") == 0 && i + 1 < argc) {
+            mesasReacomodo = atoi(argv[++i]);
+            if (mesasReacomodo <= 0) {
+                printf("Número de mesas inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--hilos-reacomodo") == 0 && i + 1 < argc) {
+            hilosReacomodo = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-manos") == 0 && i + 1 < argc) {
+            manosLote = atoi(argv[++i]);
+            if (manosLote <= 0) {
+                printf("Número de manos inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--barajas") == 0 && i + 1 < argc) {
+            int barajas = atoi(argv[++i]);
+            if (barajas < 1 || barajas > MAX_BARAJAS) {
+                printf("Número de barajas inválido. Debe ser entre 1 y %d\n", MAX_BARAJAS);
+                return EXIT_FAILURE;
+            }
+            configurarBarajas(barajas);
+        } else if (strcmp(argv[i], "--bench-banca") == 0 && i + 1 < argc) {
+            rondasBanca = atoi(argv[++i]);
+            if (rondasBanca <= 0) {
+                printf("Número de rondas inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--validar") == 0) {
+            configurarValidacion(true);
+        } else if (strcmp(argv[i], "--bench-validador") == 0 && i + 1 < argc) {
+            rondasValidador = atoi(argv[++i]);
+            if (rondasValidador <= 0) {
+                printf("Número de rondas inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-memoria") == 0 && i + 1 < argc) {
+            operacionesMemoria = atoi(argv[++i]);
+            if (operacionesMemoria <= 0) {
+                printf("Número de operaciones inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-reemplazo") == 0 && i + 1 < argc) {
+            accesosReemplazo = atoi(argv[++i]);
+            if (accesosReemplazo <= 0) {
+                printf("Número de accesos inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--tlb") == 0 && i + 1 < argc) {
+            char *resto;
+            int entradas = (int)strtol(argv[++i], &resto, 10);
+            int vias = *resto == 'x' ? atoi(resto + 1) : (entradas < VIAS_TLB ? 1 : VIAS_TLB);
+            if (!configurarTLB(entradas, vias)) {
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-tlb") == 0 && i + 1 < argc) {
+            accesosTLB = atoi(argv[++i]);
+            if (accesosTLB <= 0) {
+                printf("Número de accesos inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--tabla-paginas") == 0 && i + 1 < argc) {
+            const char *tipo = argv[++i];
+            bool valida = strcmp(tipo, "lineal") == 0 ? configurarTablaPaginas(TABLA_PAGINAS_LINEAL, 2) :
+                          strcmp(tipo, "radix2") == 0 ? configurarTablaPaginas(TABLA_PAGINAS_RADIX, 2) :
+                          strcmp(tipo, "radix4") == 0 ? configurarTablaPaginas(TABLA_PAGINAS_RADIX, 4) :
+                          strcmp(tipo, "invertida") == 0 ? configurarTablaPaginas(TABLA_PAGINAS_INVERTIDA, 2) : false;
+            if (!valida) {
+                printf("Tabla de páginas desconocida: %s (lineal, radix2, radix4 o invertida)\n", tipo);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-tabla-paginas") == 0 && i + 1 < argc) {
+            accesosTabla = atoi(argv[++i]);
+            if (accesosTabla <= 0) {
+                printf("Número de accesos inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--bench-contencion-memoria") == 0 && i + 1 < argc) {
+            operacionesContencion = atoi(argv[++i]);
+            if (operacionesContencion <= 0) {
+                printf("Número de operaciones inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--sin-slab") == 0) {
+            configurarSlabES(false);
+        } else if (strcmp(argv[i], "--bench-slab") == 0 && i + 1 < argc) {
+            operacionesSlab = atoi(argv[++i]);
+            if (operacionesSlab <= 0) {
+                printf("Número de operaciones inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--grabar-memoria") == 0 && i + 1 < argc) {
+            grabacionMemoria = argv[++i];
+        } else if (strcmp(argv[i], "--reproducir-memoria") == 0 && i + 1 < argc) {
+            reproduccionMemoria = argv[++i];
+        } else if (strcmp(argv[i], "--generar-traza-memoria") == 0 && i + 2 < argc) {
+            trazaSintetica = argv[++i];
+            eventosSinteticos = atol(argv[++i]);
+            if (eventosSinteticos <= 0) {
+                printf("Número de eventos inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semilla = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--traza") == 0 && i + 1 < argc) {
+            configurarTrazaTorneo(argv[++i]);
+        } else if (strcmp(argv[i], "--comparar-trazas") == 0 && i + 2 < argc) {
+            trazaA = argv[++i];
+            trazaB = argv[++i];
+        } else if (strcmp(argv[i], "--registro") == 0 && i + 1 < argc) {
+            if (!interpretarNivelRegistro(argv[++i], &nivelRegistro)) {
+                return EXIT_FAILURE;
+            }
+            nivelElegido = true;
+        } else if (strcmp(argv[i], "--panel") == 0) {
+            usarPanel = true;
+        } else if (strcmp(argv[i], "--sin-panel") == 0) {
+            usarPanel = false;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fpsPanel = atoi(argv[++i]);
+        } else {
+            numJugadores = atoi(argv[i]);
+            if (numJugadores <= 0 || numJugadores > MAX_JUGADORES) {
+                printf("Número de jugadores inválido. Debe ser entre 1 y %d\n", MAX_JUGADORES);
+                return EXIT_FAILURE;
+            }
         }
     }
     
     /* Inicializar semilla para números aleatorios */
-    srand(time(NULL));
+    srand(semilla);
+    
+    /* Verificación de una repetición: comparar los hashes por turno */
+    if (trazaA != NULL) {
+        return compararTrazasHash(trazaA, trazaB) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Trazas de la memoria: generar una sintética y reproducirla */
+    if (trazaSintetica != NULL || reproduccionMemoria != NULL) {
+        if (trazaSintetica != NULL && !generarTrazaMemoria(trazaSintetica, eventosSinteticos)) {
+            return EXIT_FAILURE;
+        }
+        if (reproduccionMemoria != NULL && !reproducirTrazaMemoria(reproduccionMemoria)) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    
+    /* Banco de pruebas de la contención en el gestor de memoria */
+    if (operacionesContencion > 0) {
+        return ejecutarBancoContencionMemoria(operacionesContencion) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de las representaciones de la tabla de páginas */
+    if (accesosTabla > 0) {
+        return ejecutarBancoTablaPaginas(accesosTabla) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de la TLB */
+    if (accesosTLB > 0) {
+        return ejecutarBancoTLB(accesosTLB) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de las políticas de reemplazo */
+    if (accesosReemplazo > 0) {
+        return ejecutarBancoReemplazo(accesosReemplazo) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de los slabs de E/S */
+    if (operacionesSlab > 0) {
+        return ejecutarBancoSlab(operacionesSlab) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de los algoritmos de memoria */
+    if (operacionesMemoria > 0) {
+        return ejecutarBancoMemoria(operacionesMemoria) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas del robo de la banca */
+    if (rondasBanca > 0) {
+        return ejecutarBancoBanca(rondasBanca) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas del validador de la partida */
+    if (rondasValidador > 0) {
+        return ejecutarBancoValidador(rondasValidador) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas de la evaluación de manos por lotes */
+    if (manosLote > 0) {
+        return ejecutarBancoLote(manosLote) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Banco de pruebas del reacomodo de la mesa */
+    if (mesasReacomodo > 0) {
+        return ejecutarBancoReacomodo(mesasReacomodo, hilosReacomodo) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    /* Modo torneo: partidas por lotes sin interfaz ni hilos */
+    if (partidasTorneo > 0) {
+        return ejecutarTorneo(partidasTorneo, numJugadores) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     /* Mostrar información del juego */
     mostrarInformacion();
@@ -148,6 +431,9 @@ int main(int argc, char *argv[]) {
     
     /* NUEVO: Inicializar el sistema de memoria */
     inicializarMemoria();
+    if (grabacionMemoria != NULL && !iniciarGrabacionMemoria(grabacionMemoria)) {
+        return EXIT_FAILURE;
+    }
     
     /* Inicializar el juego */
     colorVerde();
@@ -178,8 +464,18 @@ int main(int argc, char *argv[]) {
     printf("\n¡Que comience el juego!\n");
     colorReset();
     
+    /* El panel ocupa la terminal: salvo que se pida otro nivel, solo se
+     * escriben los errores por debajo de él */
+    if (usarPanel) {
+        if (!nivelElegido) {
+            nivelRegistro = REGISTRO_SILENCIO;
+        }
+        iniciarPanel(fpsPanel);
+    }
+    
     /* Esta función ejecutará el bucle principal */
     iniciarJuego();
+    detenerPanel();
     
     /* Esperar a que termine el hilo monitor con un timeout manual */
     printf("Esperando a que el hilo monitor finalice...\n");
@@ -204,8 +500,12 @@ int main(int argc, char *argv[]) {
     imprimirEstadoMemoria();
     imprimirEstadoMemoriaVirtual();
     
+    /* Reporte de contención de candados (vacío si no se compiló con PERFILAR_CANDADOS) */
+    imprimirReporteCandados();
+    
     /* Liberar recursos */
     liberarJuego();
+    terminarGrabacionMemoria();
     
     colorCian();
     printf("\n¡Gracias por jugar! El programa ha finalizado correctamente.\n");
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mazo.h"
+#include "particion.h"
+#include "utilidades.h"
+#include "zobrist.h"
+
+/* Sumar (delta = 1) o restar (delta = -1) una carta al resumen */
+static void actualizarResumen(ResumenMazo *resumen, Carta carta, int delta) {
+    resumen->puntos += delta * calcularPuntosCarta(carta);
+    resumen->mejorApertura = -1;
+
+    /* Zobrist: la clave de la copia que entra, o de la última que sale */
+    if (carta.esComodin) {
+        int copia = delta > 0 ? resumen->firma.comodines : resumen->firma.comodines - 1;
+        resumen->hash ^= claveZobrist(ZOBRIST_MANO, NUM_PALOS * NUM_VALORES, copia);
+        resumen->firma.comodines += delta;
+        return;
+    }
+
+    int palo = indicePaloParticion(carta.palo);
+    if (palo < 0 || carta.valor < 1 || carta.valor > NUM_VALORES) {
+        return;
+    }
+
+    uint8_t *copias = &resumen->firma.conteo[palo][carta.valor - 1];
+    resumen->hash ^= claveZobrist(ZOBRIST_MANO, palo * NUM_VALORES + carta.valor - 1,
+                                  delta > 0 ? *copias : *copias - 1);
+    *copias += delta;
+    resumen->conteoValor[carta.valor - 1] += delta;
+
+    if (*copias > 0) {
+        resumen->mascaraPalo[palo] |= (uint16_t)(1u << (carta.valor - 1));
+    } else {
+        resumen->mascaraPalo[palo] &= (uint16_t)~(1u << (carta.valor - 1));
+    }
+}
+
+void inicializarMazo(Mazo *mazo) {
+    mazo->cartas = mazo->enLinea;
+    mazo->numCartas = 0;
+    mazo->capacidad = CAPACIDAD_EN_LINEA_MAZO;
+    memset(&mazo->resumen, 0, sizeof(ResumenMazo));
+    mazo->resumen.mejorApertura = -1;
+}
+
+void liberarMazo(Mazo *mazo) {
+    if (mazo->cartas != NULL && mazo->cartas != mazo->enLinea) {
+        free(mazo->cartas);
+    }
+    inicializarMazo(mazo);
+}
+
+bool reservarMazo(Mazo *mazo, int numCartas) {
+    if (numCartas <= mazo->capacidad) {
+        return true;
+    }
+
+    int nuevaCapacidad = mazo->capacidad > 0 ? mazo->capacidad : CAPACIDAD_EN_LINEA_MAZO;
+    while (nuevaCapacidad < numCartas) {
+        nuevaCapacidad *= 2;
+    }
+
+    Carta *nuevasCartas;
+    if (mazo->cartas == mazo->enLinea) {
+        /* Primer desborde: el búfer en línea se queda donde está */
+        nuevasCartas = (Carta*)malloc(nuevaCapacidad * sizeof(Carta));
+        if (nuevasCartas != NULL) {
+            memcpy(nuevasCartas, mazo->enLinea, mazo->numCartas * sizeof(Carta));
+        }
+    } else {
+        nuevasCartas = (Carta*)realloc(mazo->cartas, nuevaCapacidad * sizeof(Carta));
+    }
+
+    if (nuevasCartas == NULL) {
+        printf("Error: No se pudo ampliar el mazo\n");
+        return false;
+    }
+    mazo->cartas = nuevasCartas;
+    mazo->capacidad = nuevaCapacidad;
+    return true;
+}
+
+void recalcularResumenMazo(Mazo *mazo) {
+    memset(&mazo->resumen, 0, sizeof(ResumenMazo));
+    for (int i = 0; i < mazo->numCartas; i++) {
+        actualizarResumen(&mazo->resumen, mazo->cartas[i], 1);
+    }
+    mazo->resumen.mejorApertura = -1;
+}
+
+bool agregarCartaMazo(Mazo *mazo, Carta carta) {
+    if (mazo->numCartas >= mazo->capacidad && !reservarMazo(mazo, mazo->numCartas + 1)) {
+        return false;
+    }
+
+    mazo->cartas[mazo->numCartas++] = carta;
+    actualizarResumen(&mazo->resumen, carta, 1);
+    return true;
+}
+
+bool agregarCartasMazo(Mazo *mazo, const Carta *cartas, int numCartas) {
+    if (!reservarMazo(mazo, mazo->numCartas + numCartas)) {
+        return false;
+    }
+
+    for (int i = 0; i < numCartas; i++) {
+        mazo->cartas[mazo->numCartas++] = cartas[i];
+        actualizarResumen(&mazo->resumen, cartas[i], 1);
+    }
+    return true;
+}
+
+Carta quitarCartaMazo(Mazo *mazo, int indice) {
+    Carta carta = mazo->cartas[indice];
+
+    for (int i = indice; i < mazo->numCartas - 1; i++) {
+        mazo->cartas[i] = mazo->cartas[i + 1];
+    }
+    mazo->numCartas--;
+    actualizarResumen(&mazo->resumen, carta, -1);
+
+    return carta;
+}
+
+Carta quitarCartaMazoRapido(Mazo *mazo, int indice) {
+    Carta carta = mazo->cartas[indice];
+
+    mazo->cartas[indice] = mazo->cartas[--mazo->numCartas];
+    actualizarResumen(&mazo->resumen, carta, -1);
+
+    return carta;
+}
+
+int quitarCartasMazo(Mazo *mazo, const int *indices, int numIndices, Carta *quitadas) {
+    uint64_t marcas[(MAX_CARTAS_MAZO + 63) / 64] = {0};
+    int quitadasTotal = 0;
+    int destino = 0;
+
+    for (int i = 0; i < numIndices; i++) {
+        int indice = indices[i];
+        if (indice < 0 || indice >= mazo->numCartas || indice >= MAX_CARTAS_MAZO ||
+            (marcas[indice / 64] >> (indice % 64)) & 1u) {
+            continue;  /* Fuera de rango o repetida */
+        }
+        marcas[indice / 64] |= (uint64_t)1 << (indice % 64);
+        if (quitadas != NULL) {
+            quitadas[quitadasTotal] = mazo->cartas[indice];
+        }
+        actualizarResumen(&mazo->resumen, mazo->cartas[indice], -1);
+        quitadasTotal++;
+    }
+
+    for (int i = 0; i < mazo->numCartas; i++) {
+        if (i < MAX_CARTAS_MAZO && (marcas[i / 64] >> (i % 64)) & 1u) {
+            continue;
+        }
+        mazo->cartas[destino++] = mazo->cartas[i];
+    }
+    mazo->numCartas = destino;
+
+    return quitadasTotal;
+}
+
+int buscarCartaMazo(const Mazo *mazo, Carta carta) {
+    if (carta.esComodin) {
+        if (mazo->resumen.firma.comodines == 0) {
+            return -1;
+        }
+    } else if (copiasCartaMazo(mazo, indicePaloParticion(carta.palo), carta.valor) == 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < mazo->numCartas; i++) {
+        const Carta *actual = &mazo->cartas[i];
+        if (carta.esComodin ? actual->esComodin
+                            : (!actual->esComodin && actual->valor == carta.valor && actual->palo == carta.palo)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int obtenerMejorApertura(Mazo *mazo) {
+    if (mazo->resumen.mejorApertura < 0) {
+        ParticionMano particion;
+        resolverParticionFirma(&mazo->resumen.firma, OBJ_MAX_PUNTOS, &particion);
+        mazo->resumen.mejorApertura = particion.puntos;
+    }
+    return mazo->resumen.mejorApertura;
+}
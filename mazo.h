@@ -0,0 +1,86 @@
+#ifndef MAZO_H
+#define MAZO_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+
+/* Operaciones sobre un Mazo que mantienen su ResumenMazo.
+ *
+ * Toda carta que entra o sale de una mano debe pasar por agregarCartaMazo o
+ * quitarCartaMazo: cada una actualiza conteos, máscaras, comodines, puntos y
+ * el hash de Zobrist en O(1) e invalida la mejor apertura, que se vuelve a
+ * calcular solo cuando alguien la pide. Los mazos armados o copiados a mano
+ * (instantáneas, vistas de la especulación) deben llamar a
+ * recalcularResumenMazo antes de leer el resumen.
+ *
+ * Las cartas se guardan en el búfer enLinea del propio mazo mientras caben
+ * (CAPACIDAD_EN_LINEA_MAZO, más que cualquier mano normal) y solo pasan a
+ * memoria dinámica al superarlo. Como la capacidad se duplica, un mazo de la
+ * partida (108 cartas como mucho) cambia de arreglo una sola vez y el búfer
+ * en línea nunca se libera, así que un lector del seqlock de la mano nunca
+ * lee memoria liberada. Un Mazo copiado por valor sigue apuntando a las
+ * cartas del original: quien lo copie debe darle su propio arreglo */
+
+#define MAX_CARTAS_MAZO 108   /* Mazo completo: 2 barajas + 4 comodines */
+
+/* Dejar el mazo vacío, usando su búfer en línea */
+void inicializarMazo(Mazo *mazo);
+
+/* Liberar la memoria dinámica del mazo (si la tiene) y dejarlo vacío */
+void liberarMazo(Mazo *mazo);
+
+/* Asegurar capacidad para al menos numCartas cartas */
+bool reservarMazo(Mazo *mazo, int numCartas);
+
+/* Reconstruir el resumen recorriendo las cartas (O(n)) */
+void recalcularResumenMazo(Mazo *mazo);
+
+/* Añadir una carta al final, ampliando el arreglo si hace falta */
+bool agregarCartaMazo(Mazo *mazo, Carta carta);
+
+/* Añadir varias cartas al final con una sola reserva. Si no hay memoria
+ * no añade ninguna */
+bool agregarCartasMazo(Mazo *mazo, const Carta *cartas, int numCartas);
+
+/* Quitar la carta de la posición indicada conservando el orden de las demás */
+Carta quitarCartaMazo(Mazo *mazo, int indice);
+
+/* Quitar la carta de la posición indicada en O(1): la última ocupa su lugar,
+ * así que solo sirve cuando el orden de la mano no importa */
+Carta quitarCartaMazoRapido(Mazo *mazo, int indice);
+
+/* Quitar varias posiciones (distintas, en cualquier orden) con una sola
+ * pasada de compactación que conserva el orden de las que quedan. Si
+ * quitadas no es NULL, recibe las cartas en el orden de indices. Se ignoran
+ * las posiciones repetidas o desde MAX_CARTAS_MAZO. Devuelve cuántas se quitaron */
+int quitarCartasMazo(Mazo *mazo, const int *indices, int numIndices, Carta *quitadas);
+
+/* Posición de una carta igual a la dada, o -1. Si el resumen dice que no
+ * hay ninguna, responde sin recorrer el mazo */
+int buscarCartaMazo(const Mazo *mazo, Carta carta);
+
+/* Puntos de la mejor primera apeada posible con el mazo (calculada al pedirla) */
+int obtenerMejorApertura(Mazo *mazo);
+
+/* Hash de Zobrist de las cartas del mazo (no depende de su orden) */
+static inline uint64_t hashMazo(const Mazo *mazo) {
+    return mazo->resumen.hash;
+}
+
+/* Copias de una carta natural en el mazo (palo como índice de palosParticion) */
+static inline int copiasCartaMazo(const Mazo *mazo, int palo, int valor) {
+    if (palo < 0 || palo >= NUM_PALOS || valor < 1 || valor > NUM_VALORES) {
+        return 0;
+    }
+    return mazo->resumen.firma.conteo[palo][valor - 1];
+}
+
+/* true si el mazo tiene algún valor de ese palo */
+static inline bool tieneValorPaloMazo(const Mazo *mazo, int palo, int valor) {
+    if (palo < 0 || palo >= NUM_PALOS || valor < 1 || valor > NUM_VALORES) {
+        return false;
+    }
+    return (mazo->resumen.mascaraPalo[palo] >> (valor - 1)) & 1u;
+}
+
+#endif /* MAZO_H */
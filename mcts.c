@@ -0,0 +1,836 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "mcts.h"
+#include "particion.h"
+#include "banca.h"
+
+/* Cartas codificadas en un byte: palo * 13 + valor - 1, y 52 el comodín */
+#define CARTA_COMODIN   52
+
+#define CONSTANTE_UCB   0.7
+
+/* Un nodo por turno del árbol; las estadísticas son las de la acción que
+ * lleva a él, vistas por el jugador que la eligió */
+typedef struct {
+    int hijos[NUM_MACROS];      /* -1 = sin expandir */
+    unsigned int visitas;
+    unsigned int virtuales;     /* Simulaciones en curso que pasan por aquí */
+    double victorias;
+} NodoMcts;
+
+typedef struct {
+    NodoMcts nodos[MAX_NODOS_MCTS];
+    int numNodos;
+    pthread_mutex_t mutex;
+} ArbolMcts;
+
+/* Lo que sabe el jugador al empezar el turno */
+typedef struct {
+    EstadoMcts estado;                  /* Rivales con la mano vacía y banca vacía */
+    uint8_t ocultas[MAX_CARTAS_MCTS];   /* Cartas que no ve: manos rivales y banca */
+    int numOcultas;
+    int cartasBanca;
+} RaizMcts;
+
+/* Conjunto de hilos de búsqueda */
+static pthread_t hilos[MAX_HILOS_MCTS];
+static int numHilos = 0;
+static int hilosConfigurados = 0;
+static pthread_mutex_t mutexPool = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condTrabajo = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t condFin = PTHREAD_COND_INITIALIZER;
+static unsigned long generacion = 0;    /* Aumenta con cada búsqueda */
+static int hilosOcupados = 0;
+static bool detenerPool = false;
+
+/* Búsqueda en curso (solo una a la vez) */
+static pthread_mutex_t mutexBusqueda = PTHREAD_MUTEX_INITIALIZER;
+static ArbolMcts *arboles = NULL;
+static int numArboles = 0;
+static RaizMcts raizActual;
+static double limiteActual;             /* Instante (s) en que se deja de buscar */
+
+/* Táctica elegida para el turno de cada jugador */
+static MacroMcts macroJugador[MAX_JUGADORES];
+
+/* Estadísticas */
+static unsigned long busquedas = 0;
+static unsigned long simulaciones = 0;
+static double segundosHilo = 0;         /* Tiempo sumado de todos los hilos buscando */
+static double segundosBusqueda = 0;
+static unsigned long eleccionesMacro[NUM_MACROS];
+
+static const char *nombresMacro[NUM_MACROS] = {"base", "reservada", "retener"};
+
+static double ahoraSegundos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Generador xorshift, uno por hilo */
+static inline uint64_t aleatorio(uint64_t *semilla) {
+    uint64_t x = *semilla;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *semilla = x;
+    return x;
+}
+
+/* Logaritmo natural y raíz cuadrada para UCB, sin depender de libm */
+static double logaritmo(double x) {
+    double exponente = 0.0;
+    while (x >= 2.0) {
+        x /= 2.0;
+        exponente += 1.0;
+    }
+    /* ln(x) = 2 atanh((x-1)/(x+1)) para x en [1, 2) */
+    double t = (x - 1.0) / (x + 1.0);
+    double t2 = t * t;
+    double suma = 0.0;
+    double termino = t;
+    for (int k = 1; k < 16; k += 2) {
+        suma += termino / k;
+        termino *= t2;
+    }
+    return 2.0 * suma + exponente * 0.69314718055994531;
+}
+
+static double raizCuadrada(double x) {
+    double r = x > 1.0 ? x : 1.0;
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    for (int i = 0; i < 40; i++) {
+        double siguiente = 0.5 * (r + x / r);
+        if (siguiente == r) {
+            break;
+        }
+        r = siguiente;
+    }
+    return r;
+}
+
+/* --- Estado compacto --- */
+
+static inline uint8_t codificarCarta(Carta carta) {
+    if (carta.esComodin) {
+        return CARTA_COMODIN;
+    }
+    int palo = indicePaloParticion(carta.palo);
+    if (palo < 0 || carta.valor < 1 || carta.valor > NUM_VALORES) {
+        return CARTA_COMODIN;
+    }
+    return (uint8_t)(palo * NUM_VALORES + carta.valor - 1);
+}
+
+static inline void ponerCartaFirma(FirmaMano *firma, uint8_t codigo) {
+    if (codigo == CARTA_COMODIN) {
+        firma->comodines++;
+    } else {
+        firma->conteo[codigo / NUM_VALORES][codigo % NUM_VALORES]++;
+    }
+}
+
+static int puntosFirma(const FirmaMano *firma) {
+    int puntos = firma->comodines * 20;
+    for (int v = 1; v <= NUM_VALORES; v++) {
+        int copias = 0;
+        for (int p = 0; p < NUM_PALOS; p++) {
+            copias += firma->conteo[p][v - 1];
+        }
+        puntos += copias * (v >= 11 ? 10 : (v == 1 ? 15 : v));
+    }
+    return puntos;
+}
+
+/* Reducir una apeada de la mesa a su forma compacta */
+static ApeadaCompacta compactarCartas(const Carta *cartas, int numCartas, bool esGrupo) {
+    ApeadaCompacta compacta;
+
+    memset(&compacta, 0, sizeof(compacta));
+    compacta.esGrupo = esGrupo;
+    compacta.cartas = (uint8_t)numCartas;
+
+    if (esGrupo) {
+        for (int i = 0; i < numCartas; i++) {
+            if (!cartas[i].esComodin) {
+                int palo = indicePaloParticion(cartas[i].palo);
+                compacta.valor = (uint8_t)cartas[i].valor;
+                if (palo >= 0) {
+                    compacta.palos |= (uint8_t)(1u << palo);
+                }
+            }
+        }
+        return compacta;
+    }
+
+    /* La posición de la primera carta natural fija toda la escalera */
+    int inicio = 1;
+    for (int i = 0; i < numCartas; i++) {
+        if (!cartas[i].esComodin) {
+            int palo = indicePaloParticion(cartas[i].palo);
+            compacta.palo = (uint8_t)(palo >= 0 ? palo : 0);
+            inicio = cartas[i].valor - i;
+            break;
+        }
+    }
+    if (inicio < 1) {
+        inicio = 1;
+    }
+    int fin = inicio + numCartas - 1;
+    compacta.inicio = (uint8_t)inicio;
+    compacta.fin = (uint8_t)(fin > NUM_VALORES ? NUM_VALORES : fin);
+    return compacta;
+}
+
+/* Bajar una jugada de la partición: quitar sus cartas y ponerla en la mesa */
+static void bajarJugada(EstadoMcts *estado, int jugador, const JugadaParticion *jugada) {
+    FirmaMano *mano = &estado->manos[jugador];
+
+    if (estado->numMesa >= MAX_APEADAS) {
+        return;
+    }
+
+    for (int i = 0; i < jugada->numCartas; i++) {
+        if (jugada->cartas[i].esComodin) {
+            mano->comodines--;
+        } else {
+            mano->conteo[indicePaloParticion(jugada->cartas[i].palo)][jugada->cartas[i].valor - 1]--;
+        }
+    }
+    estado->numCartas[jugador] -= (uint8_t)jugada->numCartas;
+    estado->mesa[estado->numMesa++] = compactarCartas(jugada->cartas, jugada->numCartas, jugada->esGrupo);
+}
+
+static int compararJugadasPorPuntos(const void *a, const void *b) {
+    return ((const JugadaParticion*)b)->puntos - ((const JugadaParticion*)a)->puntos;
+}
+
+/* Primera apeada según la táctica. Devuelve true si se bajó algo */
+static bool abrirCompacto(EstadoMcts *estado, int jugador, MacroMcts macro) {
+    ParticionMano particion;
+
+    resolverParticionFirma(&estado->manos[jugador], OBJ_MAX_PUNTOS, &particion);
+    if (particion.puntos < 30) {
+        return false;
+    }
+
+    int usar = particion.numJugadas;
+    if (macro != MACRO_BASE) {
+        /* Reservada y retener abren con las jugadas justas para llegar a 30 */
+        int puntos = 0;
+        qsort(particion.jugadas, particion.numJugadas, sizeof(JugadaParticion), compararJugadasPorPuntos);
+        for (usar = 0; usar < particion.numJugadas && puntos < 30; usar++) {
+            puntos += particion.jugadas[usar].puntos;
+        }
+    }
+
+    for (int i = 0; i < usar; i++) {
+        bajarJugada(estado, jugador, &particion.jugadas[i]);
+    }
+    estado->abierto[jugador] = true;
+    return true;
+}
+
+/* Poner una carta en la apeada de la mesa indicada, como realizarJugadaApeada:
+ * natural si encaja, si no un comodín. Devuelve true si se pudo */
+static bool embonarEn(EstadoMcts *estado, int jugador, ApeadaCompacta *apeada, bool permitirComodin) {
+    FirmaMano *mano = &estado->manos[jugador];
+
+    if (apeada->esGrupo) {
+        if (apeada->cartas >= 4) {
+            return false;
+        }
+        for (int p = 0; p < NUM_PALOS; p++) {
+            if (!(apeada->palos & (1u << p)) && apeada->valor >= 1 && mano->conteo[p][apeada->valor - 1] > 0) {
+                mano->conteo[p][apeada->valor - 1]--;
+                apeada->palos |= (uint8_t)(1u << p);
+                apeada->cartas++;
+                estado->numCartas[jugador]--;
+                return true;
+            }
+        }
+        if (permitirComodin && mano->comodines > 0) {
+            mano->comodines--;
+            apeada->cartas++;
+            estado->numCartas[jugador]--;
+            return true;
+        }
+        return false;
+    }
+
+    if (apeada->inicio > 1 && mano->conteo[apeada->palo][apeada->inicio - 2] > 0) {
+        mano->conteo[apeada->palo][apeada->inicio - 2]--;
+        apeada->inicio--;
+    } else if (apeada->fin < NUM_VALORES && mano->conteo[apeada->palo][apeada->fin] > 0) {
+        mano->conteo[apeada->palo][apeada->fin]--;
+        apeada->fin++;
+    } else if (permitirComodin && mano->comodines > 0 && (apeada->fin < NUM_VALORES || apeada->inicio > 1)) {
+        mano->comodines--;
+        if (apeada->fin < NUM_VALORES) {
+            apeada->fin++;
+        } else {
+            apeada->inicio--;
+        }
+    } else {
+        return false;
+    }
+
+    apeada->cartas++;
+    estado->numCartas[jugador]--;
+    return true;
+}
+
+/* Un embone según la táctica. Devuelve true si se hizo */
+static bool embonarCompacto(EstadoMcts *estado, int jugador, MacroMcts macro) {
+    bool comodin = macro != MACRO_RESERVADA || estado->numCartas[jugador] <= 3;
+
+    /* La reservada busca primero cualquier encaje natural */
+    if (macro == MACRO_RESERVADA) {
+        for (int i = 0; i < estado->numMesa; i++) {
+            if (embonarEn(estado, jugador, &estado->mesa[i], false)) {
+                return true;
+            }
+        }
+    }
+    for (int i = 0; i < estado->numMesa; i++) {
+        if (embonarEn(estado, jugador, &estado->mesa[i], comodin)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Apeadas nuevas según la táctica. Devuelve true si se bajó algo */
+static bool bajarNuevasCompacto(EstadoMcts *estado, int jugador, MacroMcts macro) {
+    ParticionMano particion;
+    int numCartas = estado->numCartas[jugador];
+
+    if (numCartas < 3 || !resolverParticionFirma(&estado->manos[jugador], OBJ_MAX_CARTAS, &particion)) {
+        return false;
+    }
+
+    if (macro == MACRO_RESERVADA && numCartas - particion.cartas > 3 && numCartas < 20) {
+        return false;
+    }
+    if (macro == MACRO_RETENER && particion.cartas < numCartas) {
+        return false;
+    }
+
+    int antes = estado->numMesa;
+    for (int i = 0; i < particion.numJugadas; i++) {
+        bajarJugada(estado, jugador, &particion.jugadas[i]);
+    }
+    return estado->numMesa > antes;
+}
+
+/* Jugar el turno del jugador al que le toca con la táctica indicada; mismo
+ * orden que realizarTurno: apearse o embonar mientras se pueda y comer al fallar */
+static void jugarTurnoCompacto(EstadoMcts *estado, MacroMcts macro) {
+    int jugador = estado->turno;
+    bool actuo = false;
+
+    while (estado->numCartas[jugador] > 0) {
+        bool jugo;
+
+        if (!estado->abierto[jugador]) {
+            jugo = abrirCompacto(estado, jugador, macro);
+        } else {
+            jugo = embonarCompacto(estado, jugador, macro) || bajarNuevasCompacto(estado, jugador, macro);
+        }
+
+        if (jugo) {
+            actuo = true;
+            continue;
+        }
+
+        if (estado->numBanca > 0) {
+            ponerCartaFirma(&estado->manos[jugador], estado->banca[--estado->numBanca]);
+            estado->numCartas[jugador]++;
+            actuo = true;
+        }
+        break;
+    }
+
+    estado->turnosSinAccion = actuo ? 0 : estado->turnosSinAccion + 1;
+    estado->turno = (estado->turno + 1) % estado->numJugadores;
+}
+
+/* Ganador de una partida terminada (o -1 si sigue) */
+static int ganadorCompacto(const EstadoMcts *estado, bool forzar) {
+    for (int j = 0; j < estado->numJugadores; j++) {
+        if (estado->numCartas[j] == 0) {
+            return j;
+        }
+    }
+    if (!forzar && estado->turnosSinAccion < estado->numJugadores) {
+        return -1;
+    }
+
+    /* Bloqueada: gana la mano con menos puntos, como en el torneo */
+    int ganador = 0;
+    int menos = puntosFirma(&estado->manos[0]);
+    for (int j = 1; j < estado->numJugadores; j++) {
+        int puntos = puntosFirma(&estado->manos[j]);
+        if (puntos < menos) {
+            menos = puntos;
+            ganador = j;
+        }
+    }
+    return ganador;
+}
+
+/* Repartir las cartas ocultas entre las manos rivales y la banca */
+static void determinizar(const RaizMcts *raiz, EstadoMcts *estado, uint64_t *semilla) {
+    uint8_t ocultas[MAX_CARTAS_MCTS];
+    int n = raiz->numOcultas;
+    int k = 0;
+
+    *estado = raiz->estado;
+    memcpy(ocultas, raiz->ocultas, n);
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(aleatorio(semilla) % (uint64_t)(i + 1));
+        uint8_t temp = ocultas[i];
+        ocultas[i] = ocultas[j];
+        ocultas[j] = temp;
+    }
+
+    for (int j = 0; j < estado->numJugadores; j++) {
+        if (j == raiz->estado.turno) {
+            continue;
+        }
+        for (int c = 0; c < estado->numCartas[j] && k < n; c++) {
+            ponerCartaFirma(&estado->manos[j], ocultas[k++]);
+        }
+    }
+    estado->numBanca = 0;
+    for (int c = 0; c < raiz->cartasBanca && k < n; c++) {
+        estado->banca[estado->numBanca++] = ocultas[k++];
+    }
+}
+
+/* --- Árbol --- */
+
+static int nuevoNodo(ArbolMcts *arbol) {
+    if (arbol->numNodos >= MAX_NODOS_MCTS) {
+        return -1;
+    }
+    NodoMcts *nodo = &arbol->nodos[arbol->numNodos];
+    for (int a = 0; a < NUM_MACROS; a++) {
+        nodo->hijos[a] = -1;
+    }
+    nodo->visitas = 0;
+    nodo->virtuales = 0;
+    nodo->victorias = 0;
+    return arbol->numNodos++;
+}
+
+/* Elegir el camino de una simulación (con el mutex del árbol tomado).
+ * Cada nodo del camino suma una pérdida virtual para que los otros hilos
+ * del árbol prueben otras ramas mientras esta simulación no termina */
+static int seleccionar(ArbolMcts *arbol, int profundidad, int *camino, MacroMcts *acciones) {
+    int nodo = 0;
+    int largo = 0;
+
+    camino[0] = 0;
+    arbol->nodos[0].virtuales++;
+
+    while (largo < profundidad) {
+        NodoMcts *actual = &arbol->nodos[nodo];
+        int elegida = -1;
+        bool expandido = false;
+
+        for (int a = 0; a < NUM_MACROS; a++) {
+            if (actual->hijos[a] < 0) {
+                int hijo = nuevoNodo(arbol);
+                if (hijo >= 0) {
+                    actual = &arbol->nodos[nodo];
+                    actual->hijos[a] = hijo;
+                    elegida = a;
+                    expandido = true;
+                }
+                break;
+            }
+        }
+
+        if (elegida < 0) {
+            if (actual->hijos[NUM_MACROS - 1] < 0) {
+                break;  /* Árbol lleno: se sigue con la simulación */
+            }
+            double total = logaritmo((double)(actual->visitas + actual->virtuales) + 1.0);
+            double mejor = -1.0;
+            for (int a = 0; a < NUM_MACROS; a++) {
+                NodoMcts *hijo = &arbol->nodos[actual->hijos[a]];
+                double n = (double)(hijo->visitas + hijo->virtuales) + 1e-9;
+                /* Las simulaciones en curso cuentan como derrotas */
+                double valor = hijo->victorias / n + CONSTANTE_UCB * raizCuadrada(total / n);
+                if (valor > mejor) {
+                    mejor = valor;
+                    elegida = a;
+                }
+            }
+        }
+
+        nodo = actual->hijos[elegida];
+        acciones[largo] = (MacroMcts)elegida;
+        camino[++largo] = nodo;
+        arbol->nodos[nodo].virtuales++;
+
+        if (expandido) {
+            break;
+        }
+    }
+
+    return largo;
+}
+
+/* Sumar el resultado al camino y quitar las pérdidas virtuales */
+static void retropropagar(ArbolMcts *arbol, const int *camino, int largo, int primerJugador,
+                          int numJugadores, int ganador) {
+    for (int d = 0; d <= largo; d++) {
+        NodoMcts *nodo = &arbol->nodos[camino[d]];
+        nodo->visitas++;
+        nodo->virtuales--;
+        /* El nodo de profundidad d lo eligió el jugador del turno d-1 */
+        if (d > 0 && ganador == (primerJugador + d - 1) % numJugadores) {
+            nodo->victorias += 1.0;
+        }
+    }
+}
+
+/* Simulaciones de un hilo sobre su árbol hasta agotar el tiempo */
+static unsigned long buscarEnArbol(ArbolMcts *arbol, const RaizMcts *raiz, double limite, uint64_t semilla) {
+    int numJugadores = raiz->estado.numJugadores;
+    int profundidad = RONDAS_ARBOL_MCTS * numJugadores;
+    int camino[RONDAS_ARBOL_MCTS * MAX_JUGADORES + 1];
+    MacroMcts acciones[RONDAS_ARBOL_MCTS * MAX_JUGADORES];
+    unsigned long hechas = 0;
+    EstadoMcts estado;
+
+    while (ahoraSegundos() < limite) {
+        pthread_mutex_lock(&arbol->mutex);
+        int largo = seleccionar(arbol, profundidad, camino, acciones);
+        pthread_mutex_unlock(&arbol->mutex);
+
+        /* Las tácticas del camino se aplican fuera del mutex */
+        determinizar(raiz, &estado, &semilla);
+        int ganador = -1;
+        for (int t = 0; t < MAX_TURNOS_SIMULACION && ganador < 0; t++) {
+            jugarTurnoCompacto(&estado, t < largo ? acciones[t] : MACRO_BASE);
+            ganador = ganadorCompacto(&estado, false);
+        }
+        if (ganador < 0) {
+            ganador = ganadorCompacto(&estado, true);
+        }
+
+        pthread_mutex_lock(&arbol->mutex);
+        retropropagar(arbol, camino, largo, raiz->estado.turno, numJugadores, ganador);
+        pthread_mutex_unlock(&arbol->mutex);
+
+        hechas++;
+    }
+
+    return hechas;
+}
+
+/* --- Hilos --- */
+
+static void *funcionHiloMcts(void *arg) {
+    int id = (int)(long)arg;
+    unsigned long vista = 0;
+
+    pthread_mutex_lock(&mutexPool);
+    while (true) {
+        while (generacion == vista && !detenerPool) {
+            pthread_cond_wait(&condTrabajo, &mutexPool);
+        }
+        if (detenerPool) {
+            break;
+        }
+        vista = generacion;
+        ArbolMcts *arbol = &arboles[id % numArboles];
+        double limite = limiteActual;
+        pthread_mutex_unlock(&mutexPool);
+
+        double inicio = ahoraSegundos();
+        uint64_t semilla = ((uint64_t)time(NULL) << 16) ^ ((uint64_t)id * 0x9E3779B97F4A7C15ULL) ^ vista;
+        unsigned long hechas = buscarEnArbol(arbol, &raizActual, limite, semilla | 1);
+        double usado = ahoraSegundos() - inicio;
+
+        pthread_mutex_lock(&mutexPool);
+        simulaciones += hechas;
+        segundosHilo += usado;
+        if (--hilosOcupados == 0) {
+            pthread_cond_signal(&condFin);
+        }
+    }
+    pthread_mutex_unlock(&mutexPool);
+
+    liberarMemoParticionHilo();
+    return NULL;
+}
+
+/* Crear los hilos y los árboles la primera vez que se busca */
+static bool iniciarPool(void) {
+    if (numHilos > 0) {
+        return true;
+    }
+
+    int hilosDeseados = hilosConfigurados > 0 ? hilosConfigurados : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (hilosDeseados < 1) {
+        hilosDeseados = 1;
+    }
+    if (hilosDeseados > MAX_HILOS_MCTS) {
+        hilosDeseados = MAX_HILOS_MCTS;
+    }
+
+    numArboles = (hilosDeseados + HILOS_POR_ARBOL_MCTS - 1) / HILOS_POR_ARBOL_MCTS;
+    arboles = (ArbolMcts*)calloc(numArboles, sizeof(ArbolMcts));
+    if (arboles == NULL) {
+        printf("Error: No se pudo asignar memoria para los árboles de búsqueda\n");
+        return false;
+    }
+    for (int i = 0; i < numArboles; i++) {
+        pthread_mutex_init(&arboles[i].mutex, NULL);
+    }
+
+    detenerPool = false;
+    for (int i = 0; i < hilosDeseados; i++) {
+        if (pthread_create(&hilos[i], NULL, funcionHiloMcts, (void*)(long)i) != 0) {
+            printf("Error al crear el hilo de búsqueda %d\n", i);
+            break;
+        }
+        numHilos++;
+    }
+
+    return numHilos > 0;
+}
+
+static void liberarMcts(void) {
+    if (numHilos == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexPool);
+    detenerPool = true;
+    pthread_cond_broadcast(&condTrabajo);
+    pthread_mutex_unlock(&mutexPool);
+
+    for (int i = 0; i < numHilos; i++) {
+        pthread_join(hilos[i], NULL);
+    }
+    numHilos = 0;
+
+    for (int i = 0; i < numArboles; i++) {
+        pthread_mutex_destroy(&arboles[i].mutex);
+    }
+    free(arboles);
+    arboles = NULL;
+    numArboles = 0;
+}
+
+void configurarHilosMcts(int hilosPedidos) {
+    hilosConfigurados = hilosPedidos;
+}
+
+/* --- Estrategia --- */
+
+/* Copiar lo que ve el jugador a la raíz de la búsqueda */
+static void construirRaiz(RaizMcts *raiz, const Jugador *jugador, const VistaPartida *vista) {
+    EstadoMcts *estado = &raiz->estado;
+    uint8_t restantes[CARTA_COMODIN + 1];
+    int barajas = barajasConfiguradas();
+
+    /* Copias de cada carta en el zapato de la partida */
+    memset(raiz, 0, sizeof(RaizMcts));
+    for (int c = 0; c < CARTA_COMODIN; c++) {
+        restantes[c] = (uint8_t)barajas;
+    }
+    restantes[CARTA_COMODIN] = (uint8_t)(barajas * COMODINES_POR_BARAJA);
+
+    estado->numJugadores = vista->numJugadores;
+    estado->turno = jugador->id;
+
+    /* Mano propia */
+    for (int i = 0; i < jugador->mano.numCartas; i++) {
+        uint8_t codigo = codificarCarta(jugador->mano.cartas[i]);
+        ponerCartaFirma(&estado->manos[jugador->id], codigo);
+        if (restantes[codigo] > 0) {
+            restantes[codigo]--;
+        }
+    }
+
+    /* Rivales: solo el número de cartas */
+    for (int j = 0; j < vista->numJugadores; j++) {
+        estado->numCartas[j] = (uint8_t)vista->jugadores[j].mano.numCartas;
+        estado->abierto[j] = vista->jugadores[j].primeraApeada;
+    }
+
+    /* Mesa: la de la transacción del turno (o la del torneo), que solo
+     * modifica este hilo */
+    for (int i = 0; i < vista->mesa->numApeadas; i++) {
+        const Apeada *apeada = apeadaEnTabla(vista->mesa, i);
+        const Carta *cartas = apeada->esGrupo ? apeada->jugada.grupo.cartas : apeada->jugada.escalera.cartas;
+        int numCartas = apeada->esGrupo ? apeada->jugada.grupo.numCartas : apeada->jugada.escalera.numCartas;
+
+        /* La mesa compacta guarda las primeras MAX_APEADAS; las cartas de
+         * todas dejan de ser desconocidas */
+        if (estado->numMesa < MAX_APEADAS) {
+            estado->mesa[estado->numMesa++] = compactarCartas(cartas, numCartas, apeada->esGrupo);
+        }
+        for (int c = 0; c < numCartas; c++) {
+            uint8_t codigo = codificarCarta(cartas[c]);
+            if (restantes[codigo] > 0) {
+                restantes[codigo]--;
+            }
+        }
+    }
+
+    /* Con más de 2 barajas las ocultas pueden pasar de MAX_CARTAS_MCTS: se
+     * toma una de cada total/MAX_CARTAS_MCTS, repartidas por todos los códigos */
+    int totalOcultas = 0, visto = 0;
+    for (int c = 0; c <= CARTA_COMODIN; c++) {
+        totalOcultas += restantes[c];
+    }
+    for (int c = 0; c <= CARTA_COMODIN; c++) {
+        for (int k = 0; k < restantes[c]; k++, visto++) {
+            if (totalOcultas > MAX_CARTAS_MCTS &&
+                (visto + 1) * MAX_CARTAS_MCTS / totalOcultas == visto * MAX_CARTAS_MCTS / totalOcultas) {
+                continue;
+            }
+            raiz->ocultas[raiz->numOcultas++] = (uint8_t)c;
+        }
+    }
+    raiz->cartasBanca = vista->cartasBanca;
+}
+
+/* Presupuesto de búsqueda a partir del quantum del turno */
+static double presupuestoMs(const Jugador *jugador) {
+    double ms = jugador->tiempoTurno > 0 ? (double)jugador->tiempoTurno / FRACCION_QUANTUM_MCTS
+                                         : PRESUPUESTO_DEFECTO_MS;
+    if (jugador->tiempoRestante > 0 && ms > jugador->tiempoRestante / 2.0) {
+        ms = jugador->tiempoRestante / 2.0;
+    }
+    if (ms < PRESUPUESTO_MIN_MS) {
+        ms = PRESUPUESTO_MIN_MS;
+    }
+    if (ms > PRESUPUESTO_MAX_MS) {
+        ms = PRESUPUESTO_MAX_MS;
+    }
+    return ms;
+}
+
+static void iniciarTurnoMcts(Jugador *jugador, const VistaPartida *vista) {
+    macroJugador[jugador->id] = MACRO_BASE;
+
+    pthread_mutex_lock(&mutexBusqueda);
+    if (!iniciarPool()) {
+        pthread_mutex_unlock(&mutexBusqueda);
+        return;
+    }
+
+    double inicio = ahoraSegundos();
+    construirRaiz(&raizActual, jugador, vista);
+    for (int i = 0; i < numArboles; i++) {
+        arboles[i].numNodos = 0;
+        nuevoNodo(&arboles[i]);
+    }
+
+    /* Despertar a los hilos y esperar a que agoten el presupuesto */
+    pthread_mutex_lock(&mutexPool);
+    limiteActual = inicio + presupuestoMs(jugador) / 1000.0;
+    hilosOcupados = numHilos;
+    generacion++;
+    pthread_cond_broadcast(&condTrabajo);
+    while (hilosOcupados > 0) {
+        pthread_cond_wait(&condFin, &mutexPool);
+    }
+    pthread_mutex_unlock(&mutexPool);
+
+    /* Paralelismo de raíz: sumar las visitas de todos los árboles */
+    unsigned int visitas[NUM_MACROS] = {0};
+    for (int i = 0; i < numArboles; i++) {
+        NodoMcts *raiz = &arboles[i].nodos[0];
+        for (int a = 0; a < NUM_MACROS; a++) {
+            if (raiz->hijos[a] >= 0) {
+                visitas[a] += arboles[i].nodos[raiz->hijos[a]].visitas;
+            }
+        }
+    }
+    MacroMcts elegida = MACRO_BASE;
+    for (int a = 1; a < NUM_MACROS; a++) {
+        if (visitas[a] > visitas[elegida]) {
+            elegida = (MacroMcts)a;
+        }
+    }
+
+    macroJugador[jugador->id] = elegida;
+    eleccionesMacro[elegida]++;
+    busquedas++;
+    segundosBusqueda += ahoraSegundos() - inicio;
+    pthread_mutex_unlock(&mutexBusqueda);
+}
+
+/* Las decisiones del turno siguen la táctica elegida */
+static MacroMcts macroDe(const Jugador *jugador) {
+    return macroJugador[jugador->id];
+}
+
+static Apeada* aperturaMcts(Jugador *jugador, int *numApeadas) {
+    const Estrategia *delegada = buscarEstrategia(macroDe(jugador) == MACRO_BASE ? "base" : "reservada");
+    return delegada->elegirApertura(jugador, numApeadas);
+}
+
+static int emboneMcts(Jugador *jugador, TablaApeadas *mesa, const int *indices, int numIndices) {
+    const Estrategia *delegada = buscarEstrategia(macroDe(jugador) == MACRO_RESERVADA ? "reservada" : "base");
+    return delegada->elegirEmbone(jugador, mesa, indices, numIndices);
+}
+
+static Apeada* nuevaApeadaMcts(Jugador *jugador, int *numApeadas) {
+    MacroMcts macro = macroDe(jugador);
+
+    if (macro == MACRO_RETENER) {
+        ParticionMano particion;
+        *numApeadas = 0;
+        if (!resolverParticionFirma(&jugador->mano.resumen.firma, OBJ_MAX_CARTAS, &particion) ||
+            particion.cartas < jugador->mano.numCartas) {
+            return NULL;
+        }
+        return crearApeadasDeParticion(jugador, &particion, numApeadas);
+    }
+
+    const Estrategia *delegada = buscarEstrategia(macro == MACRO_BASE ? "base" : "reservada");
+    return delegada->elegirNuevaApeada(jugador, numApeadas);
+}
+
+static bool comerMcts(Jugador *jugador, const Banca *banca) {
+    (void)jugador;
+    return cartasEnBanca(banca) > 0;
+}
+
+static void imprimirEstadisticasMcts(void) {
+    if (busquedas == 0) {
+        return;
+    }
+    printf("    MCTS: %d hilos en %d árboles, %lu búsquedas de %.1f ms y %.0f simulaciones de media\n",
+           numHilos, numArboles, busquedas, 1000.0 * segundosBusqueda / busquedas,
+           (double)simulaciones / busquedas);
+    printf("    MCTS: %.0f simulaciones por segundo y núcleo; tácticas elegidas:",
+           segundosHilo > 0 ? simulaciones / segundosHilo : 0.0);
+    for (int a = 0; a < NUM_MACROS; a++) {
+        printf(" %s %lu", nombresMacro[a], eleccionesMacro[a]);
+    }
+    printf("\n");
+}
+
+const Estrategia estrategiaMcts = {
+    "mcts", "Busca cada turno con Monte Carlo entre las tácticas base, reservada y retener",
+    iniciarTurnoMcts, aperturaMcts, emboneMcts, nuevaApeadaMcts, comerMcts,
+    imprimirEstadisticasMcts, liberarMcts
+};
@@ -0,0 +1,79 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "jugadores.h"
+#include "mesa.h"
+#include "juego.h"
+#include "estrategia.h"
+
+/* Jugador por búsqueda de Monte Carlo en árbol sobre conjuntos de información.
+ *
+ * Al empezar su turno, el jugador copia lo que sabe de la partida a un
+ * EstadoMcts (su mano, la mesa, cuántas cartas tiene cada rival y cuántas
+ * quedan en la banca). Cada simulación reparte al azar las cartas que no ve
+ * entre las manos rivales y la banca (determinización), baja por el árbol
+ * eligiendo para cada turno una de las tácticas de MacroMcts y termina la
+ * partida con la táctica base. Al final se juega la táctica más visitada.
+ *
+ * Las simulaciones corren en un conjunto de hilos fijo: hay varios árboles
+ * independientes que se suman al final (paralelismo de raíz) y cada árbol
+ * lo comparten varios hilos (paralelismo de árbol), que se reparten las
+ * ramas con pérdida virtual. El tiempo de búsqueda sale del quantum que
+ * asignarTurno dio al jugador, así que un quantum mayor da más simulaciones */
+
+#define MAX_CARTAS_MCTS       108   /* 2 barajas + 4 comodines */
+#define MAX_HILOS_MCTS        16
+#define HILOS_POR_ARBOL_MCTS  2
+#define MAX_NODOS_MCTS        8192  /* Por árbol */
+#define RONDAS_ARBOL_MCTS     2     /* Profundidad del árbol, en vueltas de la mesa */
+#define MAX_TURNOS_SIMULACION 300
+#define FRACCION_QUANTUM_MCTS 20    /* Se busca durante quantum / 20 */
+#define PRESUPUESTO_MIN_MS    5
+#define PRESUPUESTO_MAX_MS    250
+#define PRESUPUESTO_DEFECTO_MS 20   /* Sin quantum asignado (modo torneo) */
+
+/* Tácticas entre las que elige la búsqueda en cada turno */
+typedef enum {
+    MACRO_BASE,         /* Bajar todo y embonar donde se pueda */
+    MACRO_RESERVADA,    /* Abrir con lo justo, guardar comodines, retener apeadas */
+    MACRO_RETENER,      /* Como la base, pero solo bajar apeadas nuevas si vacían la mano */
+    NUM_MACROS
+} MacroMcts;
+
+/* Apeada de la mesa reducida a lo que importa para los embones */
+typedef struct {
+    bool esGrupo;
+    uint8_t valor;      /* Grupo: valor común */
+    uint8_t palos;      /* Grupo: máscara de palos con carta natural */
+    uint8_t palo;       /* Escalera: índice del palo */
+    uint8_t inicio;     /* Escalera: primera posición ocupada (1-13) */
+    uint8_t fin;        /* Escalera: última posición ocupada (1-13) */
+    uint8_t cartas;     /* Cartas en la apeada */
+} ApeadaCompacta;
+
+/* Estado de la partida sin punteros: se copia con una asignación */
+typedef struct {
+    FirmaMano manos[MAX_JUGADORES];
+    uint8_t numCartas[MAX_JUGADORES];
+    bool abierto[MAX_JUGADORES];        /* Ya hizo la primera apeada */
+    ApeadaCompacta mesa[MAX_APEADAS];   /* Solo las primeras MAX_APEADAS de la mesa:
+                                         * las simulaciones no embonan en las demás
+                                         * ni bajan más jugadas con la mesa llena
+                                         * (las cartas de todas cuentan como vistas) */
+    int numMesa;
+    uint8_t banca[MAX_CARTAS_MCTS];     /* Cartas codificadas (ver mcts.c); se come del final */
+    int numBanca;
+    int numJugadores;
+    int turno;                          /* Jugador al que le toca */
+    int turnosSinAccion;                /* Turnos seguidos sin jugar ni comer */
+} EstadoMcts;
+
+/* Estrategia "mcts" para la tabla de estrategias */
+extern const Estrategia estrategiaMcts;
+
+/* Número de hilos de búsqueda (por defecto, los núcleos disponibles) */
+void configurarHilosMcts(int numHilos);
+
+#endif /* MCTS_H */
@@ -3,50 +3,494 @@
 #include <string.h>
 #include <limits.h>
 #include <time.h>
+#include <pthread.h>
 #include "memoria.h"
+#include "candados.h"
+#include "slab.h"
 #include "jugadores.h"
 #include "utilidades.h"
 #include "juego.h" // Cambio: Incluir juego.h en lugar de juego.c
+#include "trazamemoria.h"
 
-// Variable global para el gestor de memoria
+// Resultados de las asignaciones internas (si no, la dirección asignada)
+#define SIN_ESPACIO      -1
+#define SIN_PARTICIONES  -2
+
+// Resultados de crecer un proceso (si no, SIN_ESPACIO)
+#define CRECIO_EN_SITIO      0
+#define CRECIO_BLOQUE_NUEVO  1
+
+// Banco de pruebas de la memoria
+#define PROCESOS_BANCO_MEMORIA 16
+#define MUESTREO_BANCO_MEMORIA 64   // Operaciones entre medidas de la fragmentación
+#define PROCESOS_BANCO_REEMPLAZO 4
+#define PAGINAS_BANCO_REEMPLAZO  8  // Páginas de cada proceso (3 de ellas, las más usadas)
+#define PROCESOS_BANCO_TABLA     8
+#define PAGINAS_BANCO_TABLA      12 // 8 * 12 caben en la tabla de páginas
+#define MAX_HILOS_BANCO_CONTENCION 8
+#define FRANJAS_PAGINAS          16 // Candados de los aciertos de la TLB, por (proceso, página)
+
+// Variable global para el gestor de memoria (el de la partida)
 GestorMemoria gestorMemoria;
 
+// Gestor sobre el que trabaja cada hilo: el de la partida, salvo en los
+// hilos del reproductor de trazas, que usan cada uno el suyo
+static __thread GestorMemoria *gestor = &gestorMemoria;
+
+// Candados del gestor de la partida, que usan a la vez los hilos de los
+// jugadores (la E/S), el monitor de teclas y el panel. Se toman en este
+// orden, y mutexSlab antes que los dos:
+// - mutexParticiones: particiones, mapa de bits, compañeros, memoria
+//   disponible, bytes pedidos y algoritmo actual
+// - candadoPaginas: tabla de páginas, marcos, TLB y estado de las políticas.
+//   Un fallo puede desalojar la página de cualquier proceso y mueve la TLB y
+//   la manecilla, así que va en exclusiva. Un acierto de la TLB solo toca su
+//   página: va en compartido, con el candado de la franja de la página y
+//   los contadores atómicos
+// Los gestores propios de un hilo (los del reproductor de trazas) no los usan
+static pthread_mutex_t mutexParticiones = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t candadoPaginas = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t franjasPaginas[FRANJAS_PAGINAS] = {
+    [0 ... FRANJAS_PAGINAS - 1] = PTHREAD_MUTEX_INITIALIZER
+};
+
+// Darlos a conocer al perfil de candados (-DPERFILAR_CANDADOS)
+static void registrarCandadosMemoria(void) {
+    REGISTRAR_CANDADOS(&mutexParticiones, 1, "mutexParticiones");
+    REGISTRAR_CANDADOS(&candadoPaginas, 1, "candadoPaginas");
+    REGISTRAR_CANDADOS(franjasPaginas, FRANJAS_PAGINAS, "franjasPaginas");
+}
+
+static inline bool gestorCompartido(void) {
+    return gestor == &gestorMemoria;
+}
+
+static void bloquearParticiones(void) {
+    if (gestorCompartido()) {
+        BLOQUEAR(&mutexParticiones);
+    }
+}
+
+static void desbloquearParticiones(void) {
+    if (gestorCompartido()) {
+        DESBLOQUEAR(&mutexParticiones);
+    }
+}
+
+static void bloquearPaginas(void) {
+    if (gestorCompartido()) {
+        BLOQUEAR_ESCRITURA(&candadoPaginas);
+    }
+}
+
+static void desbloquearPaginas(void) {
+    if (gestorCompartido()) {
+        DESBLOQUEAR_RW(&candadoPaginas);
+    }
+}
+
+void bloquearMemoria(void) {
+    BLOQUEAR(&mutexParticiones);
+    BLOQUEAR_ESCRITURA(&candadoPaginas);
+}
+
+void desbloquearMemoria(void) {
+    DESBLOQUEAR_RW(&candadoPaginas);
+    DESBLOQUEAR(&mutexParticiones);
+}
+
 // Declaración de funciones auxiliares privadas
 void consolidarParticiones(void);
 
+static const char *nombreAlgoritmoMemoria(int algoritmo) {
+    switch (algoritmo) {
+        case ALG_AJUSTE_OPTIMO: return "Ajuste Óptimo";
+        case ALG_LRU:           return "LRU (Least Recently Used)";
+        case ALG_MAPA_BITS:     return "Mapa de Bits";
+        case ALG_BUDDY:         return "Sistema de Compañeros";
+        default:                return "Desconocido";
+    }
+}
+
+//---------------------- Sistema de compañeros (buddy) -----------------------
+
+// Bit del par de compañeros al que pertenece el bloque en un orden. Los pares
+// de cada orden van seguidos: NUM_BLOQUES_BUDDY / 2 del orden 0, la mitad del
+// orden 1... (el orden máximo no tiene compañero)
+static int bitParBuddy(int bloque, int orden) {
+    return NUM_BLOQUES_BUDDY - (NUM_BLOQUES_BUDDY >> orden) + (bloque >> (orden + 1));
+}
+
+// El bloque pasa de libre a ocupado o al revés: cambiar el bit de su par y
+// devolverlo. Queda a 0 si los dos compañeros están libres (o ninguno)
+static bool alternarParBuddy(int bloque, int orden) {
+    int bit = bitParBuddy(bloque, orden);
+    gestor->paresBuddy[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+    return (gestor->paresBuddy[bit / 8] >> (bit % 8)) & 1;
+}
+
+static void enlazarLibreBuddy(int bloque, int orden) {
+    int primero = gestor->libreBuddy[orden];
+    gestor->anteriorBuddy[bloque] = -1;
+    gestor->siguienteBuddy[bloque] = primero;
+    if (primero != -1) {
+        gestor->anteriorBuddy[primero] = bloque;
+    }
+    gestor->libreBuddy[orden] = bloque;
+}
+
+static void desenlazarLibreBuddy(int bloque, int orden) {
+    int anterior = gestor->anteriorBuddy[bloque];
+    int siguiente = gestor->siguienteBuddy[bloque];
+    if (anterior != -1) {
+        gestor->siguienteBuddy[anterior] = siguiente;
+    } else {
+        gestor->libreBuddy[orden] = siguiente;
+    }
+    if (siguiente != -1) {
+        gestor->anteriorBuddy[siguiente] = anterior;
+    }
+}
+
+// Menor orden cuyo bloque contiene la cantidad, o -1 si no cabe en la memoria
+static int ordenParaBuddy(int cantidad) {
+    for (int orden = 0; orden <= ORDEN_MAXIMO_BUDDY; orden++) {
+        if ((TAMANO_MINIMO_BUDDY << orden) >= cantidad) {
+            return orden;
+        }
+    }
+    return -1;
+}
+
+// Tomar el primer bloque libre del menor orden suficiente y partirlo hasta el
+// orden pedido: cada mitad superior va a la lista de su orden. O(log n)
+static int asignarBuddy(int idProceso, int cantidad) {
+    int orden = ordenParaBuddy(cantidad);
+    if (orden < 0) {
+        return SIN_ESPACIO;
+    }
+
+    int ordenLibre = orden;
+    while (ordenLibre <= ORDEN_MAXIMO_BUDDY && gestor->libreBuddy[ordenLibre] == -1) {
+        ordenLibre++;
+    }
+    if (ordenLibre > ORDEN_MAXIMO_BUDDY) {
+        return SIN_ESPACIO;
+    }
+
+    int bloque = gestor->libreBuddy[ordenLibre];
+    desenlazarLibreBuddy(bloque, ordenLibre);
+    if (ordenLibre < ORDEN_MAXIMO_BUDDY) {
+        alternarParBuddy(bloque, ordenLibre);
+    }
+    while (ordenLibre > orden) {
+        ordenLibre--;
+        int mitad = bloque + (1 << ordenLibre);
+        enlazarLibreBuddy(mitad, ordenLibre);
+        alternarParBuddy(mitad, ordenLibre);
+    }
+
+    gestor->ordenBuddy[bloque] = (signed char)orden;
+    gestor->procesoBuddy[bloque] = idProceso;
+    gestor->usadoBuddy[bloque] = (short)cantidad;
+    gestor->memoriaDisponible -= TAMANO_MINIMO_BUDDY << orden;
+    return bloque * TAMANO_MINIMO_BUDDY;
+}
+
+// Devolver un bloque ocupado y fusionarlo con su compañero mientras el bit
+// del par diga que este también está libre. O(log n)
+static void soltarBloqueBuddy(int bloque) {
+    int orden = gestor->ordenBuddy[bloque];
+
+    gestor->ordenBuddy[bloque] = -1;
+    gestor->procesoBuddy[bloque] = -1;
+    gestor->usadoBuddy[bloque] = 0;
+    gestor->memoriaDisponible += TAMANO_MINIMO_BUDDY << orden;
+
+    while (orden < ORDEN_MAXIMO_BUDDY) {
+        if (alternarParBuddy(bloque, orden)) {
+            break; // El compañero está ocupado o partido
+        }
+        // Los dos libres: el par deja de estarlo al fusionarse y su bit vuelve a 0
+        int companero = bloque ^ (1 << orden);
+        desenlazarLibreBuddy(companero, orden);
+        bloque &= companero;
+        orden++;
+    }
+    enlazarLibreBuddy(bloque, orden);
+}
+
+static int liberarBuddy(int idProceso) {
+    int bytesLiberados = 0;
+
+    for (int b = 0; b < NUM_BLOQUES_BUDDY; b++) {
+        if (gestor->ordenBuddy[b] >= 0 && gestor->procesoBuddy[b] == idProceso) {
+            bytesLiberados += TAMANO_MINIMO_BUDDY << gestor->ordenBuddy[b];
+            soltarBloqueBuddy(b);
+        }
+    }
+    return bytesLiberados;
+}
+
+// Crecer dentro de un bloque del proceso que tenga sitio sin usar
+static bool crecerEnBloqueBuddy(int idProceso, int cantidadAdicional) {
+    for (int b = 0; b < NUM_BLOQUES_BUDDY; b++) {
+        if (gestor->ordenBuddy[b] >= 0 && gestor->procesoBuddy[b] == idProceso &&
+            (TAMANO_MINIMO_BUDDY << gestor->ordenBuddy[b]) - gestor->usadoBuddy[b] >= cantidadAdicional) {
+            gestor->usadoBuddy[b] += cantidadAdicional;
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Proceso %d creció en %d bytes dentro de su bloque de %d bytes (dirección %d)\n",
+                   idProceso, cantidadAdicional, TAMANO_MINIMO_BUDDY << gestor->ordenBuddy[b], b * TAMANO_MINIMO_BUDDY);
+            return true;
+        }
+    }
+    return false;
+}
+
+//---------------------- Ajuste Óptimo y Mapa de Bits -----------------------
+
+// Buscar la partición libre de MENOR tamaño que pueda contener el proceso
+static int asignarAjusteOptimo(int idProceso, int cantidadRequerida) {
+    int indiceOptimo = -1;
+    int tamanoOptimo = INT_MAX;
+
+    for (int i = 0; i < gestor->numParticiones; i++) {
+        if (gestor->particiones[i].libre &&
+            gestor->particiones[i].tamano >= cantidadRequerida) {
+
+            // CORRECCIÓN: Buscar el MENOR tamaño que sea >= cantidadRequerida
+            if (gestor->particiones[i].tamano < tamanoOptimo) {
+                tamanoOptimo = gestor->particiones[i].tamano;
+                indiceOptimo = i;
+            }
+        }
+    }
+
+    if (indiceOptimo == -1) {
+        return SIN_ESPACIO;
+    }
+
+    // Obtener la partición seleccionada
+    Particion *particion = &gestor->particiones[indiceOptimo];
+
+    // Si la partición es mayor que lo pedido, dividirla
+    if (particion->tamano != cantidadRequerida) {
+        if (gestor->numParticiones >= MAX_PARTICIONES) {
+            return SIN_PARTICIONES;
+        }
+
+        // Hacer espacio para la nueva partición
+        for (int i = gestor->numParticiones; i > indiceOptimo + 1; i--) {
+            gestor->particiones[i] = gestor->particiones[i - 1];
+        }
+
+        // Crear la nueva partición libre restante
+        gestor->particiones[indiceOptimo + 1].inicio = particion->inicio + cantidadRequerida;
+        gestor->particiones[indiceOptimo + 1].tamano = particion->tamano - cantidadRequerida;
+        gestor->particiones[indiceOptimo + 1].idProceso = -1;
+        gestor->particiones[indiceOptimo + 1].libre = true;
+
+        particion->tamano = cantidadRequerida;
+        gestor->numParticiones++;
+    }
+
+    particion->libre = false;
+    particion->idProceso = idProceso;
+    gestor->memoriaDisponible -= cantidadRequerida;
+    return particion->inicio;
+}
+
+static int liberarAjusteOptimo(int idProceso) {
+    int bytesLiberados = 0;
+
+    for (int i = 0; i < gestor->numParticiones; i++) {
+        if (gestor->particiones[i].idProceso == idProceso) {
+            // Liberar esta partición
+            gestor->particiones[i].libre = true;
+            gestor->particiones[i].idProceso = -1; // Marcar como libre
+            gestor->memoriaDisponible += gestor->particiones[i].tamano;
+            bytesLiberados += gestor->particiones[i].tamano;
+
+            // Fusionar con particiones libres adyacentes. Los índices cambian,
+            // así que se vuelve a recorrer desde el principio
+            consolidarParticiones();
+            i = -1;
+        }
+    }
+    return bytesLiberados;
+}
+
+static int asignarMapaBits(int idProceso, int cantidadRequerida) {
+    int numBloquesRequeridos = (cantidadRequerida + gestor->tamanoBloque - 1) / gestor->tamanoBloque;
+    int bloquesLibresConsecutivos = 0;
+    int inicioBloqueLibre = -1;
+
+    for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
+        if (gestor->mapaBits[i] == BLOQUE_LIBRE_BITMAP) {
+            if (inicioBloqueLibre == -1) {
+                inicioBloqueLibre = i;
+            }
+            bloquesLibresConsecutivos++;
+            if (bloquesLibresConsecutivos == numBloquesRequeridos) {
+                for (int j = 0; j < numBloquesRequeridos; j++) {
+                    gestor->mapaBits[inicioBloqueLibre + j] = (unsigned char)idProceso;
+                }
+                gestor->memoriaDisponible -= numBloquesRequeridos * gestor->tamanoBloque;
+                return inicioBloqueLibre * gestor->tamanoBloque;
+            }
+        } else {
+            bloquesLibresConsecutivos = 0;
+            inicioBloqueLibre = -1;
+        }
+    }
+    return SIN_ESPACIO;
+}
+
+static int liberarMapaBits(int idProceso) {
+    int bytesLiberados = 0;
+
+    for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
+        if (gestor->mapaBits[i] == (unsigned char)idProceso) { // Encontró un bloque que pertenece a este proceso
+            gestor->mapaBits[i] = BLOQUE_LIBRE_BITMAP;
+            gestor->memoriaDisponible += gestor->tamanoBloque;
+            bytesLiberados += gestor->tamanoBloque;
+        }
+    }
+    return bytesLiberados;
+}
+
+// Asignar con un algoritmo de particionamiento sin mensajes: la dirección,
+// SIN_ESPACIO o SIN_PARTICIONES
+static int asignarConAlgoritmo(int algoritmo, int idProceso, int cantidadRequerida) {
+    switch (algoritmo) {
+        case ALG_AJUSTE_OPTIMO: return asignarAjusteOptimo(idProceso, cantidadRequerida);
+        case ALG_MAPA_BITS:     return asignarMapaBits(idProceso, cantidadRequerida);
+        case ALG_BUDDY:         return asignarBuddy(idProceso, cantidadRequerida);
+        default:                return SIN_ESPACIO;
+    }
+}
+
+// Liberar toda la memoria de un proceso sin mensajes; devuelve los bytes
+static int liberarConAlgoritmo(int algoritmo, int idProceso) {
+    switch (algoritmo) {
+        case ALG_AJUSTE_OPTIMO: return liberarAjusteOptimo(idProceso);
+        case ALG_MAPA_BITS:     return liberarMapaBits(idProceso);
+        case ALG_BUDDY:         return liberarBuddy(idProceso);
+        default:                return 0;
+    }
+}
+
+static void sumarSolicitada(int idProceso, int cantidad) {
+    if (idProceso >= 0 && idProceso < MAX_PROCESOS_MEMORIA) {
+        gestor->solicitadaProceso[idProceso] += cantidad;
+    }
+}
+
+// Dejar toda la memoria libre en las estructuras de los tres algoritmos de
+// particionamiento
+static void reiniciarParticionamiento(void) {
+    gestor->tamanoBloque = TAMANO_BLOQUE_BITMAP;
+    // Crear partición inicial que abarca toda la memoria
+    gestor->particiones[0].inicio = 0;
+    gestor->particiones[0].tamano = MEM_TOTAL_SIZE;
+    gestor->particiones[0].idProceso = -1;
+    gestor->particiones[0].libre = true;
+    gestor->numParticiones = 1;
+
+    memset(gestor->mapaBits, BLOQUE_LIBRE_BITMAP, sizeof(gestor->mapaBits));
+
+    // Un solo bloque libre del orden máximo y todos los pares a 0
+    for (int orden = 0; orden <= ORDEN_MAXIMO_BUDDY; orden++) {
+        gestor->libreBuddy[orden] = -1;
+    }
+    for (int b = 0; b < NUM_BLOQUES_BUDDY; b++) {
+        gestor->ordenBuddy[b] = -1;
+        gestor->procesoBuddy[b] = -1;
+        gestor->usadoBuddy[b] = 0;
+    }
+    memset(gestor->paresBuddy, 0, sizeof(gestor->paresBuddy));
+    enlazarLibreBuddy(0, ORDEN_MAXIMO_BUDDY);
+
+    memset(gestor->solicitadaProceso, 0, sizeof(gestor->solicitadaProceso));
+    gestor->memoriaDisponible = MEM_TOTAL_SIZE;
+}
+
+void reiniciarMemoria(int algoritmo) {
+    bloquearParticiones();
+    reiniciarParticionamiento();
+    gestor->algoritmoActual = algoritmo;
+    desbloquearParticiones();
+}
+
+void usarGestorMemoria(GestorMemoria *propio) {
+    gestor = propio != NULL ? propio : &gestorMemoria;
+}
+
+int reservarBloqueMemoria(int idProceso, int cantidad) {
+    int direccion = -1;
+
+    bloquearParticiones();
+    int algoritmo = gestor->algoritmoActual;
+    grabarEventoMemoria(TRAZA_ASIGNAR, idProceso, 0, cantidad);
+
+    if (cantidad > 0 && cantidad <= gestor->memoriaDisponible &&
+        (algoritmo == ALG_AJUSTE_OPTIMO || algoritmo == ALG_MAPA_BITS || algoritmo == ALG_BUDDY)) {
+        direccion = asignarConAlgoritmo(algoritmo, idProceso, cantidad);
+        if (direccion >= 0) {
+            sumarSolicitada(idProceso, cantidad);
+        } else {
+            direccion = -1;
+        }
+    }
+    desbloquearParticiones();
+    return direccion;
+}
+
+int devolverMemoriaProceso(int idProceso) {
+    bloquearParticiones();
+    grabarEventoMemoria(TRAZA_LIBERAR, idProceso, 0, 0);
+
+    // El proceso puede tener memoria de antes de un cambio de algoritmo:
+    // se libera de las estructuras de los tres
+    int bytesLiberados = liberarConAlgoritmo(ALG_AJUSTE_OPTIMO, idProceso) +
+                         liberarConAlgoritmo(ALG_MAPA_BITS, idProceso) +
+                         liberarConAlgoritmo(ALG_BUDDY, idProceso);
+
+    if (idProceso >= 0 && idProceso < MAX_PROCESOS_MEMORIA) {
+        gestor->solicitadaProceso[idProceso] = 0;
+    }
+    desbloquearParticiones();
+    return bytesLiberados;
+}
+
 // Inicializar el sistema de memoria
 void inicializarMemoria(void) {
-    // Inicializar las particiones para ajuste óptimo
-    memset(&gestorMemoria, 0, NUM_BLOQUES_BITMAP);
-    gestorMemoria.tamanoBloque = TAMANO_BLOQUE_BITMAP;
-    // Crear partición inicial que abarca toda la memoria
-    gestorMemoria.particiones[0].inicio = 0;
-    gestorMemoria.particiones[0].tamano = MEM_TOTAL_SIZE;
-    gestorMemoria.particiones[0].idProceso = -1;
-    gestorMemoria.particiones[0].libre = true;
-    
-    gestorMemoria.numParticiones = 1;
-    gestorMemoria.memoriaDisponible = MEM_TOTAL_SIZE;
-    gestorMemoria.algoritmoActual = ALG_AJUSTE_OPTIMO;
+    // CORRECCIÓN: limpiar la estructura entera (antes solo los primeros
+    // NUM_BLOQUES_BITMAP bytes) y marcar libres los bloques del mapa de bits
+    memset(gestor, 0, sizeof(*gestor));
+    registrarCandadosMemoria();
+    reiniciarParticionamiento();
+    reiniciarSlabs();
+    gestor->algoritmoActual = ALG_AJUSTE_OPTIMO;
     
     // Inicializar la memoria virtual
     inicializarMemoriaVirtual();
     
     // Seleccionar aleatoriamente dos procesos que pueden crecer
-    gestorMemoria.creceProc1 = rand() % MAX_JUGADORES;
+    gestor->creceProc1 = rand() % MAX_JUGADORES;
     do {
-        gestorMemoria.creceProc2 = rand() % MAX_JUGADORES;
-    } while (gestorMemoria.creceProc2 == gestorMemoria.creceProc1);
+        gestor->creceProc2 = rand() % MAX_JUGADORES;
+    } while (gestor->creceProc2 == gestor->creceProc1);
     
-    colorVerde();
-    printf("Sistema de memoria inicializado: %d bytes disponibles\n", MEM_TOTAL_SIZE);
-    printf("Procesos que pueden crecer: %d y %d\n", gestorMemoria.creceProc1, gestorMemoria.creceProc2);
-    colorReset();
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE,
+                          "Sistema de memoria inicializado: %d bytes disponibles\n"
+                          "Procesos que pueden crecer: %d y %d\n",
+                          MEM_TOTAL_SIZE, gestor->creceProc1, gestor->creceProc2);
     
     // Registrar evento
     registrarEvento("Sistema de memoria inicializado: %d bytes disponibles", MEM_TOTAL_SIZE);
-    registrarEvento("Procesos que pueden crecer: %d y %d", gestorMemoria.creceProc1, gestorMemoria.creceProc2);
+    registrarEvento("Procesos que pueden crecer: %d y %d", gestor->creceProc1, gestor->creceProc2);
 }
+
 bool asignarMemoriaES(int idProceso) {
     // En lugar de intentar acceder directamente a jugadores para saber el número de cartas,
     // vamos a simular una cantidad de memoria requerida basada en una base fija
@@ -60,9 +504,10 @@ bool asignarMemoriaES(int idProceso) {
     int numCartasSimuladas = 5 + (rand() % 8); // Simula entre 5 y 12 "cartas" procesadas
     int cantidadRequerida = memoriaBase + (numCartasSimuladas * memoriaPorCartaSimulada);
     
-    // Llamar a la función principal de asignación de memoria con el algoritmo actual
-    // Esta función usará Ajuste Óptimo o Mapa de Bits según esté configurado gestorMemoria.algoritmoActual
-    bool asignado = asignarMemoria(idProceso, cantidadRequerida);
+    // Con los slabs (por defecto), la petición sale de su clase de tamaño sin
+    // buscar en el algoritmo; si no, va al algoritmo actual
+    bool asignado = slabESActivo() ? asignarMemoriaSlab(idProceso, cantidadRequerida)
+                                   : asignarMemoria(idProceso, cantidadRequerida);
     
     // Si la asignación inicial tuvo éxito, y si este proceso es uno de los que pueden crecer,
     // intentar simular un crecimiento en su necesidad de memoria.
@@ -73,18 +518,20 @@ bool asignarMemoriaES(int idProceso) {
     // como con Mapa de Bits si ambos algoritmos manejan crecimiento.
     // Si crecerProceso solo fue implementado para un algoritmo, esta parte solo será efectiva con ese.
     
-    if (asignado && (idProceso == gestorMemoria.creceProc1 || idProceso == gestorMemoria.creceProc2)) {
+    if (asignado && (idProceso == gestor->creceProc1 || idProceso == gestor->creceProc2)) {
         
         // Calcular crecimiento (aleatorio entre 10 y 30 bytes adicionales solicitados)
         int crecimiento = (rand() % 21) + 10;
         
-        colorMagenta();
-        printf("El proceso %d (autorizado para crecer) intentará solicitar crecimiento en %d bytes\n", idProceso, crecimiento);
-        colorReset();
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_MAGENTA, "El proceso %d (autorizado para crecer) intentará solicitar crecimiento en %d bytes\n", idProceso, crecimiento);
         
         // Intentar hacer crecer el proceso. La implementación de crecerProceso
         // es responsable de cómo maneja esta solicitud con el algoritmo actual.
-        crecerProceso(idProceso, crecimiento);
+        if (slabESActivo()) {
+            crecerMemoriaSlab(idProceso, crecimiento);
+        } else {
+            crecerProceso(idProceso, crecimiento);
+        }
     }
     
     return asignado; // Retorna si la asignación inicial fue exitosa
@@ -92,71 +539,26 @@ bool asignarMemoriaES(int idProceso) {
 
 // Implementación de la función liberarMemoria actualizada
 void liberarMemoria(int idProceso) {
-    bool liberada = false;
-    int bytesLiberados = 0;
-
-    if (gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO) {
-        // Lógica para Ajuste Óptimo (la que ya tenías)
-        for (int i = 0; i < gestorMemoria.numParticiones; i++) {
-            if (gestorMemoria.particiones[i].idProceso == idProceso) {
-                // Liberar esta partición
-                int tamanoLiberado = gestorMemoria.particiones[i].tamano;
-                gestorMemoria.particiones[i].libre = true;
-                gestorMemoria.particiones[i].idProceso = -1; // Marcar como libre
-                gestorMemoria.memoriaDisponible += tamanoLiberado;
-                bytesLiberados += tamanoLiberado;
-                liberada = true;
-
-                colorAmarillo();
-                printf("Memoria liberada (Ajuste Óptimo): Proceso %d, %d bytes\n", idProceso, tamanoLiberado);
-                colorReset();
-
-                // Fusionar con particiones libres adyacentes (solo para Ajuste Óptimo)
-                consolidarParticiones();
-                // Después de consolidar, es posible que el índice 'i' ya no sea válido para la siguiente iteración
-                // Podrías necesitar reiniciar el bucle o ajustar 'i'.
-                // Para simplificar, re-verificamos todas las particiones después de consolidar.
-                i = -1; // Reiniciar el bucle para volver a verificar desde el principio
-            }
-        }
-         if (!liberada) {
-             printf("No se encontró memoria asignada al proceso %d para liberar con Ajuste Óptimo.\n", idProceso);
-         }
-
-    } else if (gestorMemoria.algoritmoActual == ALG_MAPA_BITS) {
-        // Lógica para Mapa de Bits
-        int bloquesLiberados = 0;
-        for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
-            if (gestorMemoria.mapaBits[i] == idProceso) { // Encontró un bloque que pertenece a este proceso
-                gestorMemoria.mapaBits[i] = -1; // Marcar como libre (-1 indica libre)
-                gestorMemoria.memoriaDisponible += gestorMemoria.tamanoBloque;
-                bloquesLiberados++;
-                liberada = true;
-            }
-        }
+    int algoritmo = __atomic_load_n(&gestor->algoritmoActual, __ATOMIC_RELAXED);
 
-        if (liberada) {
-             bytesLiberados = bloquesLiberados * gestorMemoria.tamanoBloque;
-             colorAmarillo();
-             printf("Memoria liberada (Mapa de Bits): Proceso %d, %d bloques (%d bytes)\n",
-                    idProceso, bloquesLiberados, bytesLiberados);
-             colorReset();
-        } else {
-             printf("No se encontró memoria asignada al proceso %d para liberar con Mapa de Bits.\n", idProceso);
-        }
-
-    } else {
+    if (algoritmo != ALG_AJUSTE_OPTIMO && algoritmo != ALG_MAPA_BITS && algoritmo != ALG_BUDDY) {
         // Manejar caso de algoritmo no válido
         printf("Error: Algoritmo de liberación de memoria desconocido\n");
         // Asumiendo que la memoria no se libera si el algoritmo es desconocido
         return;
     }
 
-    if (liberada) {
+    int bytesLiberados = devolverMemoriaProceso(idProceso);
+
+    if (bytesLiberados > 0) {
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Memoria liberada (%s): Proceso %d, %d bytes\n",
+                              nombreAlgoritmoMemoria(algoritmo), idProceso, bytesLiberados);
         // Registrar evento
         registrarEvento("Memoria liberada: Proceso %d, %d bytes (Algoritmo: %s)", idProceso, bytesLiberados,
-                       gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO ? "Ajuste Óptimo" :
-                       (gestorMemoria.algoritmoActual == ALG_MAPA_BITS ? "Mapa de Bits" : "Desconocido"));
+                        nombreAlgoritmoMemoria(algoritmo));
+    } else {
+        imprimirRegistro(REGISTRO_DETALLE, "No se encontró memoria asignada al proceso %d para liberar con %s.\n",
+                         idProceso, nombreAlgoritmoMemoria(algoritmo));
     }
 
     // También liberar páginas virtuales (esto aplica independientemente del algoritmo de particionamiento)
@@ -168,19 +570,19 @@ void liberarMemoria(int idProceso) {
 void consolidarParticiones(void) {
     int i = 0;
     
-    while (i < gestorMemoria.numParticiones - 1) {
+    while (i < gestor->numParticiones - 1) {
         // Si esta partición y la siguiente están libres
-        if (gestorMemoria.particiones[i].libre && gestorMemoria.particiones[i + 1].libre) {
+        if (gestor->particiones[i].libre && gestor->particiones[i + 1].libre) {
             // Fusionar las particiones
-            gestorMemoria.particiones[i].tamano += gestorMemoria.particiones[i + 1].tamano;
+            gestor->particiones[i].tamano += gestor->particiones[i + 1].tamano;
             
             // Eliminar la partición siguiente
-            for (int j = i + 1; j < gestorMemoria.numParticiones - 1; j++) {
-                gestorMemoria.particiones[j] = gestorMemoria.particiones[j + 1];
+            for (int j = i + 1; j < gestor->numParticiones - 1; j++) {
+                gestor->particiones[j] = gestor->particiones[j + 1];
             }
             
             // Reducir el número de particiones
-            gestorMemoria.numParticiones--;
+            gestor->numParticiones--;
             
             // No incrementar i para verificar si hay más particiones adyacentes
         } else {
@@ -192,189 +594,119 @@ void consolidarParticiones(void) {
 
 // Implementación de la función asignarMemoria actualizada
 bool asignarMemoria(int idProceso, int cantidadRequerida) {
+    int direccionAsignada = SIN_ESPACIO;
+
+    // Los mensajes, fuera del candado: basta con lo que se vio dentro
+    bloquearParticiones();
+    grabarEventoMemoria(TRAZA_ASIGNAR, idProceso, 0, cantidadRequerida);
+    int disponible = gestor->memoriaDisponible;
+    int algoritmo = gestor->algoritmoActual;
+    bool algoritmoValido = algoritmo == ALG_AJUSTE_OPTIMO || algoritmo == ALG_MAPA_BITS || algoritmo == ALG_BUDDY;
+    if (cantidadRequerida > 0 && cantidadRequerida <= disponible && algoritmoValido) {
+        direccionAsignada = asignarConAlgoritmo(algoritmo, idProceso, cantidadRequerida);
+        if (direccionAsignada >= 0) {
+            sumarSolicitada(idProceso, cantidadRequerida);
+        }
+    }
+    desbloquearParticiones();
+
     if (cantidadRequerida <= 0) {
         printf("Error: La cantidad de memoria solicitada debe ser mayor que cero\n");
         return false;
     }
 
-    if (cantidadRequerida > gestorMemoria.memoriaDisponible) {
+    if (cantidadRequerida > disponible) {
         printf("Error: No hay suficiente memoria disponible (%d solicitados, %d disponibles)\n",
-               cantidadRequerida, gestorMemoria.memoriaDisponible);
+               cantidadRequerida, disponible);
         return false;
     }
 
-    bool asignado = false;
-    int direccionAsignada = -1;
-
-    if (gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO) {
-        // CORRECCIÓN: Buscar la partición libre de MENOR tamaño que pueda contener el proceso
-        int indiceOptimo = -1;
-        int tamanoOptimo = INT_MAX;
-
-        for (int i = 0; i < gestorMemoria.numParticiones; i++) {
-            if (gestorMemoria.particiones[i].libre &&
-                gestorMemoria.particiones[i].tamano >= cantidadRequerida) {
-
-                // CORRECCIÓN: Buscar el MENOR tamaño que sea >= cantidadRequerida
-                if (gestorMemoria.particiones[i].tamano < tamanoOptimo) {
-                    tamanoOptimo = gestorMemoria.particiones[i].tamano;
-                    indiceOptimo = i;
-                }
-            }
-        }
+    if (!algoritmoValido) {
+        return false;
+    }
 
-        if (indiceOptimo == -1) {
+    if (direccionAsignada == SIN_PARTICIONES) {
+        printf("Error (Ajuste Óptimo): Se alcanzó el límite máximo de particiones\n");
+        return false;
+    }
+    if (direccionAsignada == SIN_ESPACIO) {
+        if (algoritmo == ALG_AJUSTE_OPTIMO) {
             printf("Error (Ajuste Óptimo): No se encontró una partición adecuada para %d bytes\n", cantidadRequerida);
-            asignado = false;
+        } else if (algoritmo == ALG_MAPA_BITS) {
+            printf("Error (Mapa de Bits): No se encontró espacio contiguo para %d bytes\n", cantidadRequerida);
         } else {
-            // Obtener la partición seleccionada
-            Particion *particion = &gestorMemoria.particiones[indiceOptimo];
-
-            // Si la partición es exactamente del tamaño requerido
-            if (particion->tamano == cantidadRequerida) {
-                particion->libre = false;
-                particion->idProceso = idProceso;
-                direccionAsignada = particion->inicio;
-            }
-            // Si la partición es mayor, dividirla
-            else {
-                if (gestorMemoria.numParticiones >= MAX_PARTICIONES) {
-                     printf("Error (Ajuste Óptimo): Se alcanzó el límite máximo de particiones\n");
-                     return false;
-                }
-
-                // Hacer espacio para la nueva partición
-                for (int i = gestorMemoria.numParticiones; i > indiceOptimo + 1; i--) {
-                    gestorMemoria.particiones[i] = gestorMemoria.particiones[i - 1];
-                }
-
-                // Crear la nueva partición libre restante
-                gestorMemoria.particiones[indiceOptimo + 1].inicio = particion->inicio + cantidadRequerida;
-                gestorMemoria.particiones[indiceOptimo + 1].tamano = particion->tamano - cantidadRequerida;
-                gestorMemoria.particiones[indiceOptimo + 1].idProceso = -1;
-                gestorMemoria.particiones[indiceOptimo + 1].libre = true;
-
-                // Ajustar la partición original para el proceso
-                particion->tamano = cantidadRequerida;
-                particion->libre = false;
-                particion->idProceso = idProceso;
-                direccionAsignada = particion->inicio;
-
-                gestorMemoria.numParticiones++;
-            }
-
-            gestorMemoria.memoriaDisponible -= cantidadRequerida;
-            asignado = true;
+            printf("Error (Sistema de Compañeros): No hay un bloque libre de %d bytes para %d bytes\n",
+                   cantidadRequerida <= MEM_TOTAL_SIZE ? TAMANO_MINIMO_BUDDY << ordenParaBuddy(cantidadRequerida) : cantidadRequerida,
+                   cantidadRequerida);
         }
+        return false;
+    }
 
-    } else if (gestorMemoria.algoritmoActual == ALG_MAPA_BITS) {
-        // Lógica para Mapa de Bits (ya implementada correctamente)
-        int numBloquesRequeridos = (cantidadRequerida + gestorMemoria.tamanoBloque - 1) / gestorMemoria.tamanoBloque;
-        int bloquesLibresConsecutivos = 0;
-        int inicioBloqueLibre = -1;
+    imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Memoria asignada: Proceso %d, %d bytes, dirección %d (Algoritmo: %s)\n",
+           idProceso, cantidadRequerida, direccionAsignada, nombreAlgoritmoMemoria(algoritmo));
+    registrarEvento("Memoria asignada: Proceso %d, %d bytes, dirección %d (Algoritmo: %s)",
+                    idProceso, cantidadRequerida, direccionAsignada, nombreAlgoritmoMemoria(algoritmo));
+    return true;
+}
+// Hacer crecer un proceso sin mensajes: en su sitio si se puede (dentro de
+// su bloque de compañeros o sobre la partición libre que sigue a una suya)
+// y, si no, con un bloque nuevo. En la partición, si creció en su sitio, la
+// partición que creció (o -1)
+static int crecerConAlgoritmo(int algoritmo, int idProceso, int cantidadAdicional, int *particion) {
+    bool tieneParticion = false;
 
-        for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
-            if (gestorMemoria.mapaBits[i] == -1) {
-                if (inicioBloqueLibre == -1) {
-                    inicioBloqueLibre = i;
-                }
-                bloquesLibresConsecutivos++;
-                if (bloquesLibresConsecutivos == numBloquesRequeridos) {
-                    for (int j = 0; j < numBloquesRequeridos; j++) {
-                        gestorMemoria.mapaBits[inicioBloqueLibre + j] = idProceso;
-                    }
-                    gestorMemoria.memoriaDisponible -= numBloquesRequeridos * gestorMemoria.tamanoBloque;
-                    direccionAsignada = inicioBloqueLibre * gestorMemoria.tamanoBloque;
-                    asignado = true;
-                    break;
-                }
-            } else {
-                bloquesLibresConsecutivos = 0;
-                inicioBloqueLibre = -1;
-            }
-        }
+    *particion = -1;
 
-        if (!asignado) {
-             printf("Error (Mapa de Bits): No se encontró espacio contiguo para %d bytes\n", cantidadRequerida);
+    // Con el sistema de compañeros, el bloque suele tener sitio de sobra
+    // (la fragmentación interna): crecer ahí no gasta memoria nueva
+    if (algoritmo == ALG_BUDDY) {
+        if (crecerEnBloqueBuddy(idProceso, cantidadAdicional)) {
+            sumarSolicitada(idProceso, cantidadAdicional);
+            return CRECIO_EN_SITIO;
         }
+        tieneParticion = true;   // Si no, un bloque nuevo
     }
-
-    if (asignado) {
-         colorVerde();
-         printf("Memoria asignada: Proceso %d, %d bytes, dirección %d (Algoritmo: %s)\n",
-                idProceso, cantidadRequerida, direccionAsignada,
-                gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO ? "Ajuste Óptimo" : "Mapa de Bits");
-         colorReset();
-         registrarEvento("Memoria asignada: Proceso %d, %d bytes, dirección %d (Algoritmo: %s)",
-                        idProceso, cantidadRequerida, direccionAsignada,
-                        gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO ? "Ajuste Óptimo" : "Mapa de Bits");
-    }
-
-    return asignado;
-}
-// Permitir que un proceso crezca (requiere más memoria)
-bool crecerProceso(int idProceso, int cantidadAdicional) {
-    if (cantidadAdicional <= 0) {
-        printf("Error: La cantidad adicional debe ser mayor que cero\n");
-        return false;
-    }
-    
-    // Verificar si el proceso es uno de los que pueden crecer
-    if (idProceso != gestorMemoria.creceProc1 && idProceso != gestorMemoria.creceProc2) {
-        colorRojo();
-        printf("Error: El proceso %d no está autorizado para crecer\n", idProceso);
-        colorReset();
-        return false;
+    // Con el mapa de bits no hay particiones que extender: un bloque nuevo
+    // si el proceso ya tiene alguno
+    for (int i = 0; algoritmo == ALG_MAPA_BITS && !tieneParticion && i < NUM_BLOQUES_BITMAP; i++) {
+        tieneParticion = gestor->mapaBits[i] == (unsigned char)idProceso;
     }
     
-    // Verificar si hay suficiente memoria disponible
-    if (cantidadAdicional > gestorMemoria.memoriaDisponible) {
-        colorRojo();
-        printf("Error: No hay suficiente memoria disponible para el crecimiento (%d solicitados, %d disponibles)\n", 
-               cantidadAdicional, gestorMemoria.memoriaDisponible);
-        colorReset();
-        return false;
+    if (cantidadAdicional > gestor->memoriaDisponible) {
+        return SIN_ESPACIO;
     }
     
     // Buscar todas las particiones del proceso
-    int partidaEncontrada = -1;
-    
-    for (int i = 0; i < gestorMemoria.numParticiones; i++) {
-        if (gestorMemoria.particiones[i].idProceso == idProceso) {
-            partidaEncontrada = i;
+    for (int i = 0; algoritmo == ALG_AJUSTE_OPTIMO && i < gestor->numParticiones; i++) {
+        if (gestor->particiones[i].idProceso == idProceso) {
+            tieneParticion = true;
             
             // Verificar si hay una partición libre adyacente a esta que sea suficiente
-            if (i + 1 < gestorMemoria.numParticiones && 
-                gestorMemoria.particiones[i + 1].libre && 
-                gestorMemoria.particiones[i + 1].tamano >= cantidadAdicional) {
+            if (i + 1 < gestor->numParticiones && 
+                gestor->particiones[i + 1].libre && 
+                gestor->particiones[i + 1].tamano >= cantidadAdicional) {
                 
                 // Reducir el tamaño de la partición libre
-                gestorMemoria.particiones[i + 1].inicio += cantidadAdicional;
-                gestorMemoria.particiones[i + 1].tamano -= cantidadAdicional;
+                gestor->particiones[i + 1].inicio += cantidadAdicional;
+                gestor->particiones[i + 1].tamano -= cantidadAdicional;
                 
                 // Aumentar el tamaño de la partición del proceso
-                gestorMemoria.particiones[i].tamano += cantidadAdicional;
+                gestor->particiones[i].tamano += cantidadAdicional;
                 
                 // Actualizar memoria disponible
-                gestorMemoria.memoriaDisponible -= cantidadAdicional;
-                
-                colorVerde();
-                printf("Proceso %d creció en %d bytes. Nueva partición: inicio %d, tamaño %d\n", 
-                       idProceso, cantidadAdicional, gestorMemoria.particiones[i].inicio, gestorMemoria.particiones[i].tamano);
-                colorReset();
+                gestor->memoriaDisponible -= cantidadAdicional;
+                sumarSolicitada(idProceso, cantidadAdicional);
                 
                 // Si la partición libre quedó con tamaño 0, eliminarla
-                if (gestorMemoria.particiones[i + 1].tamano == 0) {
-                    for (int j = i + 1; j < gestorMemoria.numParticiones - 1; j++) {
-                        gestorMemoria.particiones[j] = gestorMemoria.particiones[j + 1];
+                if (gestor->particiones[i + 1].tamano == 0) {
+                    for (int j = i + 1; j < gestor->numParticiones - 1; j++) {
+                        gestor->particiones[j] = gestor->particiones[j + 1];
                     }
-                    gestorMemoria.numParticiones--;
+                    gestor->numParticiones--;
                 }
                 
-                // Registrar evento
-                registrarEvento("Proceso %d creció en %d bytes", idProceso, cantidadAdicional);
-                
-                return true;
+                *particion = i;
+                return CRECIO_EN_SITIO;
             }
             
             // Si encontramos una partición del proceso pero no podemos expandirla,
@@ -382,211 +714,1026 @@ bool crecerProceso(int idProceso, int cantidadAdicional) {
         }
     }
     
-    // Si no encontramos una partición adecuada para expandir, intentar asignar nueva memoria
-    if (partidaEncontrada != -1) {
-        // Asignar nueva memoria para el crecimiento
-        if (asignarMemoria(idProceso, cantidadAdicional)) {
-            colorVerde();
-            printf("Proceso %d creció en %d bytes (nueva partición)\n", idProceso, cantidadAdicional);
-            colorReset();
+    // Si no encontramos una partición adecuada para expandir, asignar nueva
+    // memoria para el crecimiento
+    if (!tieneParticion || asignarConAlgoritmo(algoritmo, idProceso, cantidadAdicional) < 0) {
+        return SIN_ESPACIO;
+    }
+    sumarSolicitada(idProceso, cantidadAdicional);
+    return CRECIO_BLOQUE_NUEVO;
+}
+
+// Permitir que un proceso crezca (requiere más memoria)
+bool crecerProceso(int idProceso, int cantidadAdicional) {
+    int particion, inicioParticion = 0, tamanoParticion = 0;
+
+    if (cantidadAdicional <= 0) {
+        printf("Error: La cantidad adicional debe ser mayor que cero\n");
+        return false;
+    }
+    
+    // Verificar si el proceso es uno de los que pueden crecer
+    if (idProceso != gestor->creceProc1 && idProceso != gestor->creceProc2) {
+        imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: El proceso %d no está autorizado para crecer\n", idProceso);
+        return false;
+    }
+    
+    bloquearParticiones();
+    grabarEventoMemoria(TRAZA_CRECER, idProceso, 0, cantidadAdicional);
+    int algoritmo = gestor->algoritmoActual;
+    int disponible = gestor->memoriaDisponible;
+    
+    // Verificar si hay suficiente memoria disponible (los compañeros pueden
+    // crecer sin gastar memoria nueva)
+    if (algoritmo != ALG_BUDDY && cantidadAdicional > disponible) {
+        desbloquearParticiones();
+        imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: No hay suficiente memoria disponible para el crecimiento (%d solicitados, %d disponibles)\n", 
+               cantidadAdicional, disponible);
+        return false;
+    }
+    
+    int crecimiento = crecerConAlgoritmo(algoritmo, idProceso, cantidadAdicional, &particion);
+    if (particion >= 0) {
+        inicioParticion = gestor->particiones[particion].inicio;
+        tamanoParticion = gestor->particiones[particion].tamano;
+    }
+    desbloquearParticiones();
+    
+    switch (crecimiento) {
+        case CRECIO_EN_SITIO:
+            if (particion >= 0) {
+                imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Proceso %d creció en %d bytes. Nueva partición: inicio %d, tamaño %d\n", 
+                       idProceso, cantidadAdicional, inicioParticion, tamanoParticion);
+            }
+            registrarEvento("Proceso %d creció en %d bytes", idProceso, cantidadAdicional);
+            return true;
+        case CRECIO_BLOQUE_NUEVO:
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Proceso %d creció en %d bytes (%s)\n", idProceso, cantidadAdicional,
+                                  algoritmo == ALG_BUDDY ? "nuevo bloque" : "nueva partición");
+            registrarEvento("Proceso %d creció en %d bytes (Algoritmo: %s)", idProceso, cantidadAdicional,
+                            nombreAlgoritmoMemoria(algoritmo));
             return true;
+        default:
+            imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: No se pudo hacer crecer el proceso %d\n", idProceso);
+            return false;
+    }
+}
+
+
+// Memoria libre y mayor hueco según las estructuras de un algoritmo
+static void medirHuecos(int algoritmo, int *libre, int *mayorHueco) {
+    *libre = 0;
+    *mayorHueco = 0;
+
+    if (algoritmo == ALG_MAPA_BITS) {
+        int racha = 0;
+        for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
+            if (gestor->mapaBits[i] == BLOQUE_LIBRE_BITMAP) {
+                racha++;
+                *libre += gestor->tamanoBloque;
+                if (racha * gestor->tamanoBloque > *mayorHueco) {
+                    *mayorHueco = racha * gestor->tamanoBloque;
+                }
+            } else {
+                racha = 0;
+            }
+        }
+    } else if (algoritmo == ALG_BUDDY) {
+        for (int orden = 0; orden <= ORDEN_MAXIMO_BUDDY; orden++) {
+            for (int b = gestor->libreBuddy[orden]; b != -1; b = gestor->siguienteBuddy[b]) {
+                *libre += TAMANO_MINIMO_BUDDY << orden;
+                *mayorHueco = TAMANO_MINIMO_BUDDY << orden;
+            }
+        }
+    } else {
+        for (int i = 0; i < gestor->numParticiones; i++) {
+            if (gestor->particiones[i].libre) {
+                *libre += gestor->particiones[i].tamano;
+                if (gestor->particiones[i].tamano > *mayorHueco) {
+                    *mayorHueco = gestor->particiones[i].tamano;
+                }
+            }
         }
     }
-    
-    colorRojo();
-    printf("Error: No se pudo hacer crecer el proceso %d\n", idProceso);
-    colorReset();
-    return false;
+}
+
+void medirFragmentacion(int *interna, double *externa) {
+    int libre, mayorHueco;
+    int solicitada = 0;
+
+    // Interna: lo que los algoritmos asignan de más (bloques de 16 bytes del
+    // mapa de bits, potencias de dos de los compañeros). Ajuste Óptimo da lo justo
+    for (int i = 0; i < MAX_PROCESOS_MEMORIA; i++) {
+        solicitada += gestor->solicitadaProceso[i];
+    }
+    *interna = MEM_TOTAL_SIZE - gestor->memoriaDisponible - solicitada;
+    if (*interna < 0) {
+        *interna = 0;
+    }
+
+    medirHuecos(gestor->algoritmoActual, &libre, &mayorHueco);
+    *externa = libre > 0 ? 100.0 * (libre - mayorHueco) / libre : 0.0;
+}
+
+// Copia de lo que muestra imprimirEstadoMemoria, tomada con mutexParticiones
+// para imprimir sin él (una escritura en la terminal no debe frenar la E/S
+// de los jugadores)
+typedef struct {
+    int algoritmo;
+    int memoriaDisponible;
+    int interna;
+    double externa;
+    Particion particiones[MAX_PARTICIONES];
+    int numParticiones;
+    unsigned char mapaBits[NUM_BLOQUES_BITMAP];
+    int tamanoBloque;
+    short libreBuddy[ORDEN_MAXIMO_BUDDY + 1];
+    short siguienteBuddy[NUM_BLOQUES_BUDDY];
+    signed char ordenBuddy[NUM_BLOQUES_BUDDY];
+    int procesoBuddy[NUM_BLOQUES_BUDDY];
+    short usadoBuddy[NUM_BLOQUES_BUDDY];
+    int creceProc1;
+    int creceProc2;
+} EstadoParticiones;
+
+static void capturarEstadoParticiones(EstadoParticiones *estado) {
+    bloquearParticiones();
+    estado->algoritmo = gestor->algoritmoActual;
+    estado->memoriaDisponible = gestor->memoriaDisponible;
+    medirFragmentacion(&estado->interna, &estado->externa);
+    estado->numParticiones = gestor->numParticiones;
+    memcpy(estado->particiones, gestor->particiones, sizeof(estado->particiones));
+    memcpy(estado->mapaBits, gestor->mapaBits, sizeof(estado->mapaBits));
+    estado->tamanoBloque = gestor->tamanoBloque;
+    memcpy(estado->libreBuddy, gestor->libreBuddy, sizeof(estado->libreBuddy));
+    memcpy(estado->siguienteBuddy, gestor->siguienteBuddy, sizeof(estado->siguienteBuddy));
+    memcpy(estado->ordenBuddy, gestor->ordenBuddy, sizeof(estado->ordenBuddy));
+    memcpy(estado->procesoBuddy, gestor->procesoBuddy, sizeof(estado->procesoBuddy));
+    memcpy(estado->usadoBuddy, gestor->usadoBuddy, sizeof(estado->usadoBuddy));
+    estado->creceProc1 = gestor->creceProc1;
+    estado->creceProc2 = gestor->creceProc2;
+    desbloquearParticiones();
 }
 
 // Imprimir el estado actual de la memoria
 void imprimirEstadoMemoria(void) {
+    EstadoParticiones estado;
+
+    capturarEstadoParticiones(&estado);
     printf("\n=== ESTADO DE LA MEMORIA ===\n");
-    printf("Algoritmo actual: %s\n", gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO ? "Ajuste Óptimo" : (gestorMemoria.algoritmoActual == ALG_LRU ? "LRU (Memoria Virtual)" : "Mapa de Bits"));
+    printf("Algoritmo actual: %s\n", estado.algoritmo == ALG_LRU ? "LRU (Memoria Virtual)" : nombreAlgoritmoMemoria(estado.algoritmo));
     printf("Memoria total: %d bytes\n", MEM_TOTAL_SIZE);
-    printf("Memoria disponible: %d bytes\n", gestorMemoria.memoriaDisponible);
+    printf("Memoria disponible: %d bytes\n", estado.memoriaDisponible);
+    printf("Fragmentación interna: %d bytes\n", estado.interna);
+    printf("Fragmentación externa: %.1f%% de la memoria libre fuera del mayor hueco\n", estado.externa);
 
-    if (gestorMemoria.algoritmoActual == ALG_AJUSTE_OPTIMO) {
-         printf("Número de particiones: %d\n", gestorMemoria.numParticiones);
+    if (estado.algoritmo == ALG_AJUSTE_OPTIMO) {
+         printf("Número de particiones: %d\n", estado.numParticiones);
          printf("\nParticiones:\n");
          printf("%-10s %-10s %-10s %-10s\n", "Inicio", "Tamaño", "Proceso", "Estado");
          printf("--------------------------------------\n");
-         for (int i = 0; i < gestorMemoria.numParticiones; i++) {
+         for (int i = 0; i < estado.numParticiones; i++) {
              printf("%-10d %-10d %-10d %-10s\n",
-                    gestorMemoria.particiones[i].inicio,
-                    gestorMemoria.particiones[i].tamano,
-                    gestorMemoria.particiones[i].idProceso,
-                    gestorMemoria.particiones[i].libre ? "Libre" : "Ocupado");
+                    estado.particiones[i].inicio,
+                    estado.particiones[i].tamano,
+                    estado.particiones[i].idProceso,
+                    estado.particiones[i].libre ? "Libre" : "Ocupado");
          }
-    } else if (gestorMemoria.algoritmoActual == ALG_MAPA_BITS) {
-        printf("Tamaño del bloque: %d bytes\n", gestorMemoria.tamanoBloque);
+    } else if (estado.algoritmo == ALG_MAPA_BITS) {
+        printf("Tamaño del bloque: %d bytes\n", estado.tamanoBloque);
         printf("Número de bloques: %d\n", NUM_BLOQUES_BITMAP);
-        printf("\nMapa de Bits:\n");
-        // Implementar la impresión del mapa de bits (puede ser compleja si es bit a bit)
-        // Un enfoque simple es imprimir el estado de cada byte/bloque
+        printf("\nMapa de Bits (proceso de cada bloque, '.' libre):\n");
         for (int i = 0; i < NUM_BLOQUES_BITMAP; i++) {
-             printf("%d", gestorMemoria.mapaBits[i]); // Imprime 0 o 1
+             if (estado.mapaBits[i] == BLOQUE_LIBRE_BITMAP) {
+                 printf(".");
+             } else {
+                 printf("%d", estado.mapaBits[i]);
+             }
              if ((i + 1) % 32 == 0) printf("\n"); // Salto de línea cada 32 bloques para mejor visualización
         }
         printf("\n");
+    } else if (estado.algoritmo == ALG_BUDDY) {
+        printf("Bloques de %d a %d bytes\n", TAMANO_MINIMO_BUDDY, TAMANO_MINIMO_BUDDY << ORDEN_MAXIMO_BUDDY);
+        printf("\nBloques libres por orden:\n");
+        for (int orden = ORDEN_MAXIMO_BUDDY; orden >= 0; orden--) {
+            printf("  %4d bytes:", TAMANO_MINIMO_BUDDY << orden);
+            for (int b = estado.libreBuddy[orden]; b != -1; b = estado.siguienteBuddy[b]) {
+                printf(" %d", b * TAMANO_MINIMO_BUDDY);
+            }
+            printf("\n");
+        }
+        printf("\nBloques ocupados:\n");
+        printf("%-10s %-10s %-10s %-10s\n", "Inicio", "Tamaño", "Usado", "Proceso");
+        printf("--------------------------------------\n");
+        for (int b = 0; b < NUM_BLOQUES_BUDDY; b++) {
+            if (estado.ordenBuddy[b] >= 0) {
+                printf("%-10d %-10d %-10d %-10d\n", b * TAMANO_MINIMO_BUDDY,
+                       TAMANO_MINIMO_BUDDY << estado.ordenBuddy[b],
+                       estado.usadoBuddy[b], estado.procesoBuddy[b]);
+            }
+        }
     }
 
-    printf("\nProcesos que pueden crecer: %d y %d\n", gestorMemoria.creceProc1, gestorMemoria.creceProc2);
+    printf("\nProcesos que pueden crecer: %d y %d\n", estado.creceProc1, estado.creceProc2);
     printf("===========================\n\n");
 }
 
-//---------------------- Funciones para memoria virtual con LRU -----------------------
+//---------------------- Funciones para memoria virtual -----------------------
 
-// Inicializar la memoria virtual
-void inicializarMemoriaVirtual(void) {
+// Marcos o páginas revisados por la selección de víctima en curso
+static __thread long examinadosSeleccion = 0;
+
+// Resultado de un acceso, para los mensajes de accederPagina
+typedef struct {
+    int marco;              // Marco de la página, o -1 si no se pudo cargar
+    bool acierto;
+    bool aciertoTLB;        // La TLB tradujo la página sin mirar la tabla
+    int tiempo;             // Tiempo del acceso
+    bool reemplazo;         // Se desalojó otra página para cargarla
+    int procesoVictima;
+    int paginaVictima;
+    int tiempoVictima;
+    bool victimaModificada; // La víctima se escribió a disco al desalojarla
+} ResultadoAcceso;
+
+//---------------------- TLB -----------------------
+
+// Geometría con la que se inicializa la memoria virtual (configurarTLB)
+static int entradasTLBConfigurada = ENTRADAS_TLB;
+static int viasTLBConfigurada = VIAS_TLB;
+
+bool configurarTLB(int entradas, int vias) {
+    if (entradas == 0) {
+        entradasTLBConfigurada = 0;
+        viasTLBConfigurada = 1;
+        return true;
+    }
+    if (entradas < 0 || entradas > MAX_ENTRADAS_TLB || (entradas & (entradas - 1)) != 0 ||
+        vias <= 0 || vias > entradas || entradas % vias != 0) {
+        printf("Error: TLB no válida (%d entradas, %d vías): las entradas deben ser potencia de 2 "
+               "hasta %d y las vías dividirlas\n", entradas, vias, MAX_ENTRADAS_TLB);
+        return false;
+    }
+    entradasTLBConfigurada = entradas;
+    viasTLBConfigurada = vias;
+    return true;
+}
+
+// Dejar la TLB vacía con una geometría y sus contadores a cero
+static void reiniciarTLB(int entradas, int vias) {
+    gestor->entradasTLB = entradas;
+    gestor->viasTLB = vias;
+    gestor->mascaraTLB = entradas > 0 ? entradas / vias - 1 : 0;
+    for (int i = 0; i < MAX_ENTRADAS_TLB; i++) {
+        gestor->tlb[i].asid = -1;
+        gestor->tlb[i].numPagina = -1;
+        gestor->tlb[i].indicePagina = -1;
+        gestor->tlb[i].ultimoUso = 0;
+    }
+    gestor->aciertosTLB = 0;
+    gestor->fallosTLB = 0;
+    gestor->vaciadosTLB = 0;
+    gestor->nsSimulados = 0;
+}
+
+// Primera entrada del conjunto de (asid, página)
+static inline EntradaTLB* conjuntoTLB(int asid, int numPagina) {
+    unsigned clave = ((unsigned)asid * 0x9E3779B1u) ^ (unsigned)numPagina;
+    clave ^= clave >> 16;
+    return &gestor->tlb[(clave & (unsigned)gestor->mascaraTLB) * gestor->viasTLB];
+}
+
+// Entrada de la TLB de (asid, página), o NULL si no está
+static inline EntradaTLB* entradaEnTLB(int asid, int numPagina) {
+    if (gestor->entradasTLB == 0) {
+        return NULL;
+    }
+    EntradaTLB *conjunto = conjuntoTLB(asid, numPagina);
+    for (int v = 0; v < gestor->viasTLB; v++) {
+        if (conjunto[v].asid == asid && conjunto[v].numPagina == numPagina) {
+            return &conjunto[v];
+        }
+    }
+    return NULL;
+}
+
+// Página traducida por la TLB, o NULL si no está
+static inline Pagina* buscarEnTLB(int asid, int numPagina) {
+    EntradaTLB *entrada = entradaEnTLB(asid, numPagina);
+    if (entrada == NULL) {
+        return NULL;
+    }
+    entrada->ultimoUso = gestor->contadorTiempo;
+    return &gestor->tablaPaginas[entrada->indicePagina];
+}
+
+// Guardar la traducción de una página recién consultada: en una vía libre
+// del conjunto o en la usada hace más tiempo
+static void cargarEnTLB(int asid, int numPagina, int indicePagina) {
+    if (gestor->entradasTLB == 0) {
+        return;
+    }
+    EntradaTLB *conjunto = conjuntoTLB(asid, numPagina);
+    EntradaTLB *entrada = NULL;
+    for (int v = 0; v < gestor->viasTLB; v++) {
+        if (conjunto[v].asid == -1) {
+            entrada = &conjunto[v];
+            break;
+        }
+        if (entrada == NULL || conjunto[v].ultimoUso < entrada->ultimoUso) {
+            entrada = &conjunto[v];
+        }
+    }
+    entrada->asid = asid;
+    entrada->numPagina = numPagina;
+    entrada->indicePagina = indicePagina;
+    entrada->ultimoUso = gestor->contadorTiempo;
+}
+
+// Una página que sale de memoria deja de poder traducirse
+static void invalidarEnTLB(int asid, int numPagina) {
+    if (gestor->entradasTLB == 0) {
+        return;
+    }
+    EntradaTLB *conjunto = conjuntoTLB(asid, numPagina);
+    for (int v = 0; v < gestor->viasTLB; v++) {
+        if (conjunto[v].asid == asid && conjunto[v].numPagina == numPagina) {
+            conjunto[v].asid = -1;
+            return;
+        }
+    }
+}
+
+// Vaciar las entradas de un proceso (al liberar sus páginas)
+static void vaciarTLBProceso(int asid) {
+    bool vaciada = false;
+
+    for (int i = 0; i < gestor->entradasTLB; i++) {
+        if (gestor->tlb[i].asid == asid) {
+            gestor->tlb[i].asid = -1;
+            vaciada = true;
+        }
+    }
+    if (vaciada) {
+        gestor->vaciadosTLB++;
+    }
+}
+
+//---------------------- Representaciones de la tabla de páginas -----------------------
+
+// Representación con la que se inicializa la memoria virtual (configurarTablaPaginas)
+static int tipoTablaConfigurado = TABLA_PAGINAS_LINEAL;
+static int nivelesRadixConfigurados = 2;
+
+bool configurarTablaPaginas(int tipo, int niveles) {
+    if (tipo != TABLA_PAGINAS_LINEAL && tipo != TABLA_PAGINAS_RADIX && tipo != TABLA_PAGINAS_INVERTIDA) {
+        printf("Error: Representación de la tabla de páginas no válida\n");
+        return false;
+    }
+    if (tipo == TABLA_PAGINAS_RADIX && niveles != 2 && niveles != 4) {
+        printf("Error: La tabla radix debe tener 2 o 4 niveles (%d pedidos)\n", niveles);
+        return false;
+    }
+    tipoTablaConfigurado = tipo;
+    nivelesRadixConfigurados = tipo == TABLA_PAGINAS_RADIX ? niveles : 2;
+    return true;
+}
+
+static void reiniciarTablaPaginas(int tipo, int niveles) {
+    gestor->tipoTablaPaginas = tipo;
+    gestor->nivelesRadix = niveles;
+    for (int p = 0; p < MAX_PROCESOS_MEMORIA; p++) {
+        gestor->raizRadix[p] = -1;
+    }
+    gestor->libreRadix = -1;
+    gestor->topeRadix = 0;
+    gestor->usadasRadix = 0;
+    gestor->maximoRadix = 0;
+    gestor->rechazosRadix = 0;
+    for (int c = 0; c < CUBETAS_TABLA_INVERTIDA; c++) {
+        gestor->cubetasInvertida[c] = -1;
+    }
+    for (int m = 0; m < NUM_MARCOS; m++) {
+        gestor->siguienteInvertida[m] = -1;
+    }
+    gestor->recorridosTabla = 0;
+    gestor->accesosTabla = 0;
+}
+
+// Entradas de cada nodo del radix: 256 con 2 niveles, 16 con 4
+static inline int entradasNodoRadix(void) {
+    return 1 << (BITS_PAGINA_RADIX / gestor->nivelesRadix);
+}
+
+// Un nodo vacío del pool (uno liberado o uno nuevo), o -1 si no queda sitio
+static int nuevoNodoRadix(void) {
+    int entradas = entradasNodoRadix();
+    int nodo = gestor->libreRadix;
+
+    if (nodo != -1) {
+        gestor->libreRadix = gestor->entradasRadix[nodo];
+    } else if (gestor->topeRadix + entradas <= ENTRADAS_POOL_RADIX) {
+        nodo = gestor->topeRadix;
+        gestor->topeRadix += entradas;
+    } else {
+        return -1;
+    }
+    for (int i = 0; i < entradas; i++) {
+        gestor->entradasRadix[nodo + i] = -1;
+    }
+    gestor->usadasRadix += entradas;
+    if (gestor->usadasRadix > gestor->maximoRadix) {
+        gestor->maximoRadix = gestor->usadasRadix;
+    }
+    return nodo;
+}
+
+// Devolver al pool un nodo y, si no es del último nivel, sus hijos
+static void liberarArbolRadix(int nodo, int nivel) {
+    int entradas = entradasNodoRadix();
+
+    for (int i = 0; nivel > 0 && i < entradas; i++) {
+        if (gestor->entradasRadix[nodo + i] != -1) {
+            liberarArbolRadix(gestor->entradasRadix[nodo + i], nivel - 1);
+        }
+    }
+    gestor->entradasRadix[nodo] = gestor->libreRadix;
+    gestor->libreRadix = (short)nodo;
+    gestor->usadasRadix -= entradas;
+}
+
+// Entrada del último nivel para (proceso, página): la posición de la página
+// en tablaPaginas o -1. Con crear, se piden los niveles que falten; NULL si
+// no existe (o no cabe). Cada nivel recorrido es un acceso a memoria
+static short* ranuraRadix(int idProceso, int numPagina, bool crear) {
+    int bits = BITS_PAGINA_RADIX / gestor->nivelesRadix;
+    short *ranura;
+
+    if (idProceso < 0 || idProceso >= MAX_PROCESOS_MEMORIA || numPagina < 0 || numPagina > MAX_NUMERO_PAGINA) {
+        return NULL;
+    }
+    ranura = &gestor->raizRadix[idProceso];
+    for (int nivel = gestor->nivelesRadix - 1; nivel >= 0; nivel--) {
+        if (*ranura == -1) {
+            int nodo = crear ? nuevoNodoRadix() : -1;
+            if (nodo == -1) {
+                return NULL;
+            }
+            *ranura = (short)nodo;
+        }
+        gestor->accesosTabla++;
+        ranura = &gestor->entradasRadix[*ranura + ((numPagina >> (nivel * bits)) & ((1 << bits) - 1))];
+    }
+    return ranura;
+}
+
+static inline int cubetaInvertida(int idProceso, int numPagina) {
+    unsigned clave = ((unsigned)idProceso * 0x9E3779B1u) ^ (unsigned)numPagina;
+    clave ^= clave >> 16;
+    return (int)(clave & (CUBETAS_TABLA_INVERTIDA - 1));
+}
+
+// Marco que tiene (proceso, página) según la tabla invertida, o -1
+static int buscarInvertida(int idProceso, int numPagina) {
+    for (int marco = gestor->cubetasInvertida[cubetaInvertida(idProceso, numPagina)]; marco != -1;
+         marco = gestor->siguienteInvertida[marco]) {
+        gestor->accesosTabla++;
+        if (gestor->marcosMemoria[marco].idProceso == idProceso &&
+            gestor->marcosMemoria[marco].numPagina == numPagina) {
+            return marco;
+        }
+    }
+    gestor->accesosTabla++;   // La cubeta vacía también se lee
+    return -1;
+}
+
+// Enlazar un marco recién cargado (o sacarlo antes de que cambie de página)
+static void insertarInvertida(int marco) {
+    if (gestor->tipoTablaPaginas != TABLA_PAGINAS_INVERTIDA) {
+        return;
+    }
+    int cubeta = cubetaInvertida(gestor->marcosMemoria[marco].idProceso, gestor->marcosMemoria[marco].numPagina);
+    gestor->siguienteInvertida[marco] = gestor->cubetasInvertida[cubeta];
+    gestor->cubetasInvertida[cubeta] = (short)marco;
+}
+
+static void quitarInvertida(int marco) {
+    if (gestor->tipoTablaPaginas != TABLA_PAGINAS_INVERTIDA) {
+        return;
+    }
+    short *enlace = &gestor->cubetasInvertida[cubetaInvertida(gestor->marcosMemoria[marco].idProceso,
+                                                               gestor->marcosMemoria[marco].numPagina)];
+    while (*enlace != -1 && *enlace != marco) {
+        enlace = &gestor->siguienteInvertida[*enlace];
+    }
+    if (*enlace == marco) {
+        *enlace = gestor->siguienteInvertida[marco];
+        gestor->siguienteInvertida[marco] = -1;
+    }
+}
+
+// Recorrer tablaPaginas buscando la página; si no está, en hueco la primera
+// posición liberada (-1 si hay que añadirla al final)
+static Pagina* buscarLineal(int idProceso, int numPagina, int *hueco) {
+    for (int i = 0; i < gestor->numPaginas; i++) {
+        gestor->accesosTabla++;
+        if (gestor->tablaPaginas[i].idProceso == idProceso && 
+            gestor->tablaPaginas[i].numPagina == numPagina) {
+            return &gestor->tablaPaginas[i];
+        }
+        if (*hueco == -1 && gestor->tablaPaginas[i].idProceso == -1) {
+            *hueco = i;
+        }
+    }
+    return NULL;
+}
+
+// Buscar el descriptor de (proceso, página) con la representación actual.
+// Si no existe, en hueco queda dónde crearlo (-1: al final de la tabla)
+static Pagina* buscarEnTablaPaginas(int idProceso, int numPagina, int *hueco) {
+    *hueco = -1;
+    gestor->recorridosTabla++;
+
+    if (gestor->tipoTablaPaginas == TABLA_PAGINAS_RADIX) {
+        short *ranura = ranuraRadix(idProceso, numPagina, false);
+        if (ranura != NULL && *ranura != -1) {
+            return &gestor->tablaPaginas[*ranura];
+        }
+        // Página nueva: la primera posición libre (crear es poco frecuente)
+        for (int i = 0; i < gestor->numPaginas && *hueco == -1; i++) {
+            if (gestor->tablaPaginas[i].idProceso == -1) {
+                *hueco = i;
+            }
+        }
+        return NULL;
+    }
+    if (gestor->tipoTablaPaginas == TABLA_PAGINAS_INVERTIDA) {
+        int marco = buscarInvertida(idProceso, numPagina);
+        if (marco != -1) {
+            return &gestor->tablaPaginas[gestor->marcosMemoria[marco].indicePagina];
+        }
+        // No está en memoria: su descriptor, en la tabla externa
+    }
+    return buscarLineal(idProceso, numPagina, hueco);
+}
+
+static const char *nombreTablaPaginas(int tipo, int niveles) {
+    switch (tipo) {
+        case TABLA_PAGINAS_LINEAL:    return "Lineal";
+        case TABLA_PAGINAS_RADIX:     return niveles == 4 ? "Radix de 4 niveles" : "Radix de 2 niveles";
+        case TABLA_PAGINAS_INVERTIDA: return "Invertida";
+        default:                      return "Desconocida";
+    }
+}
+
+int bytesTablaPaginas(void) {
+    switch (gestor->tipoTablaPaginas) {
+        case TABLA_PAGINAS_RADIX:
+            return (int)(sizeof(gestor->raizRadix) + gestor->usadasRadix * sizeof(gestor->entradasRadix[0]));
+        case TABLA_PAGINAS_INVERTIDA:
+            // Las entradas son los marcos (proceso, página y descriptor) y su enlace
+            return (int)(sizeof(gestor->cubetasInvertida) + sizeof(gestor->siguienteInvertida) +
+                         NUM_MARCOS * 3 * sizeof(int));
+        default:
+            return (int)(gestor->numPaginas * sizeof(Pagina));
+    }
+}
+
+// Dejar la tabla de páginas y los marcos vacíos, sin mensajes
+static void reiniciarMemoriaVirtual(void) {
     // Inicializar tabla de páginas
     for (int i = 0; i < MAX_PAGINAS; i++) {
-        gestorMemoria.tablaPaginas[i].idProceso = -1;
-        gestorMemoria.tablaPaginas[i].numPagina = -1;
-        gestorMemoria.tablaPaginas[i].idCarta = -1;
-        gestorMemoria.tablaPaginas[i].tiempoUltimoUso = 0;
-        gestorMemoria.tablaPaginas[i].bitReferencia = false;
-        gestorMemoria.tablaPaginas[i].bitModificacion = false;
-        gestorMemoria.tablaPaginas[i].enMemoria = false;
-        gestorMemoria.tablaPaginas[i].marcoAsignado = -1;
+        gestor->tablaPaginas[i].idProceso = -1;
+        gestor->tablaPaginas[i].numPagina = -1;
+        gestor->tablaPaginas[i].idCarta = -1;
+        gestor->tablaPaginas[i].tiempoUltimoUso = 0;
+        gestor->tablaPaginas[i].bitReferencia = false;
+        gestor->tablaPaginas[i].bitModificacion = false;
+        gestor->tablaPaginas[i].edad = 0;
+        gestor->tablaPaginas[i].enMemoria = false;
+        gestor->tablaPaginas[i].marcoAsignado = -1;
     }
     
-    gestorMemoria.numPaginas = 0;
+    gestor->numPaginas = 0;
     
     // Inicializar marcos de memoria
     for (int i = 0; i < NUM_MARCOS; i++) {
-        gestorMemoria.marcosMemoria[i].idProceso = -1;
-        gestorMemoria.marcosMemoria[i].numPagina = -1;
-        gestorMemoria.marcosMemoria[i].libre = true;
+        gestor->marcosMemoria[i].idProceso = -1;
+        gestor->marcosMemoria[i].numPagina = -1;
+        gestor->marcosMemoria[i].indicePagina = -1;
+        gestor->marcosMemoria[i].libre = true;
     }
     
-    gestorMemoria.contadorTiempo = 0;
-    gestorMemoria.fallosPagina = 0;
-    gestorMemoria.aciertosMemoria = 0;
+    gestor->contadorTiempo = 0;
+    gestor->fallosPagina = 0;
+    gestor->aciertosMemoria = 0;
+    gestor->manecilla = 0;
+    memset(gestor->estadisticasReemplazo, 0, sizeof(gestor->estadisticasReemplazo));
+    reiniciarTLB(entradasTLBConfigurada, viasTLBConfigurada);
+    reiniciarTablaPaginas(tipoTablaConfigurado, nivelesRadixConfigurados);
+}
+
+// Inicializar la memoria virtual
+void inicializarMemoriaVirtual(void) {
+    reiniciarMemoriaVirtual();
+    gestor->politicaReemplazo = REEMPLAZO_LRU;
     
-    colorVerde();
-    printf("Memoria virtual inicializada: %d marcos, %d páginas por marco\n", 
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_VERDE, "Memoria virtual inicializada: %d marcos, %d páginas por marco\n", 
            NUM_MARCOS, PAGINAS_POR_MARCO);
-    colorReset();
 }
 
-// Acceder a una página (leer o escribir)
-int accederPagina(int idProceso, int numPagina, int idCarta) {
-    gestorMemoria.contadorTiempo++;
+const char* nombrePoliticaReemplazo(int politica) {
+    switch (politica) {
+        case REEMPLAZO_LRU:     return "LRU";
+        case REEMPLAZO_RELOJ:   return "Reloj (segunda oportunidad)";
+        case REEMPLAZO_NFU:     return "NFU con envejecimiento";
+        case REEMPLAZO_WSCLOCK: return "WSClock";
+        default:                return "Desconocida";
+    }
+}
+
+static Pagina* paginaEnMarco(int marco) {
+    int indice = gestor->marcosMemoria[marco].indicePagina;
+    return indice >= 0 ? &gestor->tablaPaginas[indice] : NULL;
+}
+
+// NFU: cada INTERVALO_ENVEJECIMIENTO accesos, el bit de referencia de cada
+// página cargada entra por arriba en su contador y se borra
+static void envejecerPaginas(void) {
+    for (int m = 0; m < NUM_MARCOS; m++) {
+        Pagina *pagina = paginaEnMarco(m);
+        if (pagina != NULL) {
+            pagina->edad = (unsigned char)((pagina->edad >> 1) | (pagina->bitReferencia ? 0x80 : 0));
+            pagina->bitReferencia = false;
+        }
+    }
+}
+
+// Reloj: la manecilla da una segunda oportunidad (borra el bit) a las
+// páginas referenciadas y se lleva la primera que no lo está
+static int seleccionarVictimaReloj(void) {
+    for (;;) {
+        int marco = gestor->manecilla;
+        Pagina *pagina = paginaEnMarco(marco);
+
+        gestor->manecilla = (marco + 1) % NUM_MARCOS;
+        examinadosSeleccion++;
+        if (pagina == NULL || !pagina->bitReferencia) {
+            return marco;
+        }
+        pagina->bitReferencia = false;
+    }
+}
+
+// NFU: la página con el menor contador, contando ya la referencia que
+// entraría en el próximo desplazamiento
+static int seleccionarVictimaNFU(void) {
+    int marcoVictima = 0;
+    int edadMinima = INT_MAX;
+
+    for (int m = 0; m < NUM_MARCOS; m++) {
+        Pagina *pagina = paginaEnMarco(m);
+        examinadosSeleccion++;
+        if (pagina == NULL) {
+            return m;
+        }
+        int edad = (pagina->edad >> 1) | (pagina->bitReferencia ? 0x80 : 0);
+        if (edad < edadMinima) {
+            edadMinima = edad;
+            marcoVictima = m;
+        }
+    }
+    return marcoVictima;
+}
+
+// Escribir a disco una página modificada
+static void escribirPaginaDisco(Pagina *pagina) {
+    pagina->bitModificacion = false;
+    gestor->estadisticasReemplazo[gestor->politicaReemplazo].escrituras++;
+}
+
+// WSClock: como el reloj, pero una página sin referencia solo se desaloja si
+// además quedó fuera del conjunto de trabajo (sin usar en la última
+// VENTANA_CONJUNTO_TRABAJO). Si está modificada, se programa su escritura y
+// se sigue buscando; tras una vuelta con escrituras se da otra. El tiempo de
+// último uso lo mantiene accederPagina en cada acceso
+static int seleccionarVictimaWSClock(void) {
+    int ahora = gestor->contadorTiempo;
+    int marcoMasViejo = -1;
+    int tiempoMasViejo = INT_MAX;
+
+    for (int vuelta = 0; vuelta < 2; vuelta++) {
+        int escrituras = 0;
+
+        for (int i = 0; i < NUM_MARCOS; i++) {
+            int marco = gestor->manecilla;
+            Pagina *pagina = paginaEnMarco(marco);
+
+            gestor->manecilla = (marco + 1) % NUM_MARCOS;
+            examinadosSeleccion++;
+            if (pagina == NULL) {
+                return marco;
+            }
+            if (pagina->bitReferencia) {
+                pagina->bitReferencia = false;     // En el conjunto de trabajo
+                continue;
+            }
+            if (ahora - pagina->tiempoUltimoUso > VENTANA_CONJUNTO_TRABAJO) {
+                if (!pagina->bitModificacion) {
+                    return marco;
+                }
+                escribirPaginaDisco(pagina);
+                escrituras++;
+            }
+            if (pagina->tiempoUltimoUso < tiempoMasViejo) {
+                tiempoMasViejo = pagina->tiempoUltimoUso;
+                marcoMasViejo = marco;
+            }
+        }
+
+        if (escrituras == 0) {
+            break;
+        }
+    }
+
+    // Todo el conjunto de trabajo cabe en los marcos: la página sin
+    // referencia más vieja o, si todas la tenían, la de la manecilla
+    if (marcoMasViejo != -1) {
+        return marcoMasViejo;
+    }
+    int marco = gestor->manecilla;
+    gestor->manecilla = (marco + 1) % NUM_MARCOS;
+    return marco;
+}
+
+static int seleccionarVictima(void) {
+    switch (gestor->politicaReemplazo) {
+        case REEMPLAZO_RELOJ:   return seleccionarVictimaReloj();
+        case REEMPLAZO_NFU:     return seleccionarVictimaNFU();
+        case REEMPLAZO_WSCLOCK: return seleccionarVictimaWSClock();
+        default:                return seleccionarVictimaLRU();
+    }
+}
+
+// Acceso sin mensajes: buscar (o crear) la página, cargarla si hace falta y
+// llevar las cuentas de la política actual. Devuelve el marco o -1
+static int resolverAcceso(int idProceso, int numPagina, int idCarta, ResultadoAcceso *resultado) {
+    EstadisticasReemplazo *estadisticas = &gestor->estadisticasReemplazo[gestor->politicaReemplazo];
+
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->marco = -1;
+    resultado->tiempo = ++gestor->contadorTiempo;
+    if (gestor->politicaReemplazo == REEMPLAZO_NFU &&
+        gestor->contadorTiempo % INTERVALO_ENVEJECIMIENTO == 0) {
+        envejecerPaginas();
+    }
     
-    // Buscar la página en la tabla de páginas
-    Pagina *pagina = NULL;
+    // Primero la TLB: si traduce la página, está en memoria y no hace falta
+    // recorrer la tabla. El dato cuesta siempre un acceso a memoria
+    Pagina *pagina = buscarEnTLB(idProceso, numPagina);
+    int hueco = -1;
     
-    for (int i = 0; i < gestorMemoria.numPaginas; i++) {
-        if (gestorMemoria.tablaPaginas[i].idProceso == idProceso && 
-            gestorMemoria.tablaPaginas[i].numPagina == numPagina) {
-            pagina = &gestorMemoria.tablaPaginas[i];
-            break;
+    gestor->nsSimulados += COSTE_MEMORIA_NS + (gestor->entradasTLB > 0 ? COSTE_TLB_NS : 0);
+    if (pagina != NULL) {
+        gestor->aciertosTLB++;
+        resultado->aciertoTLB = true;
+    } else {
+        if (gestor->entradasTLB > 0) {
+            gestor->fallosTLB++;
         }
+        
+        // Buscar la página en la tabla de páginas (y un hueco liberado por si no está)
+        long accesosPrevios = gestor->accesosTabla;
+        pagina = buscarEnTablaPaginas(idProceso, numPagina, &hueco);
+        gestor->nsSimulados += COSTE_MEMORIA_NS * (gestor->accesosTabla - accesosPrevios);
     }
     
     // Si la página no existe, crearla
     if (pagina == NULL) {
-        if (gestorMemoria.numPaginas >= MAX_PAGINAS) {
-            colorRojo();
-            printf("Error: Se alcanzó el límite máximo de páginas\n");
-            colorReset();
-            return -1;
+        short *ranura = NULL;
+        
+        // En el radix, antes hay que poder colgarla del árbol del proceso
+        if (gestor->tipoTablaPaginas == TABLA_PAGINAS_RADIX) {
+            ranura = ranuraRadix(idProceso, numPagina, true);
+            if (ranura == NULL) {
+                gestor->rechazosRadix++;
+                return -1;
+            }
+        }
+        if (hueco == -1) {
+            if (gestor->numPaginas >= MAX_PAGINAS) {
+                return -1;
+            }
+            hueco = gestor->numPaginas++;
         }
         
-        pagina = &gestorMemoria.tablaPaginas[gestorMemoria.numPaginas];
+        pagina = &gestor->tablaPaginas[hueco];
         pagina->idProceso = idProceso;
         pagina->numPagina = numPagina;
         pagina->idCarta = idCarta;
-        pagina->tiempoUltimoUso = gestorMemoria.contadorTiempo; // CORRECCIÓN: Tiempo actual
-        pagina->bitReferencia = true;
         pagina->bitModificacion = false;
+        pagina->edad = 0;
         pagina->enMemoria = false;
         pagina->marcoAsignado = -1;
-        
-        gestorMemoria.numPaginas++;
+        if (ranura != NULL) {
+            *ranura = (short)hueco;
+        }
     }
     
     // CORRECCIÓN: Actualizar tiempo de último uso SIEMPRE que se accede a la página
-    pagina->tiempoUltimoUso = gestorMemoria.contadorTiempo;
+    pagina->tiempoUltimoUso = gestor->contadorTiempo;
     pagina->bitReferencia = true;
     
+    // Guardar otra carta en la página es una escritura
+    if (pagina->idCarta != idCarta) {
+        pagina->idCarta = idCarta;
+        pagina->bitModificacion = true;
+    }
+    
     // Si la página está en memoria, es un acierto
     if (pagina->enMemoria) {
-        gestorMemoria.aciertosMemoria++;
-        
-        colorVerde();
-        printf("Acierto de memoria: Proceso %d, Página %d, Marco %d, Tiempo: %d\n", 
-               idProceso, numPagina, pagina->marcoAsignado, pagina->tiempoUltimoUso);
-        colorReset();
-        
+        if (!resultado->aciertoTLB) {
+            cargarEnTLB(idProceso, numPagina, (int)(pagina - gestor->tablaPaginas));
+        }
+        gestor->aciertosMemoria++;
+        estadisticas->aciertos++;
+        resultado->acierto = true;
+        resultado->marco = pagina->marcoAsignado;
         return pagina->marcoAsignado;
     }
     
     // Si no está en memoria, es un fallo de página
-    gestorMemoria.fallosPagina++;
-    
-    colorAmarillo();
-    printf("Fallo de página: Proceso %d, Página %d (Carta %d), Tiempo: %d\n", 
-           idProceso, numPagina, idCarta, gestorMemoria.contadorTiempo);
-    colorReset();
+    gestor->fallosPagina++;
+    estadisticas->fallos++;
+    gestor->nsSimulados += COSTE_DISCO_NS;
     
     // Buscar un marco libre
     int marcoLibre = -1;
     for (int i = 0; i < NUM_MARCOS; i++) {
-        if (gestorMemoria.marcosMemoria[i].libre) {
+        if (gestor->marcosMemoria[i].libre) {
             marcoLibre = i;
             break;
         }
     }
     
-    // Si no hay marcos libres, usar LRU para seleccionar víctima
+    // Si no hay marcos libres, la política elige la víctima
     if (marcoLibre == -1) {
-        marcoLibre = seleccionarVictimaLRU();
-        
-
-        Pagina *paginaVictima = NULL;
-        for (int i = 0; i < gestorMemoria.numPaginas; i++) {
-            if (gestorMemoria.tablaPaginas[i].enMemoria && 
-                gestorMemoria.tablaPaginas[i].marcoAsignado == marcoLibre) {
-                paginaVictima = &gestorMemoria.tablaPaginas[i];
-                break;
-            }
-        }
-        
+        struct timespec inicio, fin;
+
+        examinadosSeleccion = 0;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        marcoLibre = seleccionarVictima();
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+        estadisticas->reemplazos++;
+        estadisticas->examinados += examinadosSeleccion;
+        estadisticas->nsSeleccion += (fin.tv_sec - inicio.tv_sec) * 1000000000L + (fin.tv_nsec - inicio.tv_nsec);
+
+        Pagina *paginaVictima = paginaEnMarco(marcoLibre);
         if (paginaVictima != NULL) {
-            colorAmarillo();
-            printf("Reemplazo LRU: Víctima Proceso %d, Página %d, Marco %d, Tiempo último uso: %d\n", 
-                   paginaVictima->idProceso, paginaVictima->numPagina, marcoLibre, paginaVictima->tiempoUltimoUso);
-            colorReset();
+            resultado->reemplazo = true;
+            resultado->procesoVictima = paginaVictima->idProceso;
+            resultado->paginaVictima = paginaVictima->numPagina;
+            resultado->tiempoVictima = paginaVictima->tiempoUltimoUso;
+            
+            // Una víctima modificada se escribe antes de perder el marco
+            if (paginaVictima->bitModificacion) {
+                escribirPaginaDisco(paginaVictima);
+                resultado->victimaModificada = true;
+                gestor->nsSimulados += COSTE_DISCO_NS;
+            }
+            invalidarEnTLB(paginaVictima->idProceso, paginaVictima->numPagina);
+            quitarInvertida(marcoLibre);
             
             // Marcar la página víctima como no en memoria
             paginaVictima->enMemoria = false;
             paginaVictima->marcoAsignado = -1;
-            
-            registrarEvento("Reemplazo LRU: Víctima Proceso %d, Página %d, Marco %d, Tiempo: %d", 
-                           paginaVictima->idProceso, paginaVictima->numPagina, marcoLibre, paginaVictima->tiempoUltimoUso);
         }
     }
     
     // Asignar el marco a la página
     pagina->enMemoria = true;
     pagina->marcoAsignado = marcoLibre;
+    pagina->edad = 0;
     
     // Actualizar el marco
-    gestorMemoria.marcosMemoria[marcoLibre].idProceso = idProceso;
-    gestorMemoria.marcosMemoria[marcoLibre].numPagina = numPagina;
-    gestorMemoria.marcosMemoria[marcoLibre].libre = false;
+    gestor->marcosMemoria[marcoLibre].idProceso = idProceso;
+    gestor->marcosMemoria[marcoLibre].numPagina = numPagina;
+    gestor->marcosMemoria[marcoLibre].indicePagina = (int)(pagina - gestor->tablaPaginas);
+    gestor->marcosMemoria[marcoLibre].libre = false;
+    cargarEnTLB(idProceso, numPagina, gestor->marcosMemoria[marcoLibre].indicePagina);
+    insertarInvertida(marcoLibre);
+    
+    resultado->marco = marcoLibre;
+    return marcoLibre;
+}
+
+// Avanzar el reloj de accesos desde un acierto compartido, salvo si el
+// siguiente tiempo toca envejecer (NFU), que recorre todas las páginas y va
+// por el camino exclusivo: entonces -1
+static int avanzarTiempoCompartido(void) {
+    int tiempo = __atomic_load_n(&gestor->contadorTiempo, __ATOMIC_RELAXED);
+
+    do {
+        if (gestor->politicaReemplazo == REEMPLAZO_NFU && (tiempo + 1) % INTERVALO_ENVEJECIMIENTO == 0) {
+            return -1;
+        }
+    } while (!__atomic_compare_exchange_n(&gestor->contadorTiempo, &tiempo, tiempo + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return tiempo + 1;
+}
+
+// Un acierto de la TLB en el gestor de la partida sin excluir a los demás
+// hilos. Con candadoPaginas en compartido nadie carga ni desaloja páginas ni
+// cambia la TLB; el candado de la franja ordena a los que aciertan en la
+// misma página (y en su entrada de la TLB). Falso, sin haber contado nada,
+// si hace falta el camino exclusivo
+static bool aciertoCompartido(int idProceso, int numPagina, int idCarta, ResultadoAcceso *resultado) {
+    unsigned franja = ((unsigned)idProceso * 0x9E3779B1u ^ (unsigned)numPagina) % FRANJAS_PAGINAS;
+    int tiempo = -1;
+
+    BLOQUEAR_LECTURA(&candadoPaginas);
+    BLOQUEAR(&franjasPaginas[franja]);
+    EntradaTLB *entrada = entradaEnTLB(idProceso, numPagina);
+    if (entrada != NULL) {
+        tiempo = avanzarTiempoCompartido();
+    }
+    if (tiempo >= 0) {
+        Pagina *pagina = &gestor->tablaPaginas[entrada->indicePagina];
+
+        grabarEventoMemoria(TRAZA_ACCESO, idProceso, numPagina, idCarta);
+        entrada->ultimoUso = tiempo;
+        pagina->tiempoUltimoUso = tiempo;
+        pagina->bitReferencia = true;
+        if (pagina->idCarta != idCarta) {
+            pagina->idCarta = idCarta;
+            pagina->bitModificacion = true;
+        }
+        __atomic_add_fetch(&gestor->aciertosTLB, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&gestor->aciertosMemoria, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&gestor->estadisticasReemplazo[gestor->politicaReemplazo].aciertos, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&gestor->nsSimulados, COSTE_MEMORIA_NS + COSTE_TLB_NS, __ATOMIC_RELAXED);
+
+        memset(resultado, 0, sizeof(*resultado));
+        resultado->marco = pagina->marcoAsignado;
+        resultado->acierto = true;
+        resultado->aciertoTLB = true;
+        resultado->tiempo = tiempo;
+    }
+    DESBLOQUEAR(&franjasPaginas[franja]);
+    DESBLOQUEAR_RW(&candadoPaginas);
+    return tiempo >= 0;
+}
+
+// Resolver un acceso sin mensajes: en el gestor de la partida, primero como
+// acierto compartido y, si no, con la tabla de páginas en exclusiva
+static int accederSinMensajes(int idProceso, int numPagina, int idCarta, ResultadoAcceso *resultado) {
+    if (gestorCompartido() && aciertoCompartido(idProceso, numPagina, idCarta, resultado)) {
+        return resultado->marco;
+    }
+    bloquearPaginas();
+    grabarEventoMemoria(TRAZA_ACCESO, idProceso, numPagina, idCarta);
+    int marco = resolverAcceso(idProceso, numPagina, idCarta, resultado);
+    desbloquearPaginas();
+    return marco;
+}
+
+// Acceder a una página (leer o escribir)
+int accederPagina(int idProceso, int numPagina, int idCarta) {
+    ResultadoAcceso resultado;
+
+    int marco = accederSinMensajes(idProceso, numPagina, idCarta, &resultado);
+    
+    if (marco == -1) {
+        imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: No hay sitio para la página %d del proceso %d en la tabla de páginas\n",
+                              numPagina, idProceso);
+        return -1;
+    }
     
-    colorVerde();
-    printf("Página cargada: Proceso %d, Página %d -> Marco %d, Tiempo: %d\n", 
-           idProceso, numPagina, marcoLibre, gestorMemoria.contadorTiempo);
-    colorReset();
+    if (resultado.acierto) {
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Acierto de memoria%s: Proceso %d, Página %d, Marco %d, Tiempo: %d\n", 
+               resultado.aciertoTLB ? " (TLB)" : "", idProceso, numPagina, marco, resultado.tiempo);
+        return marco;
+    }
+    
+    imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Fallo de página: Proceso %d, Página %d (Carta %d), Tiempo: %d\n", 
+           idProceso, numPagina, idCarta, resultado.tiempo);
+    
+    if (resultado.reemplazo) {
+        const char *politica = nombrePoliticaReemplazo(gestor->politicaReemplazo);
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Reemplazo %s: Víctima Proceso %d, Página %d, Marco %d, Tiempo último uso: %d%s\n", 
+               politica, resultado.procesoVictima, resultado.paginaVictima, marco, resultado.tiempoVictima,
+               resultado.victimaModificada ? " (escrita a disco)" : "");
+        registrarEvento("Reemplazo %s: Víctima Proceso %d, Página %d, Marco %d, Tiempo: %d", 
+                       politica, resultado.procesoVictima, resultado.paginaVictima, marco, resultado.tiempoVictima);
+    }
+    
+    imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Página cargada: Proceso %d, Página %d -> Marco %d, Tiempo: %d\n", 
+           idProceso, numPagina, marco, resultado.tiempo);
     
     registrarEvento("Fallo de página: Proceso %d, Página %d -> Marco %d, Tiempo: %d", 
-                   idProceso, numPagina, marcoLibre, gestorMemoria.contadorTiempo);
+                   idProceso, numPagina, marco, resultado.tiempo);
     
-    return marcoLibre;
+    return marco;
 }
 
 
@@ -596,15 +1743,16 @@ int seleccionarVictimaLRU(void) {
     
     // Buscar la página con el tiempo de último uso MÁS ANTIGUO (menor)
     for (int i = 0; i < NUM_MARCOS; i++) {
-        if (!gestorMemoria.marcosMemoria[i].libre) {
+        if (!gestor->marcosMemoria[i].libre) {
  
-            for (int j = 0; j < gestorMemoria.numPaginas; j++) {
-                if (gestorMemoria.tablaPaginas[j].enMemoria && 
-                    gestorMemoria.tablaPaginas[j].marcoAsignado == i) {
+            for (int j = 0; j < gestor->numPaginas; j++) {
+                examinadosSeleccion++;
+                if (gestor->tablaPaginas[j].enMemoria && 
+                    gestor->tablaPaginas[j].marcoAsignado == i) {
                     
                     //Seleccionar la página con MENOR tiempo de último uso
-                    if (gestorMemoria.tablaPaginas[j].tiempoUltimoUso < tiempoMasAntiguo) {
-                        tiempoMasAntiguo = gestorMemoria.tablaPaginas[j].tiempoUltimoUso;
+                    if (gestor->tablaPaginas[j].tiempoUltimoUso < tiempoMasAntiguo) {
+                        tiempoMasAntiguo = gestor->tablaPaginas[j].tiempoUltimoUso;
                         marcoVictima = i;
                     }
                     
@@ -617,7 +1765,7 @@ int seleccionarVictimaLRU(void) {
     if (marcoVictima == -1) {
 
         for (int i = 0; i < NUM_MARCOS; i++) {
-            if (!gestorMemoria.marcosMemoria[i].libre) {
+            if (!gestor->marcosMemoria[i].libre) {
                 marcoVictima = i;
                 break;
             }
@@ -628,46 +1776,99 @@ int seleccionarVictimaLRU(void) {
 }
 
 
-// Liberar todas las páginas de un proceso
-void liberarPaginasProceso(int idProceso) {
-    for (int i = 0; i < gestorMemoria.numPaginas; i++) {
-        if (gestorMemoria.tablaPaginas[i].idProceso == idProceso) {
+// Quitar de la tabla y de los marcos las páginas de un proceso, sin mensajes
+static void soltarPaginasProceso(int idProceso) {
+    vaciarTLBProceso(idProceso);
+    for (int i = 0; i < gestor->numPaginas; i++) {
+        if (gestor->tablaPaginas[i].idProceso == idProceso) {
             // Si la página está en memoria, liberar el marco
-            if (gestorMemoria.tablaPaginas[i].enMemoria) {
-                int marco = gestorMemoria.tablaPaginas[i].marcoAsignado;
-                gestorMemoria.marcosMemoria[marco].idProceso = -1;
-                gestorMemoria.marcosMemoria[marco].numPagina = -1;
-                gestorMemoria.marcosMemoria[marco].libre = true;
+            if (gestor->tablaPaginas[i].enMemoria) {
+                int marco = gestor->tablaPaginas[i].marcoAsignado;
+                quitarInvertida(marco);
+                gestor->marcosMemoria[marco].idProceso = -1;
+                gestor->marcosMemoria[marco].numPagina = -1;
+                gestor->marcosMemoria[marco].indicePagina = -1;
+                gestor->marcosMemoria[marco].libre = true;
             }
             
             // Marcar la página como no utilizada
-            gestorMemoria.tablaPaginas[i].idProceso = -1;
-            gestorMemoria.tablaPaginas[i].numPagina = -1;
-            gestorMemoria.tablaPaginas[i].idCarta = -1;
-            gestorMemoria.tablaPaginas[i].enMemoria = false;
-            gestorMemoria.tablaPaginas[i].marcoAsignado = -1;
+            gestor->tablaPaginas[i].idProceso = -1;
+            gestor->tablaPaginas[i].numPagina = -1;
+            gestor->tablaPaginas[i].idCarta = -1;
+            gestor->tablaPaginas[i].bitModificacion = false;
+            gestor->tablaPaginas[i].enMemoria = false;
+            gestor->tablaPaginas[i].marcoAsignado = -1;
         }
     }
     
+    // El árbol del proceso vuelve entero al pool
+    if (gestor->tipoTablaPaginas == TABLA_PAGINAS_RADIX && idProceso >= 0 && idProceso < MAX_PROCESOS_MEMORIA &&
+        gestor->raizRadix[idProceso] != -1) {
+        liberarArbolRadix(gestor->raizRadix[idProceso], gestor->nivelesRadix - 1);
+        gestor->raizRadix[idProceso] = -1;
+    }
+}
+
+// Liberar todas las páginas de un proceso
+void liberarPaginasProceso(int idProceso) {
+    bloquearPaginas();
+    grabarEventoMemoria(TRAZA_LIBERAR_PAGINAS, idProceso, 0, 0);
+    soltarPaginasProceso(idProceso);
+    desbloquearPaginas();
+    
     // Registrar evento
     registrarEvento("Páginas liberadas: Proceso %d", idProceso);
 }
 
 // Imprimir el estado actual de la memoria virtual
 void imprimirEstadoMemoriaVirtual(void) {
-    printf("\n=== ESTADO DE LA MEMORIA VIRTUAL (LRU) ===\n");
-    printf("Algoritmo: LRU (Least Recently Used)\n");
+    bloquearPaginas();
+    printf("\n=== ESTADO DE LA MEMORIA VIRTUAL ===\n");
+    printf("Política de reemplazo: %s\n", nombrePoliticaReemplazo(gestor->politicaReemplazo));
     printf("Marcos totales: %d\n", NUM_MARCOS);
     printf("Páginas por marco: %d\n", PAGINAS_POR_MARCO);
-    printf("Fallos de página: %d\n", gestorMemoria.fallosPagina);
-    printf("Aciertos de memoria: %d\n", gestorMemoria.aciertosMemoria);
-    printf("Tiempo actual del sistema: %d\n", gestorMemoria.contadorTiempo);
+    printf("Fallos de página: %d\n", gestor->fallosPagina);
+    printf("Aciertos de memoria: %d\n", gestor->aciertosMemoria);
+    printf("Tiempo actual del sistema: %d\n", gestor->contadorTiempo);
     
-    if (gestorMemoria.fallosPagina + gestorMemoria.aciertosMemoria > 0) {
-        float tasaAciertos = (float)gestorMemoria.aciertosMemoria / 
-                            (gestorMemoria.fallosPagina + gestorMemoria.aciertosMemoria) * 100;
+    if (gestor->fallosPagina + gestor->aciertosMemoria > 0) {
+        float tasaAciertos = (float)gestor->aciertosMemoria / 
+                            (gestor->fallosPagina + gestor->aciertosMemoria) * 100;
         printf("Tasa de aciertos: %.2f%%\n", tasaAciertos);
     }
+    if (gestor->entradasTLB > 0) {
+        int consultas = gestor->aciertosTLB + gestor->fallosTLB;
+        printf("TLB: %d entradas de %d vías; %d aciertos, %d fallos (%.2f%% de aciertos), %d vaciados\n",
+               gestor->entradasTLB, gestor->viasTLB, gestor->aciertosTLB, gestor->fallosTLB,
+               consultas > 0 ? 100.0 * gestor->aciertosTLB / consultas : 0.0, gestor->vaciadosTLB);
+    } else {
+        printf("TLB: desactivada\n");
+    }
+    printf("Tabla de páginas: %s, %d bytes de traducción, %.1f accesos por búsqueda\n",
+           nombreTablaPaginas(gestor->tipoTablaPaginas, gestor->nivelesRadix), bytesTablaPaginas(),
+           gestor->recorridosTabla > 0 ? (double)gestor->accesosTabla / gestor->recorridosTabla : 0.0);
+    if (gestor->rechazosRadix > 0) {
+        printf("Páginas que no cupieron en el pool del radix: %d\n", gestor->rechazosRadix);
+    }
+    if (gestor->fallosPagina + gestor->aciertosMemoria > 0) {
+        printf("Tiempo efectivo de acceso (simulado): %.1f ns\n",
+               (double)gestor->nsSimulados / (gestor->fallosPagina + gestor->aciertosMemoria));
+    }
+    
+    // Cada política con los accesos que hubo mientras estuvo seleccionada
+    printf("\n%-28s %8s %8s %10s %12s %12s %10s\n", "Política", "Accesos", "Fallos", "Reemplazos",
+           "Examinados", "ns/reempl.", "Escrituras");
+    for (int p = 0; p < NUM_POLITICAS_REEMPLAZO; p++) {
+        EstadisticasReemplazo *e = &gestor->estadisticasReemplazo[p];
+        int accesos = e->aciertos + e->fallos;
+        if (accesos == 0) {
+            continue;
+        }
+        printf("%-28s %8d %7.1f%% %10d %12.1f %12.0f %10d\n", nombrePoliticaReemplazo(p), accesos,
+               100.0 * e->fallos / accesos, e->reemplazos,
+               e->reemplazos > 0 ? (double)e->examinados / e->reemplazos : 0.0,
+               e->reemplazos > 0 ? (double)e->nsSeleccion / e->reemplazos : 0.0, e->escrituras);
+    }
     
     printf("\nMarcos en memoria principal:\n");
     printf("%-8s %-10s %-10s %-12s %-10s\n", "Marco", "Proceso", "Página", "Tiempo Uso", "Estado");
@@ -676,16 +1877,16 @@ void imprimirEstadoMemoriaVirtual(void) {
     for (int i = 0; i < NUM_MARCOS; i++) {
         printf("%-8d %-10d %-10d ", 
                i,
-               gestorMemoria.marcosMemoria[i].idProceso,
-               gestorMemoria.marcosMemoria[i].numPagina);
+               gestor->marcosMemoria[i].idProceso,
+               gestor->marcosMemoria[i].numPagina);
         
         // Buscar el tiempo de último uso de la página en este marco
         int tiempoUso = -1;
-        if (!gestorMemoria.marcosMemoria[i].libre) {
-            for (int j = 0; j < gestorMemoria.numPaginas; j++) {
-                if (gestorMemoria.tablaPaginas[j].enMemoria && 
-                    gestorMemoria.tablaPaginas[j].marcoAsignado == i) {
-                    tiempoUso = gestorMemoria.tablaPaginas[j].tiempoUltimoUso;
+        if (!gestor->marcosMemoria[i].libre) {
+            for (int j = 0; j < gestor->numPaginas; j++) {
+                if (gestor->tablaPaginas[j].enMemoria && 
+                    gestor->tablaPaginas[j].marcoAsignado == i) {
+                    tiempoUso = gestor->tablaPaginas[j].tiempoUltimoUso;
                     break;
                 }
             }
@@ -693,7 +1894,7 @@ void imprimirEstadoMemoriaVirtual(void) {
         
         printf("%-12d %-10s\n", 
                tiempoUso,
-               gestorMemoria.marcosMemoria[i].libre ? "Libre" : "Ocupado");
+               gestor->marcosMemoria[i].libre ? "Libre" : "Ocupado");
     }
     
     printf("\nPáginas en memoria (ordenadas por tiempo de uso):\n");
@@ -710,10 +1911,10 @@ void imprimirEstadoMemoriaVirtual(void) {
     PaginaOrdenada paginasOrdenadas[MAX_PAGINAS];
     int numPaginasActivas = 0;
     
-    for (int i = 0; i < gestorMemoria.numPaginas; i++) {
-        if (gestorMemoria.tablaPaginas[i].idProceso != -1) {
+    for (int i = 0; i < gestor->numPaginas; i++) {
+        if (gestor->tablaPaginas[i].idProceso != -1) {
             paginasOrdenadas[numPaginasActivas].indice = i;
-            paginasOrdenadas[numPaginasActivas].tiempoUso = gestorMemoria.tablaPaginas[i].tiempoUltimoUso;
+            paginasOrdenadas[numPaginasActivas].tiempoUso = gestor->tablaPaginas[i].tiempoUltimoUso;
             numPaginasActivas++;
         }
     }
@@ -733,7 +1934,7 @@ void imprimirEstadoMemoriaVirtual(void) {
     int mostradas = 0;
     for (int i = 0; i < numPaginasActivas && mostradas < 10; i++) {
         int idx = paginasOrdenadas[i].indice;
-        Pagina *p = &gestorMemoria.tablaPaginas[idx];
+        Pagina *p = &gestor->tablaPaginas[idx];
         
         printf("%-8d %-8d %-8d %-12d %-8d %-8s\n", 
                p->idProceso,
@@ -750,21 +1951,721 @@ void imprimirEstadoMemoriaVirtual(void) {
     }
     
     printf("===========================\n\n");
+    desbloquearPaginas();
 }
 
 // Cambiar entre algoritmos de memoria
 void cambiarAlgoritmoMemoria(int nuevoAlgoritmo) {
-    if (nuevoAlgoritmo != ALG_AJUSTE_OPTIMO && nuevoAlgoritmo != ALG_LRU && nuevoAlgoritmo != ALG_MAPA_BITS) {
+    if (nuevoAlgoritmo != ALG_AJUSTE_OPTIMO && nuevoAlgoritmo != ALG_LRU && nuevoAlgoritmo != ALG_MAPA_BITS &&
+        nuevoAlgoritmo != ALG_BUDDY) {
         printf("Error: Algoritmo de memoria no válido\n");
         return;
     }
     
-    gestorMemoria.algoritmoActual = nuevoAlgoritmo;
+    bloquearParticiones();
+    gestor->algoritmoActual = nuevoAlgoritmo;
+    desbloquearParticiones();
+    
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_CIAN, "Algoritmo de memoria cambiado a: %s\n", nombreAlgoritmoMemoria(nuevoAlgoritmo));
+
+    registrarEvento("Algoritmo de memoria cambiado a: %s", nombreAlgoritmoMemoria(nuevoAlgoritmo));
+}
+
+// Cambiar la política de reemplazo de páginas
+void cambiarPoliticaReemplazo(int politica) {
+    if (politica < 0 || politica >= NUM_POLITICAS_REEMPLAZO) {
+        printf("Error: Política de reemplazo no válida\n");
+        return;
+    }
+    
+    bloquearPaginas();
+    gestor->politicaReemplazo = politica;
+    desbloquearPaginas();
     
-    const char *nombres[] = {"Ajuste Óptimo", "LRU (Least Recently Used)", "Mapa de Bits"}; 
-    colorCian();
-    printf("Algoritmo de memoria cambiado a: %s\n", nombres[nuevoAlgoritmo]);
-    colorReset();
+    imprimirRegistroColor(REGISTRO_RESUMEN, COLOR_CIAN, "Política de reemplazo cambiada a: %s\n", nombrePoliticaReemplazo(politica));
+
+    registrarEvento("Política de reemplazo cambiada a: %s", nombrePoliticaReemplazo(politica));
+}
+
+//---------------------- Bancos de pruebas -----------------------
+
+typedef struct {
+    long asignaciones;
+    long fallos;
+    long liberaciones;
+    double segundos;
+    double internaMedia;   // Bytes
+    double externaMedia;   // Porcentaje
+} ResultadoBancoMemoria;
+
+// xorshift64*, con la misma semilla para los tres algoritmos
+static unsigned long long aleatorioBancoMemoria(unsigned long long *estado) {
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return *estado * 0x2545F4914F6CDD1DULL;
+}
+
+// Una pasada del banco: cada operación elige un proceso; si tiene memoria la
+// libera y si no pide entre 8 y 128 bytes. Con medir, se muestrea además la
+// fragmentación (esa pasada no se cronometra). Al final se libera todo y la
+// memoria debe volver a ser un solo hueco
+static bool pasadaBancoMemoria(int algoritmo, int numOperaciones, bool medir, ResultadoBancoMemoria *resultado) {
+    bool tieneMemoria[PROCESOS_BANCO_MEMORIA] = {false};
+    unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+    struct timespec inicio, fin;
+    int muestras = 0;
+
+    reiniciarParticionamiento();
+    gestor->algoritmoActual = algoritmo;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int i = 0; i < numOperaciones; i++) {
+        unsigned long long x = aleatorioBancoMemoria(&estado);
+        int proceso = (int)(x % PROCESOS_BANCO_MEMORIA);
+
+        if (tieneMemoria[proceso]) {
+            liberarConAlgoritmo(algoritmo, proceso);
+            gestor->solicitadaProceso[proceso] = 0;
+            tieneMemoria[proceso] = false;
+            resultado->liberaciones++;
+        } else {
+            int cantidad = 8 + (int)((x >> 32) % 121);
+            if (cantidad <= gestor->memoriaDisponible &&
+                asignarConAlgoritmo(algoritmo, proceso, cantidad) >= 0) {
+                sumarSolicitada(proceso, cantidad);
+                tieneMemoria[proceso] = true;
+                resultado->asignaciones++;
+            } else {
+                resultado->fallos++;
+            }
+        }
+
+        if (medir && (i + 1) % MUESTREO_BANCO_MEMORIA == 0) {
+            int interna;
+            double externa;
+            medirFragmentacion(&interna, &externa);
+            resultado->internaMedia += interna;
+            resultado->externaMedia += externa;
+            muestras++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    resultado->segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+    if (muestras > 0) {
+        resultado->internaMedia /= muestras;
+        resultado->externaMedia /= muestras;
+    }
+
+    for (int p = 0; p < PROCESOS_BANCO_MEMORIA; p++) {
+        if (tieneMemoria[p]) {
+            liberarConAlgoritmo(algoritmo, p);
+        }
+    }
+
+    int libre, mayorHueco;
+    medirHuecos(algoritmo, &libre, &mayorHueco);
+    bool correcto = gestor->memoriaDisponible == MEM_TOTAL_SIZE &&
+                    libre == MEM_TOTAL_SIZE && mayorHueco == MEM_TOTAL_SIZE;
+    // Con todo fusionado, ningún par de compañeros tiene un solo libre
+    for (int i = 0; algoritmo == ALG_BUDDY && i < (int)sizeof(gestor->paresBuddy); i++) {
+        correcto = correcto && gestor->paresBuddy[i] == 0;
+    }
+    if (!correcto) {
+        printf("Error (%s): la memoria no quedó entera al liberar todo (%d disponibles, hueco mayor %d)\n",
+               nombreAlgoritmoMemoria(algoritmo), gestor->memoriaDisponible, mayorHueco);
+    }
+    return correcto;
+}
+
+bool ejecutarBancoMemoria(int numOperaciones) {
+    static const int algoritmos[] = {ALG_AJUSTE_OPTIMO, ALG_MAPA_BITS, ALG_BUDDY};
+    GestorMemoria guardado = *gestor;
+    bool correcto = true;
+
+    if (numOperaciones <= 0) {
+        printf("Número de operaciones inválido\n");
+        return false;
+    }
+
+    printf("Banco de la memoria: %d operaciones sobre %d bytes, %d procesos, peticiones de 8 a 128 bytes\n",
+           numOperaciones, MEM_TOTAL_SIZE, PROCESOS_BANCO_MEMORIA);
+    printf("  %-22s %12s %9s %15s %15s\n", "Algoritmo", "ops/s", "fallos", "frag. interna", "frag. externa");
+
+    for (int a = 0; a < (int)(sizeof(algoritmos) / sizeof(algoritmos[0])); a++) {
+        ResultadoBancoMemoria cronometrada = {0}, medida = {0};
+
+        correcto = pasadaBancoMemoria(algoritmos[a], numOperaciones, false, &cronometrada) && correcto;
+        correcto = pasadaBancoMemoria(algoritmos[a], numOperaciones, true, &medida) && correcto;
+
+        long pedidas = cronometrada.asignaciones + cronometrada.fallos;
+        printf("  %-22s %12.0f %8.1f%% %11.1f B %14.1f%%\n", nombreAlgoritmoMemoria(algoritmos[a]),
+               numOperaciones / (cronometrada.segundos > 0 ? cronometrada.segundos : 1e-9),
+               pedidas > 0 ? 100.0 * cronometrada.fallos / pedidas : 0.0,
+               medida.internaMedia, medida.externaMedia);
+    }
+
+    *gestor = guardado;
+    return correcto;
+}
+
+// Secuencia del banco de reemplazo: un proceso activo que cambia de vez en
+// cuando, tres de cada cuatro accesos a sus tres primeras páginas y un
+// tercio de escrituras (otra carta en la página)
+static void accesoBancoReemplazo(unsigned long long *estado, int *proceso, int *pagina, int *carta) {
+    unsigned long long x = aleatorioBancoMemoria(estado);
+
+    if (x % 32 == 0) {
+        *proceso = (int)((x >> 8) % PROCESOS_BANCO_REEMPLAZO);
+    }
+    *pagina = (x >> 16) % 4 != 0 ? (int)((x >> 20) % 3) : (int)((x >> 24) % PAGINAS_BANCO_REEMPLAZO);
+    *carta = (x >> 32) % 3 == 0 ? (int)((x >> 36) % 108) : -2;
+}
+
+bool ejecutarBancoReemplazo(int numAccesos) {
+    GestorMemoria guardado = *gestor;
+    bool correcto = true;
+
+    if (numAccesos <= 0) {
+        printf("Número de accesos inválido\n");
+        return false;
+    }
+
+    printf("Banco de reemplazo: %d accesos, %d marcos, %d procesos de %d páginas, ventana de WSClock %d\n",
+           numAccesos, NUM_MARCOS, PROCESOS_BANCO_REEMPLAZO, PAGINAS_BANCO_REEMPLAZO, VENTANA_CONJUNTO_TRABAJO);
+    printf("  %-28s %8s %12s %12s %10s %10s\n", "Política", "Fallos", "Examinados", "ns/reempl.", "ns/acceso", "Escrituras");
+
+    for (int politica = 0; politica < NUM_POLITICAS_REEMPLAZO; politica++) {
+        unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+        int cartaPagina[PROCESOS_BANCO_REEMPLAZO][PAGINAS_BANCO_REEMPLAZO];
+        int proceso = 0, pagina, carta;
+        ResultadoAcceso resultado;
+        struct timespec inicio, fin;
+
+        reiniciarMemoriaVirtual();
+        gestor->politicaReemplazo = politica;
+        for (int p = 0; p < PROCESOS_BANCO_REEMPLAZO; p++) {
+            for (int g = 0; g < PAGINAS_BANCO_REEMPLAZO; g++) {
+                cartaPagina[p][g] = g;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        for (int i = 0; i < numAccesos; i++) {
+            accesoBancoReemplazo(&estado, &proceso, &pagina, &carta);
+            if (carta != -2) {
+                cartaPagina[proceso][pagina] = carta;   // Escritura
+            }
+            if (resolverAcceso(proceso, pagina, cartaPagina[proceso][pagina], &resultado) < 0) {
+                correcto = false;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+        double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+
+        EstadisticasReemplazo *e = &gestor->estadisticasReemplazo[politica];
+        if (e->aciertos + e->fallos != numAccesos) {
+            correcto = false;
+        }
+        printf("  %-28s %7.2f%% %12.1f %12.0f %10.1f %10d\n", nombrePoliticaReemplazo(politica),
+               100.0 * e->fallos / numAccesos,
+               e->reemplazos > 0 ? (double)e->examinados / e->reemplazos : 0.0,
+               e->reemplazos > 0 ? (double)e->nsSeleccion / e->reemplazos : 0.0,
+               segundos * 1e9 / numAccesos, e->escrituras);
+    }
+
+    if (!correcto) {
+        printf("Error: hubo accesos sin resolver\n");
+    }
+    *gestor = guardado;
+    return correcto;
+}
+
+bool ejecutarBancoTLB(int numAccesos) {
+    static const int geometrias[][2] = {{0, 1}, {4, 1}, {4, 4}, {8, 2}, {16, 4}, {64, 8}};
+    GestorMemoria guardado = *gestor;
+    int fallosSinTLB = -1;
+    bool correcto = true;
+
+    if (numAccesos <= 0) {
+        printf("Número de accesos inválido\n");
+        return false;
+    }
+
+    printf("Banco de la TLB: %d accesos del banco de reemplazo con LRU, %d marcos\n", numAccesos, NUM_MARCOS);
+    printf("  Costes: TLB %d ns, memoria %d ns, disco %d ns\n", COSTE_TLB_NS, COSTE_MEMORIA_NS, COSTE_DISCO_NS);
+    printf("  %-16s %12s %12s %12s %16s\n", "TLB", "Aciertos", "Fallos pág.", "ns/acceso", "Acceso efectivo");
+
+    for (int g = 0; g < (int)(sizeof(geometrias) / sizeof(geometrias[0])); g++) {
+        unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+        int cartaPagina[PROCESOS_BANCO_REEMPLAZO][PAGINAS_BANCO_REEMPLAZO];
+        int proceso = 0, pagina, carta;
+        ResultadoAcceso resultado;
+        struct timespec inicio, fin;
+        char nombre[32];
+
+        reiniciarMemoriaVirtual();
+        reiniciarTLB(geometrias[g][0], geometrias[g][1]);
+        gestor->politicaReemplazo = REEMPLAZO_LRU;
+        for (int p = 0; p < PROCESOS_BANCO_REEMPLAZO; p++) {
+            for (int q = 0; q < PAGINAS_BANCO_REEMPLAZO; q++) {
+                cartaPagina[p][q] = q;
+            }
+        }
 
-    registrarEvento("Algoritmo de memoria cambiado a: %s", nombres[nuevoAlgoritmo]);
-}
\ No newline at end of file
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        for (int i = 0; i < numAccesos; i++) {
+            accesoBancoReemplazo(&estado, &proceso, &pagina, &carta);
+            if (carta != -2) {
+                cartaPagina[proceso][pagina] = carta;   // Escritura
+            }
+            if (resolverAcceso(proceso, pagina, cartaPagina[proceso][pagina], &resultado) < 0) {
+                correcto = false;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+        double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+
+        // La TLB solo acorta la traducción: los fallos de página son los mismos
+        if (fallosSinTLB == -1) {
+            fallosSinTLB = gestor->fallosPagina;
+        } else if (gestor->fallosPagina != fallosSinTLB) {
+            correcto = false;
+        }
+
+        if (geometrias[g][0] == 0) {
+            snprintf(nombre, sizeof(nombre), "sin TLB");
+        } else {
+            snprintf(nombre, sizeof(nombre), "%d x %d vías", geometrias[g][0], geometrias[g][1]);
+        }
+        printf("  %-16s %11.2f%% %11.2f%% %12.1f %13.1f ns\n", nombre,
+               100.0 * gestor->aciertosTLB / numAccesos, 100.0 * gestor->fallosPagina / numAccesos,
+               segundos * 1e9 / numAccesos, (double)gestor->nsSimulados / numAccesos);
+    }
+
+    if (!correcto) {
+        printf("Error: la TLB cambió los fallos de página o hubo accesos sin resolver\n");
+    }
+    *gestor = guardado;
+    return correcto;
+}
+
+// Las tres representaciones (y las dos profundidades del radix) con los
+// mismos accesos: 8 procesos de 12 páginas, un proceso activo que cambia de
+// vez en cuando y tres de cada cuatro accesos a sus tres primeras páginas.
+// De vez en cuando un proceso termina y libera sus páginas. En el espacio
+// denso las páginas son 0..11; en el disperso, 12 números al azar de 16 bits
+bool ejecutarBancoTablaPaginas(int numAccesos) {
+    static const int representaciones[][2] = {
+        {TABLA_PAGINAS_LINEAL, 2}, {TABLA_PAGINAS_RADIX, 2}, {TABLA_PAGINAS_RADIX, 4}, {TABLA_PAGINAS_INVERTIDA, 2}
+    };
+    GestorMemoria guardado = *gestor;
+    int numPaginaBanco[PROCESOS_BANCO_TABLA][PAGINAS_BANCO_TABLA];
+    bool correcto = true;
+
+    if (numAccesos <= 0) {
+        printf("Número de accesos inválido\n");
+        return false;
+    }
+
+    printf("Banco de la tabla de páginas: %d accesos sin TLB, %d procesos de %d páginas, %d marcos, LRU\n",
+           numAccesos, PROCESOS_BANCO_TABLA, PAGINAS_BANCO_TABLA, NUM_MARCOS);
+
+    for (int disperso = 0; disperso <= 1; disperso++) {
+        unsigned long long semilla = 0xD1B54A32D192ED03ULL;
+        int fallosEspacio = -1;
+
+        for (int p = 0; p < PROCESOS_BANCO_TABLA; p++) {
+            for (int g = 0; g < PAGINAS_BANCO_TABLA; g++) {
+                numPaginaBanco[p][g] = disperso ? (int)(aleatorioBancoMemoria(&semilla) % (MAX_NUMERO_PAGINA + 1)) : g;
+                for (int h = 0; h < g; h++) {
+                    if (numPaginaBanco[p][h] == numPaginaBanco[p][g]) {
+                        numPaginaBanco[p][g] = (numPaginaBanco[p][g] + 1) & MAX_NUMERO_PAGINA;
+                        h = -1;   // Repetida: probar la siguiente
+                    }
+                }
+            }
+        }
+
+        printf("\n  Espacio %s\n", disperso ? "disperso (páginas al azar entre 0 y 65535)" : "denso (páginas 0 a 11)");
+        printf("  %-20s %10s %12s %14s %10s %10s\n", "Tabla", "ns/acceso", "accesos/busq.", "bytes (máx.)",
+               "Fallos", "Rechazos");
+
+        for (int r = 0; r < (int)(sizeof(representaciones) / sizeof(representaciones[0])); r++) {
+            unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+            int proceso = 0, rechazados = 0;
+            ResultadoAcceso resultado;
+            struct timespec inicio, fin;
+
+            reiniciarMemoriaVirtual();
+            reiniciarTLB(0, 1);
+            reiniciarTablaPaginas(representaciones[r][0], representaciones[r][1]);
+            gestor->politicaReemplazo = REEMPLAZO_LRU;
+
+            clock_gettime(CLOCK_MONOTONIC, &inicio);
+            for (int i = 0; i < numAccesos; i++) {
+                unsigned long long x = aleatorioBancoMemoria(&estado);
+
+                if (x % 32 == 0) {
+                    proceso = (int)((x >> 8) % PROCESOS_BANCO_TABLA);
+                }
+                if ((x >> 40) % 512 == 0) {
+                    soltarPaginasProceso((int)((x >> 50) % PROCESOS_BANCO_TABLA));
+                }
+                int g = (x >> 16) % 4 != 0 ? (int)((x >> 20) % 3) : (int)((x >> 24) % PAGINAS_BANCO_TABLA);
+                if (resolverAcceso(proceso, numPaginaBanco[proceso][g], g, &resultado) < 0) {
+                    rechazados++;
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &fin);
+            double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+
+            // La lineal nunca encoge (numPaginas) y la invertida no cambia
+            int bytesMaximos = gestor->tipoTablaPaginas == TABLA_PAGINAS_RADIX ?
+                               (int)(sizeof(gestor->raizRadix) + gestor->maximoRadix * sizeof(gestor->entradasRadix[0])) :
+                               bytesTablaPaginas();
+
+            // La representación no cambia qué páginas están en memoria
+            if (rechazados == 0) {
+                if (fallosEspacio == -1) {
+                    fallosEspacio = gestor->fallosPagina;
+                } else if (gestor->fallosPagina != fallosEspacio) {
+                    correcto = false;
+                }
+            }
+            printf("  %-20s %10.1f %12.1f %14d %10d %10d\n",
+                   nombreTablaPaginas(representaciones[r][0], representaciones[r][1]),
+                   segundos * 1e9 / numAccesos, (double)gestor->accesosTabla / gestor->recorridosTabla,
+                   bytesMaximos, gestor->fallosPagina, rechazados);
+        }
+    }
+
+    if (!correcto) {
+        printf("Error: las representaciones no dieron los mismos fallos de página\n");
+    }
+    *gestor = guardado;
+    return correcto;
+}
+
+//---------------------- Reproducción de trazas -----------------------
+
+// Una pasada de los eventos de asignación de una traza con un algoritmo. Con
+// medir, se muestrea además la fragmentación (esa pasada no se cronometra).
+// Al final se libera todo y la memoria debe volver a ser un solo hueco
+static void pasadaReproduccionAsignacion(int algoritmo, const EventoTraza *eventos, long numEventos,
+                                         bool medir, ResultadoReproduccion *resultado) {
+    bool conMemoria[UINT8_MAX + 1] = {false};
+    struct timespec inicio, fin;
+    int particion, muestras = 0;
+
+    reiniciarMemoria(algoritmo);
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (long i = 0; i < numEventos; i++) {
+        const EventoTraza *evento = &eventos[i];
+
+        switch (evento->tipo) {
+            case TRAZA_ASIGNAR:
+                if (evento->valor > 0 && evento->valor <= gestor->memoriaDisponible &&
+                    asignarConAlgoritmo(algoritmo, evento->proceso, evento->valor) >= 0) {
+                    sumarSolicitada(evento->proceso, evento->valor);
+                    conMemoria[evento->proceso] = true;
+                    resultado->asignaciones++;
+                } else {
+                    resultado->fallosAsignacion++;
+                }
+                break;
+            case TRAZA_CRECER:
+                if (evento->valor > 0 &&
+                    crecerConAlgoritmo(algoritmo, evento->proceso, evento->valor, &particion) != SIN_ESPACIO) {
+                    resultado->crecimientos++;
+                } else {
+                    resultado->fallosCrecimiento++;
+                }
+                break;
+            case TRAZA_LIBERAR:
+                liberarConAlgoritmo(algoritmo, evento->proceso);
+                if (evento->proceso < MAX_PROCESOS_MEMORIA) {
+                    gestor->solicitadaProceso[evento->proceso] = 0;
+                }
+                conMemoria[evento->proceso] = false;
+                break;
+            default:
+                continue;   // Eventos de páginas
+        }
+        resultado->operaciones++;
+
+        if (medir && resultado->operaciones % MUESTREO_BANCO_MEMORIA == 0) {
+            int interna;
+            double externa;
+            medirFragmentacion(&interna, &externa);
+            resultado->internaMedia += interna;
+            resultado->externaMedia += externa;
+            muestras++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    resultado->segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+    if (muestras > 0) {
+        resultado->internaMedia /= muestras;
+        resultado->externaMedia /= muestras;
+    }
+
+    for (int p = 0; p <= UINT8_MAX; p++) {
+        if (conMemoria[p]) {
+            liberarConAlgoritmo(algoritmo, p);
+        }
+    }
+
+    int libre, mayorHueco;
+    medirHuecos(algoritmo, &libre, &mayorHueco);
+    resultado->memoriaEntera = gestor->memoriaDisponible == MEM_TOTAL_SIZE &&
+                               libre == MEM_TOTAL_SIZE && mayorHueco == MEM_TOTAL_SIZE;
+}
+
+// Los eventos de páginas de una traza con una política de reemplazo
+static void pasadaReproduccionReemplazo(int politica, const EventoTraza *eventos, long numEventos,
+                                        ResultadoReproduccion *resultado) {
+    ResultadoAcceso acceso;
+    struct timespec inicio, fin;
+
+    reiniciarMemoriaVirtual();
+    gestor->politicaReemplazo = politica;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (long i = 0; i < numEventos; i++) {
+        const EventoTraza *evento = &eventos[i];
+
+        if (evento->tipo == TRAZA_ACCESO) {
+            if (resolverAcceso(evento->proceso, evento->pagina, evento->valor, &acceso) < 0) {
+                resultado->accesosRechazados++;
+            }
+        } else if (evento->tipo == TRAZA_LIBERAR_PAGINAS) {
+            soltarPaginasProceso(evento->proceso);
+        } else {
+            continue;   // Eventos de asignación
+        }
+        resultado->operaciones++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    resultado->segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+    resultado->reemplazo = gestor->estadisticasReemplazo[politica];
+}
+
+void reproducirEventosMemoria(GestorMemoria *propio, int algoritmo, int politica,
+                              const EventoTraza *eventos, long numEventos, ResultadoReproduccion *resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    usarGestorMemoria(propio);
+    memset(gestor, 0, sizeof(*gestor));
+
+    if (algoritmo >= 0) {
+        ResultadoReproduccion medida = {0};
+
+        pasadaReproduccionAsignacion(algoritmo, eventos, numEventos, false, resultado);
+        pasadaReproduccionAsignacion(algoritmo, eventos, numEventos, true, &medida);
+        resultado->internaMedia = medida.internaMedia;
+        resultado->externaMedia = medida.externaMedia;
+        resultado->memoriaEntera = resultado->memoriaEntera && medida.memoriaEntera;
+    }
+    if (politica >= 0) {
+        pasadaReproduccionReemplazo(politica, eventos, numEventos, resultado);
+    }
+
+    usarGestorMemoria(NULL);
+}
+
+//---------------------- Banco de contención -----------------------
+
+typedef struct {
+    int hilo;
+    int numOperaciones;
+    bool candadoUnico;     // Cada operación bajo mutexBancoContencion
+    bool conSlabs;         // Pedir la memoria como la E/S, por los slabs
+    long accesos;          // Accesos a páginas hechos
+    long sinMemoria;       // Peticiones de memoria que no se pudieron atender
+    bool correcto;
+} DatosHiloContencion;
+
+// Un solo candado para todo el gestor, la referencia con la que se comparan
+// los de particiones y páginas
+static pthread_mutex_t mutexBancoContencion = PTHREAD_MUTEX_INITIALIZER;
+
+// Cada hilo es un proceso (su número): una de cada ocho operaciones pide o
+// devuelve su memoria, y el resto son accesos a sus páginas, siete de cada
+// ocho a las dos primeras y un cuarto de ellos escrituras. Al terminar
+// devuelve la memoria y las páginas (y los objetos de su magazine)
+static void* funcionHiloContencion(void *arg) {
+    DatosHiloContencion *datos = arg;
+    unsigned long long estado = 0x9E3779B97F4A7C15ULL * (unsigned long long)(datos->hilo + 1);
+    int proceso = datos->hilo;
+    int cartaPagina[PAGINAS_BANCO_REEMPLAZO];
+    bool tieneMemoria = false;
+    ResultadoAcceso resultado;
+
+    for (int g = 0; g < PAGINAS_BANCO_REEMPLAZO; g++) {
+        cartaPagina[g] = g;
+    }
+
+    for (int i = 0; i < datos->numOperaciones; i++) {
+        unsigned long long x = aleatorioBancoMemoria(&estado);
+
+        if (datos->candadoUnico) {
+            BLOQUEAR(&mutexBancoContencion);
+        }
+        if (x % 8 == 0) {
+            int cantidad = 16 + 4 * (int)(5 + (x >> 8) % 8);
+            if (tieneMemoria) {
+                if (datos->conSlabs) {
+                    devolverMemoriaSlab(proceso);
+                } else {
+                    devolverMemoriaProceso(proceso);
+                }
+                tieneMemoria = false;
+            } else {
+                tieneMemoria = datos->conSlabs ? asignarObjetoSlab(proceso, cantidad)
+                                               : reservarBloqueMemoria(proceso, cantidad) >= 0;
+                if (!tieneMemoria) {
+                    datos->sinMemoria++;
+                }
+            }
+        } else {
+            int pagina = (x >> 16) % 8 != 0 ? (int)((x >> 20) % 2) : (int)((x >> 24) % PAGINAS_BANCO_REEMPLAZO);
+            if ((x >> 32) % 4 == 0) {
+                cartaPagina[pagina] = (int)((x >> 36) % 108);   // Escritura
+            }
+            if (accederSinMensajes(proceso, pagina, cartaPagina[pagina], &resultado) < 0) {
+                datos->correcto = false;
+            }
+            datos->accesos++;
+        }
+        if (datos->candadoUnico) {
+            DESBLOQUEAR(&mutexBancoContencion);
+        }
+    }
+
+    if (datos->conSlabs) {
+        devolverMemoriaSlab(proceso);
+        vaciarMagazinesHilo();
+    } else {
+        devolverMemoriaProceso(proceso);
+    }
+    bloquearPaginas();
+    soltarPaginasProceso(proceso);
+    desbloquearPaginas();
+    return NULL;
+}
+
+bool ejecutarBancoContencionMemoria(int numOperaciones) {
+    static const int hilosPrueba[] = {1, 2, 4, MAX_HILOS_BANCO_CONTENCION};
+    static const int politicas[] = {REEMPLAZO_LRU, REEMPLAZO_NFU};
+    static const char *nombresModo[] = {"uno", "por subsistema", "slabs"};
+    GestorMemoria *anterior = gestor;
+    GestorMemoria guardado = gestorMemoria;
+    bool slabAnterior = slabESActivo();
+    bool correcto = true;
+
+    if (numOperaciones <= 0) {
+        printf("Número de operaciones inválido\n");
+        return false;
+    }
+
+    // Sobre el gestor de la partida, el que tiene los candados
+    usarGestorMemoria(NULL);
+    registrarCandadosMemoria();
+    configurarSlabES(true);
+    printf("Banco de contención de la memoria: %d operaciones por hilo (1 de cada 8, pedir o devolver memoria;\n"
+           "el resto, accesos a páginas), un proceso por hilo, %d marcos, TLB de %d entradas\n"
+           "(\"slabs\": candados por subsistema y la memoria por los slabs y magazines, como la E/S)\n",
+           numOperaciones, NUM_MARCOS, entradasTLBConfigurada);
+    printf("  %-28s %-16s %6s %14s %10s %9s %10s %12s %12s\n", "Política", "Candados", "Hilos", "Operaciones/s",
+           "ns/op", "Escala", "Aciertos", "TLB", "Sin memoria");
+
+    for (int p = 0; p < (int)(sizeof(politicas) / sizeof(politicas[0])); p++) {
+        long sinMemoriaDirecta[sizeof(hilosPrueba) / sizeof(hilosPrueba[0])] = {0};
+
+        for (int modo = 0; modo < 3; modo++) {
+            double operacionesUnHilo = 0.0;
+
+            for (int k = 0; k < (int)(sizeof(hilosPrueba) / sizeof(hilosPrueba[0])); k++) {
+                int numHilos = hilosPrueba[k];
+                pthread_t hilos[MAX_HILOS_BANCO_CONTENCION];
+                DatosHiloContencion datosHilos[MAX_HILOS_BANCO_CONTENCION];
+                struct timespec inicio, fin;
+                long accesos = 0;
+                long sinMemoria = 0;
+                int creados = 0;
+
+                reiniciarMemoria(ALG_AJUSTE_OPTIMO);
+                reiniciarMemoriaVirtual();
+                reiniciarSlabs();
+                gestor->politicaReemplazo = politicas[p];
+
+                clock_gettime(CLOCK_MONOTONIC, &inicio);
+                for (int h = 0; h < numHilos; h++) {
+                    datosHilos[h] = (DatosHiloContencion){h, numOperaciones, modo == 0, modo == 2, 0, 0, true};
+                    if (pthread_create(&hilos[h], NULL, funcionHiloContencion, &datosHilos[h]) != 0) {
+                        printf("Error: no se pudo crear el hilo %d del banco de contención\n", h);
+                        correcto = false;
+                        break;
+                    }
+                    creados++;
+                }
+                for (int h = 0; h < creados; h++) {
+                    pthread_join(hilos[h], NULL);
+                    accesos += datosHilos[h].accesos;
+                    sinMemoria += datosHilos[h].sinMemoria;
+                    correcto = correcto && datosHilos[h].correcto;
+                }
+                clock_gettime(CLOCK_MONOTONIC, &fin);
+                double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+
+                // Ningún acierto ni fallo perdido, y al terminar los hilos los
+                // marcos están libres
+                if (gestor->aciertosMemoria + gestor->fallosPagina != accesos) {
+                    correcto = false;
+                }
+                for (int m = 0; m < NUM_MARCOS; m++) {
+                    correcto = correcto && gestor->marcosMemoria[m].libre;
+                }
+
+                // La memoria vuelve a ser un hueco; con los slabs, una vez
+                // vaciados los magazines y devueltos los slabs vacíos. Y los
+                // magazines no deben dejar sin memoria más peticiones que el
+                // camino directo con los mismos hilos
+                devolverSlabsVacios();
+                if (gestor->memoriaDisponible != MEM_TOTAL_SIZE) {
+                    printf("Error: quedaron %d bytes sin devolver (%s, %d hilos)\n",
+                           MEM_TOTAL_SIZE - gestor->memoriaDisponible, nombresModo[modo], creados);
+                    correcto = false;
+                }
+                if (modo == 1) {
+                    sinMemoriaDirecta[k] = sinMemoria;
+                } else if (modo == 2 && sinMemoria > sinMemoriaDirecta[k]) {
+                    printf("Error: con los slabs quedaron sin memoria %ld peticiones y sin ellos %ld (%d hilos)\n",
+                           sinMemoria, sinMemoriaDirecta[k], creados);
+                    correcto = false;
+                }
+
+                double operaciones = segundos > 0 ? (double)creados * numOperaciones / segundos : 0.0;
+                if (numHilos == 1) {
+                    operacionesUnHilo = operaciones;
+                }
+                printf("  %-28s %-16s %6d %14.0f %10.1f %8.2fx %9.2f%% %11.2f%% %12ld\n",
+                       nombrePoliticaReemplazo(politicas[p]), nombresModo[modo], creados,
+                       operaciones, operaciones > 0 ? 1e9 / operaciones : 0.0,
+                       operacionesUnHilo > 0 ? operaciones / operacionesUnHilo : 0.0,
+                       accesos > 0 ? 100.0 * gestor->aciertosMemoria / accesos : 0.0,
+                       accesos > 0 ? 100.0 * gestor->aciertosTLB / accesos : 0.0, sinMemoria);
+            }
+        }
+    }
+
+    if (!correcto) {
+        printf("Error: se perdieron accesos o la memoria no quedó entera al terminar los hilos\n");
+    }
+    configurarSlabES(slabAnterior);
+    reiniciarSlabs();
+    gestorMemoria = guardado;
+    gestor = anterior;
+    return correcto;
+}
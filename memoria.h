@@ -13,6 +13,54 @@
 #define TAMANO_BLOQUE_BITMAP 16 // Define el tamaño de los bloques en bytes
 #define NUM_BLOQUES_BITMAP (MEM_TOTAL_SIZE / TAMANO_BLOQUE_BITMAP)
 #define ALG_MAPA_BITS 2 // Define un nuevo valor para Mapa de Bits
+#define BLOQUE_LIBRE_BITMAP 0xFF // Valor de un bloque libre en el mapa de bits
+
+// Sistema de compañeros (buddy): bloques de TAMANO_MINIMO_BUDDY << orden bytes
+#define ALG_BUDDY            3
+#define TAMANO_MINIMO_BUDDY  16
+#define ORDEN_MAXIMO_BUDDY   6       // 16 << 6 = MEM_TOTAL_SIZE
+#define NUM_BLOQUES_BUDDY    (MEM_TOTAL_SIZE / TAMANO_MINIMO_BUDDY)
+
+#define MAX_PROCESOS_MEMORIA 64      // Procesos cuyos bytes pedidos se contabilizan
+
+// Políticas de reemplazo de páginas de la memoria virtual
+#define REEMPLAZO_LRU        0
+#define REEMPLAZO_RELOJ      1       // Clock / segunda oportunidad
+#define REEMPLAZO_NFU        2       // NFU con envejecimiento (aging)
+#define REEMPLAZO_WSCLOCK    3
+#define NUM_POLITICAS_REEMPLAZO 4
+#define INTERVALO_ENVEJECIMIENTO 4   // Accesos entre dos desplazamientos de los contadores de NFU
+#define VENTANA_CONJUNTO_TRABAJO 12  // Ventana del conjunto de trabajo de WSClock, en accesos
+
+// TLB asociativa por conjuntos delante de la tabla de páginas. Las entradas
+// llevan el ASID (el idProceso), así que no se vacía al cambiar de proceso
+#define MAX_ENTRADAS_TLB     64
+#define ENTRADAS_TLB         8       // Por defecto, 4 conjuntos de 2 vías
+#define VIAS_TLB             2
+
+// Representaciones de la tabla de páginas. Los descriptores (Pagina) están
+// siempre en tablaPaginas; lo que cambia es cómo se encuentra el de
+// (proceso, página):
+// - lineal: recorriendo tablaPaginas
+// - radix: un árbol por proceso de 2 o 4 niveles sobre los 16 bits del
+//   número de página, con los nodos pedidos a un pool al usarse
+// - invertida: una entrada por marco (marcosMemoria) encadenada en cubetas
+//   por hash; las páginas que no están en memoria se buscan en tablaPaginas
+#define TABLA_PAGINAS_LINEAL     0
+#define TABLA_PAGINAS_RADIX      1
+#define TABLA_PAGINAS_INVERTIDA  2
+#define BITS_PAGINA_RADIX        16
+#define MAX_NUMERO_PAGINA        ((1 << BITS_PAGINA_RADIX) - 1)
+#define ENTRADAS_POOL_RADIX      32768   // Entradas de todos los nodos (los índices caben en short)
+#define CUBETAS_TABLA_INVERTIDA  8       // Potencia de 2, al menos NUM_MARCOS
+
+// Modelo de costes del acceso simulado, en ns: la consulta a la TLB, cada
+// acceso a memoria principal (el del dato y, si falla la TLB, los de la
+// búsqueda en la tabla de páginas: uno por entrada recorrida de la lineal,
+// por nivel del radix o por eslabón de la invertida) y el disco (traer la página o escribir la víctima)
+#define COSTE_TLB_NS         1
+#define COSTE_MEMORIA_NS     100
+#define COSTE_DISCO_NS       5000000
 
 // Algoritmos de asignación de memoria
 #define ALG_AJUSTE_OPTIMO  0
@@ -33,7 +81,8 @@ typedef struct {
     int idCarta;        // ID de la carta almacenada en esta página (-1 si no hay carta)
     int tiempoUltimoUso; // CRÍTICO: Tiempo del último uso (para LRU) - SE ACTUALIZA EN CADA ACCESO
     bool bitReferencia;  // Bit de referencia (para algoritmos que lo requieran)
-    bool bitModificacion; // Bit de modificación (para algoritmos que lo requieran)
+    bool bitModificacion; // Bit de modificación: se escribió otra carta en la página
+    unsigned char edad;  // Contador de envejecimiento de NFU (el bit alto, el último intervalo)
     bool enMemoria;      // Indica si la página está en memoria principal
     int marcoAsignado;   // Marco asignado en memoria principal (-1 si no está en memoria)
 } Pagina;
@@ -42,9 +91,29 @@ typedef struct {
 typedef struct {
     int idProceso;      // ID del proceso que está utilizando este marco (-1 si está libre)
     int numPagina;      // Número de página que está en este marco (-1 si está libre)
+    int indicePagina;   // Posición de esa página en la tabla de páginas (-1 si está libre)
     bool libre;         // Indica si el marco está libre
 } Marco;
 
+// Medidas de una política de reemplazo (mientras estuvo seleccionada)
+typedef struct {
+    int aciertos;
+    int fallos;
+    int reemplazos;
+    long examinados;    // Marcos o páginas revisados para elegir víctimas
+    long nsSeleccion;   // Tiempo total eligiendo víctimas
+    int escrituras;     // Páginas modificadas escritas a disco
+} EstadisticasReemplazo;
+
+// Entrada de la TLB: traduce (ASID, página) a la posición en la tabla de
+// páginas de una página que está en memoria
+typedef struct {
+    int asid;           // idProceso (-1 si la entrada está libre)
+    int numPagina;
+    int indicePagina;
+    int ultimoUso;      // Para el LRU dentro del conjunto
+} EntradaTLB;
+
 // Estructura principal para gestión de memoria
 typedef struct {
     // Para ajuste óptimo
@@ -60,10 +129,52 @@ typedef struct {
     int contadorTiempo;    // CRÍTICO: Contador global para el algoritmo LRU - SE INCREMENTA EN CADA ACCESO
     int fallosPagina;      // Contador de fallos de página
     int aciertosMemoria;   // Contador de aciertos de memoria
+    int politicaReemplazo; // REEMPLAZO_LRU, REEMPLAZO_RELOJ...
+    int manecilla;         // Siguiente marco del reloj (Clock y WSClock)
+    EstadisticasReemplazo estadisticasReemplazo[NUM_POLITICAS_REEMPLAZO];
+
+    // TLB: viasTLB entradas por conjunto, conjuntos consecutivos
+    EntradaTLB tlb[MAX_ENTRADAS_TLB];
+    int entradasTLB;       // 0: sin TLB
+    int viasTLB;
+    int mascaraTLB;        // Conjuntos - 1 (los conjuntos son potencia de 2)
+    int aciertosTLB;
+    int fallosTLB;
+    int vaciadosTLB;       // Procesos cuyas entradas se vaciaron al liberar sus páginas
+    long long nsSimulados; // Tiempo de acceso simulado (modelo de costes)
+
+    // Representación de la tabla de páginas
+    int tipoTablaPaginas;  // TABLA_PAGINAS_LINEAL, _RADIX o _INVERTIDA
+    int nivelesRadix;      // 2 o 4
+    short raizRadix[MAX_PROCESOS_MEMORIA];  // Nodo raíz de cada proceso (-1 si no tiene)
+    short entradasRadix[ENTRADAS_POOL_RADIX]; // Nodos: hijo o, en el último nivel, página (-1 vacía)
+    short libreRadix;      // Primer nodo liberado (la lista sigue por su primera entrada)
+    int topeRadix;         // Entradas del pool repartidas alguna vez
+    int usadasRadix;       // Entradas en nodos en uso
+    int maximoRadix;       // Máximo de usadasRadix
+    int rechazosRadix;     // Páginas que no cupieron en el pool
+    short cubetasInvertida[CUBETAS_TABLA_INVERTIDA]; // Primer marco de cada cubeta (-1 si no hay)
+    short siguienteInvertida[NUM_MARCOS];
+    long recorridosTabla;  // Búsquedas en la tabla de páginas (fallos de la TLB)
+    long accesosTabla;     // Accesos a memoria de esas búsquedas
     
     // Para Mapa de Bits
     unsigned char mapaBits[NUM_BLOQUES_BITMAP];
     int tamanoBloque;
+
+    // Para el sistema de compañeros. Un bloque se identifica por su primer
+    // bloque mínimo; las listas libres son dobles para poder sacar al
+    // compañero en O(1) al fusionar
+    short libreBuddy[ORDEN_MAXIMO_BUDDY + 1];    // Primer bloque libre de cada orden (-1 si no hay)
+    short siguienteBuddy[NUM_BLOQUES_BUDDY];
+    short anteriorBuddy[NUM_BLOQUES_BUDDY];
+    signed char ordenBuddy[NUM_BLOQUES_BUDDY];   // Orden del bloque ocupado que empieza aquí (-1 si no)
+    int procesoBuddy[NUM_BLOQUES_BUDDY];         // Proceso del bloque ocupado que empieza aquí
+    short usadoBuddy[NUM_BLOQUES_BUDDY];         // Bytes pedidos dentro de ese bloque
+    unsigned char paresBuddy[NUM_BLOQUES_BUDDY / 8]; // Un bit por par de compañeros: libre(A) XOR libre(B)
+
+    // Bytes pedidos por cada proceso, para la fragmentación interna
+    int solicitadaProceso[MAX_PROCESOS_MEMORIA];
     
     // Contador de crecimiento de procesos
     int creceProc1;        // ID del primer proceso que puede crecer
@@ -85,12 +196,73 @@ Pagina* buscarPaginaLibre(void);
 int seleccionarVictimaLRU(void);
 void imprimirEstadoMemoriaVirtual(void);
 
+// Geometría de la TLB (entradas potencia de 2, vías que las dividan; 0
+// entradas, sin TLB). Se aplica al inicializar la memoria virtual
+bool configurarTLB(int entradas, int vias);
+
+// Representación de la tabla de páginas (lineal, radix de 2 o 4 niveles o
+// invertida). Se aplica al inicializar la memoria virtual
+bool configurarTablaPaginas(int tipo, int niveles);
+
+// Bytes de la estructura de traducción de la representación actual
+int bytesTablaPaginas(void);
+
+// Banco de pruebas: las tres representaciones con un espacio virtual denso
+// y uno disperso, comparando latencia, memoria y fallos
+bool ejecutarBancoTablaPaginas(int numAccesos);
+
+// Banco de pruebas: los accesos del banco de reemplazo con varias TLB,
+// comparando aciertos, coste real por acceso y tiempo efectivo simulado
+bool ejecutarBancoTLB(int numAccesos);
+
+// Cambiar la política de reemplazo de páginas (LRU, Clock, NFU o WSClock)
+void cambiarPoliticaReemplazo(int politica);
+const char* nombrePoliticaReemplazo(int politica);
+
+// Banco de pruebas: la misma secuencia de numAccesos accesos con localidad
+// (y un tercio de escrituras) con cada política
+bool ejecutarBancoReemplazo(int numAccesos);
+
 // Funciones para cambio de algoritmo
 void cambiarAlgoritmoMemoria(int nuevoAlgoritmo);
 
 // Función para asignar memoria cuando un proceso entra en E/S
 bool asignarMemoriaES(int idProceso);
 
+// Asignar y liberar con el algoritmo actual sin mensajes ni eventos, para
+// las capas que van encima (los slabs de E/S). La dirección o -1; los bytes
+// liberados de las estructuras de los tres algoritmos
+int reservarBloqueMemoria(int idProceso, int cantidad);
+int devolverMemoriaProceso(int idProceso);
+
+// Dejar toda la memoria libre con un algoritmo, sin mensajes (bancos de pruebas)
+void reiniciarMemoria(int algoritmo);
+
+// Hacer que el hilo que llama trabaje sobre otro gestor (NULL: el de la
+// partida). Cada hilo del reproductor de trazas usa el suyo
+void usarGestorMemoria(GestorMemoria *propio);
+
+// Fragmentación del algoritmo actual: bytes asignados de más respecto a lo
+// pedido (interna) y porcentaje de la memoria libre que queda fuera del mayor
+// hueco (externa). No toma candados: con el gestor de la partida, llamarla
+// con la memoria bloqueada
+void medirFragmentacion(int *interna, double *externa);
+
+// Banco de pruebas: numOperaciones asignaciones y liberaciones aleatorias con
+// Ajuste Óptimo, Mapa de Bits y el sistema de compañeros
+bool ejecutarBancoMemoria(int numOperaciones);
+
+// Las funciones públicas toman los candados del gestor de la partida
+// (particiones y páginas por separado; ver memoria.c). Para leer el gestor
+// desde fuera (el panel), bloquear los dos
+void bloquearMemoria(void);
+void desbloquearMemoria(void);
+
+// Banco de pruebas: 1, 2, 4 y 8 hilos pidiendo memoria y accediendo a
+// páginas a la vez sobre el gestor de la partida, con un solo candado, con
+// los de cada subsistema y con estos pidiendo la memoria por los slabs
+bool ejecutarBancoContencionMemoria(int numOperaciones);
+
 // Variable global para el gestor de memoria
 extern GestorMemoria gestorMemoria;
 
@@ -2,53 +2,235 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "mesa.h"
+#include "mazo.h"
+#include "arena.h"
+#include "utilidades.h"
+#include "zobrist.h"
+#include "particion.h"
 
 // Variable global para la mesa
 Mesa mesaJuego;
 
+// Arreglo fijo de versiones; mutexVersiones solo se toma para ocupar una
+// libre y para devolver los bloques de la que se quedó sin referencias
+static VersionMesa versiones[MAX_VERSIONES_MESA];
+static pthread_mutex_t mutexVersiones = PTHREAD_MUTEX_INITIALIZER;
+
+#define INTENTOS_VERSION_LIBRE 1000   // De 1 ms, antes de dar el error
+
+// Ocupar una versión libre, vacía y con la referencia de quien la pide
+static VersionMesa* reservarVersion(void) {
+    for (int intento = 0; intento < INTENTOS_VERSION_LIBRE; intento++) {
+        pthread_mutex_lock(&mutexVersiones);
+        for (int i = 0; i < MAX_VERSIONES_MESA; i++) {
+            VersionMesa *version = &versiones[i];
+            int libre = 0;
+            // Un lector que llegó tarde puede tener una referencia a una
+            // versión sin ocupar: entonces no se puede tomar todavía
+            if (!version->ocupada &&
+                __atomic_compare_exchange_n(&version->referencias, &libre, 1, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+                version->ocupada = true;
+                inicializarTablaApeadas(&version->apeadas);
+                pthread_mutex_unlock(&mutexVersiones);
+                return version;
+            }
+        }
+        pthread_mutex_unlock(&mutexVersiones);
+        // Todas en uso: los lectores las sueltan enseguida
+        usleep(1000);
+    }
+    printf("Error: No hay versiones libres de la mesa (%d)\n", MAX_VERSIONES_MESA);
+    return NULL;
+}
+
+// Soltar una referencia; la última devuelve los bloques de la versión
+static void soltarVersion(VersionMesa *version) {
+    if (__atomic_sub_fetch(&version->referencias, 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+
+    // Otro lector pudo tomar una referencia mientras tanto: se comprueba otra vez
+    pthread_mutex_lock(&mutexVersiones);
+    if (version->ocupada && __atomic_load_n(&version->referencias, __ATOMIC_SEQ_CST) == 0) {
+        liberarTablaApeadas(&version->apeadas);
+        version->ocupada = false;
+    }
+    pthread_mutex_unlock(&mutexVersiones);
+}
+
+// Referencia a la versión publicada. Si se publicó otra entre leer el puntero
+// y contar la referencia, se suelta y se vuelve a intentar
+static VersionMesa* adquirirVersion(void) {
+    for (;;) {
+        VersionMesa *version = __atomic_load_n(&mesaJuego.actual, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&version->referencias, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&mesaJuego.actual, __ATOMIC_SEQ_CST) == version) {
+            return version;
+        }
+        soltarVersion(version);
+    }
+}
+
 // Inicializar la mesa
 bool inicializarMesa(void) {
-    // Inicializar el contador de apeadas
-    mesaJuego.numApeadas = 0;
+    // Primera versión publicada: sin apeadas (los bloques se piden al llenarse)
+    VersionMesa *version = reservarVersion();
+    if (version == NULL) {
+        return false;
+    }
+    version->numero = 0;
+    __atomic_store_n(&mesaJuego.actual, version, __ATOMIC_SEQ_CST);
     
-    // Inicializar el mazo de la banca
-    mesaJuego.banca.cartas = NULL;
-    mesaJuego.banca.numCartas = 0;
-    mesaJuego.banca.capacidad = 0;
+    // Inicializar la banca vacía; repartirFichas genera su zapato
+    inicializarBanca(&mesaJuego.banca, &mutexBanca);
     
     return true;
 }
 
-// Agregar una nueva apeada a la mesa
-bool agregarApeada(Apeada *nuevaApeada) {
-    if (mesaJuego.numApeadas >= MAX_APEADAS) {
-        printf("Error: No se pueden agregar más apeadas a la mesa\n");
+// Empezar una transacción sobre la versión publicada
+bool iniciarTransaccionMesa(TransaccionMesa *transaccion, Jugador *jugador) {
+    Mazo *mano = &jugador->mano;
+    
+    transaccion->activa = false;
+    transaccion->jugador = jugador;
+    transaccion->cambios = 0;
+    
+    // La mano se guarda para deshacer; solo la modifica el hilo del jugador
+    transaccion->numCartas = mano->numCartas;
+    transaccion->mano = cartasTemporales(mano->numCartas > 0 ? mano->numCartas : 1);
+    if (transaccion->mano == NULL) {
+        return false;
+    }
+    memcpy(transaccion->mano, mano->cartas, mano->numCartas * sizeof(Carta));
+    transaccion->resumen = mano->resumen;
+    transaccion->primeraApeada = jugador->primeraApeada;
+    
+    // La copia de la mesa comparte todos los bloques: O(bloques), sin copiar apeadas
+    transaccion->trabajo = reservarVersion();
+    if (transaccion->trabajo == NULL) {
+        return false;
+    }
+    transaccion->base = adquirirVersion();
+    if (!compartirTablaApeadas(&transaccion->trabajo->apeadas, &transaccion->base->apeadas)) {
+        soltarVersion(transaccion->trabajo);
+        soltarVersion(transaccion->base);
         return false;
     }
+    transaccion->mesa = &transaccion->trabajo->apeadas;
+    transaccion->activa = true;
+    return true;
+}
+
+// Publicar la mesa de la transacción
+bool confirmarTransaccionMesa(TransaccionMesa *transaccion) {
+    if (!transaccion->activa) {
+        return true;
+    }
+    
+    // Solo cambió la mano (o nada): la versión publicada sigue valiendo
+    if (transaccion->cambios == 0) {
+        soltarVersion(transaccion->trabajo);
+        soltarVersion(transaccion->base);
+        transaccion->activa = false;
+        return true;
+    }
+    
+    VersionMesa *esperada = transaccion->base;
+    transaccion->trabajo->numero = transaccion->base->numero + 1;
+    if (__atomic_compare_exchange_n(&mesaJuego.actual, &esperada, transaccion->trabajo, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        // La referencia de trabajo pasa a ser la de la publicación; base
+        // pierde la de la publicación y la de la transacción
+        soltarVersion(transaccion->base);
+        soltarVersion(transaccion->base);
+        transaccion->activa = false;
+        return true;
+    }
     
+    imprimirRegistro(REGISTRO_DETALLE, "La mesa cambió durante el turno del Jugador %d: se deshace\n",
+                     transaccion->jugador->id);
+    deshacerTransaccionMesa(transaccion);
+    return false;
+}
+
+// Descartar la mesa de la transacción y restaurar la mano
+void deshacerTransaccionMesa(TransaccionMesa *transaccion) {
+    if (!transaccion->activa) {
+        return;
+    }
+    
+    // La mano solo pudo encoger, así que la copia cabe en su arreglo
+    Jugador *jugador = transaccion->jugador;
+    iniciarEscrituraMano(jugador);
+    if (reservarMazo(&jugador->mano, transaccion->numCartas)) {
+        memcpy(jugador->mano.cartas, transaccion->mano, transaccion->numCartas * sizeof(Carta));
+        jugador->mano.numCartas = transaccion->numCartas;
+        jugador->mano.resumen = transaccion->resumen;
+    }
+    jugador->primeraApeada = transaccion->primeraApeada;
+    finalizarEscrituraMano(jugador);
+    
+    soltarVersion(transaccion->trabajo);
+    soltarVersion(transaccion->base);
+    transaccion->activa = false;
+}
+
+// Agregar una nueva apeada a la mesa de la transacción
+bool agregarApeada(TransaccionMesa *transaccion, Apeada *nuevaApeada) {
     // Primero validar la apeada
     if (!validarApeada(nuevaApeada)) {
         printf("Error: La apeada no es válida\n");
         return false;
     }
     
-    // Copiar la apeada a la mesa
-    mesaJuego.apeadas[mesaJuego.numApeadas] = *nuevaApeada;
-    mesaJuego.numApeadas++;
+    // Copiar la apeada a la mesa; solo falla si no hay memoria para otro bloque
+    if (agregarEnTabla(transaccion->mesa, nuevaApeada) == NULL) {
+        printf("Error: No se pueden agregar más apeadas a la mesa\n");
+        return false;
+    }
+    transaccion->cambios++;
     
-    printf("Apeada agregada correctamente. Total de apeadas: %d\n", mesaJuego.numApeadas);
+    imprimirRegistro(REGISTRO_DETALLE, "Apeada agregada correctamente. Total de apeadas: %d\n", transaccion->mesa->numApeadas);
     return true;
 }
 
-// Modificar una apeada existente (añadir carta)
-bool modificarApeada(int indiceApeada, Carta carta, int posicion) {
-    if (indiceApeada < 0 || indiceApeada >= mesaJuego.numApeadas) {
+// Sustituir todas las apeadas de la mesa (reacomodo). Todas deben ser válidas
+bool reemplazarApeadas(TransaccionMesa *transaccion, const Apeada *apeadas, int numApeadas) {
+    if (numApeadas < 0) {
+        printf("Error: Número de apeadas inválido\n");
+        return false;
+    }
+
+    for (int i = 0; i < numApeadas; i++) {
+        Apeada copia = apeadas[i];
+        if (!validarApeada(&copia)) {
+            printf("Error: La apeada %d del reacomodo no es válida\n", i + 1);
+            return false;
+        }
+    }
+
+    // Las posiciones y los bloques propios de la transacción se reutilizan
+    if (!reemplazarEnTabla(transaccion->mesa, apeadas, numApeadas)) {
+        return false;
+    }
+    transaccion->cambios++;
+    return true;
+}
+
+// Modificar una apeada existente (añadir carta). Se trabaja sobre una copia
+// y solo se escribe en la mesa si el resultado es válido
+bool modificarApeada(TransaccionMesa *transaccion, int indiceApeada, Carta carta, int posicion) {
+    if (indiceApeada < 0 || indiceApeada >= transaccion->mesa->numApeadas) {
         printf("Error: Índice de apeada inválido\n");
         return false;
     }
     
-    Apeada *apeada = &mesaJuego.apeadas[indiceApeada];
+    Apeada modificada = *apeadaEnTabla(transaccion->mesa, indiceApeada);
+    Apeada *apeada = &modificada;
     
     // Verificar si es grupo o escalera
     if (apeada->esGrupo) {
@@ -76,8 +258,8 @@ bool modificarApeada(int indiceApeada, Carta carta, int posicion) {
         Escalera *escalera = &apeada->jugada.escalera;
         
         // Verificar capacidad
-        if (escalera->numCartas >= 13) {
-            printf("Error: La escalera ya tiene el máximo de cartas (13)\n");
+        if (escalera->numCartas >= MAX_CARTAS_ESCALERA) {
+            printf("Error: La escalera ya tiene el máximo de cartas (%d)\n", MAX_CARTAS_ESCALERA);
             return false;
         }
         
@@ -87,13 +269,6 @@ bool modificarApeada(int indiceApeada, Carta carta, int posicion) {
             return false;
         }
         
-        // Ampliar la escalera si es necesario
-        if (escalera->numCartas >= escalera->capacidad) {
-            int nuevaCapacidad = escalera->capacidad == 0 ? 13 : escalera->capacidad * 2;
-            escalera->cartas = realloc(escalera->cartas, nuevaCapacidad * sizeof(Carta));
-            escalera->capacidad = nuevaCapacidad;
-        }
-        
         // Añadir la carta a la escalera (en la posición correcta)
         // Esto es una simplificación - una implementación real debería ordenar
         // las cartas y verificar que la secuencia sea válida
@@ -110,19 +285,66 @@ bool modificarApeada(int indiceApeada, Carta carta, int posicion) {
         escalera->numCartas++;
     }
     
-    // Validar que la apeada sigue siendo válida después de la modificación
+    // Validar que la apeada sigue siendo válida después de la modificación;
+    // si no, la de la mesa no se ha tocado
     if (!validarApeada(apeada)) {
         printf("Error: La modificación hace que la apeada no sea válida\n");
-        // Aquí deberíamos revertir la modificación, pero por simplicidad no lo hacemos
         return false;
     }
     
+    Apeada *destino = escribirApeada(transaccion, indiceApeada);
+    if (destino == NULL) {
+        return false;
+    }
+    uint64_t hashAnterior = hashApeada(destino);
+    *destino = modificada;
+    apeadaModificada(transaccion, indiceApeada, hashAnterior);
+    
     printf("Apeada modificada correctamente\n");
     return true;
 }
 
+// Apeada de la transacción para modificarla en su sitio
+Apeada* escribirApeada(TransaccionMesa *transaccion, int indice) {
+    return escribirApeadaEnTabla(transaccion->mesa, indice);
+}
+
+// Registrar una apeada modificada en su sitio, que antes tenía hashAnterior
+void apeadaModificada(TransaccionMesa *transaccion, int indice, uint64_t hashAnterior) {
+    cambiarApeadaEnTabla(transaccion->mesa, indice, hashAnterior);
+    transaccion->cambios++;
+}
+
+// Referencia a la mesa publicada (las apeadas son el primer campo de la versión)
+const TablaApeadas* adquirirMesa(unsigned int *version) {
+    VersionMesa *actual = adquirirVersion();
+    if (version != NULL) {
+        *version = actual->numero;
+    }
+    return &actual->apeadas;
+}
+
+void soltarMesa(const TablaApeadas *mesa) {
+    soltarVersion((VersionMesa *)mesa);
+}
+
+// Hash de Zobrist de la mesa publicada
+uint64_t obtenerHashMesa(void) {
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    uint64_t hash = mesa->hash;
+    soltarMesa(mesa);
+    return hash;
+}
+
+// Obtener la versión actual de la mesa
+unsigned int obtenerVersionMesa(void) {
+    unsigned int version;
+    soltarMesa(adquirirMesa(&version));
+    return version;
+}
+
 // Validar si una apeada cumple con las reglas del juego
-bool validarApeada(Apeada *apeada) {
+bool validarApeada(const Apeada *apeada) {
     if (apeada->esGrupo) {
         // Validar grupo (terna o cuaterna)
         return esGrupoValido(apeada->jugada.grupo.cartas, apeada->jugada.grupo.numCartas);
@@ -132,63 +354,74 @@ bool validarApeada(Apeada *apeada) {
     }
 }
 
-// Verificar si un conjunto de cartas forma un grupo válido (terna o cuaterna)
-bool esGrupoValido(Carta *cartas, int numCartas) {
+// Verificar si un conjunto de cartas forma un grupo válido (terna o cuaterna).
+// Una sola pasada: los palos vistos van en una máscara de bits
+bool esGrupoValido(const Carta *cartas, int numCartas) {
     if (numCartas < 3 || numCartas > 4) {
         return false;  // Un grupo debe tener 3 o 4 cartas
     }
     
-    // Contar comodines
-    int numComodines = 0;
+    int valorReferencia = -1;
+    unsigned int palos = 0;
+    
     for (int i = 0; i < numCartas; i++) {
         if (cartas[i].esComodin) {
-            numComodines++;
+            continue;
         }
-    }
-    
-    // Si todas son comodines, no es válido
-    if (numComodines == numCartas) {
-        return false;
-    }
-    
-    // Verificar que todas las cartas no comodines tengan el mismo valor
-    int valorReferencia = -1;
-    for (int i = 0; i < numCartas; i++) {
-        if (!cartas[i].esComodin) {
-            if (valorReferencia == -1) {
-                valorReferencia = cartas[i].valor;
-            } else if (cartas[i].valor != valorReferencia) {
-                return false;  // Valores diferentes
-            }
+        
+        // Todas las cartas no comodines con el mismo valor
+        if (valorReferencia == -1) {
+            valorReferencia = cartas[i].valor;
+        } else if (cartas[i].valor != valorReferencia) {
+            return false;  // Valores diferentes
         }
-    }
-    
-    // Verificar que no haya palos repetidos (excepto comodines)
-    for (int i = 0; i < numCartas; i++) {
-        if (!cartas[i].esComodin) {
-            for (int j = i + 1; j < numCartas; j++) {
-                if (!cartas[j].esComodin && cartas[i].palo == cartas[j].palo) {
-                    return false;  // Palos repetidos
-                }
-            }
+        
+        // Sin palos repetidos
+        int palo = indicePaloParticion(cartas[i].palo);
+        if (palo < 0 || (palos & (1u << palo))) {
+            return false;
         }
+        palos |= 1u << palo;
     }
     
-    return true;
+    // Si todas son comodines, no es válido
+    return valorReferencia != -1;
 }
 
-// Verificar si un conjunto de cartas forma una escalera válida
-bool esEscaleraValida(Carta *cartas, int numCartas) {
+// Verificar si un conjunto de cartas forma una escalera válida. Una sola
+// pasada sin copiar ni ordenar: los valores naturales van en una máscara de
+// bits y los huecos entre el menor y el mayor se cubren con comodines
+bool esEscaleraValida(const Carta *cartas, int numCartas) {
     if (numCartas < 3) {
         return false;  // Una escalera debe tener al menos 3 cartas
     }
     
-    // Contar comodines
+    char paloReferencia = '\0';
+    unsigned int valores = 0;
+    int minimo = NUM_VALORES + 1, maximo = 0;
     int numComodines = 0;
+    
     for (int i = 0; i < numCartas; i++) {
         if (cartas[i].esComodin) {
             numComodines++;
+            continue;
+        }
+        
+        // Todas las cartas no comodines con el mismo palo
+        if (paloReferencia == '\0') {
+            paloReferencia = cartas[i].palo;
+        } else if (cartas[i].palo != paloReferencia) {
+            return false;  // Palos diferentes
         }
+        
+        // Cada valor una sola vez
+        int valor = cartas[i].valor;
+        if (valor < 1 || valor > NUM_VALORES || (valores & (1u << (valor - 1)))) {
+            return false;
+        }
+        valores |= 1u << (valor - 1);
+        if (valor < minimo) minimo = valor;
+        if (valor > maximo) maximo = valor;
     }
     
     // Si todas son comodines, no es válido
@@ -196,81 +429,29 @@ bool esEscaleraValida(Carta *cartas, int numCartas) {
         return false;
     }
     
-    // Crear una copia de las cartas para ordenarlas
-    Carta *cartasOrdenadas = malloc(numCartas * sizeof(Carta));
-    memcpy(cartasOrdenadas, cartas, numCartas * sizeof(Carta));
-    
-    // Ordenar las cartas por valor (burbuja simple)
-    for (int i = 0; i < numCartas - 1; i++) {
-        for (int j = 0; j < numCartas - i - 1; j++) {
-            if (!cartasOrdenadas[j].esComodin && !cartasOrdenadas[j+1].esComodin && 
-                cartasOrdenadas[j].valor > cartasOrdenadas[j+1].valor) {
-                // Intercambiar
-                Carta temp = cartasOrdenadas[j];
-                cartasOrdenadas[j] = cartasOrdenadas[j+1];
-                cartasOrdenadas[j+1] = temp;
-            }
-        }
-    }
-    
-    // Verificar que todas las cartas no comodines tengan el mismo palo
-    char paloReferencia = '\0';
-    for (int i = 0; i < numCartas; i++) {
-        if (!cartasOrdenadas[i].esComodin) {
-            if (paloReferencia == '\0') {
-                paloReferencia = cartasOrdenadas[i].palo;
-            } else if (cartasOrdenadas[i].palo != paloReferencia) {
-                free(cartasOrdenadas);
-                return false;  // Palos diferentes
-            }
-        }
-    }
-    
-    // Verificar secuencia (considerando comodines)
-    int valorEsperado = -1;
-    int comodinesDisponibles = numComodines;
-    
-    for (int i = 0; i < numCartas; i++) {
-        if (!cartasOrdenadas[i].esComodin) {
-            if (valorEsperado == -1) {
-                valorEsperado = cartasOrdenadas[i].valor;
-            } else {
-                // Calcular huecos
-                int huecos = cartasOrdenadas[i].valor - valorEsperado - 1;
-                
-                if (huecos > 0) {
-                    // Verificar si tenemos suficientes comodines para llenar los huecos
-                    if (huecos > comodinesDisponibles) {
-                        free(cartasOrdenadas);
-                        return false;  // No hay suficientes comodines
-                    }
-                    
-                    comodinesDisponibles -= huecos;
-                }
-                
-                valorEsperado = cartasOrdenadas[i].valor;
-            }
-            
-            valorEsperado++;  // Para la próxima carta
-        }
-    }
-    
-    free(cartasOrdenadas);
-    return true;
+    // Huecos entre el menor y el mayor: los rellenan los comodines
+    int huecos = (maximo - minimo + 1) - (numCartas - numComodines);
+    return huecos <= numComodines;
 }
 
-// Obtener acceso a las apeadas
-Apeada* obtenerApeadas(void) {
-    return mesaJuego.apeadas;
+// Obtener el número de apeadas de la mesa publicada
+int obtenerNumApeadas(void) {
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    int numApeadas = mesa->numApeadas;
+    soltarMesa(mesa);
+    return numApeadas;
 }
 
-// Obtener el número de apeadas
-int obtenerNumApeadas(void) {
-    return mesaJuego.numApeadas;
+// Memoria que ocupan las apeadas de la mesa publicada
+size_t memoriaMesa(void) {
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    size_t memoria = memoriaTablaApeadas(mesa);
+    soltarMesa(mesa);
+    return memoria;
 }
 
-// Obtener acceso al mazo de la banca
-Mazo* obtenerBanca(void) {
+// Obtener acceso a la banca
+Banca* obtenerBanca(void) {
     return &mesaJuego.banca;
 }
 
@@ -283,19 +464,9 @@ void crearMazoCompleto(Mazo *mazo) {
         return;
     }
 
-    // Liberar memoria si ya hay cartas
-    if (mazo->cartas != NULL) {
-        free(mazo->cartas);
-    }
-    
-    // 2 barajas * 52 cartas + 4 comodines = 108 cartas
-    mazo->capacidad = 108;
-    mazo->numCartas = 0;
-    mazo->cartas = malloc(mazo->capacidad * sizeof(Carta));
-    
-
-    // Verificar si malloc tuvo éxito
-    if (mazo->cartas == NULL) {
+    // Vaciar el mazo y reservar de una vez las 108 cartas (2 barajas * 52 + 4 comodines)
+    liberarMazo(mazo);
+    if (!reservarMazo(mazo, MAX_CARTAS_MAZO)) {
         printf("Error: No se pudo asignar memoria para el mazo\n");
         return;
     }
@@ -327,6 +498,9 @@ void crearMazoCompleto(Mazo *mazo) {
             mazo->numCartas++;
         }
     }
+
+    // Conteos y puntos del mazo recién llenado
+    recalcularResumenMazo(mazo);
 }
 
 // Mezclar un mazo
@@ -348,10 +522,11 @@ void mezclarMazo(Mazo *mazo) {
 
 // Mostrar todas las apeadas en la mesa
 void mostrarApeadas(void) {
-    printf("\n=== APEADAS EN LA MESA (%d) ===\n", mesaJuego.numApeadas);
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    printf("\n=== APEADAS EN LA MESA (%d, %zu bytes) ===\n", mesa->numApeadas, memoriaTablaApeadas(mesa));
     
-    for (int i = 0; i < mesaJuego.numApeadas; i++) {
-        Apeada *apeada = &mesaJuego.apeadas[i];
+    for (int i = 0; i < mesa->numApeadas; i++) {
+        const Apeada *apeada = apeadaEnTabla(mesa, i);
         printf("Apeada %d (Jugador %d): ", i, apeada->idJugador);
         
         if (apeada->esGrupo) {
@@ -378,25 +553,19 @@ void mostrarApeadas(void) {
         
         printf("(%d puntos)\n", apeada->puntos);
     }
+    soltarMesa(mesa);
     
-    printf("\nBanca: %d cartas\n", mesaJuego.banca.numCartas);
+    printf("\nBanca: %d cartas\n", cartasEnBanca(&mesaJuego.banca));
 }
 
 // 3. En mesa.c - Corregir liberarMesa()
 void liberarMesa(void) {
-    // Liberar escaleras (que usan memoria dinámica)
-    for (int i = 0; i < mesaJuego.numApeadas; i++) {
-        if (!mesaJuego.apeadas[i].esGrupo && mesaJuego.apeadas[i].jugada.escalera.cartas != NULL) {
-            free(mesaJuego.apeadas[i].jugada.escalera.cartas);
-            mesaJuego.apeadas[i].jugada.escalera.cartas = NULL;  // Importante!
-        }
-    }
+    // Las escaleras guardan sus cartas dentro de la apeada: basta con soltar
+    // la versión publicada (con ella se van sus bloques) y liberar la banca
+    liberarBanca(&mesaJuego.banca);
     
-    // Liberar banca
-    if (mesaJuego.banca.cartas != NULL) {
-        free(mesaJuego.banca.cartas);
-        mesaJuego.banca.cartas = NULL;
+    VersionMesa *actual = __atomic_exchange_n(&mesaJuego.actual, NULL, __ATOMIC_SEQ_CST);
+    if (actual != NULL) {
+        soltarVersion(actual);
     }
-    
-    mesaJuego.numApeadas = 0;
 }
\ No newline at end of file
@@ -5,45 +5,120 @@
 
 // Incluir definiciones de Carta, Grupo, Escalera, Apeada y Mazo
 #include "jugadores.h"
-
+#include "tablaapeadas.h"
+#include "banca.h"
+
+// La mesa crece sin límite (ver tablaapeadas.h). MAX_APEADAS es el tamaño de
+// los arreglos fijos que trabajan con una parte de ella: la mesa compacta de
+// las simulaciones MCTS, las jugadas de un reacomodo y las candidatas de la
+// especulación. Se puede cambiar al compilar (-DMAX_APEADAS=N)
+#ifndef MAX_APEADAS
 #define MAX_APEADAS 50
+#endif
+
+// Versiones de la mesa. Una mesa publicada no se modifica nunca: el turno
+// trabaja en una transacción, sobre una copia que comparte los bloques de la
+// publicada y solo copia los que toca (ver tablaapeadas.h), y al confirmar la
+// publica cambiando un puntero. Quien solo lee (historial, panel, especulación)
+// toma una referencia a la versión publicada y la recorre sin candados.
+// Las versiones viven en un arreglo fijo y no se liberan, así que una
+// referencia tomada tarde sobre una versión ya soltada nunca apunta a basura
+#ifndef MAX_VERSIONES_MESA
+#define MAX_VERSIONES_MESA 32
+#endif
+
+typedef struct {
+    TablaApeadas apeadas;         // No cambia mientras está publicada
+    unsigned int numero;          // Aumenta con cada transacción confirmada
+    int referencias;              // Lectores y transacciones; la publicación cuenta una (atómico)
+    bool ocupada;                 // Sus bloques aún no se devolvieron
+} VersionMesa;
 
 // Estructura global para la mesa de juego
 typedef struct {
-    Apeada apeadas[MAX_APEADAS];  // Arreglo de apeadas en la mesa
-    int numApeadas;               // Número actual de apeadas
-    Mazo banca;                   // Mazo de la banca
+    VersionMesa *actual;          // Versión publicada (atómico)
+    Banca banca;                  // Cartas por comer, protegidas por mutexBanca
 } Mesa;
 
+// Transacción de un turno sobre la mesa y la mano del jugador. La mano se
+// modifica en su sitio (con su seqlock) y se guarda al empezar para poder
+// deshacerla; la mesa se modifica en mesa, que nadie más ve hasta confirmar
+typedef struct {
+    VersionMesa *base;            // Versión publicada al empezar
+    VersionMesa *trabajo;         // Copia de base que modifica el turno
+    TablaApeadas *mesa;           // Las apeadas de trabajo
+    Jugador *jugador;
+    Carta *mano;                  // Copia de la mano al empezar, en la arena del turno
+    int numCartas;
+    ResumenMazo resumen;
+    bool primeraApeada;
+    int cambios;                  // Cambios en la mesa; sin cambios no se publica nada
+    bool activa;
+} TransaccionMesa;
+
 // Variable global para la mesa
 extern Mesa mesaJuego;
 
 // Inicializar la mesa
 bool inicializarMesa(void);
 
-// Agregar una nueva apeada (grupo o escalera) a la mesa
-bool agregarApeada(Apeada *nuevaApeada);
+// Empezar una transacción del jugador sobre la mesa publicada. Con el hilo
+// del jugador y la arena del turno ya iniciada. false si no hubo memoria o
+// versiones libres
+bool iniciarTransaccionMesa(TransaccionMesa *transaccion, Jugador *jugador);
+
+// Publicar la mesa de la transacción con un solo intercambio de puntero. Si
+// otra transacción publicó antes, esta se deshace y devuelve false. Sin
+// efecto si la transacción ya terminó
+bool confirmarTransaccionMesa(TransaccionMesa *transaccion);
+
+// Descartar la mesa de la transacción y devolver la mano a como estaba al
+// empezar. Sin efecto si la transacción ya terminó
+void deshacerTransaccionMesa(TransaccionMesa *transaccion);
+
+// Agregar una nueva apeada (grupo o escalera) a la mesa de la transacción
+bool agregarApeada(TransaccionMesa *transaccion, Apeada *nuevaApeada);
 
-// Modificar una apeada existente (añadir carta)
-bool modificarApeada(int indiceApeada, Carta carta, int posicion);
+// Modificar una apeada existente (añadir carta). Si el resultado no es
+// válido la apeada queda como estaba
+bool modificarApeada(TransaccionMesa *transaccion, int indiceApeada, Carta carta, int posicion);
+
+// Sustituir todas las apeadas de la mesa de la transacción (reacomodo)
+bool reemplazarApeadas(TransaccionMesa *transaccion, const Apeada *apeadas, int numApeadas);
+
+// Apeada de la transacción para modificarla en su sitio (un embone); tras
+// modificarla hay que avisar con apeadaModificada. NULL si no hubo memoria
+Apeada* escribirApeada(TransaccionMesa *transaccion, int indice);
+void apeadaModificada(TransaccionMesa *transaccion, int indice, uint64_t hashAnterior);
+
+// Tomar una referencia a la mesa publicada; sus apeadas no cambian hasta
+// soltarla. Si version no es NULL, devuelve también su número
+const TablaApeadas* adquirirMesa(unsigned int *version);
+void soltarMesa(const TablaApeadas *mesa);
+
+// Obtener la versión de la mesa, que aumenta con cada transacción confirmada
+unsigned int obtenerVersionMesa(void);
+
+// Hash de Zobrist de la mesa publicada; ver zobrist.h
+uint64_t obtenerHashMesa(void);
 
 // Validar si una apeada cumple con las reglas del juego
-bool validarApeada(Apeada *apeada);
+bool validarApeada(const Apeada *apeada);
 
 // Verificar si un conjunto de cartas forma una escalera válida
-bool esEscaleraValida(Carta *cartas, int numCartas);
+bool esEscaleraValida(const Carta *cartas, int numCartas);
 
 // Verificar si un conjunto de cartas forma un grupo válido (terna o cuaterna)
-bool esGrupoValido(Carta *cartas, int numCartas);
-
-// Obtener acceso a las apeadas
-Apeada* obtenerApeadas(void);
+bool esGrupoValido(const Carta *cartas, int numCartas);
 
-// Obtener el número de apeadas
+// Obtener el número de apeadas de la mesa publicada
 int obtenerNumApeadas(void);
 
-// Obtener acceso al mazo de la banca
-Mazo* obtenerBanca(void);
+// Memoria que ocupan las apeadas de la mesa publicada, en bytes
+size_t memoriaMesa(void);
+
+// Obtener acceso a la banca
+Banca* obtenerBanca(void);
 
 // Crear un mazo completo (2 barajas + 4 comodines)
 void crearMazoCompleto(Mazo *mazo);
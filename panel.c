@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "panel.h"
+#include "mesa.h"
+#include "candados.h"
+#include "estrategia.h"
+#include "utilidades.h"
+
+/* Secuencias de la terminal */
+#define INICIO_PANTALLA   "\x1b[H"
+#define BORRAR_PANTALLA   "\x1b[2J"
+#define OCULTAR_CURSOR    "\x1b[?25l"
+#define MOSTRAR_CURSOR    "\x1b[?25h"
+
+/* Cada línea lleva su color, ANCHO_PANEL caracteres (UTF-8, hasta 2 bytes) y
+ * el reinicio de color */
+#define BYTES_LINEA_PANEL (2 * ANCHO_PANEL + 16)
+#define BYTES_CUADRO      (ALTO_PANEL * BYTES_LINEA_PANEL + 16)
+
+/* Un cuadro compuesto en memoria */
+typedef struct {
+    char texto[BYTES_CUADRO];
+    int longitud;
+    int lineas;
+} Cuadro;
+
+static pthread_t hiloPanel;
+static bool activo = false;
+static bool detener = false;
+static pthread_mutex_t mutexPanel = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t condPanel = PTHREAD_COND_INITIALIZER;
+static int periodoMs = 1000 / FPS_PANEL;
+
+/* Doble búfer: se compone en uno y se compara con el otro, el último escrito */
+static Cuadro cuadros[2];
+static int cuadroActual = 0;
+
+/* Para la tasa de fallos de página del último intervalo */
+static int fallosAnteriores = 0;
+static double segundosAnteriores = 0.0;
+static double fallosPorSegundo = 0.0;
+
+static const char *nombresEstado[] = {"LISTO", "EJECUCION", "ESPERA_ES", "BLOQUEADO"};
+
+static double ahoraSegundos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Copiar el estado vivo del juego en una instantánea del panel. Los contadores
+ * de los jugadores se leen sin candado, como en la instantánea del historial:
+ * a lo sumo un cuadro muestra un valor a medio actualizar. La memoria se
+ * copia con sus candados, para no ver una partición o un marco a medio mover */
+void capturarEstadoPanel(EstadoPanel *estado) {
+    int numJugadores;
+    Jugador *jugadores = obtenerJugadores(&numJugadores);
+
+    estado->numRonda = rondaActual;
+    obtenerEstadoPlanificador(&estado->algoritmoCpu, &estado->quantum, &estado->jugadorEnTurno);
+
+    estado->numJugadores = numJugadores;
+    for (int i = 0; i < numJugadores; i++) {
+        FilaPanel *fila = &estado->jugadores[i];
+
+        fila->id = jugadores[i].id;
+        fila->estado = jugadores[i].estado;
+        fila->numCartas = __atomic_load_n(&jugadores[i].mano.numCartas, __ATOMIC_RELAXED);
+        fila->tiempoTurno = jugadores[i].tiempoTurno;
+        fila->tiempoRestante = jugadores[i].tiempoRestante;
+        fila->primeraApeada = jugadores[i].primeraApeada;
+        fila->estrategia = jugadores[i].estrategia != NULL ? jugadores[i].estrategia->nombre : "-";
+    }
+
+    estado->numApeadas = obtenerNumApeadas();
+    estado->memoriaMesa = memoriaMesa();
+    estado->cartasBanca = cartasEnBanca(obtenerBanca());
+
+    /* Mapa de memoria: con Mapa de Bits, el dueño de cada bloque está en el
+     * mapa; con el sistema de compañeros, en el primer bloque mínimo de cada
+     * bloque ocupado; con Ajuste Óptimo y LRU, en las particiones */
+    bloquearMemoria();
+    estado->algoritmoMemoria = gestorMemoria.algoritmoActual;
+    estado->memoriaDisponible = gestorMemoria.memoriaDisponible;
+    if (estado->algoritmoMemoria == ALG_MAPA_BITS) {
+        for (int b = 0; b < NUM_BLOQUES_BITMAP; b++) {
+            unsigned char dueno = gestorMemoria.mapaBits[b];
+            estado->duenoBloque[b] = dueno == BLOQUE_LIBRE_BITMAP ? -1 : dueno;
+        }
+    } else if (estado->algoritmoMemoria == ALG_BUDDY) {
+        for (int b = 0; b < NUM_BLOQUES_BITMAP; b++) {
+            estado->duenoBloque[b] = -1;
+        }
+        for (int b = 0; b < NUM_BLOQUES_BUDDY; b++) {
+            int orden = gestorMemoria.ordenBuddy[b];
+            if (orden < 0) {
+                continue;
+            }
+            int primero = b * TAMANO_MINIMO_BUDDY / TAMANO_BLOQUE_BITMAP;
+            int ultimo = ((b + (1 << orden)) * TAMANO_MINIMO_BUDDY - 1) / TAMANO_BLOQUE_BITMAP;
+            for (int m = primero; m <= ultimo && m < NUM_BLOQUES_BITMAP; m++) {
+                estado->duenoBloque[m] = gestorMemoria.procesoBuddy[b];
+            }
+        }
+    } else {
+        for (int b = 0; b < NUM_BLOQUES_BITMAP; b++) {
+            estado->duenoBloque[b] = -1;
+        }
+        int numParticiones = gestorMemoria.numParticiones;
+        for (int p = 0; p < numParticiones && p < MAX_PARTICIONES; p++) {
+            Particion particion = gestorMemoria.particiones[p];
+            if (particion.libre || particion.tamano <= 0) {
+                continue;
+            }
+            int primero = particion.inicio / TAMANO_BLOQUE_BITMAP;
+            int ultimo = (particion.inicio + particion.tamano - 1) / TAMANO_BLOQUE_BITMAP;
+            for (int b = primero; b <= ultimo && b < NUM_BLOQUES_BITMAP; b++) {
+                if (b >= 0) {
+                    estado->duenoBloque[b] = particion.idProceso;
+                }
+            }
+        }
+    }
+
+    for (int m = 0; m < NUM_MARCOS; m++) {
+        Marco marco = gestorMemoria.marcosMemoria[m];
+        estado->procesoMarco[m] = marco.libre ? -1 : marco.idProceso;
+        estado->paginaMarco[m] = marco.numPagina;
+    }
+    estado->politicaReemplazo = gestorMemoria.politicaReemplazo;
+    estado->fallosPagina = gestorMemoria.fallosPagina;
+    estado->aciertosMemoria = gestorMemoria.aciertosMemoria;
+    estado->aciertosTLB = gestorMemoria.aciertosTLB;
+    estado->fallosTLB = gestorMemoria.fallosTLB;
+    desbloquearMemoria();
+    estado->segundos = ahoraSegundos();
+}
+
+/* Añadir una línea al cuadro, rellenada con espacios hasta ANCHO_PANEL
+ * caracteres para que tape lo que hubiera en el cuadro anterior */
+static void agregarLinea(Cuadro *cuadro, const char *color, const char *formato, ...) {
+    char linea[BYTES_LINEA_PANEL];
+    va_list args;
+
+    if (cuadro->lineas >= ALTO_PANEL) {
+        return;
+    }
+
+    va_start(args, formato);
+    int bytes = vsnprintf(linea, sizeof(linea), formato, args);
+    va_end(args);
+    if (bytes < 0) {
+        bytes = 0;
+    }
+    if (bytes >= (int)sizeof(linea)) {
+        bytes = sizeof(linea) - 1;
+    }
+
+    /* Recortar a ANCHO_PANEL caracteres y contar los que quedan */
+    int caracteres = 0;
+    int corte = 0;
+    while (corte < bytes) {
+        if (((unsigned char)linea[corte] & 0xC0) != 0x80) {
+            if (caracteres == ANCHO_PANEL) {
+                break;
+            }
+            caracteres++;
+        }
+        corte++;
+    }
+
+    char *destino = cuadro->texto + cuadro->longitud;
+    int escrito = 0;
+    if (color != NULL) {
+        escrito += sprintf(destino, "%s", color);
+    }
+    memcpy(destino + escrito, linea, corte);
+    escrito += corte;
+    memset(destino + escrito, ' ', ANCHO_PANEL - caracteres);
+    escrito += ANCHO_PANEL - caracteres;
+    escrito += sprintf(destino + escrito, "%s\n", color != NULL ? COLOR_RESET : "");
+
+    cuadro->longitud += escrito;
+    cuadro->lineas++;
+}
+
+/* Componer el cuadro completo desde la instantánea */
+static void componerCuadro(Cuadro *cuadro, const EstadoPanel *estado) {
+    static const char *nombresCpu[] = {"FCFS", "Round Robin"};
+    static const char *nombresMemoria[] = {"Ajuste Óptimo", "LRU", "Mapa de Bits", "Compañeros"};
+    static const char *nombresReemplazo[] = {"LRU", "Reloj", "NFU", "WSClock"};
+    char mapa[NUM_BLOQUES_BITMAP + 1];
+    char marcos[ANCHO_PANEL + 1];
+    int usado = 0;
+
+    cuadro->longitud = 0;
+    cuadro->lineas = 0;
+
+    agregarLinea(cuadro, COLOR_CIAN, "==== JUEGO RUMMY ==== ronda %d", estado->numRonda);
+    agregarLinea(cuadro, NULL, "CPU: %s   quantum: %d ms   mesa: %d apeadas (%zu KB)   banca: %d cartas",
+                 nombresCpu[estado->algoritmoCpu == ALG_RR], estado->quantum,
+                 estado->numApeadas, (estado->memoriaMesa + 1023) / 1024, estado->cartasBanca);
+    agregarLinea(cuadro, NULL, "");
+    agregarLinea(cuadro, NULL, "  Jugador  Estrategia  Estado      Cartas  Tiempo restante  Apeado");
+
+    for (int i = 0; i < MAX_JUGADORES; i++) {
+        if (i >= estado->numJugadores) {
+            agregarLinea(cuadro, NULL, "");
+            continue;
+        }
+        const FilaPanel *fila = &estado->jugadores[i];
+        const char *color = fila->estado == EJECUCION ? COLOR_VERDE :
+                            fila->estado == ESPERA_ES ? COLOR_MAGENTA : NULL;
+        agregarLinea(cuadro, color, "%c %-7d  %-10s  %-10s  %6d  %5d / %5d ms  %s",
+                     i == estado->jugadorEnTurno ? '>' : ' ', fila->id, fila->estrategia,
+                     nombresEstado[fila->estado], fila->numCartas,
+                     fila->tiempoRestante, fila->tiempoTurno, fila->primeraApeada ? "sí" : "no");
+    }
+
+    agregarLinea(cuadro, NULL, "");
+    agregarLinea(cuadro, NULL, "Memoria: %s   disponible: %d / %d bytes",
+                 nombresMemoria[estado->algoritmoMemoria], estado->memoriaDisponible, MEM_TOTAL_SIZE);
+
+    /* Un carácter por bloque de 16 bytes: el dígito del proceso o '.' */
+    for (int b = 0; b < NUM_BLOQUES_BITMAP; b++) {
+        int dueno = estado->duenoBloque[b];
+        mapa[b] = dueno < 0 ? '.' : (dueno < 10 ? '0' + dueno : '#');
+    }
+    mapa[NUM_BLOQUES_BITMAP] = '\0';
+    agregarLinea(cuadro, NULL, "[%s]", mapa);
+
+    for (int m = 0; m < NUM_MARCOS && usado < (int)sizeof(marcos); m++) {
+        if (estado->procesoMarco[m] < 0) {
+            usado += snprintf(marcos + usado, sizeof(marcos) - usado, "[  --  ] ");
+        } else {
+            usado += snprintf(marcos + usado, sizeof(marcos) - usado, "[P%d:p%-2d] ",
+                              estado->procesoMarco[m], estado->paginaMarco[m]);
+        }
+    }
+    agregarLinea(cuadro, NULL, "Marcos: %s", marcos);
+
+    int accesos = estado->fallosPagina + estado->aciertosMemoria;
+    int consultasTLB = estado->aciertosTLB + estado->fallosTLB;
+    agregarLinea(cuadro, estado->fallosPagina > 0 ? COLOR_AMARILLO : NULL,
+                 "Páginas (%s): %d accesos, %d fallos (%.1f%%), %.1f fallos/s, TLB %.0f%%",
+                 nombresReemplazo[estado->politicaReemplazo], accesos, estado->fallosPagina,
+                 accesos > 0 ? 100.0 * estado->fallosPagina / accesos : 0.0, fallosPorSegundo,
+                 consultasTLB > 0 ? 100.0 * estado->aciertosTLB / consultasTLB : 0.0);
+
+    agregarLinea(cuadro, NULL, "");
+    agregarLinea(cuadro, COLOR_AZUL, "1 FCFS  2 RR  3 Ajuste Óptimo  4 LRU  5 Mapa de Bits  q salir");
+
+    while (cuadro->lineas < ALTO_PANEL) {
+        agregarLinea(cuadro, NULL, "");
+    }
+}
+
+/* Capturar, componer y escribir un cuadro si cambió */
+static void dibujarCuadro(void) {
+    EstadoPanel estado;
+    capturarEstadoPanel(&estado);
+
+    double intervalo = estado.segundos - segundosAnteriores;
+    if (segundosAnteriores > 0.0 && intervalo > 0.0) {
+        fallosPorSegundo = (estado.fallosPagina - fallosAnteriores) / intervalo;
+    }
+    fallosAnteriores = estado.fallosPagina;
+    segundosAnteriores = estado.segundos;
+
+    Cuadro *nuevo = &cuadros[cuadroActual];
+    Cuadro *anterior = &cuadros[1 - cuadroActual];
+    componerCuadro(nuevo, &estado);
+
+    if (nuevo->longitud == anterior->longitud &&
+        memcmp(nuevo->texto, anterior->texto, nuevo->longitud) == 0) {
+        return;
+    }
+
+    /* Un solo fwrite: stdout se bloquea una vez y los printf de otros hilos
+     * no se intercalan dentro del cuadro */
+    flockfile(stdout);
+    fputs(INICIO_PANTALLA, stdout);
+    fwrite(nuevo->texto, 1, nuevo->longitud, stdout);
+    fflush(stdout);
+    funlockfile(stdout);
+
+    cuadroActual = 1 - cuadroActual;
+}
+
+static void *funcionHiloPanel(void *arg) {
+    (void)arg;
+    struct timespec limite;
+
+    pthread_mutex_lock(&mutexPanel);
+    while (!detener) {
+        pthread_mutex_unlock(&mutexPanel);
+        dibujarCuadro();
+        pthread_mutex_lock(&mutexPanel);
+
+        /* Esperar al siguiente cuadro o a que nos detengan */
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += (long)periodoMs * 1000000L;
+        limite.tv_sec += limite.tv_nsec / 1000000000L;
+        limite.tv_nsec %= 1000000000L;
+        while (!detener && pthread_cond_timedwait(&condPanel, &mutexPanel, &limite) == 0) {
+        }
+    }
+    pthread_mutex_unlock(&mutexPanel);
+
+    /* Último cuadro con el estado final */
+    dibujarCuadro();
+    return NULL;
+}
+
+bool iniciarPanel(int fps) {
+    if (activo) {
+        return true;
+    }
+    if (fps < 1) fps = 1;
+    if (fps > MAX_FPS_PANEL) fps = MAX_FPS_PANEL;
+    periodoMs = 1000 / fps;
+
+    memset(cuadros, 0, sizeof(cuadros));
+    cuadroActual = 0;
+    fallosAnteriores = 0;
+    segundosAnteriores = 0.0;
+    fallosPorSegundo = 0.0;
+    detener = false;
+
+    printf(BORRAR_PANTALLA INICIO_PANTALLA OCULTAR_CURSOR);
+    fflush(stdout);
+
+    if (pthread_create(&hiloPanel, NULL, funcionHiloPanel, NULL) != 0) {
+        printf(MOSTRAR_CURSOR "Error al crear el hilo del panel\n");
+        return false;
+    }
+    activo = true;
+    return true;
+}
+
+void detenerPanel(void) {
+    if (!activo) {
+        return;
+    }
+
+    pthread_mutex_lock(&mutexPanel);
+    detener = true;
+    pthread_cond_signal(&condPanel);
+    pthread_mutex_unlock(&mutexPanel);
+    pthread_join(hiloPanel, NULL);
+    activo = false;
+
+    /* El resto de la salida continúa debajo del cuadro */
+    printf(MOSTRAR_CURSOR "\n");
+    fflush(stdout);
+}
+
+bool panelActivo(void) {
+    return activo;
+}
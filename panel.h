@@ -0,0 +1,72 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "juego.h"
+#include "memoria.h"
+
+/* Panel de la partida en la terminal.
+ *
+ * En lugar de que cada hilo escriba un printf por evento, un solo hilo de
+ * dibujo copia periódicamente el estado (jugadores, planificador, memoria)
+ * en una instantánea y redibuja un cuadro de tamaño fijo desde ella, a un
+ * máximo de cuadros por segundo. El cuadro se compone en un búfer y se
+ * escribe con un solo fwrite desde el principio de la pantalla; si es igual
+ * al anterior (son dos búferes que se alternan) no se escribe nada */
+
+#define FPS_PANEL          10   /* Cuadros por segundo por defecto */
+#define MAX_FPS_PANEL      60
+#define ANCHO_PANEL        80   /* Columnas de cada línea del cuadro */
+#define ALTO_PANEL         20   /* Líneas del cuadro */
+
+/* Lo que el panel sabe de un jugador */
+typedef struct {
+    int id;
+    EstadoJugador estado;
+    int numCartas;
+    int tiempoTurno;
+    int tiempoRestante;
+    bool primeraApeada;
+    const char *estrategia;
+} FilaPanel;
+
+/* Estado copiado para dibujar un cuadro */
+typedef struct {
+    int numRonda;
+    int algoritmoCpu;
+    int quantum;
+    int jugadorEnTurno;
+    FilaPanel jugadores[MAX_JUGADORES];
+    int numJugadores;
+    int numApeadas;
+    size_t memoriaMesa;     /* Bytes de la tabla de apeadas */
+    int cartasBanca;
+    /* Memoria: dueño de cada bloque de 16 bytes (-1 libre) y de cada marco */
+    int algoritmoMemoria;
+    int memoriaDisponible;
+    int duenoBloque[NUM_BLOQUES_BITMAP];
+    int procesoMarco[NUM_MARCOS];
+    int paginaMarco[NUM_MARCOS];
+    int politicaReemplazo;
+    int fallosPagina;
+    int aciertosMemoria;
+    int aciertosTLB;
+    int fallosTLB;
+    double segundos;        /* Tiempo monotónico de la captura */
+} EstadoPanel;
+
+/* Arrancar el hilo del panel a fps cuadros por segundo (acotado a
+ * 1..MAX_FPS_PANEL). Devuelve false si no se pudo crear el hilo */
+bool iniciarPanel(int fps);
+
+/* Dibujar un último cuadro, detener el hilo y devolver el cursor. No hace
+ * nada si el panel no está activo */
+void detenerPanel(void);
+
+bool panelActivo(void);
+
+/* Copiar el estado vivo del juego en una instantánea del panel */
+void capturarEstadoPanel(EstadoPanel *estado);
+
+#endif /* PANEL_H */
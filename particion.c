@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "particion.h"
+#include "utilidades.h"
+#include "cacheparticion.h"
+
+#define BITS_TABLA_MEMO    13
+#define TAMANO_TABLA_MEMO  (1 << BITS_TABLA_MEMO)
+#define NUM_INDICES        (NUM_PALOS_PARTICION * NUM_VALORES_PARTICION)
+#define PRESUPUESTO_RECONSTRUCCION 2000
+
+const char palosParticion[NUM_PALOS_PARTICION] = {'C', 'D', 'T', 'E'};
+
+/* Tipo de jugada elegida para la carta más baja */
+enum {
+    ELECCION_NINGUNA,   /* La carta queda en la mano */
+    ELECCION_GRUPO,
+    ELECCION_ESCALERA
+};
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t mascara;      /* Grupo: palos que aportan carta natural */
+    uint8_t hasta;        /* Escalera: último valor natural */
+    uint8_t comodines;    /* Comodines obligatorios (huecos o mínimo de 3 cartas) */
+} Eleccion;
+
+/* Entrada de la tabla de memoización */
+typedef struct {
+    uint64_t clave[4];
+    uint32_t generacion;
+    int32_t valor;
+    Eleccion eleccion;
+} EntradaMemo;
+
+/* Estado de la búsqueda. La clave empaqueta la firma con 4 bits por carta y
+ * se actualiza con cada carta que se quita o se devuelve */
+typedef struct {
+    EntradaMemo *tabla;
+    uint32_t generacion;
+    ObjetivoParticion objetivo;
+    int nodos;
+    int presupuesto;
+    bool exacto;
+    FirmaMano firma;
+    uint64_t clave[4];
+    int huecos;           /* Posiciones libres para comodines en las jugadas ya hechas */
+} ContextoParticion;
+
+/* Tabla propia de cada hilo: el jugador en turno y el hilo de especulación
+ * pueden resolver a la vez. Se reserva la primera vez y se libera al
+ * terminar el hilo (liberarMemoParticionHilo) */
+static __thread EntradaMemo *tablaHilo = NULL;
+static __thread uint32_t generacionHilo = 0;
+
+/* Estadísticas globales */
+static unsigned long llamadas = 0;
+static unsigned long inexactas = 0;
+static unsigned long nodosTotales = 0;
+static unsigned long tiempoTotalNs = 0;
+static unsigned long tiempoMaximoNs = 0;
+
+int indicePaloParticion(char palo) {
+    for (int i = 0; i < NUM_PALOS_PARTICION; i++) {
+        if (palosParticion[i] == palo) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Las cartas se recorren por valor y luego por palo: indice = (valor-1)*4 + palo */
+static inline int indiceCarta(int palo, int valor) {
+    return (valor - 1) * NUM_PALOS_PARTICION + palo;
+}
+
+static inline void quitarCarta(ContextoParticion *ctx, int palo, int valor) {
+    int indice = indiceCarta(palo, valor);
+    ctx->firma.conteo[palo][valor - 1]--;
+    ctx->clave[indice / 16] -= 1ULL << ((indice % 16) * 4);
+}
+
+static inline void ponerCarta(ContextoParticion *ctx, int palo, int valor) {
+    int indice = indiceCarta(palo, valor);
+    ctx->firma.conteo[palo][valor - 1]++;
+    ctx->clave[indice / 16] += 1ULL << ((indice % 16) * 4);
+}
+
+/* Puntos de una carta natural por valor, igual que calcularPuntosCarta */
+static const int puntosValor[NUM_VALORES_PARTICION + 1] = {
+    0, 15, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10
+};
+
+static int puntuacion(ContextoParticion *ctx, int puntos, int cartas) {
+    if (ctx->objetivo == OBJ_MAX_PUNTOS) {
+        return puntos * 256 + cartas;
+    }
+    return cartas * 4096 + puntos;
+}
+
+static uint32_t hashClave(const uint64_t clave[4]) {
+    uint64_t h = clave[0] * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 29) ^ clave[1]) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 32) ^ clave[2]) * 0x94D049BB133111EBULL;
+    h = (h ^ (h >> 29) ^ clave[3]) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(h >> (64 - BITS_TABLA_MEMO));
+}
+
+void calcularFirmaMano(const Carta *mano, int numCartas, FirmaMano *firma) {
+    memset(firma, 0, sizeof(FirmaMano));
+    for (int i = 0; i < numCartas; i++) {
+        if (mano[i].esComodin) {
+            if (firma->comodines < 15) {
+                firma->comodines++;
+            }
+            continue;
+        }
+        int palo = indicePaloParticion(mano[i].palo);
+        if (palo < 0 || mano[i].valor < 1 || mano[i].valor > NUM_VALORES_PARTICION) {
+            continue;
+        }
+        if (firma->conteo[palo][mano[i].valor - 1] < 15) {
+            firma->conteo[palo][mano[i].valor - 1]++;
+        }
+    }
+}
+
+static int resolver(ContextoParticion *ctx, int desde, Eleccion *eleccion);
+
+/* Probar una jugada cuyas cartas naturales ya se quitaron: descuenta sus
+ * comodines, suma sus huecos libres y devuelve su valor más el del resto */
+static int probarJugada(ContextoParticion *ctx, int desde, int puntos, int cartas,
+                        int comodines, int huecosNuevos) {
+    Eleccion temporal;
+
+    ctx->firma.comodines -= comodines;
+    ctx->huecos += huecosNuevos;
+    int v = puntuacion(ctx, puntos, cartas) + resolver(ctx, desde, &temporal);
+    ctx->huecos -= huecosNuevos;
+    ctx->firma.comodines += comodines;
+    return v;
+}
+
+/* Mejor puntuación alcanzable con las cartas restantes. desde es el índice
+ * de la carta más baja que puede quedar; eleccion recibe la jugada tomada.
+ *
+ * Los comodines solo se ramifican donde son obligatorios (huecos de una
+ * escalera o completar 3 cartas). Los que sobran valen lo mismo en
+ * cualquier jugada con sitio libre, así que se cuentan al final contra los
+ * huecos acumulados en vez de probar cada forma de repartirlos */
+static int resolver(ContextoParticion *ctx, int desde, Eleccion *eleccion) {
+    FirmaMano *firma = &ctx->firma;
+    uint64_t clave[4];
+    int mejor;
+
+    eleccion->tipo = ELECCION_NINGUNA;
+
+    while (desde < NUM_INDICES &&
+           firma->conteo[desde % NUM_PALOS_PARTICION][desde / NUM_PALOS_PARTICION] == 0) {
+        desde++;
+    }
+
+    /* Los huecos solo importan hasta el número de comodines que quedan */
+    int huecos = ctx->huecos < firma->comodines ? ctx->huecos : firma->comodines;
+
+    if (desde == NUM_INDICES) {
+        /* Solo quedan comodines: van a los huecos libres */
+        return puntuacion(ctx, huecos * 20, huecos);
+    }
+
+    clave[0] = ctx->clave[0];
+    clave[1] = ctx->clave[1];
+    clave[2] = ctx->clave[2];
+    clave[3] = ctx->clave[3] | ((uint64_t)firma->comodines << 32) | ((uint64_t)huecos << 40);
+    EntradaMemo *entrada = &ctx->tabla[hashClave(clave)];
+    if (entrada->generacion == ctx->generacion &&
+        entrada->clave[0] == clave[0] && entrada->clave[1] == clave[1] &&
+        entrada->clave[2] == clave[2] && entrada->clave[3] == clave[3]) {
+        *eleccion = entrada->eleccion;
+        return entrada->valor;
+    }
+
+    if (ctx->nodos >= ctx->presupuesto) {
+        ctx->exacto = false;
+        return puntuacion(ctx, huecos * 20, huecos);
+    }
+    ctx->nodos++;
+
+    int palo = desde % NUM_PALOS_PARTICION;
+    int valor = desde / NUM_PALOS_PARTICION + 1;
+    int puntosBase = puntosValor[valor];
+    int comodines = firma->comodines;
+    Eleccion mejorEleccion = {ELECCION_NINGUNA, 0, 0, 0};
+    Eleccion temporal;
+
+    quitarCarta(ctx, palo, valor);
+
+    /* 1. La carta más baja queda en la mano */
+    mejor = resolver(ctx, desde, &temporal);
+
+    /* 2. Grupo del mismo valor: palos mayores que aún tienen esa carta */
+    int otros = 0;
+    for (int p = palo + 1; p < NUM_PALOS_PARTICION; p++) {
+        if (firma->conteo[p][valor - 1] > 0) {
+            otros |= 1 << p;
+        }
+    }
+    for (int sub = otros; ; sub = (sub - 1) & otros) {
+        int naturales = 1 + __builtin_popcount(sub);
+        int necesarios = naturales < 3 ? 3 - naturales : 0;
+
+        if (necesarios <= comodines) {
+            for (int p = 0; p < NUM_PALOS_PARTICION; p++) {
+                if (sub & (1 << p)) quitarCarta(ctx, p, valor);
+            }
+            int cartas = naturales + necesarios;
+            int v = probarJugada(ctx, desde, naturales * puntosBase + necesarios * 20, cartas,
+                                 necesarios, 4 - cartas);
+            for (int p = 0; p < NUM_PALOS_PARTICION; p++) {
+                if (sub & (1 << p)) ponerCarta(ctx, p, valor);
+            }
+            if (v > mejor) {
+                mejor = v;
+                mejorEleccion.tipo = ELECCION_GRUPO;
+                mejorEleccion.mascara = (uint8_t)(sub | (1 << palo));
+                mejorEleccion.comodines = (uint8_t)necesarios;
+            }
+        }
+
+        if (sub == 0) {
+            break;
+        }
+    }
+
+    /* 3. Escalera del palo que empieza en esta carta y termina en una carta
+     * natural (hasta). Los huecos intermedios se cubren con la carta natural
+     * si la hay, porque cambiarla por un comodín no mejora nada, y si no con
+     * un comodín */
+    int puntos = puntosBase;
+    int naturales = 1;
+    int huecosEscalera = 0;
+    uint16_t tomadas = 0;  /* Valores cuya carta natural se tomó */
+
+    for (int hasta = valor; hasta <= NUM_VALORES_PARTICION; hasta++) {
+        if (hasta > valor) {
+            if (firma->conteo[palo][hasta - 1] == 0) {
+                huecosEscalera++;
+                if (huecosEscalera > comodines) {
+                    break;
+                }
+                continue;
+            }
+            quitarCarta(ctx, palo, hasta);
+            tomadas |= 1 << hasta;
+            puntos += puntosValor[hasta];
+            naturales++;
+        }
+
+        int longitud = hasta - valor + 1;
+        int necesarios = huecosEscalera + (longitud < 3 ? 3 - longitud : 0);
+        if (necesarios > comodines) {
+            continue;
+        }
+        int cartas = naturales + necesarios;
+        int v = probarJugada(ctx, desde, puntos + necesarios * 20, cartas,
+                             necesarios, NUM_VALORES_PARTICION - cartas);
+        if (v > mejor) {
+            mejor = v;
+            mejorEleccion.tipo = ELECCION_ESCALERA;
+            mejorEleccion.hasta = (uint8_t)hasta;
+            mejorEleccion.comodines = (uint8_t)necesarios;
+        }
+    }
+    for (int v = valor + 1; v <= NUM_VALORES_PARTICION; v++) {
+        if (tomadas & (1 << v)) ponerCarta(ctx, palo, v);
+    }
+
+    ponerCarta(ctx, palo, valor);
+
+    memcpy(entrada->clave, clave, sizeof(clave));
+    entrada->generacion = ctx->generacion;
+    entrada->valor = mejor;
+    entrada->eleccion = mejorEleccion;
+
+    *eleccion = mejorEleccion;
+    return mejor;
+}
+
+bool agregarComodinJugada(JugadaParticion *jugada) {
+    Carta comodin = {0, 'J', true};
+
+    if (jugada->esGrupo) {
+        if (jugada->numCartas >= 4) {
+            return false;
+        }
+        jugada->cartas[jugada->numCartas++] = comodin;
+    } else {
+        if (jugada->numCartas >= NUM_VALORES_PARTICION) {
+            return false;
+        }
+
+        /* Valor de la última posición: el de la primera carta natural más su distancia */
+        int ultimo = 0;
+        for (int i = 0; i < jugada->numCartas; i++) {
+            if (!jugada->cartas[i].esComodin) {
+                ultimo = jugada->cartas[i].valor + (jugada->numCartas - 1 - i);
+                break;
+            }
+        }
+
+        if (ultimo < NUM_VALORES_PARTICION) {
+            jugada->cartas[jugada->numCartas] = comodin;
+        } else {
+            memmove(&jugada->cartas[1], &jugada->cartas[0], jugada->numCartas * sizeof(Carta));
+            jugada->cartas[0] = comodin;
+        }
+        jugada->numCartas++;
+    }
+
+    jugada->puntos += 20;
+    return true;
+}
+
+/* Quitar del estado las cartas de la jugada elegida y escribirla */
+static void construirJugada(ContextoParticion *ctx, int desde, const Eleccion *eleccion,
+                            JugadaParticion *jugada) {
+    int palo = desde % NUM_PALOS_PARTICION;
+    int valor = desde / NUM_PALOS_PARTICION + 1;
+    Carta comodin = {0, 'J', true};
+
+    jugada->numCartas = 0;
+    jugada->puntos = 0;
+    jugada->palo = palosParticion[palo];
+
+    if (eleccion->tipo == ELECCION_GRUPO) {
+        jugada->esGrupo = true;
+        for (int p = 0; p < NUM_PALOS_PARTICION; p++) {
+            if (eleccion->mascara & (1 << p)) {
+                Carta carta = {valor, palosParticion[p], false};
+                quitarCarta(ctx, p, valor);
+                jugada->cartas[jugada->numCartas++] = carta;
+            }
+        }
+        for (int c = 0; c < eleccion->comodines; c++) {
+            jugada->cartas[jugada->numCartas++] = comodin;
+        }
+    } else {
+        jugada->esGrupo = false;
+        for (int v = valor; v <= eleccion->hasta; v++) {
+            if (ctx->firma.conteo[palo][v - 1] > 0) {
+                Carta carta = {v, palosParticion[palo], false};
+                quitarCarta(ctx, palo, v);
+                jugada->cartas[jugada->numCartas++] = carta;
+            } else {
+                jugada->cartas[jugada->numCartas++] = comodin;
+            }
+        }
+    }
+
+    for (int i = 0; i < jugada->numCartas; i++) {
+        jugada->puntos += calcularPuntosCarta(jugada->cartas[i]);
+    }
+    while (jugada->numCartas < 3) {
+        agregarComodinJugada(jugada);
+    }
+
+    ctx->firma.comodines -= eleccion->comodines;
+    ctx->huecos += (jugada->esGrupo ? 4 : NUM_VALORES_PARTICION) - jugada->numCartas;
+}
+
+/* Acumular el tiempo de una llamada (también las resueltas por la caché) */
+static void registrarLlamada(const struct timespec *t0, int nodos, bool exacto) {
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    unsigned long ns = (unsigned long)((t1.tv_sec - t0->tv_sec) * 1000000000L + (t1.tv_nsec - t0->tv_nsec));
+    __atomic_add_fetch(&llamadas, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&nodosTotales, (unsigned long)nodos, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tiempoTotalNs, ns, __ATOMIC_RELAXED);
+    if (!exacto) {
+        __atomic_add_fetch(&inexactas, 1, __ATOMIC_RELAXED);
+    }
+    unsigned long maximo = __atomic_load_n(&tiempoMaximoNs, __ATOMIC_RELAXED);
+    while (ns > maximo &&
+           !__atomic_compare_exchange_n(&tiempoMaximoNs, &maximo, ns, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+bool resolverParticion(const Carta *mano, int numCartas, ObjetivoParticion objetivo, ParticionMano *resultado) {
+    FirmaMano firma;
+
+    calcularFirmaMano(mano, numCartas, &firma);
+    return resolverParticionFirma(&firma, objetivo, resultado);
+}
+
+bool resolverParticionFirma(const FirmaMano *firma, ObjetivoParticion objetivo, ParticionMano *resultado) {
+    struct timespec t0;
+    ContextoParticion ctx;
+    Eleccion eleccion;
+    uint64_t claveCache[4];
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    resultado->numJugadas = 0;
+    resultado->puntos = 0;
+    resultado->cartas = 0;
+    resultado->exacto = true;
+    resultado->nodos = 0;
+
+    /* La clave guarda 4 bits por carta, como calcularFirmaMano */
+    ctx.firma = *firma;
+    if (ctx.firma.comodines > 15) {
+        ctx.firma.comodines = 15;
+    }
+    memset(ctx.clave, 0, sizeof(ctx.clave));
+    for (int i = 0; i < NUM_INDICES; i++) {
+        uint8_t *copias = &ctx.firma.conteo[i % NUM_PALOS_PARTICION][i / NUM_PALOS_PARTICION];
+        if (*copias > 15) {
+            *copias = 15;
+        }
+        uint64_t conteo = ctx.firma.conteo[i % NUM_PALOS_PARTICION][i / NUM_PALOS_PARTICION];
+        ctx.clave[i / 16] |= conteo << ((i % 16) * 4);
+    }
+
+    /* La misma firma con el mismo objetivo da la misma partición, sea de
+     * este turno, de uno anterior o de otra partida */
+    claveCache[0] = ctx.clave[0];
+    claveCache[1] = ctx.clave[1];
+    claveCache[2] = ctx.clave[2];
+    claveCache[3] = ctx.clave[3] | ((uint64_t)ctx.firma.comodines << 32) | ((uint64_t)objetivo << 48);
+    if (buscarParticionCache(claveCache, resultado)) {
+        registrarLlamada(&t0, 0, true);
+        return resultado->numJugadas > 0;
+    }
+
+    if (tablaHilo == NULL) {
+        tablaHilo = calloc(TAMANO_TABLA_MEMO, sizeof(EntradaMemo));
+        if (tablaHilo == NULL) {
+            printf("Error: No se pudo asignar memoria para la tabla de particiones\n");
+            return false;
+        }
+    }
+
+    /* Cambiar de generación invalida la tabla sin tener que limpiarla */
+    generacionHilo++;
+    if (generacionHilo == 0) {
+        memset(tablaHilo, 0, TAMANO_TABLA_MEMO * sizeof(EntradaMemo));
+        generacionHilo = 1;
+    }
+
+    ctx.tabla = tablaHilo;
+    ctx.generacion = generacionHilo;
+    ctx.objetivo = objetivo;
+    ctx.nodos = 0;
+    ctx.presupuesto = PRESUPUESTO_PARTICION;
+    ctx.exacto = true;
+    ctx.huecos = 0;
+
+    resolver(&ctx, 0, &eleccion);
+
+    /* Reconstruir siguiendo las elecciones; casi todo sale de la tabla, y si
+     * alguna entrada se pisó se vuelve a calcular con un poco más de presupuesto */
+    ctx.presupuesto = ctx.nodos + PRESUPUESTO_RECONSTRUCCION;
+    int desde = 0;
+    while (resultado->numJugadas < MAX_JUGADAS_PARTICION) {
+        while (desde < NUM_INDICES &&
+               ctx.firma.conteo[desde % NUM_PALOS_PARTICION][desde / NUM_PALOS_PARTICION] == 0) {
+            desde++;
+        }
+        if (desde == NUM_INDICES) {
+            break;
+        }
+
+        resolver(&ctx, desde, &eleccion);
+        if (eleccion.tipo == ELECCION_NINGUNA) {
+            quitarCarta(&ctx, desde % NUM_PALOS_PARTICION, desde / NUM_PALOS_PARTICION + 1);
+            continue;
+        }
+
+        construirJugada(&ctx, desde, &eleccion, &resultado->jugadas[resultado->numJugadas++]);
+    }
+
+    /* Los comodines que sobran van a las jugadas con sitio libre */
+    for (int i = 0; i < resultado->numJugadas && ctx.firma.comodines > 0; i++) {
+        while (ctx.firma.comodines > 0 && agregarComodinJugada(&resultado->jugadas[i])) {
+            ctx.firma.comodines--;
+        }
+    }
+
+    for (int i = 0; i < resultado->numJugadas; i++) {
+        resultado->puntos += resultado->jugadas[i].puntos;
+        resultado->cartas += resultado->jugadas[i].numCartas;
+    }
+
+    resultado->exacto = ctx.exacto;
+    resultado->nodos = ctx.nodos;
+
+    /* Solo se guardan los resultados óptimos */
+    guardarParticionCache(claveCache, resultado);
+
+    registrarLlamada(&t0, ctx.nodos, ctx.exacto);
+    return resultado->numJugadas > 0;
+}
+
+void liberarMemoParticionHilo(void) {
+    free(tablaHilo);
+    tablaHilo = NULL;
+    generacionHilo = 0;
+}
+
+void imprimirEstadisticasParticion(void) {
+    if (llamadas == 0) {
+        return;
+    }
+    printf("\nParticiones: %lu búsquedas, %.1f nodos y %.1f us de media, máximo %.1f us, "
+           "%lu sin terminar (presupuesto de %d nodos)\n",
+           llamadas, (double)nodosTotales / llamadas, tiempoTotalNs / 1000.0 / llamadas,
+           tiempoMaximoNs / 1000.0, inexactas, PRESUPUESTO_PARTICION);
+    imprimirEstadisticasCacheParticion();
+}
@@ -0,0 +1,72 @@
+#ifndef PARTICION_H
+#define PARTICION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "jugadores.h"
+
+/* Solucionador exacto de la partición de una mano en apeadas disjuntas.
+ *
+ * La mano se reduce a su firma (cuántas copias hay de cada palo y valor y
+ * cuántos comodines), y una búsqueda con memoización sobre esa firma decide
+ * para la carta más baja si queda en la mano, abre un grupo de su valor o
+ * abre una escalera de su palo. Los comodines se asignan dentro de cada
+ * grupo o escalera, así que nunca se cuentan dos veces. Un presupuesto de
+ * nodos acota el tiempo; si se agota, el resultado es válido pero puede no
+ * ser el óptimo (exacto = false) */
+
+#define NUM_PALOS_PARTICION     NUM_PALOS
+#define NUM_VALORES_PARTICION   NUM_VALORES
+#define MAX_JUGADAS_PARTICION   36   /* 108 cartas / 3 */
+#define PRESUPUESTO_PARTICION   20000
+
+/* Qué se maximiza */
+typedef enum {
+    OBJ_MAX_PUNTOS,     /* Primera apeada: máximo de puntos (desempate: cartas) */
+    OBJ_MAX_CARTAS      /* Apeadas posteriores: máximo de cartas (desempate: puntos) */
+} ObjetivoParticion;
+
+/* Una apeada de la partición, con las cartas ya en orden válido */
+typedef struct {
+    Carta cartas[NUM_VALORES_PARTICION];
+    int numCartas;
+    bool esGrupo;
+    char palo;          /* Palo de la escalera */
+    int puntos;
+} JugadaParticion;
+
+/* Resultado de la partición */
+typedef struct ParticionMano {
+    JugadaParticion jugadas[MAX_JUGADAS_PARTICION];
+    int numJugadas;
+    int puntos;         /* Puntos de todas las jugadas */
+    int cartas;         /* Cartas usadas en todas las jugadas */
+    bool exacto;        /* false si se agotó el presupuesto de nodos */
+    int nodos;          /* Nodos expandidos en la búsqueda */
+} ParticionMano;
+
+/* Orden de los palos en la firma y su índice (-1 si no es un palo) */
+extern const char palosParticion[NUM_PALOS_PARTICION];
+int indicePaloParticion(char palo);
+
+/* Calcular la firma de una mano */
+void calcularFirmaMano(const Carta *mano, int numCartas, FirmaMano *firma);
+
+/* Calcular la mejor partición de la mano según el objetivo. Devuelve true si
+ * encontró al menos una jugada */
+bool resolverParticion(const Carta *mano, int numCartas, ObjetivoParticion objetivo, ParticionMano *resultado);
+
+/* Igual, partiendo de la firma ya calculada (por ejemplo, la del resumen de un Mazo) */
+bool resolverParticionFirma(const FirmaMano *firma, ObjetivoParticion objetivo, ParticionMano *resultado);
+
+/* Añadir un comodín a una jugada con sitio. En una escalera va al final, o
+ * al principio si ya llega al rey */
+bool agregarComodinJugada(JugadaParticion *jugada);
+
+/* Liberar la tabla de memoización del hilo (al terminar el hilo) */
+void liberarMemoParticionHilo(void);
+
+/* Mostrar llamadas, tiempo medio y máximo y búsquedas sin terminar */
+void imprimirEstadisticasParticion(void);
+
+#endif /* PARTICION_H */
@@ -135,7 +135,7 @@ BCP* crearBCP(int id) {
     nuevoBCP->tiempoUltimoEstado = 0;
     nuevoBCP->tiempoUltimoBloqueo = 0;
     
-    printf("BCP creado para el proceso %d\n", id);
+    imprimirRegistro(REGISTRO_RESUMEN, "BCP creado para el proceso %d\n", id);
     
     return nuevoBCP;
 }
@@ -169,7 +169,7 @@ void inicializarTabla(void) {
         tablaProc.procesos[i] = NULL;
     }
     
-    printf("Tabla de procesos inicializada\n");
+    imprimirRegistro(REGISTRO_RESUMEN, "Tabla de procesos inicializada\n");
     
     // Crear directorio para BCPs si no existe
     system("mkdir -p " RUTA_BCP);
@@ -208,7 +208,7 @@ void registrarProcesoEnTabla(int id, int estado) {
             break;
     }
     
-    printf("Proceso %d registrado en la tabla (estado: %d)\n", id, estado);
+    imprimirRegistro(REGISTRO_DETALLE, "Proceso %d registrado en la tabla (estado: %d)\n", id, estado);
     
     // Guardar el BCP
     guardarBCP(nuevoBCP);
@@ -293,7 +293,7 @@ void actualizarProcesoEnTabla(int id, int nuevoEstado) {
             break;
     }
     
-    printf("Estado del proceso %d actualizado: %d -> %d\n", id, estadoAnterior, nuevoEstado);
+    imprimirRegistro(REGISTRO_DETALLE, "Estado del proceso %d actualizado: %d -> %d\n", id, estadoAnterior, nuevoEstado);
     
     // Actualizar el BCP para reflejar el cambio de estado
     bcp->cambiosEstado++;
@@ -341,7 +341,7 @@ void asignarQuantum(int id, int quantum) {
     bcp->tiempoQuantum = quantum;
     bcp->tiempoRestante = quantum;
     
-    printf("Quantum asignado al proceso %d: %d ms\n", id, quantum);
+    imprimirRegistro(REGISTRO_DETALLE, "Quantum asignado al proceso %d: %d ms\n", id, quantum);
     
     // Incrementar contador de turnos asignados
     tablaProc.turnosAsignados++;
@@ -462,8 +462,23 @@ BCP* obtenerBCPActual(void) {
     return tablaProc.procesos[tablaProc.procesoActual];
 }
 
+// Copiar la tabla de procesos y sus BCP (el llamador debe tener mutexTabla)
+void copiarTablaProc(TablaProc *destino, BCP *bcps) {
+    *destino = tablaProc;
+    
+    for (int i = 0; i < tablaProc.numProcesos; i++) {
+        bcps[i] = *tablaProc.procesos[i];
+        destino->procesos[i] = &bcps[i];
+    }
+}
+
 // Imprimir estadísticas de la tabla de procesos
 void imprimirEstadisticasTabla(void) {
+    imprimirEstadisticasDeTabla(&tablaProc);
+}
+
+// Imprimir estadísticas de una tabla de procesos (la global o una copia)
+void imprimirEstadisticasDeTabla(TablaProc *tabla) {
     FILE *archivo;
     const char *nombreArchivo = "estadisticas_procesos.txt";
     
@@ -478,62 +493,62 @@ void imprimirEstadisticasTabla(void) {
     printf("\n=== ESTADÍSTICAS DE LA TABLA DE PROCESOS ===\n");
     fprintf(archivo, "=== ESTADÍSTICAS DE LA TABLA DE PROCESOS ===\n");
     
-    printf("Número de procesos: %d\n", tablaProc.numProcesos);
-    fprintf(archivo, "Número de procesos: %d\n", tablaProc.numProcesos);
+    printf("Número de procesos: %d\n", tabla->numProcesos);
+    fprintf(archivo, "Número de procesos: %d\n", tabla->numProcesos);
     
-    printf("Procesos listos: %d\n", tablaProc.numProcesosListos);
-    fprintf(archivo, "Procesos listos: %d\n", tablaProc.numProcesosListos);
+    printf("Procesos listos: %d\n", tabla->numProcesosListos);
+    fprintf(archivo, "Procesos listos: %d\n", tabla->numProcesosListos);
     
-    printf("Procesos bloqueados: %d\n", tablaProc.numProcesosBloqueados);
-    fprintf(archivo, "Procesos bloqueados: %d\n", tablaProc.numProcesosBloqueados);
+    printf("Procesos bloqueados: %d\n", tabla->numProcesosBloqueados);
+    fprintf(archivo, "Procesos bloqueados: %d\n", tabla->numProcesosBloqueados);
     
-    printf("Procesos terminados: %d\n", tablaProc.numProcesosTerminados);
-    fprintf(archivo, "Procesos terminados: %d\n", tablaProc.numProcesosTerminados);
+    printf("Procesos terminados: %d\n", tabla->numProcesosTerminados);
+    fprintf(archivo, "Procesos terminados: %d\n", tabla->numProcesosTerminados);
     
-    printf("Cambios de contexto: %d\n", tablaProc.cambiosContexto);
-    fprintf(archivo, "Cambios de contexto: %d\n", tablaProc.cambiosContexto);
+    printf("Cambios de contexto: %d\n", tabla->cambiosContexto);
+    fprintf(archivo, "Cambios de contexto: %d\n", tabla->cambiosContexto);
     
-    printf("Tiempo total de ejecución: %d ms\n", tablaProc.tiempoTotalEjecucion);
-    fprintf(archivo, "Tiempo total de ejecución: %d ms\n", tablaProc.tiempoTotalEjecucion);
+    printf("Tiempo total de ejecución: %d ms\n", tabla->tiempoTotalEjecucion);
+    fprintf(archivo, "Tiempo total de ejecución: %d ms\n", tabla->tiempoTotalEjecucion);
     
-    printf("Tiempo total de espera: %d ms\n", tablaProc.tiempoTotalEspera);
-    fprintf(archivo, "Tiempo total de espera: %d ms\n", tablaProc.tiempoTotalEspera);
+    printf("Tiempo total de espera: %d ms\n", tabla->tiempoTotalEspera);
+    fprintf(archivo, "Tiempo total de espera: %d ms\n", tabla->tiempoTotalEspera);
     
-    printf("Tiempo total de bloqueo: %d ms\n", tablaProc.tiempoTotalBloqueo);
-    fprintf(archivo, "Tiempo total de bloqueo: %d ms\n", tablaProc.tiempoTotalBloqueo);
+    printf("Tiempo total de bloqueo: %d ms\n", tabla->tiempoTotalBloqueo);
+    fprintf(archivo, "Tiempo total de bloqueo: %d ms\n", tabla->tiempoTotalBloqueo);
     
-    printf("Tiempo total en E/S: %d ms\n", tablaProc.tiempoTotalES);
-    fprintf(archivo, "Tiempo total en E/S: %d ms\n", tablaProc.tiempoTotalES);
+    printf("Tiempo total en E/S: %d ms\n", tabla->tiempoTotalES);
+    fprintf(archivo, "Tiempo total en E/S: %d ms\n", tabla->tiempoTotalES);
     
-    printf("Turnos asignados: %d\n", tablaProc.turnosAsignados);
-    fprintf(archivo, "Turnos asignados: %d\n", tablaProc.turnosAsignados);
+    printf("Turnos asignados: %d\n", tabla->turnosAsignados);
+    fprintf(archivo, "Turnos asignados: %d\n", tabla->turnosAsignados);
     
-    printf("Turnos completados: %d\n", tablaProc.turnosCompletados);
-    fprintf(archivo, "Turnos completados: %d\n", tablaProc.turnosCompletados);
+    printf("Turnos completados: %d\n", tabla->turnosCompletados);
+    fprintf(archivo, "Turnos completados: %d\n", tabla->turnosCompletados);
     
-    printf("Turnos interrumpidos: %d\n", tablaProc.turnosInterrumpidos);
-    fprintf(archivo, "Turnos interrumpidos: %d\n", tablaProc.turnosInterrumpidos);
+    printf("Turnos interrumpidos: %d\n", tabla->turnosInterrumpidos);
+    fprintf(archivo, "Turnos interrumpidos: %d\n", tabla->turnosInterrumpidos);
     
     // Calcular tiempo total de la simulación
-    tablaProc.tiempoActual = time(NULL);
-    double tiempoTotal = difftime(tablaProc.tiempoActual, tablaProc.tiempoInicio);
+    tabla->tiempoActual = time(NULL);
+    double tiempoTotal = difftime(tabla->tiempoActual, tabla->tiempoInicio);
     
     printf("Tiempo total de simulación: %.2f segundos\n", tiempoTotal);
     fprintf(archivo, "Tiempo total de simulación: %.2f segundos\n", tiempoTotal);
     
     // Calcular uso de CPU
     if (tiempoTotal > 0) {
-        tablaProc.usoCPU = (float)tablaProc.tiempoTotalEjecucion / (tiempoTotal * 1000) * 100;
-        printf("Uso de CPU: %.2f%%\n", tablaProc.usoCPU);
-        fprintf(archivo, "Uso de CPU: %.2f%%\n", tablaProc.usoCPU);
+        tabla->usoCPU = (float)tabla->tiempoTotalEjecucion / (tiempoTotal * 1000) * 100;
+        printf("Uso de CPU: %.2f%%\n", tabla->usoCPU);
+        fprintf(archivo, "Uso de CPU: %.2f%%\n", tabla->usoCPU);
     }
     
     // Imprimir detalles de cada proceso
     printf("\nDETALLES DE PROCESOS:\n");
     fprintf(archivo, "\nDETALLES DE PROCESOS:\n");
     
-    for (int i = 0; i < tablaProc.numProcesos; i++) {
-        BCP *bcp = tablaProc.procesos[i];
+    for (int i = 0; i < tabla->numProcesos; i++) {
+        BCP *bcp = tabla->procesos[i];
         
         // Obtener nombre del estado
         const char *estadoTexto[] = {"NUEVO", "LISTO", "EJECUTANDO", "BLOQUEADO", "TERMINADO"};
@@ -562,5 +577,5 @@ void liberarTabla(void) {
     }
     
     tablaProc.numProcesos = 0;
-    printf("Tabla de procesos liberada\n");
+    imprimirRegistro(REGISTRO_RESUMEN, "Tabla de procesos liberada\n");
 }
\ No newline at end of file
@@ -82,6 +82,8 @@ void aumentarTiempoBloqueo(int id, int tiempo);
 void registrarCambioContexto(void);
 BCP* obtenerBCPActual(void);
 void imprimirEstadisticasTabla(void);
+void imprimirEstadisticasDeTabla(TablaProc *tabla);
+void copiarTablaProc(TablaProc *destino, BCP *bcps);
 void liberarTabla(void);
 
 #endif /* PROCESOS_H */
\ No newline at end of file
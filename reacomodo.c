@@ -0,0 +1,1005 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include "reacomodo.h"
+#include "mazo.h"
+#include "utilidades.h"
+
+#define BITS_TABLA_REACOMODO    14
+#define TAMANO_TABLA_REACOMODO  (1 << BITS_TABLA_REACOMODO)
+#define NUM_INDICES_REACOMODO   (NUM_PALOS * NUM_VALORES)
+#define PALABRAS_CLAVE          9     /* 4 obligatorias, 4 opcionales; comodines, huecos y jugadas */
+#define INVIABLE                (-1000000)
+#define ESCALA_VALOR_REACOMODO  256   /* Más que jugadas posibles en una mesa */
+#define PRESUPUESTO_RECONSTRUCCION_REACOMODO 5000
+#define MAX_MOVIMIENTOS_RAIZ    64
+
+/* Jugada elegida para la carta más baja */
+enum {
+    ELECCION_DESCARTAR,     /* Copia opcional que se queda en la mano */
+    ELECCION_GRUPO,
+    ELECCION_ESCALERA
+};
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t mascara;        /* Grupo: palos con carta natural */
+    uint8_t hasta;          /* Escalera: último valor */
+    uint8_t comodines;      /* Comodines de huecos o para llegar a 3 cartas */
+} EleccionReacomodo;
+
+typedef struct {
+    uint64_t clave[PALABRAS_CLAVE];
+    uint32_t generacion;
+    int32_t valor;
+    EleccionReacomodo eleccion;
+} EntradaReacomodo;
+
+/* Estado de la búsqueda. Las cartas se indexan como en particion.c:
+ * indice = (valor-1)*4 + palo, con 4 bits por copia en la clave */
+typedef struct {
+    EntradaReacomodo *tabla;
+    uint32_t generacion;
+    uint8_t obligatorias[NUM_INDICES_REACOMODO];
+    uint8_t opcionales[NUM_INDICES_REACOMODO];
+    uint64_t clave[8];
+    uint64_t presentes;         /* Bit i: queda alguna copia de la carta i */
+    int comodinesObligatorios;
+    int comodinesOpcionales;
+    int opcionalesRestantes;    /* Cartas naturales opcionales que quedan */
+    int huecos;                 /* Posiciones libres en las jugadas hechas */
+    int jugadasLibres;          /* Jugadas que aún caben en la mesa */
+    bool limitarJugadas;        /* Puede haber más jugadas que sitio en la mesa */
+    long nodos;
+    long presupuesto;
+    long limiteNs;
+    bool exacto;
+} ContextoReacomodo;
+
+/* Tabla de memoización de cada hilo que busca (como en particion.c): se
+ * reserva la primera vez y se libera al terminar el hilo, también en los
+ * trabajadores de buscarParalelo */
+static __thread EntradaReacomodo *tablaHilo = NULL;
+static __thread uint32_t generacionHilo = 0;
+
+/* Estadísticas globales */
+static unsigned long busquedas = 0;
+static unsigned long encontrados = 0;
+static unsigned long inexactos = 0;
+static unsigned long nodosTotales = 0;
+static unsigned long tiempoTotalNs = 0;
+static bool reproducible = false;
+
+static long ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static inline int indiceReacomodo(int palo, int valor) {
+    return (valor - 1) * NUM_PALOS + palo;
+}
+
+static inline bool presente(const ContextoReacomodo *ctx, int indice) {
+    return (ctx->presentes >> indice) & 1u;
+}
+
+/* Quitar una copia de la carta, primero de las obligatorias. Devuelve 1 si
+ * fue opcional */
+static inline int tomarCarta(ContextoReacomodo *ctx, int indice) {
+    uint64_t unidad = 1ULL << ((indice % 16) * 4);
+    int opcional;
+
+    if (ctx->obligatorias[indice] > 0) {
+        ctx->obligatorias[indice]--;
+        ctx->clave[indice / 16] -= unidad;
+        opcional = 0;
+    } else {
+        ctx->opcionales[indice]--;
+        ctx->clave[4 + indice / 16] -= unidad;
+        ctx->opcionalesRestantes--;
+        opcional = 1;
+    }
+    if (ctx->obligatorias[indice] == 0 && ctx->opcionales[indice] == 0) {
+        ctx->presentes &= ~(1ULL << indice);
+    }
+    return opcional;
+}
+
+static inline void devolverCarta(ContextoReacomodo *ctx, int indice, int opcional) {
+    uint64_t unidad = 1ULL << ((indice % 16) * 4);
+
+    if (opcional) {
+        ctx->opcionales[indice]++;
+        ctx->clave[4 + indice / 16] += unidad;
+        ctx->opcionalesRestantes++;
+    } else {
+        ctx->obligatorias[indice]++;
+        ctx->clave[indice / 16] += unidad;
+    }
+    ctx->presentes |= 1ULL << indice;
+}
+
+/* Tomar comodines, primero los obligatorios. Devuelve cuántos fueron opcionales */
+static inline int tomarComodines(ContextoReacomodo *ctx, int cantidad) {
+    int obligatorios = cantidad < ctx->comodinesObligatorios ? cantidad : ctx->comodinesObligatorios;
+
+    ctx->comodinesObligatorios -= obligatorios;
+    ctx->comodinesOpcionales -= cantidad - obligatorios;
+    return cantidad - obligatorios;
+}
+
+static inline void devolverComodines(ContextoReacomodo *ctx, int cantidad, int opcionales) {
+    ctx->comodinesObligatorios += cantidad - opcionales;
+    ctx->comodinesOpcionales += opcionales;
+}
+
+static uint32_t hashReacomodo(const uint64_t clave[PALABRAS_CLAVE]) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < PALABRAS_CLAVE; i++) {
+        h = (h ^ clave[i]) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    return (uint32_t)(h >> (64 - BITS_TABLA_REACOMODO));
+}
+
+/* Valor de una solución: cartas de la mano que se bajan y, a igualdad, menos
+ * jugadas (la mesa nueva tiene que caber en MAX_APEADAS) */
+static inline int valorCartas(int cartas) {
+    return cartas * ESCALA_VALOR_REACOMODO;
+}
+
+/* Mejor valor que se puede conseguir con lo que queda, o INVIABLE si las
+ * obligatorias no caben en jugadas válidas */
+static int buscar(ContextoReacomodo *ctx, EleccionReacomodo *eleccion) {
+    int comodines = ctx->comodinesObligatorios + ctx->comodinesOpcionales;
+    int huecos = ctx->huecos < comodines ? ctx->huecos : comodines;
+    uint64_t clave[PALABRAS_CLAVE];
+    EleccionReacomodo temporal;
+
+    eleccion->tipo = ELECCION_DESCARTAR;
+
+    if (ctx->presentes == 0) {
+        /* Solo quedan comodines: los obligatorios deben caber en los huecos */
+        if (ctx->comodinesObligatorios > huecos) {
+            return INVIABLE;
+        }
+        int libres = huecos - ctx->comodinesObligatorios;
+        return valorCartas(libres < ctx->comodinesOpcionales ? libres : ctx->comodinesOpcionales);
+    }
+
+    memcpy(clave, ctx->clave, sizeof(ctx->clave));
+    clave[8] = (uint64_t)ctx->comodinesObligatorios | ((uint64_t)ctx->comodinesOpcionales << 8) |
+               ((uint64_t)huecos << 16) | ((uint64_t)(ctx->limitarJugadas ? ctx->jugadasLibres : 0) << 32);
+    EntradaReacomodo *entrada = &ctx->tabla[hashReacomodo(clave)];
+    if (entrada->generacion == ctx->generacion && memcmp(entrada->clave, clave, sizeof(clave)) == 0) {
+        *eleccion = entrada->eleccion;
+        return entrada->valor;
+    }
+
+    if (ctx->nodos >= ctx->presupuesto ||
+        ((ctx->nodos & 255) == 0 && ahoraNs() > ctx->limiteNs)) {
+        ctx->presupuesto = ctx->nodos;  /* No seguir expandiendo en esta búsqueda */
+        ctx->exacto = false;
+        return INVIABLE;
+    }
+    ctx->nodos++;
+
+    int indice = __builtin_ctzll(ctx->presentes);
+    int palo = indice % NUM_PALOS;
+    int valor = indice / NUM_PALOS + 1;
+    bool obligatoria = ctx->obligatorias[indice] > 0;
+    /* Con todas las cartas opcionales bajadas no se busca con menos jugadas */
+    int cota = valorCartas(ctx->opcionalesRestantes + ctx->comodinesOpcionales) - ESCALA_VALOR_REACOMODO + 1;
+    int mejor = INVIABLE;
+    EleccionReacomodo mejorEleccion = {ELECCION_DESCARTAR, 0, 0, 0};
+
+    int opcional = tomarCarta(ctx, indice);
+
+    /* 1. Una copia opcional puede quedarse en la mano */
+    if (!obligatoria) {
+        mejor = buscar(ctx, &temporal);
+    }
+
+    /* 2. Grupo del valor con palos mayores que aún tienen copia, del más
+     * grande al más pequeño */
+    int otros = 0;
+    for (int p = palo + 1; p < NUM_PALOS; p++) {
+        if (presente(ctx, indiceReacomodo(p, valor))) {
+            otros |= 1 << p;
+        }
+    }
+    for (int sub = otros; mejor < cota && ctx->jugadasLibres > 0; sub = (sub - 1) & otros) {
+        int naturales = 1 + __builtin_popcount(sub);
+        int necesarios = naturales < 3 ? 3 - naturales : 0;
+
+        if (necesarios <= comodines) {
+            int tomadas[NUM_PALOS] = {0};
+            int ganancia = opcional;
+
+            for (int p = 0; p < NUM_PALOS; p++) {
+                if (sub & (1 << p)) {
+                    tomadas[p] = tomarCarta(ctx, indiceReacomodo(p, valor));
+                    ganancia += tomadas[p];
+                }
+            }
+            int comodinesOpcionales = tomarComodines(ctx, necesarios);
+            ctx->huecos += 4 - (naturales + necesarios);
+            ctx->jugadasLibres--;
+
+            int v = buscar(ctx, &temporal);
+
+            ctx->jugadasLibres++;
+            ctx->huecos -= 4 - (naturales + necesarios);
+            devolverComodines(ctx, necesarios, comodinesOpcionales);
+            for (int p = NUM_PALOS - 1; p >= 0; p--) {
+                if (sub & (1 << p)) {
+                    devolverCarta(ctx, indiceReacomodo(p, valor), tomadas[p]);
+                }
+            }
+
+            v += valorCartas(ganancia + comodinesOpcionales) - 1;
+            if (v > INVIABLE / 2 && v > mejor) {
+                mejor = v;
+                mejorEleccion.tipo = ELECCION_GRUPO;
+                mejorEleccion.mascara = (uint8_t)(sub | (1 << palo));
+                mejorEleccion.comodines = (uint8_t)necesarios;
+            }
+        }
+
+        if (sub == 0) {
+            break;
+        }
+    }
+
+    /* 3. Escalera del palo desde esta carta; los huecos van con comodín.
+     * Primero se toman todas las cartas hasta donde alcancen los comodines y
+     * luego se prueba de la más larga a la más corta, devolviendo cartas */
+    int tomadas[NUM_VALORES + 1];
+    int huecosHasta[NUM_VALORES + 1];
+    int ganancia = opcional;
+    int huecosEscalera = 0;
+    int maximo = valor;
+
+    tomadas[valor] = -1;
+    huecosHasta[valor] = 0;
+    for (int hasta = valor + 1; hasta <= NUM_VALORES; hasta++) {
+        int siguiente = indiceReacomodo(palo, hasta);
+        if (presente(ctx, siguiente)) {
+            tomadas[hasta] = tomarCarta(ctx, siguiente);
+            ganancia += tomadas[hasta];
+        } else if (huecosEscalera < comodines) {
+            tomadas[hasta] = -1;
+            huecosEscalera++;
+        } else {
+            break;
+        }
+        huecosHasta[hasta] = huecosEscalera;
+        maximo = hasta;
+    }
+
+    for (int hasta = maximo; hasta >= valor; hasta--) {
+        int longitud = hasta - valor + 1;
+        int necesarios = huecosHasta[hasta] + (longitud < 3 ? 3 - longitud : 0);
+
+        /* La escalera acaba en una carta natural; un comodín al final es un hueco */
+        if (mejor < cota && ctx->jugadasLibres > 0 && (hasta == valor || tomadas[hasta] >= 0) &&
+            necesarios <= comodines) {
+            int cartas = longitud + (longitud < 3 ? 3 - longitud : 0);
+            int comodinesOpcionales = tomarComodines(ctx, necesarios);
+            ctx->huecos += NUM_VALORES - cartas;
+            ctx->jugadasLibres--;
+
+            int resto = buscar(ctx, &temporal);
+
+            ctx->jugadasLibres++;
+            ctx->huecos -= NUM_VALORES - cartas;
+            devolverComodines(ctx, necesarios, comodinesOpcionales);
+
+            resto += valorCartas(ganancia + comodinesOpcionales) - 1;
+            if (resto > INVIABLE / 2 && resto > mejor) {
+                mejor = resto;
+                mejorEleccion.tipo = ELECCION_ESCALERA;
+                mejorEleccion.hasta = (uint8_t)hasta;
+                mejorEleccion.comodines = (uint8_t)necesarios;
+            }
+        }
+
+        if (hasta > valor && tomadas[hasta] >= 0) {
+            devolverCarta(ctx, indiceReacomodo(palo, hasta), tomadas[hasta]);
+            ganancia -= tomadas[hasta];
+        }
+    }
+
+    devolverCarta(ctx, indice, opcional);
+
+    memcpy(entrada->clave, clave, sizeof(clave));
+    entrada->generacion = ctx->generacion;
+    entrada->valor = mejor;
+    entrada->eleccion = mejorEleccion;
+
+    *eleccion = mejorEleccion;
+    return mejor;
+}
+
+static void anotarDeMano(Reacomodo *resultado, int palo, int valor) {
+    resultado->deMano.conteo[palo][valor - 1]++;
+    resultado->cartasMano++;
+}
+
+/* Aplicar la elección a la carta más baja: quitar sus cartas del estado y
+ * escribir la jugada. Devuelve false si no se puede */
+static bool aplicarEleccion(ContextoReacomodo *ctx, const EleccionReacomodo *eleccion, Reacomodo *resultado) {
+    int indice = __builtin_ctzll(ctx->presentes);
+    int palo = indice % NUM_PALOS;
+    int valor = indice / NUM_PALOS + 1;
+    Carta comodin = {0, 'J', true};
+
+    if (eleccion->tipo == ELECCION_DESCARTAR) {
+        if (ctx->obligatorias[indice] > 0) {
+            return false;   /* Una carta de la mesa no puede volver a la mano */
+        }
+        tomarCarta(ctx, indice);
+        return true;
+    }
+
+    if (resultado->numJugadas >= MAX_JUGADAS_REACOMODO) {
+        return false;
+    }
+    JugadaParticion *jugada = &resultado->jugadas[resultado->numJugadas++];
+    jugada->numCartas = 0;
+    jugada->puntos = 0;
+    jugada->palo = palosParticion[palo];
+    jugada->esGrupo = eleccion->tipo == ELECCION_GRUPO;
+
+    if (jugada->esGrupo) {
+        for (int p = 0; p < NUM_PALOS; p++) {
+            if (!(eleccion->mascara & (1 << p))) {
+                continue;
+            }
+            int otro = indiceReacomodo(p, valor);
+            if (!presente(ctx, otro)) {
+                return false;
+            }
+            if (tomarCarta(ctx, otro)) {
+                anotarDeMano(resultado, p, valor);
+            }
+            Carta carta = {valor, palosParticion[p], false};
+            jugada->cartas[jugada->numCartas++] = carta;
+        }
+        for (int c = 0; c < eleccion->comodines; c++) {
+            jugada->cartas[jugada->numCartas++] = comodin;
+        }
+    } else {
+        for (int v = valor; v <= eleccion->hasta; v++) {
+            int siguiente = indiceReacomodo(palo, v);
+            if (presente(ctx, siguiente)) {
+                if (tomarCarta(ctx, siguiente)) {
+                    anotarDeMano(resultado, palo, v);
+                }
+                Carta carta = {v, palosParticion[palo], false};
+                jugada->cartas[jugada->numCartas++] = carta;
+            } else {
+                jugada->cartas[jugada->numCartas++] = comodin;
+            }
+        }
+    }
+
+    if (eleccion->comodines > ctx->comodinesObligatorios + ctx->comodinesOpcionales) {
+        return false;
+    }
+    int comodinesOpcionales = tomarComodines(ctx, eleccion->comodines);
+    resultado->deMano.comodines += comodinesOpcionales;
+    resultado->cartasMano += comodinesOpcionales;
+
+    for (int i = 0; i < jugada->numCartas; i++) {
+        jugada->puntos += calcularPuntosCarta(jugada->cartas[i]);
+    }
+    while (jugada->numCartas < 3) {
+        agregarComodinJugada(jugada);
+    }
+
+    ctx->huecos += (jugada->esGrupo ? 4 : NUM_VALORES) - jugada->numCartas;
+    ctx->jugadasLibres--;
+    return true;
+}
+
+/* Seguir las elecciones de la tabla desde el estado actual hasta vaciarlo y
+ * repartir los comodines sueltos: primero los de la mesa, que deben caber */
+static bool reconstruir(ContextoReacomodo *ctx, Reacomodo *resultado) {
+    EleccionReacomodo eleccion;
+
+    ctx->presupuesto = ctx->nodos + PRESUPUESTO_RECONSTRUCCION_REACOMODO;
+    ctx->limiteNs = LONG_MAX;
+
+    while (ctx->presentes != 0) {
+        if (buscar(ctx, &eleccion) <= INVIABLE || !aplicarEleccion(ctx, &eleccion, resultado)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < resultado->numJugadas && ctx->comodinesObligatorios > 0; i++) {
+        while (ctx->comodinesObligatorios > 0 && agregarComodinJugada(&resultado->jugadas[i])) {
+            ctx->comodinesObligatorios--;
+        }
+    }
+    if (ctx->comodinesObligatorios > 0) {
+        return false;
+    }
+    for (int i = 0; i < resultado->numJugadas && ctx->comodinesOpcionales > 0; i++) {
+        while (ctx->comodinesOpcionales > 0 && agregarComodinJugada(&resultado->jugadas[i])) {
+            ctx->comodinesOpcionales--;
+            resultado->deMano.comodines++;
+            resultado->cartasMano++;
+        }
+    }
+    return true;
+}
+
+static void iniciarContexto(ContextoReacomodo *ctx, const FirmaMano *mesa, const FirmaMano *mano,
+                            long presupuesto, long limiteNs) {
+    int cartas = mesa->comodines + mano->comodines;
+
+    memset(ctx, 0, sizeof(ContextoReacomodo));
+    for (int i = 0; i < NUM_INDICES_REACOMODO; i++) {
+        int obligatorias = mesa->conteo[i % NUM_PALOS][i / NUM_PALOS];
+        int opcionales = mano->conteo[i % NUM_PALOS][i / NUM_PALOS];
+
+        /* La clave guarda 4 bits por copia */
+        ctx->obligatorias[i] = (uint8_t)(obligatorias > 15 ? 15 : obligatorias);
+        ctx->opcionales[i] = (uint8_t)(opcionales > 15 ? 15 : opcionales);
+        ctx->clave[i / 16] |= (uint64_t)ctx->obligatorias[i] << ((i % 16) * 4);
+        ctx->clave[4 + i / 16] |= (uint64_t)ctx->opcionales[i] << ((i % 16) * 4);
+        ctx->opcionalesRestantes += ctx->opcionales[i];
+        cartas += ctx->obligatorias[i] + ctx->opcionales[i];
+        if (ctx->obligatorias[i] + ctx->opcionales[i] > 0) {
+            ctx->presentes |= 1ULL << i;
+        }
+    }
+    ctx->comodinesObligatorios = mesa->comodines;
+    ctx->comodinesOpcionales = mano->comodines;
+    ctx->jugadasLibres = MAX_JUGADAS_REACOMODO;
+    /* Si ni con jugadas de 3 cartas se llena la mesa, el límite no se usa en
+     * la clave y los estados se comparten entre caminos con distintas jugadas */
+    ctx->limitarJugadas = cartas / 3 > MAX_JUGADAS_REACOMODO;
+    ctx->presupuesto = presupuesto;
+    ctx->limiteNs = limiteNs;
+    ctx->exacto = true;
+}
+
+static void vaciarResultado(Reacomodo *resultado) {
+    resultado->numJugadas = 0;
+    memset(&resultado->deMano, 0, sizeof(FirmaMano));
+    resultado->cartasMano = 0;
+    resultado->encontrado = false;
+}
+
+/* --- Modo paralelo: las alternativas de la carta más baja se reparten --- */
+
+typedef struct {
+    const ContextoReacomodo *base;
+    EleccionReacomodo movimientos[MAX_MOVIMIENTOS_RAIZ];
+    int numMovimientos;
+    int siguiente;              /* Próximo movimiento sin asignar (atómico) */
+    pthread_mutex_t mutex;
+    Reacomodo *mejor;
+    int mejorValor;             /* valorCartas(cartasMano) - numJugadas del mejor */
+    long nodos;                 /* Atómico */
+    bool exacto;                /* Bajo mutex */
+} TrabajoReacomodo;
+
+/* Alternativas de la carta más baja, en el mismo orden que buscar */
+static int enumerarMovimientos(const ContextoReacomodo *ctx, EleccionReacomodo *movimientos) {
+    int indice = __builtin_ctzll(ctx->presentes);
+    int palo = indice % NUM_PALOS;
+    int valor = indice / NUM_PALOS + 1;
+    int comodines = ctx->comodinesObligatorios + ctx->comodinesOpcionales;
+    int numMovimientos = 0;
+
+    if (ctx->obligatorias[indice] == 0) {
+        EleccionReacomodo descartar = {ELECCION_DESCARTAR, 0, 0, 0};
+        movimientos[numMovimientos++] = descartar;
+    }
+
+    int otros = 0;
+    for (int p = palo + 1; p < NUM_PALOS; p++) {
+        if (presente(ctx, indiceReacomodo(p, valor))) {
+            otros |= 1 << p;
+        }
+    }
+    for (int sub = otros; ; sub = (sub - 1) & otros) {
+        int naturales = 1 + __builtin_popcount(sub);
+        int necesarios = naturales < 3 ? 3 - naturales : 0;
+        if (necesarios <= comodines) {
+            EleccionReacomodo grupo = {ELECCION_GRUPO, (uint8_t)(sub | (1 << palo)), 0, (uint8_t)necesarios};
+            movimientos[numMovimientos++] = grupo;
+        }
+        if (sub == 0) {
+            break;
+        }
+    }
+
+    /* Escaleras de la más corta a la más larga, y luego al revés */
+    int primeraEscalera = numMovimientos;
+    int huecosEscalera = 0;
+    for (int hasta = valor; hasta <= NUM_VALORES; hasta++) {
+        if (hasta > valor && !presente(ctx, indiceReacomodo(palo, hasta))) {
+            if (++huecosEscalera > comodines) {
+                break;
+            }
+            continue;
+        }
+        int longitud = hasta - valor + 1;
+        int necesarios = huecosEscalera + (longitud < 3 ? 3 - longitud : 0);
+        if (necesarios <= comodines) {
+            EleccionReacomodo escalera = {ELECCION_ESCALERA, 0, (uint8_t)hasta, (uint8_t)necesarios};
+            movimientos[numMovimientos++] = escalera;
+        }
+    }
+    for (int i = primeraEscalera, j = numMovimientos - 1; i < j; i++, j--) {
+        EleccionReacomodo temporal = movimientos[i];
+        movimientos[i] = movimientos[j];
+        movimientos[j] = temporal;
+    }
+    return numMovimientos;
+}
+
+/* La tabla del hilo que llama, con una generación nueva (vacía para la
+ * búsqueda que empieza), o NULL si no se pudo reservar */
+static EntradaReacomodo* tablaReacomodoHilo(uint32_t *generacion) {
+    if (tablaHilo == NULL) {
+        tablaHilo = calloc(TAMANO_TABLA_REACOMODO, sizeof(EntradaReacomodo));
+        if (tablaHilo == NULL) {
+            return NULL;
+        }
+    }
+    if (++generacionHilo == 0) {
+        memset(tablaHilo, 0, TAMANO_TABLA_REACOMODO * sizeof(EntradaReacomodo));
+        generacionHilo = 1;
+    }
+    *generacion = generacionHilo;
+    return tablaHilo;
+}
+
+void liberarReacomodoHilo(void) {
+    free(tablaHilo);
+    tablaHilo = NULL;
+    generacionHilo = 0;
+}
+
+static void* trabajadorReacomodo(void *arg) {
+    TrabajoReacomodo *trabajo = (TrabajoReacomodo*)arg;
+    uint32_t generacion;
+    EntradaReacomodo *tabla = tablaReacomodoHilo(&generacion);
+    Reacomodo *local = malloc(sizeof(Reacomodo));
+    long nodos = 0;
+    bool exacto = true;
+
+    if (tabla == NULL || local == NULL) {
+        printf("Error: No se pudo asignar memoria para un hilo de reacomodo\n");
+        liberarReacomodoHilo();
+        free(local);
+        return NULL;
+    }
+
+    for (;;) {
+        int k = __atomic_fetch_add(&trabajo->siguiente, 1, __ATOMIC_RELAXED);
+        if (k >= trabajo->numMovimientos) {
+            break;
+        }
+
+        /* La tabla sirve para todos los movimientos: la clave es el estado
+         * entero. El presupuesto de nodos es del hilo, no del movimiento */
+        ContextoReacomodo ctx = *trabajo->base;
+        ctx.tabla = tabla;
+        ctx.generacion = generacion;
+        if (ctx.presupuesto != LONG_MAX) {
+            ctx.presupuesto -= nodos;
+        }
+        vaciarResultado(local);
+
+        if (!aplicarEleccion(&ctx, &trabajo->movimientos[k], local)) {
+            continue;
+        }
+
+        EleccionReacomodo eleccion;
+        int resto = buscar(&ctx, &eleccion);
+        nodos += ctx.nodos;
+        exacto = exacto && ctx.exacto;
+        if (resto <= INVIABLE) {
+            continue;
+        }
+
+        int valor = resto + valorCartas(local->cartasMano) - local->numJugadas;
+        pthread_mutex_lock(&trabajo->mutex);
+        bool mejora = valor > trabajo->mejorValor;
+        pthread_mutex_unlock(&trabajo->mutex);
+
+        if (mejora && reconstruir(&ctx, local)) {
+            valor = valorCartas(local->cartasMano) - local->numJugadas;
+            pthread_mutex_lock(&trabajo->mutex);
+            if (valor > trabajo->mejorValor) {
+                trabajo->mejorValor = valor;
+                local->encontrado = true;
+                memcpy(trabajo->mejor, local, sizeof(Reacomodo));
+            }
+            pthread_mutex_unlock(&trabajo->mutex);
+        }
+    }
+
+    __atomic_add_fetch(&trabajo->nodos, nodos, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&trabajo->mutex);
+    trabajo->exacto = trabajo->exacto && exacto;
+    pthread_mutex_unlock(&trabajo->mutex);
+
+    liberarReacomodoHilo();
+    free(local);
+    return NULL;
+}
+
+static void buscarParalelo(const ContextoReacomodo *base, int numHilos, Reacomodo *resultado) {
+    TrabajoReacomodo trabajo;
+    pthread_t hilos[MAX_HILOS_REACOMODO];
+    int creados = 0;
+
+    trabajo.base = base;
+    trabajo.numMovimientos = enumerarMovimientos(base, trabajo.movimientos);
+    trabajo.siguiente = 0;
+    pthread_mutex_init(&trabajo.mutex, NULL);
+    trabajo.mejor = resultado;
+    trabajo.mejorValor = INVIABLE;
+    trabajo.nodos = 0;
+    trabajo.exacto = true;
+
+    if (numHilos > MAX_HILOS_REACOMODO) {
+        numHilos = MAX_HILOS_REACOMODO;
+    }
+    if (numHilos > trabajo.numMovimientos) {
+        numHilos = trabajo.numMovimientos;
+    }
+    for (int i = 0; i < numHilos; i++) {
+        if (pthread_create(&hilos[creados], NULL, trabajadorReacomodo, &trabajo) == 0) {
+            creados++;
+        }
+    }
+    if (creados == 0) {
+        trabajadorReacomodo(&trabajo);
+    }
+    for (int i = 0; i < creados; i++) {
+        pthread_join(hilos[i], NULL);
+    }
+
+    pthread_mutex_destroy(&trabajo.mutex);
+    resultado->nodos = trabajo.nodos;
+    resultado->exacto = trabajo.exacto;
+}
+
+bool buscarReacomodoFirmas(const FirmaMano *mesa, const FirmaMano *mano, long presupuestoNodos,
+                           int limiteMs, int numHilos, Reacomodo *resultado) {
+    long inicio = ahoraNs();
+    long limiteNs = limiteMs > 0 ? inicio + limiteMs * 1000000L : LONG_MAX;
+    ContextoReacomodo ctx;
+
+    vaciarResultado(resultado);
+    resultado->exacto = true;
+    resultado->nodos = 0;
+    iniciarContexto(&ctx, mesa, mano, presupuestoNodos > 0 ? presupuestoNodos : LONG_MAX, limiteNs);
+
+    if (ctx.presentes == 0) {
+        /* Sin cartas naturales no hay jugadas */
+    } else if (numHilos > 1) {
+        buscarParalelo(&ctx, numHilos, resultado);
+    } else {
+        ctx.tabla = tablaReacomodoHilo(&ctx.generacion);
+        if (ctx.tabla == NULL) {
+            printf("Error: No se pudo asignar memoria para la tabla de reacomodo\n");
+            return false;
+        }
+
+        EleccionReacomodo eleccion;
+        if (buscar(&ctx, &eleccion) > INVIABLE && reconstruir(&ctx, resultado)) {
+            resultado->encontrado = true;
+        } else {
+            vaciarResultado(resultado);
+        }
+        resultado->nodos = ctx.nodos;
+        resultado->exacto = ctx.exacto;
+    }
+
+    long ns = ahoraNs() - inicio;
+    resultado->ms = ns / 1e6;
+
+    __atomic_add_fetch(&busquedas, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&nodosTotales, (unsigned long)resultado->nodos, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tiempoTotalNs, (unsigned long)ns, __ATOMIC_RELAXED);
+    if (!resultado->exacto) {
+        __atomic_add_fetch(&inexactos, 1, __ATOMIC_RELAXED);
+    }
+
+    bool baja = resultado->encontrado && resultado->cartasMano > 0;
+    if (baja) {
+        __atomic_add_fetch(&encontrados, 1, __ATOMIC_RELAXED);
+    }
+    return baja;
+}
+
+/* Sumar a la firma las cartas de una apeada */
+static void sumarApeadaFirma(const Apeada *apeada, FirmaMano *firma) {
+    const Carta *cartas = apeada->esGrupo ? apeada->jugada.grupo.cartas : apeada->jugada.escalera.cartas;
+    int numCartas = apeada->esGrupo ? apeada->jugada.grupo.numCartas : apeada->jugada.escalera.numCartas;
+
+    for (int i = 0; i < numCartas; i++) {
+        if (cartas[i].esComodin) {
+            firma->comodines++;
+            continue;
+        }
+        int palo = indicePaloParticion(cartas[i].palo);
+        if (palo >= 0 && cartas[i].valor >= 1 && cartas[i].valor <= NUM_VALORES) {
+            firma->conteo[palo][cartas[i].valor - 1]++;
+        }
+    }
+}
+
+bool buscarReacomodo(const TablaApeadas *mesa, const Mazo *mano,
+                     int limiteMs, int numHilos, Reacomodo *resultado) {
+    FirmaMano firmaMesa;
+
+    memset(&firmaMesa, 0, sizeof(FirmaMano));
+    for (int i = 0; i < mesa->numApeadas; i++) {
+        sumarApeadaFirma(apeadaEnTabla(mesa, i), &firmaMesa);
+    }
+    return buscarReacomodoFirmas(&firmaMesa, &mano->resumen.firma, PRESUPUESTO_REACOMODO,
+                                 reproducible ? 0 : limiteMs, numHilos, resultado);
+}
+
+void configurarReacomodoReproducible(bool activar) {
+    reproducible = activar;
+}
+
+void imprimirEstadisticasReacomodo(void) {
+    if (busquedas == 0) {
+        return;
+    }
+    printf("\nReacomodos: %lu búsquedas, %lu bajaron cartas, %.1f nodos y %.1f us de media, %lu sin terminar\n",
+           busquedas, encontrados, (double)nodosTotales / busquedas, tiempoTotalNs / 1000.0 / busquedas, inexactos);
+}
+
+/* --- Banco de pruebas --- */
+
+/* Barajas del banco: crecen con MAX_APEADAS hasta las 15 copias por carta
+ * que caben en la clave */
+#define BARAJAS_BANCO_REACOMODO   (MAX_APEADAS / 12 < 4 ? 4 : MAX_APEADAS / 12 > 15 ? 15 : MAX_APEADAS / 12)
+#define CARTAS_MANO_BANCO         14
+#define TIEMPO_BANCO_REACOMODO_MS 500
+#define OCUPACION_BANCO_REACOMODO 75    /* % de MAX_APEADAS: deja sitio a jugadas nuevas */
+
+/* Sacar una carta al azar de la firma (palo -1 = comodín). false si está vacía */
+static bool sacarCartaFirma(FirmaMano *firma, unsigned int *semilla, int *palo, int *valor) {
+    int total = firma->comodines;
+    for (int i = 0; i < NUM_INDICES_REACOMODO; i++) {
+        total += firma->conteo[i % NUM_PALOS][i / NUM_PALOS];
+    }
+    if (total == 0) {
+        return false;
+    }
+
+    int elegida = rand_r(semilla) % total;
+    for (int i = 0; i < NUM_INDICES_REACOMODO; i++) {
+        uint8_t *copias = &firma->conteo[i % NUM_PALOS][i / NUM_PALOS];
+        if (elegida < *copias) {
+            (*copias)--;
+            *palo = i % NUM_PALOS;
+            *valor = i / NUM_PALOS + 1;
+            return true;
+        }
+        elegida -= *copias;
+    }
+    firma->comodines--;
+    *palo = -1;
+    *valor = 0;
+    return true;
+}
+
+/* Llenar la mesa con grupos y escaleras al azar sacados del mazo, hasta
+ * OCUPACION_BANCO_REACOMODO de MAX_APEADAS o hasta que no salgan más */
+static int generarMesaSintetica(FirmaMano *mazo, FirmaMano *mesa, unsigned int *semilla) {
+    int numApeadas = 0;
+
+    for (int intentos = 0; intentos < 40 * MAX_APEADAS && numApeadas < MAX_APEADAS * OCUPACION_BANCO_REACOMODO / 100; intentos++) {
+        if (rand_r(semilla) % 2 == 0) {
+            int valor = rand_r(semilla) % NUM_VALORES + 1;
+            int palos = 0;
+            for (int p = 0; p < NUM_PALOS; p++) {
+                if (mazo->conteo[p][valor - 1] > 0 && rand_r(semilla) % 4 != 0) {
+                    palos |= 1 << p;
+                }
+            }
+            int naturales = __builtin_popcount(palos);
+            int comodines = naturales < 3 ? 3 - naturales : 0;
+            if (naturales == 0 || comodines > 1 || comodines > mazo->comodines) {
+                continue;
+            }
+            for (int p = 0; p < NUM_PALOS; p++) {
+                if (palos & (1 << p)) {
+                    mazo->conteo[p][valor - 1]--;
+                    mesa->conteo[p][valor - 1]++;
+                }
+            }
+            mazo->comodines -= comodines;
+            mesa->comodines += comodines;
+        } else {
+            int palo = rand_r(semilla) % NUM_PALOS;
+            int longitud = 3 + rand_r(semilla) % 5;
+            int inicio = 1 + rand_r(semilla) % (NUM_VALORES - longitud + 1);
+            int comodines = 0;
+            for (int v = inicio; v < inicio + longitud; v++) {
+                if (mazo->conteo[palo][v - 1] == 0) {
+                    comodines++;
+                }
+            }
+            if (comodines > 1 || comodines > mazo->comodines || comodines == longitud) {
+                continue;
+            }
+            for (int v = inicio; v < inicio + longitud; v++) {
+                if (mazo->conteo[palo][v - 1] > 0) {
+                    mazo->conteo[palo][v - 1]--;
+                    mesa->conteo[palo][v - 1]++;
+                }
+            }
+            mazo->comodines -= comodines;
+            mesa->comodines += comodines;
+        }
+        numApeadas++;
+    }
+    return numApeadas;
+}
+
+/* Comprobar que las jugadas son válidas y que usan exactamente la mesa más
+ * las cartas de la mano indicadas */
+static bool verificarReacomodo(const Reacomodo *reacomodo, const FirmaMano *mesa) {
+    FirmaMano usadas;
+    Apeada apeada;
+
+    memset(&usadas, 0, sizeof(FirmaMano));
+    for (int i = 0; i < reacomodo->numJugadas; i++) {
+        const JugadaParticion *jugada = &reacomodo->jugadas[i];
+
+        memset(&apeada, 0, sizeof(Apeada));
+        apeada.esGrupo = jugada->esGrupo;
+        if (jugada->esGrupo) {
+            if (jugada->numCartas > 4) {
+                return false;
+            }
+            memcpy(apeada.jugada.grupo.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+            apeada.jugada.grupo.numCartas = jugada->numCartas;
+        } else {
+            memcpy(apeada.jugada.escalera.cartas, jugada->cartas, jugada->numCartas * sizeof(Carta));
+            apeada.jugada.escalera.numCartas = jugada->numCartas;
+            apeada.jugada.escalera.palo = jugada->palo;
+        }
+        if (!validarApeada(&apeada)) {
+            return false;
+        }
+        sumarApeadaFirma(&apeada, &usadas);
+    }
+
+    if (usadas.comodines != mesa->comodines + reacomodo->deMano.comodines) {
+        return false;
+    }
+    for (int p = 0; p < NUM_PALOS; p++) {
+        for (int v = 0; v < NUM_VALORES; v++) {
+            if (usadas.conteo[p][v] != mesa->conteo[p][v] + reacomodo->deMano.conteo[p][v]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    double ms;
+    double msMaximo;
+    long nodos;
+    int cartas;
+    int exactas;
+    int verificadas;
+} MedicionBanco;
+
+static void medirReacomodo(const FirmaMano *mesa, const FirmaMano *mano, int numHilos,
+                           Reacomodo *reacomodo, MedicionBanco *medicion) {
+    buscarReacomodoFirmas(mesa, mano, 0, TIEMPO_BANCO_REACOMODO_MS, numHilos, reacomodo);
+
+    medicion->ms += reacomodo->ms;
+    if (reacomodo->ms > medicion->msMaximo) {
+        medicion->msMaximo = reacomodo->ms;
+    }
+    medicion->nodos += reacomodo->nodos;
+    medicion->cartas += reacomodo->cartasMano;
+    medicion->exactas += reacomodo->exacto;
+    medicion->verificadas += !reacomodo->encontrado || verificarReacomodo(reacomodo, mesa);
+}
+
+static void imprimirMedicion(const char *nombre, const MedicionBanco *medicion, int numMesas) {
+    printf("  %-12s %8.2f ms de media, máximo %8.2f ms, %10.0f nodos, %.2f cartas bajadas, "
+           "%d/%d exactas, %d/%d verificadas\n",
+           nombre, medicion->ms / numMesas, medicion->msMaximo, (double)medicion->nodos / numMesas,
+           (double)medicion->cartas / numMesas, medicion->exactas, numMesas, medicion->verificadas, numMesas);
+}
+
+bool ejecutarBancoReacomodo(int numMesas, int numHilos) {
+    MedicionBanco secuencial, paralelo;
+    Reacomodo *reacomodo;
+    long apeadasTotales = 0;
+    long cartasMesa = 0;
+    char nombre[32];
+
+    if (numMesas <= 0) {
+        printf("Número de mesas inválido\n");
+        return false;
+    }
+    if (numHilos < 2) {
+        numHilos = 2;
+    }
+
+    reacomodo = (Reacomodo*)malloc(sizeof(Reacomodo));
+    if (reacomodo == NULL) {
+        printf("Error: No se pudo asignar memoria para el banco de reacomodo\n");
+        return false;
+    }
+    memset(&secuencial, 0, sizeof(secuencial));
+    memset(&paralelo, 0, sizeof(paralelo));
+
+    printf("Banco de reacomodo: %d mesas de %d barajas con sitio para %d apeadas, manos de %d cartas, "
+           "límite %d ms\n", numMesas, BARAJAS_BANCO_REACOMODO, MAX_APEADAS, CARTAS_MANO_BANCO,
+           TIEMPO_BANCO_REACOMODO_MS);
+
+    for (int m = 0; m < numMesas; m++) {
+        unsigned int semilla = 1000 + m;
+        FirmaMano mazo, mesa, mano;
+
+        memset(&mazo, 0, sizeof(FirmaMano));
+        memset(&mesa, 0, sizeof(FirmaMano));
+        memset(&mano, 0, sizeof(FirmaMano));
+        for (int p = 0; p < NUM_PALOS; p++) {
+            for (int v = 0; v < NUM_VALORES; v++) {
+                mazo.conteo[p][v] = BARAJAS_BANCO_REACOMODO;
+            }
+        }
+        mazo.comodines = 2 * BARAJAS_BANCO_REACOMODO;
+
+        apeadasTotales += generarMesaSintetica(&mazo, &mesa, &semilla);
+        for (int c = 0; c < CARTAS_MANO_BANCO; c++) {
+            int palo, valor;
+            if (!sacarCartaFirma(&mazo, &semilla, &palo, &valor)) {
+                break;
+            }
+            if (palo < 0) {
+                mano.comodines++;
+            } else {
+                mano.conteo[palo][valor - 1]++;
+            }
+        }
+        cartasMesa += mesa.comodines;
+        for (int p = 0; p < NUM_PALOS; p++) {
+            for (int v = 0; v < NUM_VALORES; v++) {
+                cartasMesa += mesa.conteo[p][v];
+            }
+        }
+
+        medirReacomodo(&mesa, &mano, 1, reacomodo, &secuencial);
+        medirReacomodo(&mesa, &mano, numHilos, reacomodo, &paralelo);
+    }
+
+    printf("Mesas de %.1f apeadas y %.1f cartas de media\n",
+           (double)apeadasTotales / numMesas, (double)cartasMesa / numMesas);
+    imprimirMedicion("1 hilo", &secuencial, numMesas);
+    snprintf(nombre, sizeof(nombre), "%d hilos", numHilos);
+    imprimirMedicion(nombre, &paralelo, numMesas);
+
+    free(reacomodo);
+    liberarReacomodoHilo();
+    return true;
+}
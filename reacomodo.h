@@ -0,0 +1,69 @@
+#ifndef REACOMODO_H
+#define REACOMODO_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "mesa.h"
+#include "particion.h"
+
+/* Reacomodo de la mesa: volver a partir todas las cartas de la mesa, junto
+ * con algunas de la mano, en apeadas válidas nuevas (partir escaleras, unir
+ * grupos, mover cartas de una apeada a otra), maximizando las cartas de la
+ * mano que se bajan y, a igualdad, con menos apeadas. La mesa nueva no puede
+ * pasar de MAX_JUGADAS_REACOMODO apeadas.
+ *
+ * La mesa y la mano se reducen a dos firmas: las cartas de la mesa son
+ * obligatorias y las de la mano opcionales. La búsqueda es la de particion.c
+ * (la carta más baja abre un grupo o una escalera, memoización sobre el
+ * estado empaquetado) con dos cambios: una carta obligatoria no puede
+ * quedarse fuera, y cada jugada consume primero las copias obligatorias, que
+ * son intercambiables con las opcionales. Las cartas presentes se siguen con
+ * una máscara de bits para encontrar la más baja con una instrucción.
+ *
+ * La búsqueda se acota por nodos y por tiempo; si se agota, solo se usa lo
+ * que ya se demostró válido. En modo paralelo, las alternativas de la
+ * primera carta se reparten entre hilos, cada uno con su propia tabla */
+
+#define MAX_JUGADAS_REACOMODO     MAX_APEADAS
+#define PRESUPUESTO_REACOMODO     20000    /* Nodos por hilo */
+#define TIEMPO_REACOMODO_MS       2        /* Límite en un turno de la partida */
+#define MAX_HILOS_REACOMODO       16
+
+typedef struct {
+    JugadaParticion jugadas[MAX_JUGADAS_REACOMODO];
+    int numJugadas;
+    FirmaMano deMano;       /* Cartas de la mano que pasan a la mesa */
+    int cartasMano;         /* Cuántas son */
+    bool encontrado;        /* Hay una partición válida de toda la mesa */
+    bool exacto;            /* La búsqueda terminó sin agotar el presupuesto */
+    long nodos;
+    double ms;
+} Reacomodo;
+
+/* Buscar el reacomodo de la mesa con la mano. numHilos <= 1 busca en el hilo
+ * que llama. Devuelve true si encontró uno que baja al menos una carta */
+bool buscarReacomodo(const TablaApeadas *mesa, const Mazo *mano,
+                     int limiteMs, int numHilos, Reacomodo *resultado);
+
+/* Acotar buscarReacomodo solo por nodos, sin límite de tiempo, para que
+ * dos ejecuciones con la misma semilla tomen las mismas decisiones (las
+ * trazas de hashes del torneo) */
+void configurarReacomodoReproducible(bool activar);
+
+/* Igual, con la mesa y la mano ya reducidas a firmas y un presupuesto de
+ * nodos por hilo (0 = sin límite, como limiteMs) */
+bool buscarReacomodoFirmas(const FirmaMano *mesa, const FirmaMano *mano, long presupuestoNodos,
+                           int limiteMs, int numHilos, Reacomodo *resultado);
+
+/* Banco de pruebas: mesas sintéticas de varias barajas, llenas en sus tres
+ * cuartas partes (compilar con -DMAX_APEADAS=N para mesas más grandes),
+ * resueltas en un hilo y con numHilos */
+bool ejecutarBancoReacomodo(int numMesas, int numHilos);
+
+/* Liberar la tabla de memoización del hilo (al terminar el hilo) */
+void liberarReacomodoHilo(void);
+
+/* Búsquedas, reacomodos encontrados, nodos y tiempo */
+void imprimirEstadisticasReacomodo(void);
+
+#endif /* REACOMODO_H */
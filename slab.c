@@ -0,0 +1,607 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "slab.h"
+#include "candados.h"
+#include "utilidades.h"
+
+#define PROCESOS_BANCO_SLAB 8
+
+typedef enum {
+    SLAB_VACIO,
+    SLAB_PARCIAL,
+    SLAB_LLENO,
+    NUM_LISTAS_SLAB
+} ListaSlab;
+
+typedef struct {
+    int direccion;      /* En la memoria simulada; -1 si el hueco está sin slab */
+    int clase;
+    int numObjetos;
+    int usados;
+    unsigned libres;    /* Bit k: el objeto k está libre */
+    ListaSlab lista;
+    int anterior;
+    int siguiente;
+} Slab;
+
+/* Objetos libres de cada clase guardados por un hilo (se identifican por
+ * slab * MAX_OBJETOS_SLAB + posición; -1 si la posición está vacía). Solo el
+ * hilo dueño los llena; los saca él o, con mutexSlab, quien se quedó sin
+ * memoria para un slab, así que cada posición se vacía con un intercambio
+ * atómico y el objeto es de quien lo obtuvo */
+typedef struct {
+    int objetos[NUM_CLASES_SLAB][TAMANO_MAGAZINE];
+} Magazine;
+
+static pthread_mutex_t mutexSlab = PTHREAD_MUTEX_INITIALIZER;
+static Slab slabs[MAX_SLABS];
+static int listas[NUM_CLASES_SLAB][NUM_LISTAS_SLAB];
+
+/* Dueño de cada objeto y objetos de cada proceso (lista enlazada) */
+static int procesoObjeto[MAX_SLABS * MAX_OBJETOS_SLAB];
+static int siguienteObjeto[MAX_SLABS * MAX_OBJETOS_SLAB];
+static int objetosProceso[MAX_PROCESOS_MEMORIA];
+static bool directaProceso[MAX_PROCESOS_MEMORIA];   /* Tiene memoria pedida al algoritmo */
+
+/* Los magazines están fuera de los hilos para poder vaciarlos desde otro;
+ * cada hilo ocupa uno la primera vez que libera un objeto */
+static Magazine magazines[MAX_HILOS_MAGAZINE];
+static bool magazineOcupado[MAX_HILOS_MAGAZINE];
+static __thread int magazineHilo = -1;     /* -2: no quedó ninguno libre */
+
+static bool slabActivo = true;
+
+/* Estadísticas (atómicas: las actualizan los hilos de los jugadores) */
+static unsigned long peticiones = 0;
+static unsigned long aciertosMagazine = 0;
+static unsigned long aciertosSlab = 0;
+static unsigned long slabsCreados = 0;
+static unsigned long slabsDevueltos = 0;
+static unsigned long peticionesDirectas = 0;
+static unsigned long recuperadosMagazine = 0;
+
+void configurarSlabES(bool activo) {
+    slabActivo = activo;
+}
+
+bool slabESActivo(void) {
+    return slabActivo;
+}
+
+static int tamanoClase(int clase) {
+    return TAMANO_MINIMO_CLASE_SLAB + clase * PASO_CLASE_SLAB;
+}
+
+/* Clase más pequeña que contiene la cantidad, o -1 si no hay */
+static int claseSlab(int cantidad) {
+    if (cantidad <= 0) {
+        return -1;
+    }
+    int clase = cantidad <= TAMANO_MINIMO_CLASE_SLAB ? 0 :
+                (cantidad - TAMANO_MINIMO_CLASE_SLAB + PASO_CLASE_SLAB - 1) / PASO_CLASE_SLAB;
+    return clase < NUM_CLASES_SLAB ? clase : -1;
+}
+
+static int claseObjeto(int objeto) {
+    return slabs[objeto / MAX_OBJETOS_SLAB].clase;
+}
+
+static int direccionObjeto(int objeto) {
+    return slabs[objeto / MAX_OBJETOS_SLAB].direccion + (objeto % MAX_OBJETOS_SLAB) * tamanoClase(claseObjeto(objeto));
+}
+
+/* Listas de slabs de cada clase (con mutexSlab) */
+
+static void desenlazarSlab(int s) {
+    Slab *slab = &slabs[s];
+    if (slab->anterior != -1) {
+        slabs[slab->anterior].siguiente = slab->siguiente;
+    } else {
+        listas[slab->clase][slab->lista] = slab->siguiente;
+    }
+    if (slab->siguiente != -1) {
+        slabs[slab->siguiente].anterior = slab->anterior;
+    }
+}
+
+static void enlazarSlab(int s, ListaSlab lista) {
+    Slab *slab = &slabs[s];
+    slab->lista = lista;
+    slab->anterior = -1;
+    slab->siguiente = listas[slab->clase][lista];
+    if (slab->siguiente != -1) {
+        slabs[slab->siguiente].anterior = s;
+    }
+    listas[slab->clase][lista] = s;
+}
+
+static void moverSlab(int s, ListaSlab lista) {
+    if (slabs[s].lista != lista) {
+        desenlazarSlab(s);
+        enlazarSlab(s, lista);
+    }
+}
+
+static bool crearSlab(int clase) {
+    int s = 0;
+    while (s < MAX_SLABS && slabs[s].direccion != -1) {
+        s++;
+    }
+    if (s == MAX_SLABS) {
+        return false;
+    }
+
+    int direccion = reservarBloqueMemoria(PRIMER_PROCESO_SLAB + s, TAMANO_SLAB);
+    if (direccion < 0) {
+        return false;
+    }
+
+    Slab *slab = &slabs[s];
+    slab->direccion = direccion;
+    slab->clase = clase;
+    slab->numObjetos = TAMANO_SLAB / tamanoClase(clase);
+    slab->usados = 0;
+    slab->libres = (1u << slab->numObjetos) - 1;
+    enlazarSlab(s, SLAB_VACIO);
+    __atomic_add_fetch(&slabsCreados, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void destruirSlab(int s) {
+    desenlazarSlab(s);
+    devolverMemoriaProceso(PRIMER_PROCESO_SLAB + s);
+    slabs[s].direccion = -1;
+    __atomic_add_fetch(&slabsDevueltos, 1, __ATOMIC_RELAXED);
+}
+
+/* Devolver al algoritmo los slabs vacíos de todas las clases */
+static void reclamarSlabsVacios(void) {
+    for (int c = 0; c < NUM_CLASES_SLAB; c++) {
+        while (listas[c][SLAB_VACIO] != -1) {
+            destruirSlab(listas[c][SLAB_VACIO]);
+        }
+    }
+}
+
+/* Un objeto de un slab parcial, de uno vacío o de uno nuevo; -1 si no queda
+ * memoria ni devolviendo los slabs vacíos */
+static int tomarObjetoSlab(int clase) {
+    int s = listas[clase][SLAB_PARCIAL];
+    if (s == -1) {
+        s = listas[clase][SLAB_VACIO];
+    }
+    if (s != -1) {
+        __atomic_add_fetch(&aciertosSlab, 1, __ATOMIC_RELAXED);
+    } else {
+        if (!crearSlab(clase)) {
+            reclamarSlabsVacios();
+            if (!crearSlab(clase)) {
+                return -1;
+            }
+        }
+        s = listas[clase][SLAB_VACIO];
+    }
+
+    Slab *slab = &slabs[s];
+    int posicion = __builtin_ctz(slab->libres);
+    slab->libres &= ~(1u << posicion);
+    slab->usados++;
+    moverSlab(s, slab->usados == slab->numObjetos ? SLAB_LLENO : SLAB_PARCIAL);
+    return s * MAX_OBJETOS_SLAB + posicion;
+}
+
+static void devolverObjetoSlab(int objeto) {
+    int s = objeto / MAX_OBJETOS_SLAB;
+    Slab *slab = &slabs[s];
+
+    slab->libres |= 1u << (objeto % MAX_OBJETOS_SLAB);
+    slab->usados--;
+    if (slab->usados > 0) {
+        moverSlab(s, SLAB_PARCIAL);
+    } else {
+        destruirSlab(s);    /* Sin reserva: ocho slabs llenan la memoria */
+    }
+}
+
+/* Devolver a sus slabs los objetos de un magazine (con mutexSlab);
+ * devuelve cuántos había */
+static int devolverMagazine(int m) {
+    int devueltos = 0;
+    for (int c = 0; c < NUM_CLASES_SLAB; c++) {
+        for (int i = 0; i < TAMANO_MAGAZINE; i++) {
+            int objeto = __atomic_exchange_n(&magazines[m].objetos[c][i], -1, __ATOMIC_ACQ_REL);
+            if (objeto >= 0) {
+                devolverObjetoSlab(objeto);
+                devueltos++;
+            }
+        }
+    }
+    return devueltos;
+}
+
+/* Los objetos de los magazines de todos los hilos retienen sus slabs: con
+ * la memoria llena se devuelven todos (con mutexSlab) */
+static void devolverTodosMagazines(void) {
+    for (int m = 0; m < MAX_HILOS_MAGAZINE; m++) {
+        if (magazineOcupado[m]) {
+            int devueltos = devolverMagazine(m);
+            if (m != magazineHilo) {
+                __atomic_add_fetch(&recuperadosMagazine, devueltos, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+/* Objeto de la clase: primero del magazine del hilo, sin candado */
+static int obtenerObjeto(int clase) {
+    __atomic_add_fetch(&peticiones, 1, __ATOMIC_RELAXED);
+    if (magazineHilo >= 0) {
+        int *objetos = magazines[magazineHilo].objetos[clase];
+        for (int i = TAMANO_MAGAZINE - 1; i >= 0; i--) {
+            if (__atomic_load_n(&objetos[i], __ATOMIC_RELAXED) >= 0) {
+                int objeto = __atomic_exchange_n(&objetos[i], -1, __ATOMIC_ACQ_REL);
+                if (objeto >= 0) {
+                    __atomic_add_fetch(&aciertosMagazine, 1, __ATOMIC_RELAXED);
+                    return objeto;
+                }
+            }
+        }
+    }
+
+    BLOQUEAR(&mutexSlab);
+    int objeto = tomarObjetoSlab(clase);
+    if (objeto < 0) {
+        /* Lo que guardan los magazines puede dejar slabs vacíos */
+        devolverTodosMagazines();
+        reclamarSlabsVacios();
+        objeto = tomarObjetoSlab(clase);
+    }
+    DESBLOQUEAR(&mutexSlab);
+    return objeto;
+}
+
+/* Ocupar un magazine libre para el hilo (con mutexSlab) */
+static void ocuparMagazine(void) {
+    magazineHilo = -2;
+    for (int m = 0; m < MAX_HILOS_MAGAZINE; m++) {
+        if (!magazineOcupado[m]) {
+            memset(magazines[m].objetos, -1, sizeof(magazines[m].objetos));
+            magazineOcupado[m] = true;
+            magazineHilo = m;
+            return;
+        }
+    }
+}
+
+static void soltarObjeto(int objeto) {
+    if (magazineHilo >= 0) {
+        /* Solo este hilo llena las posiciones: una vacía sigue vacía */
+        int *objetos = magazines[magazineHilo].objetos[claseObjeto(objeto)];
+        for (int i = 0; i < TAMANO_MAGAZINE; i++) {
+            if (__atomic_load_n(&objetos[i], __ATOMIC_RELAXED) < 0) {
+                __atomic_store_n(&objetos[i], objeto, __ATOMIC_RELEASE);
+                return;
+            }
+        }
+    }
+
+    BLOQUEAR(&mutexSlab);
+    devolverObjetoSlab(objeto);
+    if (magazineHilo == -1) {
+        ocuparMagazine();
+    }
+    DESBLOQUEAR(&mutexSlab);
+}
+
+void vaciarMagazinesHilo(void) {
+    BLOQUEAR(&mutexSlab);
+    if (magazineHilo >= 0) {
+        devolverMagazine(magazineHilo);
+        magazineOcupado[magazineHilo] = false;
+    }
+    magazineHilo = -1;
+    DESBLOQUEAR(&mutexSlab);
+}
+
+void reiniciarSlabs(void) {
+    REGISTRAR_CANDADOS(&mutexSlab, 1, "mutexSlab");
+    BLOQUEAR(&mutexSlab);
+    for (int s = 0; s < MAX_SLABS; s++) {
+        slabs[s].direccion = -1;
+    }
+    for (int c = 0; c < NUM_CLASES_SLAB; c++) {
+        for (int l = 0; l < NUM_LISTAS_SLAB; l++) {
+            listas[c][l] = -1;
+        }
+    }
+    for (int m = 0; m < MAX_HILOS_MAGAZINE; m++) {
+        memset(magazines[m].objetos, -1, sizeof(magazines[m].objetos));
+        magazineOcupado[m] = false;
+    }
+    magazineHilo = -1;
+    for (int o = 0; o < MAX_SLABS * MAX_OBJETOS_SLAB; o++) {
+        procesoObjeto[o] = -1;
+    }
+    for (int p = 0; p < MAX_PROCESOS_MEMORIA; p++) {
+        objetosProceso[p] = -1;
+        directaProceso[p] = false;
+    }
+    DESBLOQUEAR(&mutexSlab);
+}
+
+static bool procesoConSlabs(int idProceso) {
+    return slabActivo && idProceso >= 0 && idProceso < PRIMER_PROCESO_SLAB;
+}
+
+static void agregarObjetoProceso(int idProceso, int objeto) {
+    procesoObjeto[objeto] = idProceso;
+    siguienteObjeto[objeto] = objetosProceso[idProceso];
+    objetosProceso[idProceso] = objeto;
+}
+
+static void quitarObjetoProceso(int idProceso, int objeto) {
+    int *enlace = &objetosProceso[idProceso];
+    while (*enlace != -1 && *enlace != objeto) {
+        enlace = &siguienteObjeto[*enlace];
+    }
+    if (*enlace == objeto) {
+        *enlace = siguienteObjeto[objeto];
+    }
+    procesoObjeto[objeto] = -1;
+}
+
+/* Memoria pedida directamente al algoritmo (con sus mensajes), después de
+ * devolverle los slabs que retienen los magazines */
+static bool asignarDirecta(int idProceso, int cantidad) {
+    __atomic_add_fetch(&peticionesDirectas, 1, __ATOMIC_RELAXED);
+    devolverSlabsVacios();
+    if (!asignarMemoria(idProceso, cantidad)) {
+        return false;
+    }
+    if (idProceso >= 0 && idProceso < MAX_PROCESOS_MEMORIA) {
+        directaProceso[idProceso] = true;
+    }
+    return true;
+}
+
+bool asignarObjetoSlab(int idProceso, int cantidad) {
+    int clase = claseSlab(cantidad);
+
+    if (!procesoConSlabs(idProceso) || clase < 0) {
+        return false;
+    }
+
+    int objeto = obtenerObjeto(clase);
+    if (objeto < 0) {
+        return false;
+    }
+    agregarObjetoProceso(idProceso, objeto);
+    return true;
+}
+
+bool asignarMemoriaSlab(int idProceso, int cantidad) {
+    if (!asignarObjetoSlab(idProceso, cantidad)) {
+        return asignarDirecta(idProceso, cantidad);
+    }
+
+    int objeto = objetosProceso[idProceso];
+    imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Memoria asignada: Proceso %d, %d bytes, dirección %d (slab de %d bytes)\n",
+                          idProceso, cantidad, direccionObjeto(objeto), tamanoClase(claseObjeto(objeto)));
+    return true;
+}
+
+bool crecerMemoriaSlab(int idProceso, int cantidadAdicional) {
+    int objeto = procesoConSlabs(idProceso) ? objetosProceso[idProceso] : -1;
+
+    if (objeto < 0) {
+        return crecerProceso(idProceso, cantidadAdicional);
+    }
+
+    /* Como un realloc: el contenido pasa a un objeto de la clase mayor */
+    int nuevaClase = claseSlab(tamanoClase(claseObjeto(objeto)) + cantidadAdicional);
+    if (nuevaClase >= 0) {
+        int nuevo = obtenerObjeto(nuevaClase);
+        if (nuevo >= 0) {
+            quitarObjetoProceso(idProceso, objeto);
+            soltarObjeto(objeto);
+            agregarObjetoProceso(idProceso, nuevo);
+            imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Proceso %d creció en %d bytes (slab de %d bytes, dirección %d)\n",
+                                  idProceso, cantidadAdicional, tamanoClase(nuevaClase), direccionObjeto(nuevo));
+            return true;
+        }
+    }
+
+    /* Lo que no cabe en ninguna clase se pide al algoritmo */
+    if (asignarDirecta(idProceso, cantidadAdicional)) {
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_VERDE, "Proceso %d creció en %d bytes (fuera de los slabs)\n",
+                              idProceso, cantidadAdicional);
+        return true;
+    }
+    imprimirRegistroColor(REGISTRO_SILENCIO, COLOR_ROJO, "Error: No se pudo hacer crecer el proceso %d\n", idProceso);
+    return false;
+}
+
+/* Soltar los objetos del proceso; devuelve sus bytes */
+static int soltarObjetosProceso(int idProceso) {
+    int bytesLiberados = 0;
+    int objeto = objetosProceso[idProceso];
+    while (objeto != -1) {
+        int siguiente = siguienteObjeto[objeto];
+        bytesLiberados += tamanoClase(claseObjeto(objeto));
+        procesoObjeto[objeto] = -1;
+        soltarObjeto(objeto);
+        objeto = siguiente;
+    }
+    objetosProceso[idProceso] = -1;
+    return bytesLiberados;
+}
+
+void liberarMemoriaES(int idProceso) {
+    if (idProceso < 0 || idProceso >= PRIMER_PROCESO_SLAB) {
+        liberarMemoria(idProceso);
+        return;
+    }
+
+    int bytesLiberados = soltarObjetosProceso(idProceso);
+    if (bytesLiberados > 0) {
+        imprimirRegistroColor(REGISTRO_DETALLE, COLOR_AMARILLO, "Memoria liberada (slab): Proceso %d, %d bytes\n",
+                              idProceso, bytesLiberados);
+    }
+
+    /* liberarMemoria libera también las páginas; sin memoria directa basta con eso */
+    if (directaProceso[idProceso] || bytesLiberados == 0) {
+        directaProceso[idProceso] = false;
+        liberarMemoria(idProceso);
+    } else {
+        liberarPaginasProceso(idProceso);
+    }
+}
+
+void devolverMemoriaSlab(int idProceso) {
+    if (idProceso >= 0 && idProceso < PRIMER_PROCESO_SLAB) {
+        soltarObjetosProceso(idProceso);
+        if (!directaProceso[idProceso]) {
+            return;
+        }
+        directaProceso[idProceso] = false;
+    }
+    devolverMemoriaProceso(idProceso);
+}
+
+void devolverSlabsVacios(void) {
+    BLOQUEAR(&mutexSlab);
+    devolverTodosMagazines();
+    reclamarSlabsVacios();
+    DESBLOQUEAR(&mutexSlab);
+}
+
+void imprimirEstadisticasSlab(void) {
+    unsigned long total = __atomic_load_n(&peticiones, __ATOMIC_RELAXED);
+    unsigned long magazine = __atomic_load_n(&aciertosMagazine, __ATOMIC_RELAXED);
+    unsigned long slab = __atomic_load_n(&aciertosSlab, __ATOMIC_RELAXED);
+
+    if (total == 0) {
+        return;
+    }
+    printf("\nSlabs de E/S: %lu peticiones, %.1f%% sin pedir memoria al algoritmo (%lu del magazine, %lu de un slab)\n",
+           total, 100.0 * (magazine + slab) / total, magazine, slab);
+    printf("Slabs pedidos: %lu, devueltos: %lu; peticiones directas al algoritmo: %lu; "
+           "objetos recuperados de magazines de otros hilos: %lu\n",
+           __atomic_load_n(&slabsCreados, __ATOMIC_RELAXED), __atomic_load_n(&slabsDevueltos, __ATOMIC_RELAXED),
+           __atomic_load_n(&peticionesDirectas, __ATOMIC_RELAXED),
+           __atomic_load_n(&recuperadosMagazine, __ATOMIC_RELAXED));
+}
+
+/* Banco de pruebas */
+
+static unsigned long long aleatorioBancoSlab(unsigned long long *estado) {
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return *estado * 0x2545F4914F6CDD1DULL;
+}
+
+static double segundosDesde(const struct timespec *inicio) {
+    struct timespec fin;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - inicio->tv_sec) + (fin.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/* Una pasada con peticiones como las de asignarMemoriaES: cada operación
+ * elige un proceso y libera su búfer o pide uno de 16 + 4k bytes. Devuelve
+ * los segundos; al final la memoria debe haber vuelto entera */
+static double pasadaBancoSlab(int algoritmo, int numOperaciones, bool conSlabs, long *fallos, bool *correcto) {
+    int objeto[PROCESOS_BANCO_SLAB];
+    bool tieneMemoria[PROCESOS_BANCO_SLAB] = {false};
+    unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+    struct timespec inicio;
+
+    reiniciarMemoria(algoritmo);
+    reiniciarSlabs();
+    *fallos = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int i = 0; i < numOperaciones; i++) {
+        unsigned long long x = aleatorioBancoSlab(&estado);
+        int proceso = (int)(x % PROCESOS_BANCO_SLAB);
+
+        if (tieneMemoria[proceso]) {
+            if (conSlabs) {
+                soltarObjeto(objeto[proceso]);
+            } else {
+                devolverMemoriaProceso(proceso);
+            }
+            tieneMemoria[proceso] = false;
+        } else {
+            int cantidad = 16 + 4 * (5 + (int)((x >> 32) % 8));
+            if (conSlabs) {
+                objeto[proceso] = obtenerObjeto(claseSlab(cantidad));
+                tieneMemoria[proceso] = objeto[proceso] >= 0;
+            } else {
+                tieneMemoria[proceso] = reservarBloqueMemoria(proceso, cantidad) >= 0;
+            }
+            if (!tieneMemoria[proceso]) {
+                (*fallos)++;
+            }
+        }
+    }
+    double segundos = segundosDesde(&inicio);
+
+    for (int p = 0; p < PROCESOS_BANCO_SLAB; p++) {
+        if (tieneMemoria[p]) {
+            if (conSlabs) {
+                soltarObjeto(objeto[p]);
+            } else {
+                devolverMemoriaProceso(p);
+            }
+        }
+    }
+    vaciarMagazinesHilo();
+    BLOQUEAR(&mutexSlab);
+    reclamarSlabsVacios();
+    DESBLOQUEAR(&mutexSlab);
+
+    if (gestorMemoria.memoriaDisponible != MEM_TOTAL_SIZE) {
+        printf("Error: quedaron %d bytes sin devolver (%s)\n", MEM_TOTAL_SIZE - gestorMemoria.memoriaDisponible,
+               conSlabs ? "slabs" : "directa");
+        *correcto = false;
+    }
+    return segundos;
+}
+
+bool ejecutarBancoSlab(int numOperaciones) {
+    static const int algoritmos[] = {ALG_AJUSTE_OPTIMO, ALG_MAPA_BITS, ALG_BUDDY};
+    static const char *nombres[] = {"Ajuste Óptimo", "Mapa de Bits", "Compañeros"};
+    GestorMemoria guardado = gestorMemoria;
+    bool correcto = true;
+
+    if (numOperaciones <= 0) {
+        printf("Número de operaciones inválido\n");
+        return false;
+    }
+
+    printf("Banco de los slabs de E/S: %d operaciones, %d procesos, peticiones de %d a %d bytes\n",
+           numOperaciones, PROCESOS_BANCO_SLAB, tamanoClase(0), tamanoClase(NUM_CLASES_SLAB - 1));
+
+    for (int a = 0; a < (int)(sizeof(algoritmos) / sizeof(algoritmos[0])); a++) {
+        long fallosDirecta, fallosSlab;
+        double directa = pasadaBancoSlab(algoritmos[a], numOperaciones, false, &fallosDirecta, &correcto);
+
+        unsigned long peticionesAntes = peticiones, magazineAntes = aciertosMagazine, slabAntes = aciertosSlab;
+        double conSlabs = pasadaBancoSlab(algoritmos[a], numOperaciones, true, &fallosSlab, &correcto);
+        unsigned long pedidas = peticiones - peticionesAntes;
+        unsigned long aciertos = (aciertosMagazine - magazineAntes) + (aciertosSlab - slabAntes);
+
+        printf("  %-14s directa: %6.1f ns/op (%ld fallos)   slabs: %6.1f ns/op (%ld fallos, %.1f%% aciertos)   %.1fx\n",
+               nombres[a], directa * 1e9 / numOperaciones, fallosDirecta,
+               conSlabs * 1e9 / numOperaciones, fallosSlab,
+               pedidas > 0 ? 100.0 * aciertos / pedidas : 0.0,
+               conSlabs > 0 ? directa / conSlabs : 0.0);
+    }
+
+    gestorMemoria = guardado;
+    reiniciarSlabs();
+    return correcto;
+}
@@ -0,0 +1,81 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stdbool.h>
+#include "memoria.h"
+
+/* Slabs para los búferes de E/S.
+ *
+ * asignarMemoriaES pide siempre 16 + 4k bytes con k entre 5 y 12: ocho
+ * tamaños. Cada uno es una clase, y cada clase reparte objetos de su tamaño
+ * exacto desde slabs de TAMANO_SLAB bytes que se piden al algoritmo de
+ * memoria actual (cada slab como un proceso más, PRIMER_PROCESO_SLAB + i).
+ * Los slabs de una clase están en tres listas (vacíos, parciales y llenos),
+ * así que tomar o devolver un objeto es O(1) y no parte ni fusiona nada.
+ *
+ * Encima, cada hilo guarda en un magazine por clase los últimos objetos que
+ * liberó y los reutiliza sin tomar mutexSlab. La memoria es de 1 KB (ocho
+ * slabs), así que un slab que se queda vacío vuelve enseguida al algoritmo,
+ * y un objeto en un magazine retiene su slab entero: si falta memoria para
+ * un slab nuevo, o antes de pedir memoria directa al algoritmo, se vacían
+ * los magazines de todos los hilos y se devuelven los slabs que quedan
+ * vacíos.
+ *
+ * La lista de objetos de cada proceso solo la toca su hilo (el del jugador),
+ * salvo al terminar la partida, cuando ya no queda ningún jugador en E/S */
+
+#define TAMANO_SLAB              128
+#define MAX_SLABS                (MEM_TOTAL_SIZE / TAMANO_SLAB)
+#define PRIMER_PROCESO_SLAB      48      /* Procesos de memoria de los slabs */
+#define TAMANO_MINIMO_CLASE_SLAB 36
+#define PASO_CLASE_SLAB          4
+#define NUM_CLASES_SLAB          8       /* 36, 40, ..., 64 bytes */
+#define MAX_OBJETOS_SLAB         (TAMANO_SLAB / TAMANO_MINIMO_CLASE_SLAB)
+#define TAMANO_MAGAZINE          2
+#define MAX_HILOS_MAGAZINE       16      /* Hilos con magazine; el resto va directo a los slabs */
+
+/* Usar los slabs para la E/S (por defecto sí; --sin-slab para ir directo
+ * al algoritmo) */
+void configurarSlabES(bool activo);
+bool slabESActivo(void);
+
+/* Vaciar los slabs y los magazines del hilo que llama. Lo llama
+ * inicializarMemoria, antes de que arranquen los jugadores */
+void reiniciarSlabs(void);
+
+/* Memoria de E/S de un proceso: de su clase si la tiene y, si no (o si no
+ * queda memoria para un slab), directamente del algoritmo actual */
+bool asignarMemoriaSlab(int idProceso, int cantidad);
+
+/* Solo el objeto de la clase, sin mensajes: false si no hay clase o no queda
+ * memoria para un slab, sin pedirla al algoritmo (para los bancos de pruebas) */
+bool asignarObjetoSlab(int idProceso, int cantidad);
+
+/* Crecer: pasar a un objeto de una clase mayor o, si no hay clase para el
+ * nuevo tamaño, pedir lo adicional al algoritmo */
+bool crecerMemoriaSlab(int idProceso, int cantidadAdicional);
+
+/* Liberar toda la memoria de E/S del proceso (objetos y memoria directa) y
+ * sus páginas, como liberarMemoria */
+void liberarMemoriaES(int idProceso);
+
+/* Solo la memoria de E/S del proceso, sin sus páginas ni mensajes (para
+ * los bancos de pruebas) */
+void devolverMemoriaSlab(int idProceso);
+
+/* Devolver a sus slabs los objetos del magazine del hilo y dejarlo libre
+ * para otro (al terminar) */
+void vaciarMagazinesHilo(void);
+
+/* Vaciar los magazines de todos los hilos y devolver al algoritmo los slabs
+ * que queden vacíos (también al terminar la partida) */
+void devolverSlabsVacios(void);
+
+/* Peticiones, aciertos del magazine y de los slabs y slabs pedidos */
+void imprimirEstadisticasSlab(void);
+
+/* Banco de pruebas: numOperaciones peticiones de E/S con cada algoritmo,
+ * directas y con los slabs, comparando la latencia */
+bool ejecutarBancoSlab(int numOperaciones);
+
+#endif /* SLAB_H */
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tablaapeadas.h"
+#include "zobrist.h"
+
+#define BLOQUES_INICIALES_DIRECTORIO 4
+
+/* Bloque con su cuenta de referencias. El directorio apunta a apeadas, así
+ * que apeadaEnTabla no sabe nada de la cabecera */
+typedef struct {
+    int referencias;    /* Tablas que lo tienen en su directorio (atómico) */
+    Apeada apeadas[APEADAS_POR_BLOQUE];
+} BloqueApeadas;
+
+static BloqueApeadas *cabeceraBloque(Apeada *apeadas) {
+    return (BloqueApeadas *)((char *)apeadas - offsetof(BloqueApeadas, apeadas));
+}
+
+static Apeada *nuevoBloque(void) {
+    BloqueApeadas *bloque = malloc(sizeof(BloqueApeadas));
+    if (bloque == NULL) {
+        printf("Error: No se pudo asignar un bloque de apeadas\n");
+        return NULL;
+    }
+    bloque->referencias = 1;
+    return bloque->apeadas;
+}
+
+static void soltarBloque(Apeada *apeadas) {
+    BloqueApeadas *bloque = cabeceraBloque(apeadas);
+    if (__atomic_sub_fetch(&bloque->referencias, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(bloque);
+    }
+}
+
+/* Apeadas de la tabla que caen en el bloque b */
+static int apeadasEnBloque(const TablaApeadas *tabla, int b) {
+    int resto = tabla->numApeadas - b * APEADAS_POR_BLOQUE;
+    if (resto <= 0) {
+        return 0;
+    }
+    return resto < APEADAS_POR_BLOQUE ? resto : APEADAS_POR_BLOQUE;
+}
+
+/* Dejar el bloque b solo para esta tabla antes de escribir en él. Con una
+ * referencia es de la tabla (las demás solo pueden soltarlo); si no, se
+ * cambia por una copia de sus apeadas válidas. false si no hubo memoria */
+static bool bloqueExclusivo(TablaApeadas *tabla, int b) {
+    Apeada *apeadas = tabla->bloques[b];
+    if (__atomic_load_n(&cabeceraBloque(apeadas)->referencias, __ATOMIC_ACQUIRE) == 1) {
+        return true;
+    }
+
+    Apeada *copia = nuevoBloque();
+    if (copia == NULL) {
+        return false;
+    }
+    memcpy(copia, apeadas, apeadasEnBloque(tabla, b) * sizeof(Apeada));
+    tabla->bloques[b] = copia;
+    soltarBloque(apeadas);
+    return true;
+}
+
+void inicializarTablaApeadas(TablaApeadas *tabla) {
+    tabla->bloques = NULL;
+    tabla->numBloques = 0;
+    tabla->capacidadBloques = 0;
+    tabla->numApeadas = 0;
+    tabla->hash = 0;
+}
+
+void liberarTablaApeadas(TablaApeadas *tabla) {
+    for (int b = 0; b < tabla->numBloques; b++) {
+        soltarBloque(tabla->bloques[b]);
+    }
+    free(tabla->bloques);
+    inicializarTablaApeadas(tabla);
+}
+
+void vaciarTablaApeadas(TablaApeadas *tabla) {
+    tabla->numApeadas = 0;
+    tabla->hash = 0;
+}
+
+/* Asegurar que el directorio tenga sitio para necesarios bloques */
+static bool ampliarDirectorio(TablaApeadas *tabla, int necesarios) {
+    if (necesarios > tabla->capacidadBloques) {
+        int capacidad = tabla->capacidadBloques > 0 ? tabla->capacidadBloques : BLOQUES_INICIALES_DIRECTORIO;
+        while (capacidad < necesarios) {
+            capacidad *= 2;
+        }
+        Apeada **directorio = realloc(tabla->bloques, capacidad * sizeof(Apeada *));
+        if (directorio == NULL) {
+            printf("Error: No se pudo ampliar el directorio de apeadas\n");
+            return false;
+        }
+        tabla->bloques = directorio;
+        tabla->capacidadBloques = capacidad;
+    }
+    return true;
+}
+
+/* Asegurar bloques para numApeadas apeadas. Los bloques existentes no se
+ * tocan; si falla, la tabla queda como estaba (con algún bloque más) */
+static bool reservarEnTabla(TablaApeadas *tabla, int numApeadas) {
+    int necesarios = (numApeadas + APEADAS_POR_BLOQUE - 1) / APEADAS_POR_BLOQUE;
+
+    if (!ampliarDirectorio(tabla, necesarios)) {
+        return false;
+    }
+
+    while (tabla->numBloques < necesarios) {
+        Apeada *bloque = nuevoBloque();
+        if (bloque == NULL) {
+            return false;
+        }
+        tabla->bloques[tabla->numBloques++] = bloque;
+    }
+    return true;
+}
+
+Apeada* agregarEnTabla(TablaApeadas *tabla, const Apeada *apeada) {
+    if (!reservarEnTabla(tabla, tabla->numApeadas + 1) ||
+        !bloqueExclusivo(tabla, tabla->numApeadas / APEADAS_POR_BLOQUE)) {
+        return NULL;
+    }
+
+    Apeada *destino = apeadaEnTabla(tabla, tabla->numApeadas);
+    *destino = *apeada;
+    tabla->numApeadas++;
+    tabla->hash += hashApeada(destino);
+    return destino;
+}
+
+bool reemplazarEnTabla(TablaApeadas *tabla, const Apeada *apeadas, int numApeadas) {
+    if (!reservarEnTabla(tabla, numApeadas)) {
+        return false;
+    }
+
+    /* Primero todos los bloques propios, para no dejar la tabla a medias */
+    for (int b = 0; b * APEADAS_POR_BLOQUE < numApeadas; b++) {
+        if (!bloqueExclusivo(tabla, b)) {
+            return false;
+        }
+    }
+
+    /* Un memcpy por bloque */
+    for (int inicio = 0; inicio < numApeadas; inicio += APEADAS_POR_BLOQUE) {
+        int cuantas = numApeadas - inicio < APEADAS_POR_BLOQUE ? numApeadas - inicio : APEADAS_POR_BLOQUE;
+        memcpy(tabla->bloques[inicio / APEADAS_POR_BLOQUE], apeadas + inicio, cuantas * sizeof(Apeada));
+    }
+    tabla->numApeadas = numApeadas;
+    tabla->hash = recalcularHashTabla(tabla);
+    return true;
+}
+
+bool compartirTablaApeadas(TablaApeadas *destino, const TablaApeadas *origen) {
+    if (destino == origen) {
+        return true;
+    }
+
+    for (int b = 0; b < destino->numBloques; b++) {
+        soltarBloque(destino->bloques[b]);
+    }
+    destino->numBloques = 0;
+    vaciarTablaApeadas(destino);
+
+    if (!ampliarDirectorio(destino, origen->numBloques)) {
+        return false;
+    }
+
+    /* origen tiene una referencia a cada bloque mientras dura la llamada */
+    for (int b = 0; b < origen->numBloques; b++) {
+        __atomic_add_fetch(&cabeceraBloque(origen->bloques[b])->referencias, 1, __ATOMIC_RELAXED);
+        destino->bloques[b] = origen->bloques[b];
+    }
+    destino->numBloques = origen->numBloques;
+    destino->numApeadas = origen->numApeadas;
+    destino->hash = origen->hash;
+    return true;
+}
+
+Apeada* escribirApeadaEnTabla(TablaApeadas *tabla, int indice) {
+    if (!bloqueExclusivo(tabla, indice / APEADAS_POR_BLOQUE)) {
+        return NULL;
+    }
+    return apeadaEnTabla(tabla, indice);
+}
+
+void cambiarApeadaEnTabla(TablaApeadas *tabla, int indice, uint64_t hashAnterior) {
+    tabla->hash += hashApeada(apeadaEnTabla(tabla, indice)) - hashAnterior;
+}
+
+uint64_t recalcularHashTabla(const TablaApeadas *tabla) {
+    uint64_t hash = 0;
+
+    for (int i = 0; i < tabla->numApeadas; i++) {
+        hash += hashApeada(apeadaEnTabla(tabla, i));
+    }
+    return hash;
+}
+
+size_t memoriaTablaApeadas(const TablaApeadas *tabla) {
+    return sizeof(TablaApeadas) +
+           (size_t)tabla->capacidadBloques * sizeof(Apeada *) +
+           (size_t)tabla->numBloques * sizeof(BloqueApeadas);
+}
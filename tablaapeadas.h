@@ -0,0 +1,78 @@
+#ifndef TABLAAPEADAS_H
+#define TABLAAPEADAS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "jugadores.h"
+
+/* Almacén de apeadas por bloques.
+ *
+ * Las apeadas viven en bloques de APEADAS_POR_BLOQUE que se piden cuando
+ * hacen falta y no se mueven nunca: al crecer solo se amplía el directorio
+ * de bloques, así que el índice y el puntero de una apeada siguen siendo
+ * válidos mientras esté en la tabla (por ejemplo, durante todo un turno).
+ * Vaciar la tabla o reemplazar su contenido reutiliza las posiciones y los
+ * bloques que ya tiene; la memoria solo se devuelve con liberarTablaApeadas.
+ *
+ * La tabla lleva además el hash de Zobrist de su contenido (la suma de los
+ * hashApeada). Agregar, reemplazar, copiar y vaciar lo mantienen solas; quien
+ * modifique una apeada en su sitio (un embone) debe avisar con
+ * cambiarApeadaEnTabla, pasando el hash que tenía antes.
+ *
+ * Varias tablas pueden compartir bloques (compartirTablaApeadas): cada bloque
+ * lleva una cuenta de referencias y quien escribe en uno compartido se queda
+ * antes con una copia propia (en esa tabla las apeadas del bloque cambian
+ * entonces de dirección), así que compartir una mesa cuesta O(bloques) y
+ * un turno solo copia los bloques que toca. Para modificar una apeada en su
+ * sitio hay que pedirla con escribirApeadaEnTabla, no con apeadaEnTabla */
+
+#define APEADAS_POR_BLOQUE 32   /* Potencia de 2: el índice se parte con desplazamientos */
+
+typedef struct TablaApeadas {
+    Apeada **bloques;       /* Directorio; solo él se realoja al crecer */
+    int numBloques;         /* Bloques pedidos (llenos o no) */
+    int capacidadBloques;   /* Entradas del directorio */
+    int numApeadas;         /* Apeadas en la tabla, en las posiciones 0..numApeadas-1 */
+    uint64_t hash;          /* Zobrist de la mesa: suma de los hashes de las apeadas */
+} TablaApeadas;
+
+void inicializarTablaApeadas(TablaApeadas *tabla);
+void liberarTablaApeadas(TablaApeadas *tabla);
+
+/* Dejar la tabla sin apeadas, conservando los bloques para reutilizarlos */
+void vaciarTablaApeadas(TablaApeadas *tabla);
+
+/* Apeada en una posición válida (0..numApeadas-1) */
+static inline Apeada* apeadaEnTabla(const TablaApeadas *tabla, int indice) {
+    return &tabla->bloques[indice / APEADAS_POR_BLOQUE][indice % APEADAS_POR_BLOQUE];
+}
+
+/* Copiar una apeada al final de la tabla. Devuelve su posición en la tabla o
+ * NULL si no hubo memoria para un bloque nuevo */
+Apeada* agregarEnTabla(TablaApeadas *tabla, const Apeada *apeada);
+
+/* Sustituir todo el contenido por numApeadas apeadas contiguas */
+bool reemplazarEnTabla(TablaApeadas *tabla, const Apeada *apeadas, int numApeadas);
+
+/* Hacer que destino tenga el contenido de origen compartiendo sus bloques,
+ * sin copiar apeadas. Lo que tuviera destino se suelta. Si no hubo memoria
+ * para el directorio, destino queda vacía y devuelve false */
+bool compartirTablaApeadas(TablaApeadas *destino, const TablaApeadas *origen);
+
+/* Apeada de una posición válida para modificarla en su sitio: si su bloque
+ * es compartido, antes se copia. NULL si no hubo memoria para la copia */
+Apeada* escribirApeadaEnTabla(TablaApeadas *tabla, int indice);
+
+/* Actualizar el hash tras modificar en su sitio la apeada de la posición
+ * indicada, que antes tenía hashAnterior. O(1): la apeada tiene a lo sumo
+ * MAX_CARTAS_ESCALERA cartas */
+void cambiarApeadaEnTabla(TablaApeadas *tabla, int indice, uint64_t hashAnterior);
+
+/* Hash recorriendo todas las apeadas, para comprobar el incremental */
+uint64_t recalcularHashTabla(const TablaApeadas *tabla);
+
+/* Bytes que ocupa la tabla (bloques y directorio; los compartidos cuentan entero) */
+size_t memoriaTablaApeadas(const TablaApeadas *tabla);
+
+#endif /* TABLAAPEADAS_H */
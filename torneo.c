@@ -0,0 +1,388 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "torneo.h"
+#include "estrategia.h"
+#include "juego.h"
+#include "mesa.h"
+#include "mazo.h"
+#include "particion.h"
+#include "cacheparticion.h"
+#include "arena.h"
+#include "reacomodo.h"
+#include "banca.h"
+#include "zobrist.h"
+#include "validador.h"
+
+/* Resultados acumulados por estrategia */
+typedef struct {
+    int asientos;       /* Veces que jugó */
+    int victorias;      /* Partidas ganadas */
+    int porPuntos;      /* De ellas, ganadas por menos puntos en la mano */
+} ResultadoTorneo;
+
+/* Estado de una partida del torneo */
+typedef struct {
+    Jugador jugadores[MAX_JUGADORES];
+    int numJugadores;
+    TablaApeadas mesa;  /* Se vacía entre partidas: sus bloques se reutilizan */
+    Banca banca;        /* Sin candado; el zapato se regenera en su memoria */
+    int numero;
+} PartidaTorneo;
+
+static const char *rutaTraza = NULL;
+static FILE *archivoTraza = NULL;
+static long hashesDistintos = 0;   /* Incrementales que no coinciden con los recalculados */
+
+void configurarTrazaTorneo(const char *ruta) {
+    rutaTraza = ruta;
+}
+
+static int indiceEstrategia(const Estrategia *estrategia) {
+    for (int i = 0; i < numEstrategias(); i++) {
+        if (obtenerEstrategia(i) == estrategia) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/* Estrategia del asiento en la partida: las configuradas, o todas las
+ * disponibles por turnos, rotando un asiento en cada partida */
+static const Estrategia* estrategiaAsiento(int asiento, int partida, int numJugadores) {
+    int posicion = (asiento + partida) % numJugadores;
+
+    if (hayEstrategiasConfiguradas()) {
+        return estrategiaJugador(posicion);
+    }
+    return obtenerEstrategia(posicion % numEstrategias());
+}
+
+static void prepararPartida(PartidaTorneo *partida, int numPartida, int numJugadores) {
+    Carta mano[MAX_CARTAS_MAZO];
+    TablaApeadas mesa = partida->mesa;
+    Banca banca = partida->banca;
+
+    memset(partida, 0, sizeof(PartidaTorneo));
+    partida->mesa = mesa;
+    partida->banca = banca;
+    vaciarTablaApeadas(&partida->mesa);
+    partida->numJugadores = numJugadores;
+    partida->numero = numPartida;
+    generarZapato(&partida->banca, barajasConfiguradas(), 0);
+
+    /* Mismo reparto que repartirFichas: 2/3 del zapato entre los jugadores */
+    int cartasPorJugador = cartasRepartoBanca(partida->banca.totalCartas, numJugadores);
+
+    for (int i = 0; i < numJugadores; i++) {
+        Jugador *jugador = &partida->jugadores[i];
+
+        jugador->id = i;
+        jugador->estado = LISTO;
+        jugador->bcp = NULL;
+        jugador->estrategia = estrategiaAsiento(i, numPartida, numJugadores);
+        inicializarMazo(&jugador->mano);
+
+        int robadas = robarBanca(&partida->banca, mano, cartasPorJugador);
+        agregarCartasMazo(&jugador->mano, mano, robadas);
+    }
+}
+
+static void liberarPartida(PartidaTorneo *partida) {
+    for (int i = 0; i < partida->numJugadores; i++) {
+        liberarMazo(&partida->jugadores[i].mano);
+    }
+}
+
+/* Poner en la mesa de la partida las apeadas creadas; las que no son válidas
+ * (o no caben por falta de memoria) vuelven a la mano. Devuelve cuántas se
+ * pusieron */
+static int ponerApeadas(PartidaTorneo *partida, Jugador *jugador, Apeada *nuevas, int numNuevas) {
+    int puestas = 0;
+
+    for (int i = 0; i < numNuevas; i++) {
+        Apeada *apeada = &nuevas[i];
+
+        if (validarApeada(apeada) && agregarEnTabla(&partida->mesa, apeada) != NULL) {
+            puestas++;
+            continue;
+        }
+
+        Carta *cartas = apeada->esGrupo ? apeada->jugada.grupo.cartas : apeada->jugada.escalera.cartas;
+        int numCartas = apeada->esGrupo ? apeada->jugada.grupo.numCartas : apeada->jugada.escalera.numCartas;
+        for (int j = 0; j < numCartas; j++) {
+            agregarCartaMazo(&jugador->mano, cartas[j]);
+        }
+    }
+
+    return puestas;
+}
+
+/* Una jugada del turno, con el mismo orden que realizarTurno. Devuelve true
+ * si el jugador bajó o embonó algo */
+static bool intentarJugada(PartidaTorneo *partida, Jugador *jugador) {
+    Apeada *nuevas;
+    int numNuevas;
+
+    if (!jugador->primeraApeada) {
+        if (obtenerMejorApertura(&jugador->mano) < 30) {
+            return false;
+        }
+        nuevas = decidirApertura(jugador, &numNuevas);
+        if (nuevas != NULL && ponerApeadas(partida, jugador, nuevas, numNuevas) > 0) {
+            jugador->primeraApeada = true;
+            return true;
+        }
+        return false;
+    }
+
+    int numApeadas = partida->mesa.numApeadas;
+    int *indices = (int*)reservarArena((numApeadas + 1) * sizeof(int));
+    if (indices == NULL) {
+        return false;
+    }
+    for (int i = 0; i < numApeadas; i++) {
+        indices[i] = i;
+    }
+
+    int elegida = decidirEmbone(jugador, &partida->mesa, indices, numApeadas);
+    if (elegida >= 0) {
+        uint64_t hashAnterior = hashApeada(apeadaEnTabla(&partida->mesa, elegida));
+        Apeada *apeada = escribirApeadaEnTabla(&partida->mesa, elegida);
+        if (apeada != NULL && realizarJugadaApeada(jugador, apeada)) {
+            cambiarApeadaEnTabla(&partida->mesa, elegida, hashAnterior);
+            return true;
+        }
+    }
+
+    nuevas = decidirNuevaApeada(jugador, &numNuevas);
+    if (nuevas != NULL && ponerApeadas(partida, jugador, nuevas, numNuevas) > 0) {
+        return true;
+    }
+
+    /* Último recurso: rehacer la mesa entera con cartas de la mano */
+    if (partida->mesa.numApeadas == 0) {
+        return false;
+    }
+    nuevas = crearApeadasDeReacomodo(jugador, &partida->mesa, &numNuevas);
+    if (nuevas == NULL) {
+        return false;
+    }
+    return reemplazarEnTabla(&partida->mesa, nuevas, numNuevas);
+}
+
+/* Jugar un turno. Devuelve true si hubo alguna acción (jugada o comer) */
+static bool jugarTurno(PartidaTorneo *partida, Jugador *jugador) {
+    bool actuo = false;
+    VistaPartida vista = {partida->jugadores, partida->numJugadores, &partida->mesa,
+                          cartasEnBanca(&partida->banca)};
+
+    iniciarTurnoArena();
+    decidirInicioTurno(jugador, &vista);
+
+    while (jugador->mano.numCartas > 0) {
+        if (intentarJugada(partida, jugador)) {
+            actuo = true;
+            continue;
+        }
+
+        /* Sin jugada: comer y terminar el turno */
+        if (cartasEnBanca(&partida->banca) > 0 && jugador->mano.numCartas < MAX_CARTAS_MAZO &&
+            decidirComer(jugador, &partida->banca)) {
+            Carta carta;
+            if (robarBanca(&partida->banca, &carta, 1) == 1) {
+                agregarCartaMazo(&jugador->mano, carta);
+                actuo = true;
+            }
+        }
+        break;
+    }
+
+    /* Las apeadas candidatas del turno ya están en la mesa o en la mano */
+    reiniciarArena();
+    return actuo;
+}
+
+/* Línea de la traza tras el turno, comprobando los hashes incrementales */
+static void trazarTurno(PartidaTorneo *partida, const Jugador *jugador, int turno) {
+    bool distinto = partida->mesa.hash != recalcularHashTabla(&partida->mesa);
+    for (int i = 0; i < partida->numJugadores; i++) {
+        const Mazo *mano = &partida->jugadores[i].mano;
+        distinto = distinto || hashMazo(mano) != hashCartas(mano->cartas, mano->numCartas);
+    }
+    if (distinto) {
+        hashesDistintos++;
+    }
+
+    fprintf(archivoTraza, "Hash partida %d turno %d jugador %d mano %016llx mesa %016llx estado %016llx\n",
+            partida->numero, turno, jugador->id, (unsigned long long)hashMazo(&jugador->mano),
+            (unsigned long long)partida->mesa.hash,
+            (unsigned long long)hashPartida(partida->jugadores, partida->numJugadores, partida->mesa.hash,
+                                            cartasEnBanca(&partida->banca)));
+}
+
+/* Jugar una partida completa; devuelve el asiento ganador */
+static int jugarPartida(PartidaTorneo *partida, bool *porPuntos, int *turnos) {
+    int turnosSinAccion = 0;
+
+    *porPuntos = false;
+    for (*turnos = 0; *turnos < MAX_TURNOS_TORNEO; (*turnos)++) {
+        Jugador *jugador = &partida->jugadores[*turnos % partida->numJugadores];
+
+        if (jugarTurno(partida, jugador)) {
+            turnosSinAccion = 0;
+        } else {
+            turnosSinAccion++;
+        }
+        if (archivoTraza != NULL) {
+            trazarTurno(partida, jugador, *turnos);
+        }
+        if (validacionActiva()) {
+            comprobarTurno(partida->jugadores, partida->numJugadores, &partida->mesa, &partida->banca, jugador->id);
+        }
+
+        if (jugador->mano.numCartas == 0) {
+            return jugador->id;
+        }
+        if (turnosSinAccion >= partida->numJugadores) {
+            break;  /* Nadie puede jugar ni comer */
+        }
+    }
+
+    /* Partida bloqueada: gana la mano con menos puntos */
+    int ganador = 0;
+    for (int i = 1; i < partida->numJugadores; i++) {
+        if (calcularPuntosMano(&partida->jugadores[i].mano) <
+            calcularPuntosMano(&partida->jugadores[ganador].mano)) {
+            ganador = i;
+        }
+    }
+    *porPuntos = true;
+    return ganador;
+}
+
+bool ejecutarTorneo(int numPartidas, int numJugadores) {
+    ResultadoTorneo resultados[MAX_ESTRATEGIAS];
+    PartidaTorneo *partida;
+    long turnosTotales = 0;
+    int bloqueadas = 0;
+    struct timespec inicio, fin;
+    /* Tasa de aciertos de la caché de particiones en cada partida: la
+     * primera, la última, la mínima, la máxima y la suma para la media */
+    double tasaPrimera = 0.0, tasaUltima = 0.0, tasaMinima = 100.0, tasaMaxima = 0.0, sumaTasas = 0.0;
+    int partidasConConsultas = 0;
+
+    if (numPartidas <= 0 || numJugadores < 2 || numJugadores > MAX_JUGADORES) {
+        printf("Torneo inválido: se necesitan partidas > 0 y entre 2 y %d jugadores\n", MAX_JUGADORES);
+        return false;
+    }
+
+    partida = (PartidaTorneo*)malloc(sizeof(PartidaTorneo));
+    if (partida == NULL) {
+        printf("Error: No se pudo asignar memoria para el torneo\n");
+        return false;
+    }
+    inicializarTablaApeadas(&partida->mesa);
+    inicializarBanca(&partida->banca, NULL);
+    if (rutaTraza != NULL) {
+        archivoTraza = fopen(rutaTraza, "w");
+        if (archivoTraza == NULL) {
+            printf("Error: No se pudo crear la traza %s\n", rutaTraza);
+            free(partida);
+            return false;
+        }
+        hashesDistintos = 0;
+        configurarReacomodoReproducible(true);
+    }
+
+    memset(resultados, 0, sizeof(resultados));
+    reiniciarEstadisticasEstrategias();
+
+    printf("Torneo: %d partidas de %d jugadores\n", numPartidas, numJugadores);
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    for (int p = 0; p < numPartidas; p++) {
+        bool porPuntos;
+        int turnos;
+
+        unsigned long aciertosAntes, fallosAntes, aciertosDespues, fallosDespues;
+
+        prepararPartida(partida, p, numJugadores);
+        contadoresCacheParticion(&aciertosAntes, &fallosAntes);
+        int ganador = jugarPartida(partida, &porPuntos, &turnos);
+        contadoresCacheParticion(&aciertosDespues, &fallosDespues);
+
+        unsigned long consultas = (aciertosDespues - aciertosAntes) + (fallosDespues - fallosAntes);
+        if (consultas > 0) {
+            double tasa = 100.0 * (aciertosDespues - aciertosAntes) / consultas;
+            if (partidasConConsultas++ == 0) {
+                tasaPrimera = tasa;
+            }
+            tasaUltima = tasa;
+            tasaMinima = tasa < tasaMinima ? tasa : tasaMinima;
+            tasaMaxima = tasa > tasaMaxima ? tasa : tasaMaxima;
+            sumaTasas += tasa;
+        }
+
+        for (int i = 0; i < numJugadores; i++) {
+            resultados[indiceEstrategia(partida->jugadores[i].estrategia)].asientos++;
+        }
+        ResultadoTorneo *r = &resultados[indiceEstrategia(partida->jugadores[ganador].estrategia)];
+        r->victorias++;
+        if (porPuntos) {
+            r->porPuntos++;
+            bloqueadas++;
+        }
+        turnosTotales += turnos;
+
+        liberarPartida(partida);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+
+    printf("\n=== RESULTADOS DEL TORNEO ===\n");
+    printf("%d partidas en %.2f s (%.1f turnos por partida, %d decididas por puntos)\n",
+           numPartidas, segundos, (double)turnosTotales / numPartidas, bloqueadas);
+    for (int i = 0; i < numEstrategias(); i++) {
+        if (resultados[i].asientos == 0) {
+            continue;
+        }
+        printf("  %-10s %5d asientos, %5d victorias (%5.1f%%), %d por puntos\n",
+               obtenerEstrategia(i)->nombre, resultados[i].asientos, resultados[i].victorias,
+               100.0 * resultados[i].victorias / resultados[i].asientos, resultados[i].porPuntos);
+    }
+
+    printf("Mesa: %d bloques de %d apeadas reutilizados entre partidas, %zu bytes\n",
+           partida->mesa.numBloques, APEADAS_POR_BLOQUE, memoriaTablaApeadas(&partida->mesa));
+    printf("Banca: zapatos de %d barajas (%d cartas) generados en la misma memoria, %zu bytes\n",
+           partida->banca.numBarajas, partida->banca.totalCartas, memoriaBanca(&partida->banca));
+    if (partidasConConsultas > 0) {
+        printf("Caché de particiones por partida: %.1f%% de aciertos de media (mínimo %.1f%%, máximo %.1f%%), "
+               "%.1f%% en la primera y %.1f%% en la última\n",
+               sumaTasas / partidasConConsultas, tasaMinima, tasaMaxima, tasaPrimera, tasaUltima);
+    }
+
+    if (archivoTraza != NULL) {
+        fclose(archivoTraza);
+        archivoTraza = NULL;
+        printf("Traza de hashes en %s: %ld turnos con el hash incremental distinto del recalculado\n",
+               rutaTraza, hashesDistintos);
+    }
+
+    imprimirEstadisticasValidacion();
+    imprimirEstadisticasEstrategias();
+    imprimirEstadisticasParticion();
+    imprimirEstadisticasReacomodo();
+    imprimirEstadisticasArena();
+
+    liberarEstrategias();
+    liberarArenaHilo();
+    liberarMemoParticionHilo();
+    liberarReacomodoHilo();
+    liberarTablaApeadas(&partida->mesa);
+    liberarBanca(&partida->banca);
+    free(partida);
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef TORNEO_H
+#define TORNEO_H
+
+#include <stdbool.h>
+
+/* Torneo de estrategias por lotes.
+ *
+ * Juega numPartidas partidas seguidas en un solo hilo, sin planificador,
+ * memoria simulada ni pausas: solo las reglas de la mesa y las decisiones de
+ * cada estrategia. Los asientos rotan entre partidas para que ninguna
+ * estrategia salga siempre primero. Gana quien se queda sin cartas; si la
+ * banca se agota y nadie puede jugar (o se llega al límite de turnos), gana
+ * quien tenga menos puntos en la mano. Al final se muestra la tasa de
+ * victorias y la latencia media de decisión de cada estrategia */
+
+#define MAX_TURNOS_TORNEO 2000
+
+bool ejecutarTorneo(int numPartidas, int numJugadores);
+
+/* Escribir en ruta una línea por turno con los hashes de Zobrist del estado
+ * (ver zobrist.h) y comprobar que los incrementales coinciden con los
+ * recalculados. Con traza el reacomodo se acota solo por nodos, así que dos
+ * torneos con la misma semilla deben dar la misma traza (se comparan con
+ * compararTrazasHash); mcts, que busca por tiempo y con varios hilos, puede
+ * hacerlas divergir. NULL para no escribir traza */
+void configurarTrazaTorneo(const char *ruta);
+
+#endif /* TORNEO_H */
@@ -0,0 +1,556 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "trazamemoria.h"
+#include "candados.h"
+
+#define PROCESOS_TRAZA_SINTETICA 12
+#define PAGINAS_TRAZA_SINTETICA  8    /* 12 * 8 páginas caben en la tabla de páginas */
+#define POLITICA_OPTIMA          NUM_POLITICAS_REEMPLAZO
+#define MAX_HILOS_REPRODUCCION   16
+
+/* Grabación (los hilos de los jugadores, bajo mutexTraza) */
+static pthread_mutex_t mutexTraza = PTHREAD_MUTEX_INITIALIZER;
+static bool grabando = false;
+static FILE *archivoTraza = NULL;
+static const char *rutaGrabacion = NULL;
+static EventoTraza bufer[EVENTOS_BUFER_TRAZA];
+static int eventosEnBufer = 0;
+static long eventosGrabados = 0;
+static bool errorEscritura = false;
+
+/* Una reproducción: un algoritmo de asignación o una política de reemplazo */
+typedef struct {
+    const char *nombre;
+    int algoritmo;      /* -1 si es de reemplazo */
+    int politica;       /* -1 si es de asignación; POLITICA_OPTIMA, Belady */
+    ResultadoReproduccion resultado;
+} TrabajoReproduccion;
+
+/* Lo que comparten los hilos del reproductor: la traza es de solo lectura y
+ * cada hilo toma el siguiente trabajo con un incremento atómico */
+typedef struct {
+    const EventoTraza *eventos;
+    long numEventos;
+    int maxPagina;
+    TrabajoReproduccion *trabajos;
+    int numTrabajos;
+    int siguiente;
+} Reproduccion;
+
+typedef struct {
+    Reproduccion *reproduccion;
+    GestorMemoria *gestor;
+} HiloReproduccion;
+
+static double segundosDesde(const struct timespec *inicio) {
+    struct timespec fin;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - inicio->tv_sec) + (fin.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/* xorshift64*, para la traza sintética */
+static unsigned long long aleatorioTraza(unsigned long long *estado) {
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return *estado * 0x2545F4914F6CDD1DULL;
+}
+
+static bool escribirCabecera(FILE *archivo) {
+    uint32_t cabecera[2] = {MAGIA_TRAZA_MEMORIA, VERSION_TRAZA_MEMORIA};
+    return fwrite(cabecera, sizeof(cabecera), 1, archivo) == 1;
+}
+
+/* Escribir el búfer; con mutexTraza tomado */
+static void volcarBufer(void) {
+    if (eventosEnBufer > 0 &&
+        fwrite(bufer, sizeof(EventoTraza), eventosEnBufer, archivoTraza) != (size_t)eventosEnBufer) {
+        errorEscritura = true;
+    }
+    eventosEnBufer = 0;
+}
+
+bool iniciarGrabacionMemoria(const char *ruta) {
+    FILE *archivo = fopen(ruta, "wb");
+
+    if (archivo == NULL || !escribirCabecera(archivo)) {
+        printf("Error: No se pudo crear la traza de memoria %s\n", ruta);
+        if (archivo != NULL) {
+            fclose(archivo);
+        }
+        return false;
+    }
+
+    REGISTRAR_CANDADOS(&mutexTraza, 1, "mutexTraza");
+    BLOQUEAR(&mutexTraza);
+    archivoTraza = archivo;
+    rutaGrabacion = ruta;
+    eventosEnBufer = 0;
+    eventosGrabados = 0;
+    errorEscritura = false;
+    DESBLOQUEAR(&mutexTraza);
+    __atomic_store_n(&grabando, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+void grabarEventoMemoria(int tipo, int proceso, int pagina, int valor) {
+    if (!__atomic_load_n(&grabando, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    /* Un proceso o una página fuera de rango no cabe en el evento */
+    if (proceso < 0 || proceso > UINT8_MAX || pagina < 0 || pagina > UINT16_MAX) {
+        return;
+    }
+
+    BLOQUEAR(&mutexTraza);
+    if (archivoTraza != NULL) {
+        EventoTraza *evento = &bufer[eventosEnBufer++];
+        evento->tipo = (uint8_t)tipo;
+        evento->proceso = (uint8_t)proceso;
+        evento->pagina = (uint16_t)pagina;
+        evento->valor = valor;
+        eventosGrabados++;
+        if (eventosEnBufer == EVENTOS_BUFER_TRAZA) {
+            volcarBufer();
+        }
+    }
+    DESBLOQUEAR(&mutexTraza);
+}
+
+bool terminarGrabacionMemoria(void) {
+    bool correcto;
+
+    if (!__atomic_load_n(&grabando, __ATOMIC_ACQUIRE)) {
+        return true;
+    }
+    __atomic_store_n(&grabando, false, __ATOMIC_RELEASE);
+
+    BLOQUEAR(&mutexTraza);
+    volcarBufer();
+    correcto = fclose(archivoTraza) == 0 && !errorEscritura;
+    archivoTraza = NULL;
+    DESBLOQUEAR(&mutexTraza);
+
+    if (correcto) {
+        printf("Traza de memoria: %ld eventos en %s\n", eventosGrabados, rutaGrabacion);
+    } else {
+        printf("Error: No se pudo escribir la traza de memoria %s\n", rutaGrabacion);
+    }
+    return correcto;
+}
+
+/* Cargar una traza entera. Devuelve los eventos (a liberar con free) o NULL */
+static EventoTraza* cargarTraza(const char *ruta, long *numEventos) {
+    FILE *archivo = fopen(ruta, "rb");
+    uint32_t cabecera[2];
+
+    if (archivo == NULL) {
+        printf("Error: No se pudo abrir la traza de memoria %s\n", ruta);
+        return NULL;
+    }
+    if (fread(cabecera, sizeof(cabecera), 1, archivo) != 1 ||
+        cabecera[0] != MAGIA_TRAZA_MEMORIA || cabecera[1] != VERSION_TRAZA_MEMORIA) {
+        printf("Error: %s no es una traza de memoria (versión %u)\n", ruta, VERSION_TRAZA_MEMORIA);
+        fclose(archivo);
+        return NULL;
+    }
+
+    fseek(archivo, 0, SEEK_END);
+    long bytes = ftell(archivo) - (long)sizeof(cabecera);
+    fseek(archivo, sizeof(cabecera), SEEK_SET);
+    if (bytes % (long)sizeof(EventoTraza) != 0) {
+        printf("Aviso: la traza %s está cortada; se ignora el último evento\n", ruta);
+    }
+    *numEventos = bytes / (long)sizeof(EventoTraza);
+
+    EventoTraza *eventos = (EventoTraza*)malloc((*numEventos > 0 ? *numEventos : 1) * sizeof(EventoTraza));
+    if (eventos == NULL) {
+        printf("Error: No se pudo asignar memoria para %ld eventos\n", *numEventos);
+        fclose(archivo);
+        return NULL;
+    }
+    if (fread(eventos, sizeof(EventoTraza), *numEventos, archivo) != (size_t)*numEventos) {
+        printf("Error: No se pudo leer la traza de memoria %s\n", ruta);
+        free(eventos);
+        fclose(archivo);
+        return NULL;
+    }
+    fclose(archivo);
+    return eventos;
+}
+
+static void anotarEvento(EventoTraza *evento, int tipo, int proceso, int pagina, int valor) {
+    evento->tipo = (uint8_t)tipo;
+    evento->proceso = (uint8_t)proceso;
+    evento->pagina = (uint16_t)pagina;
+    evento->valor = valor;
+}
+
+/* Como en la partida: peticiones de E/S de 36 a 64 bytes, algún crecimiento
+ * de 10 a 30 y, entre medias, accesos de un proceso activo que cambia de vez
+ * en cuando, con tres de cada cuatro a sus tres primeras páginas y un
+ * tercio de escrituras. Al liberar un proceso se liberan también sus páginas */
+bool generarTrazaMemoria(const char *ruta, long numEventos) {
+    bool conMemoria[PROCESOS_TRAZA_SINTETICA] = {false};
+    int cartaPagina[PROCESOS_TRAZA_SINTETICA][PAGINAS_TRAZA_SINTETICA];
+    unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+    EventoTraza eventos[EVENTOS_BUFER_TRAZA];
+    int enBloque = 0, activo = 0;
+    long generados = 0;
+    bool correcto = true;
+
+    if (numEventos <= 0) {
+        printf("Número de eventos inválido\n");
+        return false;
+    }
+
+    FILE *archivo = fopen(ruta, "wb");
+    if (archivo == NULL || !escribirCabecera(archivo)) {
+        printf("Error: No se pudo crear la traza de memoria %s\n", ruta);
+        if (archivo != NULL) {
+            fclose(archivo);
+        }
+        return false;
+    }
+
+    for (int p = 0; p < PROCESOS_TRAZA_SINTETICA; p++) {
+        for (int g = 0; g < PAGINAS_TRAZA_SINTETICA; g++) {
+            cartaPagina[p][g] = p * PAGINAS_TRAZA_SINTETICA + g;
+        }
+    }
+
+    while (generados < numEventos) {
+        unsigned long long x = aleatorioTraza(&estado);
+        int proceso = (int)((x >> 8) % PROCESOS_TRAZA_SINTETICA);
+
+        /* Los eventos salen de uno en uno o de dos en dos (liberar la memoria
+         * y las páginas): se vuelca antes de que falte sitio */
+        if (enBloque + 2 > EVENTOS_BUFER_TRAZA) {
+            correcto = fwrite(eventos, sizeof(EventoTraza), enBloque, archivo) == (size_t)enBloque && correcto;
+            enBloque = 0;
+        }
+
+        if (x % 8 == 0) {
+            if (!conMemoria[proceso]) {
+                anotarEvento(&eventos[enBloque++], TRAZA_ASIGNAR, proceso, 0, 36 + 4 * (int)((x >> 16) % 8));
+                conMemoria[proceso] = true;
+            } else if ((x >> 16) % 4 != 0) {
+                anotarEvento(&eventos[enBloque++], TRAZA_LIBERAR, proceso, 0, 0);
+                anotarEvento(&eventos[enBloque++], TRAZA_LIBERAR_PAGINAS, proceso, 0, 0);
+                conMemoria[proceso] = false;
+                generados++;
+            } else {
+                anotarEvento(&eventos[enBloque++], TRAZA_CRECER, proceso, 0, 10 + (int)((x >> 24) % 21));
+            }
+        } else {
+            if (x % 32 == 1) {
+                activo = proceso;
+            }
+            int pagina = (x >> 16) % 4 != 0 ? (int)((x >> 20) % 3) : (int)((x >> 24) % PAGINAS_TRAZA_SINTETICA);
+            if ((x >> 32) % 3 == 0) {
+                cartaPagina[activo][pagina] = (int)((x >> 36) % 108);   /* Escritura */
+            }
+            anotarEvento(&eventos[enBloque++], TRAZA_ACCESO, activo, pagina, cartaPagina[activo][pagina]);
+        }
+        generados++;
+    }
+
+    correcto = fwrite(eventos, sizeof(EventoTraza), enBloque, archivo) == (size_t)enBloque && correcto;
+    correcto = fclose(archivo) == 0 && correcto;
+    if (!correcto) {
+        printf("Error: No se pudo escribir la traza de memoria %s\n", ruta);
+        return false;
+    }
+    printf("Traza sintética: %ld eventos en %s\n", generados, ruta);
+    return true;
+}
+
+/* Reemplazo óptimo de Belady. Una pasada hacia atrás apunta, para cada
+ * acceso, cuándo vuelve a usarse su página (nunca si antes se liberan las
+ * páginas de su proceso); hacia delante, en un fallo sin marco libre se
+ * desaloja la página cuyo siguiente uso es el más lejano. Las cartas y las
+ * escrituras se llevan igual que en resolverAcceso */
+typedef struct {
+    long proximoUso;
+    int marco;          /* -1 si no está en memoria */
+    int carta;
+    bool existe;
+    bool modificada;
+} PaginaOptima;
+
+static bool simularOptimo(const EventoTraza *eventos, long numEventos, int maxPagina,
+                          ResultadoReproduccion *resultado) {
+    int paginasProceso = maxPagina + 1;
+    long numClaves = (long)(UINT8_MAX + 1) * paginasProceso;
+    long *siguienteUso = (long*)malloc((numEventos > 0 ? numEventos : 1) * sizeof(long));
+    PaginaOptima *paginas = (PaginaOptima*)malloc(numClaves * sizeof(PaginaOptima));
+    long claveMarco[NUM_MARCOS];
+    struct timespec inicio;
+
+    memset(resultado, 0, sizeof(*resultado));
+    if (siguienteUso == NULL || paginas == NULL) {
+        printf("Error: No se pudo asignar memoria para el reemplazo óptimo\n");
+        free(siguienteUso);
+        free(paginas);
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (long k = 0; k < numClaves; k++) {
+        paginas[k].proximoUso = LONG_MAX;
+        paginas[k].marco = -1;
+        paginas[k].existe = false;
+        paginas[k].modificada = false;
+    }
+    for (long i = numEventos - 1; i >= 0; i--) {
+        long base = (long)eventos[i].proceso * paginasProceso;
+
+        if (eventos[i].tipo == TRAZA_ACCESO) {
+            siguienteUso[i] = paginas[base + eventos[i].pagina].proximoUso;
+            paginas[base + eventos[i].pagina].proximoUso = i;
+        } else if (eventos[i].tipo == TRAZA_LIBERAR_PAGINAS) {
+            for (int g = 0; g < paginasProceso; g++) {
+                paginas[base + g].proximoUso = LONG_MAX;
+            }
+        }
+    }
+
+    for (int m = 0; m < NUM_MARCOS; m++) {
+        claveMarco[m] = -1;
+    }
+    for (long i = 0; i < numEventos; i++) {
+        const EventoTraza *evento = &eventos[i];
+        long base = (long)evento->proceso * paginasProceso;
+
+        if (evento->tipo == TRAZA_LIBERAR_PAGINAS) {
+            for (int g = 0; g < paginasProceso; g++) {
+                PaginaOptima *pagina = &paginas[base + g];
+                if (pagina->marco >= 0) {
+                    claveMarco[pagina->marco] = -1;
+                }
+                pagina->marco = -1;
+                pagina->existe = false;
+                pagina->modificada = false;
+            }
+            resultado->operaciones++;
+            continue;
+        }
+        if (evento->tipo != TRAZA_ACCESO) {
+            continue;
+        }
+        resultado->operaciones++;
+
+        long clave = base + evento->pagina;
+        PaginaOptima *pagina = &paginas[clave];
+        if (!pagina->existe) {
+            pagina->existe = true;
+            pagina->carta = evento->valor;
+        } else if (pagina->carta != evento->valor) {
+            pagina->carta = evento->valor;
+            pagina->modificada = true;
+        }
+        pagina->proximoUso = siguienteUso[i];
+
+        if (pagina->marco >= 0) {
+            resultado->reemplazo.aciertos++;
+            continue;
+        }
+        resultado->reemplazo.fallos++;
+
+        int marco = -1;
+        for (int m = 0; m < NUM_MARCOS && marco == -1; m++) {
+            if (claveMarco[m] == -1) {
+                marco = m;
+            }
+        }
+        if (marco == -1) {
+            long masLejano = -1;
+            for (int m = 0; m < NUM_MARCOS; m++) {
+                if (paginas[claveMarco[m]].proximoUso > masLejano) {
+                    masLejano = paginas[claveMarco[m]].proximoUso;
+                    marco = m;
+                }
+            }
+            PaginaOptima *victima = &paginas[claveMarco[marco]];
+            if (victima->modificada) {
+                victima->modificada = false;
+                resultado->reemplazo.escrituras++;
+            }
+            victima->marco = -1;
+            resultado->reemplazo.reemplazos++;
+            resultado->reemplazo.examinados += NUM_MARCOS;
+        }
+        pagina->marco = marco;
+        claveMarco[marco] = clave;
+    }
+    resultado->segundos = segundosDesde(&inicio);
+
+    free(siguienteUso);
+    free(paginas);
+    return true;
+}
+
+static void* funcionHiloReproduccion(void *arg) {
+    HiloReproduccion *hilo = (HiloReproduccion*)arg;
+    Reproduccion *reproduccion = hilo->reproduccion;
+
+    for (;;) {
+        int t = __atomic_fetch_add(&reproduccion->siguiente, 1, __ATOMIC_RELAXED);
+        if (t >= reproduccion->numTrabajos) {
+            break;
+        }
+
+        TrabajoReproduccion *trabajo = &reproduccion->trabajos[t];
+        if (trabajo->politica == POLITICA_OPTIMA) {
+            simularOptimo(reproduccion->eventos, reproduccion->numEventos, reproduccion->maxPagina,
+                          &trabajo->resultado);
+        } else {
+            reproducirEventosMemoria(hilo->gestor, trabajo->algoritmo, trabajo->politica,
+                                     reproduccion->eventos, reproduccion->numEventos, &trabajo->resultado);
+        }
+    }
+    return NULL;
+}
+
+static double operacionesPorSegundo(const ResultadoReproduccion *resultado) {
+    return resultado->operaciones / (resultado->segundos > 0 ? resultado->segundos : 1e-9);
+}
+
+static double porcentaje(long parte, long total) {
+    return total > 0 ? 100.0 * parte / total : 0.0;
+}
+
+bool reproducirTrazaMemoria(const char *ruta) {
+    TrabajoReproduccion trabajos[] = {
+        {"Ajuste Óptimo", ALG_AJUSTE_OPTIMO, -1, {0}},
+        {"Mapa de Bits", ALG_MAPA_BITS, -1, {0}},
+        {"Sistema de Compañeros", ALG_BUDDY, -1, {0}},
+        {NULL, -1, REEMPLAZO_LRU, {0}},
+        {NULL, -1, REEMPLAZO_RELOJ, {0}},
+        {NULL, -1, REEMPLAZO_NFU, {0}},
+        {NULL, -1, REEMPLAZO_WSCLOCK, {0}},
+        {"Óptimo (Belady)", -1, POLITICA_OPTIMA, {0}},
+    };
+    int numTrabajos = (int)(sizeof(trabajos) / sizeof(trabajos[0]));
+    pthread_t hilos[MAX_HILOS_REPRODUCCION];
+    HiloReproduccion datosHilos[MAX_HILOS_REPRODUCCION];
+    Reproduccion reproduccion = {0};
+    long eventosAsignacion = 0, eventosPaginas = 0;
+    struct timespec inicio;
+    bool correcto = true;
+
+    reproduccion.eventos = cargarTraza(ruta, &reproduccion.numEventos);
+    if (reproduccion.eventos == NULL) {
+        return false;
+    }
+    for (long i = 0; i < reproduccion.numEventos; i++) {
+        const EventoTraza *evento = &reproduccion.eventos[i];
+        if (evento->tipo == TRAZA_ACCESO || evento->tipo == TRAZA_LIBERAR_PAGINAS) {
+            eventosPaginas++;
+            if (evento->tipo == TRAZA_ACCESO && evento->pagina > reproduccion.maxPagina) {
+                reproduccion.maxPagina = evento->pagina;
+            }
+        } else {
+            eventosAsignacion++;
+        }
+    }
+    for (int t = 0; t < numTrabajos; t++) {
+        if (trabajos[t].nombre == NULL) {
+            trabajos[t].nombre = nombrePoliticaReemplazo(trabajos[t].politica);
+        }
+    }
+    reproduccion.trabajos = trabajos;
+    reproduccion.numTrabajos = numTrabajos;
+
+    /* Un hilo por núcleo, sin pasar del número de trabajos */
+    int numHilos = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numHilos < 1) {
+        numHilos = 1;
+    }
+    if (numHilos > numTrabajos) {
+        numHilos = numTrabajos;
+    }
+    GestorMemoria *gestores = (GestorMemoria*)calloc(numHilos, sizeof(GestorMemoria));
+    if (gestores == NULL) {
+        printf("Error: No se pudo asignar memoria para los gestores de la reproducción\n");
+        free((void*)reproduccion.eventos);
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    int creados = 0;
+    for (int h = 0; h < numHilos; h++) {
+        datosHilos[h].reproduccion = &reproduccion;
+        datosHilos[h].gestor = &gestores[h];
+        if (pthread_create(&hilos[creados], NULL, funcionHiloReproduccion, &datosHilos[h]) == 0) {
+            creados++;
+        }
+    }
+    if (creados == 0) {
+        funcionHiloReproduccion(&datosHilos[0]);   /* Sin hilos, en este */
+    }
+    for (int h = 0; h < creados; h++) {
+        pthread_join(hilos[h], NULL);
+    }
+    double segundos = segundosDesde(&inicio);
+
+    long operaciones = 0;
+    for (int t = 0; t < numTrabajos; t++) {
+        operaciones += trabajos[t].resultado.operaciones;
+    }
+    printf("Reproducción de %s: %ld eventos (%ld de asignación, %ld de páginas), %d trabajos en %d hilos\n",
+           ruta, reproduccion.numEventos, eventosAsignacion, eventosPaginas, numTrabajos, creados > 0 ? creados : 1);
+    printf("  %.3f s en total, %.0f eventos/s entre todos los hilos\n\n", segundos,
+           operaciones / (segundos > 0 ? segundos : 1e-9));
+
+    printf("  %-28s %12s %9s %14s %15s %15s\n", "Algoritmo", "ops/s", "fallos", "crec. fallidos",
+           "frag. interna", "frag. externa");
+    for (int t = 0; t < numTrabajos; t++) {
+        const ResultadoReproduccion *r = &trabajos[t].resultado;
+        if (trabajos[t].algoritmo < 0) {
+            continue;
+        }
+        printf("  %-28s %12.0f %8.1f%% %13.1f%% %13.1f B %14.1f%%\n", trabajos[t].nombre,
+               operacionesPorSegundo(r), porcentaje(r->fallosAsignacion, r->asignaciones + r->fallosAsignacion),
+               porcentaje(r->fallosCrecimiento, r->crecimientos + r->fallosCrecimiento),
+               r->internaMedia, r->externaMedia);
+        if (!r->memoriaEntera) {
+            printf("Error (%s): la memoria no quedó entera al liberar todo\n", trabajos[t].nombre);
+            correcto = false;
+        }
+    }
+
+    const ResultadoReproduccion *optimo = &trabajos[numTrabajos - 1].resultado;
+    printf("\n  %-28s %12s %9s %11s %11s %11s %11s\n", "Política", "ops/s", "fallos", "reemplazos",
+           "examinados", "escrituras", "vs. óptimo");
+    for (int t = 0; t < numTrabajos; t++) {
+        const ResultadoReproduccion *r = &trabajos[t].resultado;
+        long accesos = r->reemplazo.aciertos + r->reemplazo.fallos;
+        if (trabajos[t].politica < 0) {
+            continue;
+        }
+        printf("  %-28s %12.0f %8.2f%% %11d %11.1f %11d %+10.1f%%\n", trabajos[t].nombre,
+               operacionesPorSegundo(r), porcentaje(r->reemplazo.fallos, accesos), r->reemplazo.reemplazos,
+               r->reemplazo.reemplazos > 0 ? (double)r->reemplazo.examinados / r->reemplazo.reemplazos : 0.0,
+               r->reemplazo.escrituras,
+               optimo->reemplazo.fallos > 0 ? porcentaje(r->reemplazo.fallos - optimo->reemplazo.fallos,
+                                                          optimo->reemplazo.fallos) : 0.0);
+        /* Ninguna política con los mismos marcos puede fallar menos que Belady */
+        if (r->accesosRechazados > 0) {
+            printf("Aviso (%s): %ld accesos sin sitio en la tabla de páginas\n", trabajos[t].nombre,
+                   r->accesosRechazados);
+        } else if (r->reemplazo.fallos < optimo->reemplazo.fallos) {
+            printf("Error (%s): menos fallos que el reemplazo óptimo\n", trabajos[t].nombre);
+            correcto = false;
+        }
+    }
+
+    free(gestores);
+    free((void*)reproduccion.eventos);
+    return correcto;
+}
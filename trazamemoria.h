@@ -0,0 +1,87 @@
+#ifndef TRAZAMEMORIA_H
+#define TRAZAMEMORIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "memoria.h"
+
+/* Trazas de la memoria.
+ *
+ * Con --grabar-memoria, cada llamada al gestor de memoria de la partida
+ * (asignar, crecer, liberar la memoria o las páginas de un proceso y acceder
+ * a una página) se guarda como un evento de 8 bytes. Los hilos de los
+ * jugadores llenan un búfer común bajo su mutex, que se escribe al archivo
+ * cuando se llena y al terminar.
+ *
+ * El reproductor (--reproducir-memoria) carga la traza entera y la aplica,
+ * en paralelo y cada uno con su propio GestorMemoria, con los tres
+ * algoritmos de asignación y las cuatro políticas de reemplazo, más el
+ * reemplazo óptimo de Belady: con toda la traza a la vista, desaloja la
+ * página que más tarda en volver a usarse, y sus fallos son la cota
+ * inferior de los de cualquier política con los mismos marcos.
+ *
+ * Formato: MAGIA_TRAZA_MEMORIA y VERSION_TRAZA_MEMORIA (4 bytes cada una) y
+ * los eventos, sin contador: se deduce del tamaño */
+
+#define MAGIA_TRAZA_MEMORIA    0x4D5A5452u   /* "RTZM" en little endian */
+#define VERSION_TRAZA_MEMORIA  1u
+
+#define TRAZA_ASIGNAR          1   /* valor: bytes pedidos */
+#define TRAZA_CRECER           2   /* valor: bytes adicionales */
+#define TRAZA_LIBERAR          3   /* Toda la memoria del proceso */
+#define TRAZA_LIBERAR_PAGINAS  4   /* Todas las páginas del proceso */
+#define TRAZA_ACCESO           5   /* pagina y valor: la carta */
+
+#define EVENTOS_BUFER_TRAZA    4096
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t proceso;
+    uint16_t pagina;
+    int32_t valor;
+} EventoTraza;
+
+/* Lo que mide la reproducción de una traza con un algoritmo o una política */
+typedef struct {
+    long operaciones;           /* Eventos aplicados */
+    double segundos;
+    /* Asignación */
+    long asignaciones;
+    long fallosAsignacion;
+    long crecimientos;
+    long fallosCrecimiento;
+    double internaMedia;        /* Bytes */
+    double externaMedia;        /* Porcentaje */
+    bool memoriaEntera;         /* Al liberar todo, la memoria vuelve a ser un hueco */
+    /* Reemplazo */
+    EstadisticasReemplazo reemplazo;
+    long accesosRechazados;     /* Sin sitio en la tabla de páginas */
+} ResultadoReproduccion;
+
+/* Empezar a grabar en ruta las llamadas a la memoria de la partida */
+bool iniciarGrabacionMemoria(const char *ruta);
+
+/* Guardar un evento si se está grabando (si no, no cuesta más que mirar
+ * una bandera). Lo llaman las funciones públicas de memoria.c */
+void grabarEventoMemoria(int tipo, int proceso, int pagina, int valor);
+
+/* Escribir lo que quede en el búfer y cerrar la traza */
+bool terminarGrabacionMemoria(void);
+
+/* Escribir una traza sintética de numEventos eventos con la forma de la
+ * E/S de la partida, para reproducirla sin jugar */
+bool generarTrazaMemoria(const char *ruta, long numEventos);
+
+/* Aplicar numEventos eventos al gestor propio (que se reinicia) sin
+ * mensajes: con algoritmo >= 0, los de asignación con ese algoritmo; con
+ * politica >= 0, los de páginas con esa política. Está en memoria.c, que
+ * conoce las estructuras de los algoritmos; el hilo que la llama vuelve
+ * después al gestor de la partida */
+void reproducirEventosMemoria(GestorMemoria *propio, int algoritmo, int politica,
+                              const EventoTraza *eventos, long numEventos, ResultadoReproduccion *resultado);
+
+/* Reproducir la traza con cada algoritmo y cada política, un hilo por
+ * núcleo, e imprimir la comparación */
+bool reproducirTrazaMemoria(const char *ruta);
+
+#endif /* TRAZAMEMORIA_H */
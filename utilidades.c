@@ -6,15 +6,12 @@
 #include "utilidades.h"
 #include "jugadores.h"
 #include "juego.h"
+#include "mesa.h"
 
-/* Constantes para colores en terminal */
-#define COLOR_ROJO     "\x1b[31m"
-#define COLOR_VERDE    "\x1b[32m"
-#define COLOR_AMARILLO "\x1b[33m"
-#define COLOR_AZUL     "\x1b[34m"
-#define COLOR_MAGENTA  "\x1b[35m"
-#define COLOR_CIAN     "\x1b[36m"
-#define COLOR_RESET    "\x1b[0m"
+/* Nivel de la salida por consola; main lo fija antes de crear los hilos */
+NivelRegistro nivelRegistro = REGISTRO_RESUMEN;
+
+static const char *nombresNivelRegistro[] = {"silencio", "resumen", "detalle"};
 
 // Declarar como global (ya no static) y exportarla
 int rondaActual = 0;
@@ -23,7 +20,16 @@ static const char* ARCHIVO_HISTORIAL = "historial_juego.txt";
 // Función para registrar el historial de una ronda completa
 // Función para registrar el historial de una ronda completa
 void registrarHistorial(int numRonda, Jugador *jugadores, int numJugadores) {
+    const TablaApeadas *mesa = adquirirMesa(NULL);
+    registrarHistorialMesa(numRonda, jugadores, numJugadores, mesa, cartasEnBanca(obtenerBanca()));
+    soltarMesa(mesa);
+}
+
+// Registrar el historial a partir de un estado dado (el vivo o una instantánea)
+void registrarHistorialMesa(int numRonda, Jugador *jugadores, int numJugadores,
+                            const TablaApeadas *mesa, int cartasBanca) {
     FILE *archivo;
+    int numApeadas = mesa->numApeadas;
     
     // Determinar si es la primera vez que escribimos en el archivo
     bool primerRegistro = false;
@@ -68,26 +74,23 @@ void registrarHistorial(int numRonda, Jugador *jugadores, int numJugadores) {
     fprintf(archivo, "Fecha y hora: %s\n\n", timestamp);
     
     // Escribir estado de la mesa
-    Apeada *apeadas = obtenerApeadas();
-    int numApeadas = obtenerNumApeadas();
-    Mazo *banca = obtenerBanca();
-    
     fprintf(archivo, "ESTADO DE LA MESA:\n");
     fprintf(archivo, "  Número de apeadas: %d\n", numApeadas);
-    fprintf(archivo, "  Cartas en la banca: %d\n\n", banca->numCartas);
+    fprintf(archivo, "  Cartas en la banca: %d\n\n", cartasBanca);
     
     // Mostrar detalles de las apeadas
     if (numApeadas > 0) {
         fprintf(archivo, "  Detalle de apeadas:\n");
         for (int i = 0; i < numApeadas; i++) {
-            fprintf(archivo, "    Apeada %d (Jugador %d): ", i, apeadas[i].idJugador);
+            const Apeada *apeada = apeadaEnTabla(mesa, i);
+            fprintf(archivo, "    Apeada %d (Jugador %d): ", i, apeada->idJugador);
             
-            if (apeadas[i].esGrupo) {
+            if (apeada->esGrupo) {
                 fprintf(archivo, "GRUPO, %d cartas, %d puntos\n", 
-                       apeadas[i].jugada.grupo.numCartas, apeadas[i].puntos);
+                       apeada->jugada.grupo.numCartas, apeada->puntos);
             } else {
                 fprintf(archivo, "ESCALERA, %d cartas, %d puntos\n", 
-                       apeadas[i].jugada.escalera.numCartas, apeadas[i].puntos);
+                       apeada->jugada.escalera.numCartas, apeada->puntos);
             }
         }
         fprintf(archivo, "\n");
@@ -418,6 +421,22 @@ void guardarEstadisticasJuego(Jugador *jugadores, int numJugadores) {
     printf("Estadísticas del juego guardadas en 'estadisticas.txt'\n");
 }
 
+/* Interpretar el nombre de un nivel de registro */
+bool interpretarNivelRegistro(const char *texto, NivelRegistro *nivel) {
+    for (int i = REGISTRO_SILENCIO; i <= REGISTRO_DETALLE; i++) {
+        if (strcmp(texto, nombresNivelRegistro[i]) == 0) {
+            *nivel = (NivelRegistro)i;
+            return true;
+        }
+    }
+    printf("Nivel de registro desconocido: %s (silencio, resumen o detalle)\n", texto);
+    return false;
+}
+
+const char* nombreNivelRegistro(NivelRegistro nivel) {
+    return nombresNivelRegistro[nivel];
+}
+
 /* Funciones para colorear la salida en terminal */
 void colorRojo(void) { printf(COLOR_ROJO); }
 void colorVerde(void) { printf(COLOR_VERDE); }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include "jugadores.h"
+#include "tablaapeadas.h"
 
 /* Funciones auxiliares para manejo de cartas */
 void imprimirCarta(Carta carta);
@@ -11,6 +12,8 @@ char* obtenerNombreCarta(Carta carta, char *buffer);
 int calcularPuntosCarta(Carta carta);
 extern int rondaActual;
 void registrarHistorial(int numRonda, Jugador *jugadores, int numJugadores);
+void registrarHistorialMesa(int numRonda, Jugador *jugadores, int numJugadores,
+                            const TablaApeadas *mesa, int cartasBanca);
 void registrarHistorialRonda(int numRonda, Jugador *jugadores, int numJugadores);
 void registrarHistorialJugador(int numRonda, Jugador *jugador);
 void mostrarHistorialCompleto(void);
@@ -19,6 +22,39 @@ void mostrarHistorialCompleto(void);
 void registrarEvento(const char *formato, ...);
 void guardarEstadisticasJuego(Jugador *jugadores, int numJugadores);
 
+/* Constantes para colores en terminal */
+#define COLOR_ROJO     "\x1b[31m"
+#define COLOR_VERDE    "\x1b[32m"
+#define COLOR_AMARILLO "\x1b[33m"
+#define COLOR_AZUL     "\x1b[34m"
+#define COLOR_MAGENTA  "\x1b[35m"
+#define COLOR_CIAN     "\x1b[36m"
+#define COLOR_RESET    "\x1b[0m"
+
+/* Niveles de la salida por consola. Cada mensaje tiene el nivel mínimo en el
+ * que aparece; los de nivel superior al actual ni se formatean */
+typedef enum {
+    REGISTRO_SILENCIO,  /* Solo errores (el panel ocupa la terminal) */
+    REGISTRO_RESUMEN,   /* Jugadas, turnos y cambios de algoritmo */
+    REGISTRO_DETALLE    /* Además manos, estados y cada acceso a memoria */
+} NivelRegistro;
+
+extern NivelRegistro nivelRegistro;
+
+#define REGISTRO_ACTIVO(nivel) (nivelRegistro >= (nivel))
+
+/* printf condicionado al nivel: los argumentos no se evalúan si no se muestra */
+#define imprimirRegistro(nivel, ...) \
+    do { if (REGISTRO_ACTIVO(nivel)) printf(__VA_ARGS__); } while (0)
+
+/* Lo mismo con color, en un solo printf (formato debe ser un literal) */
+#define imprimirRegistroColor(nivel, color, formato, ...) \
+    do { if (REGISTRO_ACTIVO(nivel)) printf(color formato COLOR_RESET, ##__VA_ARGS__); } while (0)
+
+/* Interpretar "silencio", "resumen" o "detalle". Devuelve false si no es válido */
+bool interpretarNivelRegistro(const char *texto, NivelRegistro *nivel);
+const char* nombreNivelRegistro(NivelRegistro nivel);
+
 /* Funciones para colores en terminal (para visualización) */
 void colorRojo(void);
 void colorVerde(void);
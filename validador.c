@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "validador.h"
+#include "mesa.h"
+#include "mazo.h"
+#include "particion.h"
+#include "utilidades.h"
+#include "zobrist.h"
+
+#define NUM_CODIGOS_CARTA       (NUM_PALOS * NUM_VALORES + 1)   /* 52 naturales y el comodín */
+#define MAX_CARTAS_ZAPATO       (MAX_BARAJAS * CARTAS_POR_BARAJA)
+#define JUGADORES_BANCO_VALIDADOR 4
+#define SEMILLA_BANCO_VALIDADOR   12345
+
+static bool validacionTrasTurno = false;
+
+/* Estadísticas de comprobarTurno (atómicas: la llaman los hilos de los jugadores) */
+static long validaciones = 0;
+static long validacionesFallidas = 0;
+static long nsValidacion = 0;
+
+static long ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Sumar las copias de cada carta al conteo por código */
+static void contarCartas(const Carta *cartas, int numCartas, uint16_t *conteo, ValidacionPartida *resultado) {
+    for (int i = 0; i < numCartas; i++) {
+        int codigo = codigoZobrist(cartas[i]);
+        if (codigo < 0) {
+            resultado->cartasDesconocidas++;
+        } else {
+            conteo[codigo]++;
+        }
+    }
+    resultado->totalCartas += numCartas;
+}
+
+bool validarPartida(const Jugador *jugadores, int numJugadores, const TablaApeadas *mesa,
+                    Banca *banca, ValidacionPartida *resultado) {
+    uint16_t conteo[NUM_CODIGOS_CARTA] = {0};
+    Carta enBanca[MAX_CARTAS_ZAPATO];
+
+    memset(resultado, 0, sizeof(ValidacionPartida));
+    resultado->primeraInvalida = -1;
+    resultado->codigoDescuadre = -1;
+
+    for (int j = 0; j < numJugadores; j++) {
+        contarCartas(jugadores[j].mano.cartas, jugadores[j].mano.numCartas, conteo, resultado);
+    }
+
+    /* Cada apeada se valida y se cuenta mientras está en caché */
+    for (int i = 0; i < mesa->numApeadas; i++) {
+        const Apeada *apeada = apeadaEnTabla(mesa, i);
+        const Carta *cartas = apeada->esGrupo ? apeada->jugada.grupo.cartas : apeada->jugada.escalera.cartas;
+        int numCartas = apeada->esGrupo ? apeada->jugada.grupo.numCartas : apeada->jugada.escalera.numCartas;
+        int maximo = apeada->esGrupo ? 4 : MAX_CARTAS_ESCALERA;
+
+        if (numCartas < 0 || numCartas > maximo || !validarApeada(apeada)) {
+            if (resultado->primeraInvalida < 0) {
+                resultado->primeraInvalida = i;
+            }
+            resultado->apeadasInvalidas++;
+            if (numCartas < 0 || numCartas > maximo) {
+                continue;  /* Con un número de cartas imposible no se puede contar */
+            }
+        }
+        contarCartas(cartas, numCartas, conteo, resultado);
+    }
+
+    contarCartas(enBanca, copiarCartasBanca(banca, enBanca, MAX_CARTAS_ZAPATO), conteo, resultado);
+
+    /* Sin zapato generado no hay con qué comparar las cuentas */
+    if (banca->numBarajas > 0) {
+        for (int codigo = 0; codigo < NUM_CODIGOS_CARTA; codigo++) {
+            int esperadas = codigo == NUM_CODIGOS_CARTA - 1 ? COMODINES_POR_BARAJA * banca->numBarajas
+                                                            : banca->numBarajas;
+            int diferencia = conteo[codigo] - esperadas;
+            if (diferencia == 0) {
+                continue;
+            }
+            if (diferencia < 0) {
+                resultado->faltantes -= diferencia;
+            } else {
+                resultado->sobrantes += diferencia;
+            }
+            if (resultado->codigoDescuadre < 0) {
+                resultado->codigoDescuadre = codigo;
+            }
+        }
+    }
+
+    return resultado->apeadasInvalidas == 0 && resultado->cartasDesconocidas == 0 &&
+           resultado->faltantes == 0 && resultado->sobrantes == 0;
+}
+
+void configurarValidacion(bool activa) {
+    validacionTrasTurno = activa;
+}
+
+bool validacionActiva(void) {
+    return validacionTrasTurno;
+}
+
+/* Nombre de la carta de un código de codigoZobrist */
+static char *nombreCodigo(int codigo, char *buffer) {
+    Carta carta = {0, 'J', true};
+
+    if (codigo < NUM_PALOS * NUM_VALORES) {
+        carta.valor = codigo % NUM_VALORES + 1;
+        carta.palo = palosParticion[codigo / NUM_VALORES];
+        carta.esComodin = false;
+    }
+    return obtenerNombreCarta(carta, buffer);
+}
+
+bool comprobarTurno(const Jugador *jugadores, int numJugadores, const TablaApeadas *mesa,
+                    Banca *banca, int idJugador) {
+    ValidacionPartida resultado;
+    long inicio = ahoraNs();
+    bool valida = validarPartida(jugadores, numJugadores, mesa, banca, &resultado);
+
+    __atomic_add_fetch(&nsValidacion, ahoraNs() - inicio, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&validaciones, 1, __ATOMIC_RELAXED);
+    if (valida) {
+        return true;
+    }
+
+    __atomic_add_fetch(&validacionesFallidas, 1, __ATOMIC_RELAXED);
+    char carta[50] = "-";
+    if (resultado.codigoDescuadre >= 0) {
+        nombreCodigo(resultado.codigoDescuadre, carta);
+    }
+    printf("Error: Partida inválida tras el turno del jugador %d: %d apeadas inválidas (primera en %d), "
+           "%d cartas faltantes y %d sobrantes (primera descuadrada: %s), %d desconocidas\n",
+           idJugador, resultado.apeadasInvalidas, resultado.primeraInvalida,
+           resultado.faltantes, resultado.sobrantes, carta, resultado.cartasDesconocidas);
+    return false;
+}
+
+void imprimirEstadisticasValidacion(void) {
+    long total = __atomic_load_n(&validaciones, __ATOMIC_RELAXED);
+
+    if (total == 0) {
+        return;
+    }
+    printf("\nValidación: %ld estados comprobados tras cada turno, %ld inválidos, %.1f us de media\n",
+           total, __atomic_load_n(&validacionesFallidas, __ATOMIC_RELAXED),
+           __atomic_load_n(&nsValidacion, __ATOMIC_RELAXED) / 1000.0 / total);
+}
+
+/* --- Banco de pruebas --- */
+
+static Jugador jugadoresBanco[JUGADORES_BANCO_VALIDADOR];
+
+static double segundosDesde(long inicioNs) {
+    return (ahoraNs() - inicioNs) / 1e9;
+}
+
+/* Pasar al destino una copia de la carta sacándola del montón */
+static bool sacarCarta(Carta *monton, int *numMonton, Carta carta, Carta *destino) {
+    int codigo = codigoZobrist(carta);
+
+    for (int i = 0; i < *numMonton; i++) {
+        if (codigoZobrist(monton[i]) == codigo) {
+            *destino = monton[i];
+            monton[i] = monton[--(*numMonton)];
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Partida sintética de un zapato: por baraja, escaleras del 1 al 3 y del 7 al
+ * 9 en cada palo y un grupo de reyes con comodín; el resto, repartido a
+ * partes iguales entre las manos y la banca */
+static bool prepararPartidaBanco(Banca *banca, TablaApeadas *mesa) {
+    static Carta monton[MAX_CARTAS_ZAPATO];
+
+    if (!generarZapato(banca, barajasConfiguradas(), SEMILLA_BANCO_VALIDADOR)) {
+        return false;
+    }
+    int numMonton = robarBanca(banca, monton, banca->totalCartas);
+
+    for (int b = 0; b < banca->numBarajas; b++) {
+        for (int p = 0; p < NUM_PALOS; p++) {
+            for (int inicio = 1; inicio <= 7; inicio += 6) {
+                Apeada apeada;
+                memset(&apeada, 0, sizeof(Apeada));
+                apeada.jugada.escalera.palo = palosParticion[p];
+                for (int k = 0; k < 3; k++) {
+                    Carta carta = {inicio + k, palosParticion[p], false};
+                    if (!sacarCarta(monton, &numMonton, carta, &apeada.jugada.escalera.cartas[k])) {
+                        return false;
+                    }
+                }
+                apeada.jugada.escalera.numCartas = 3;
+                if (agregarEnTabla(mesa, &apeada) == NULL) {
+                    return false;
+                }
+            }
+        }
+
+        Apeada grupo;
+        memset(&grupo, 0, sizeof(Apeada));
+        grupo.esGrupo = true;
+        for (int p = 0; p < 3; p++) {
+            Carta rey = {NUM_VALORES, palosParticion[p], false};
+            if (!sacarCarta(monton, &numMonton, rey, &grupo.jugada.grupo.cartas[p])) {
+                return false;
+            }
+        }
+        Carta comodin = {0, 'J', true};
+        if (!sacarCarta(monton, &numMonton, comodin, &grupo.jugada.grupo.cartas[3])) {
+            return false;
+        }
+        grupo.jugada.grupo.numCartas = 4;
+        if (agregarEnTabla(mesa, &grupo) == NULL) {
+            return false;
+        }
+    }
+
+    int porMano = numMonton / (JUGADORES_BANCO_VALIDADOR + 1);
+    for (int j = 0; j < JUGADORES_BANCO_VALIDADOR; j++) {
+        jugadoresBanco[j].id = j;
+        inicializarMazo(&jugadoresBanco[j].mano);
+        if (!agregarCartasMazo(&jugadoresBanco[j].mano, monton + j * porMano, porMano)) {
+            return false;
+        }
+    }
+    int resto = numMonton - JUGADORES_BANCO_VALIDADOR * porMano;
+    return devolverBanca(banca, monton + JUGADORES_BANCO_VALIDADOR * porMano, resto);
+}
+
+/* Validar la partida del banco esperando un error: true si se detectó */
+static bool detectarError(const char *nombre, const TablaApeadas *mesa, Banca *banca) {
+    ValidacionPartida resultado;
+    bool detectado = !validarPartida(jugadoresBanco, JUGADORES_BANCO_VALIDADOR, mesa, banca, &resultado);
+
+    printf("  %-28s %s (%d apeadas inválidas, %d faltantes, %d sobrantes)\n", nombre,
+           detectado ? "detectada" : "NO DETECTADA", resultado.apeadasInvalidas,
+           resultado.faltantes, resultado.sobrantes);
+    return detectado;
+}
+
+bool ejecutarBancoValidador(int numRondas) {
+    ValidacionPartida resultado;
+    TablaApeadas mesa;
+    Banca banca;
+    bool correcto = true;
+
+    if (numRondas <= 0) {
+        printf("Número de rondas inválido\n");
+        return false;
+    }
+
+    inicializarBanca(&banca, NULL);
+    inicializarTablaApeadas(&mesa);
+    if (!prepararPartidaBanco(&banca, &mesa)) {
+        printf("Error: No se pudo preparar el banco del validador\n");
+        liberarTablaApeadas(&mesa);
+        liberarBanca(&banca);
+        return false;
+    }
+
+    int cartasManos = 0;
+    for (int j = 0; j < JUGADORES_BANCO_VALIDADOR; j++) {
+        cartasManos += jugadoresBanco[j].mano.numCartas;
+    }
+    printf("Banco del validador: zapato de %d barajas, %d apeadas en la mesa, %d cartas en %d manos, "
+           "%d en la banca, %d rondas\n", banca.numBarajas, mesa.numApeadas, cartasManos,
+           JUGADORES_BANCO_VALIDADOR, cartasEnBanca(&banca), numRondas);
+
+    /* Apeada a apeada, como validarApeada en cada jugada */
+    long validas = 0;
+    long inicio = ahoraNs();
+    for (int r = 0; r < numRondas; r++) {
+        for (int i = 0; i < mesa.numApeadas; i++) {
+            validas += validarApeada(apeadaEnTabla(&mesa, i));
+        }
+    }
+    double segundosApeadas = segundosDesde(inicio);
+    long apeadas = (long)numRondas * mesa.numApeadas;
+    correcto = correcto && validas == apeadas;
+
+    /* La partida entera: apeadas y conservación de las cartas */
+    long partidasValidas = 0;
+    inicio = ahoraNs();
+    for (int r = 0; r < numRondas; r++) {
+        partidasValidas += validarPartida(jugadoresBanco, JUGADORES_BANCO_VALIDADOR, &mesa, &banca, &resultado);
+    }
+    double segundosPartida = segundosDesde(inicio);
+    correcto = correcto && partidasValidas == numRondas;
+
+    printf("  apeada a apeada: %12.0f apeadas/s (%ld de %ld válidas)\n",
+           apeadas / (segundosApeadas > 0 ? segundosApeadas : 1e-9), validas, apeadas);
+    printf("  partida entera:  %12.0f validaciones/s, %.2f us cada una, %.1f ns por carta (%d cartas)\n",
+           numRondas / (segundosPartida > 0 ? segundosPartida : 1e-9), segundosPartida * 1e6 / numRondas,
+           segundosPartida * 1e9 / numRondas / resultado.totalCartas, resultado.totalCartas);
+
+    /* Errores inyectados, deshechos tras comprobar cada uno */
+    Mazo *mano = &jugadoresBanco[0].mano;
+    mano->numCartas--;
+    correcto = detectarError("carta perdida en una mano", &mesa, &banca) && correcto;
+    mano->numCartas++;
+
+    Carta original = mano->cartas[0];
+    Apeada *apeada = apeadaEnTabla(&mesa, 0);
+    for (int k = 0; k < apeada->jugada.escalera.numCartas; k++) {
+        if (codigoZobrist(apeada->jugada.escalera.cartas[k]) != codigoZobrist(original)) {
+            mano->cartas[0] = apeada->jugada.escalera.cartas[k];
+            break;
+        }
+    }
+    correcto = detectarError("carta de la mesa en una mano", &mesa, &banca) && correcto;
+    mano->cartas[0] = original;
+
+    Carta segunda = apeada->jugada.escalera.cartas[1];
+    apeada->jugada.escalera.cartas[1] = apeada->jugada.escalera.cartas[0];
+    correcto = detectarError("escalera con valor repetido", &mesa, &banca) && correcto;
+    apeada->jugada.escalera.cartas[1] = segunda;
+
+    correcto = correcto && validarPartida(jugadoresBanco, JUGADORES_BANCO_VALIDADOR, &mesa, &banca, &resultado);
+    printf("  partida %s tras deshacer los errores\n", correcto ? "válida" : "INVÁLIDA");
+
+    for (int j = 0; j < JUGADORES_BANCO_VALIDADOR; j++) {
+        liberarMazo(&jugadoresBanco[j].mano);
+    }
+    liberarTablaApeadas(&mesa);
+    liberarBanca(&banca);
+    return correcto;
+}
@@ -0,0 +1,55 @@
+#ifndef VALIDADOR_H
+#define VALIDADOR_H
+
+#include <stdbool.h>
+#include "jugadores.h"
+#include "tablaapeadas.h"
+#include "banca.h"
+
+/* Validación de la partida completa.
+ *
+ * validarPartida recorre una sola vez la mesa, las manos y la banca: valida
+ * cada apeada (esGrupoValido y esEscaleraValida son O(n) y no piden memoria)
+ * y cuenta las copias de cada carta en un arreglo por código (el de
+ * codigoZobrist). Al terminar, las cuentas deben ser exactamente las del
+ * zapato: numBarajas copias de cada carta natural y COMODINES_POR_BARAJA por
+ * baraja de comodines. Una carta perdida o duplicada en cualquier sitio
+ * aparece como faltante o sobrante, aunque el número total cuadre.
+ *
+ * Cuesta unos microsegundos por estado, así que con --validar el juego y el
+ * torneo la llaman tras cada turno y cuentan los fallos. Las manos se leen
+ * sin su seqlock: no puede haber otro turno en curso */
+
+typedef struct {
+    int apeadasInvalidas;
+    int primeraInvalida;    /* Posición en la mesa de la primera, o -1 */
+    int cartasDesconocidas; /* Cartas que no son de ninguna baraja */
+    int faltantes;          /* Copias que faltan respecto al zapato */
+    int sobrantes;          /* Copias de más */
+    int codigoDescuadre;    /* Primer código con la cuenta distinta, o -1 */
+    int totalCartas;        /* Cartas contadas en manos, mesa y banca */
+} ValidacionPartida;
+
+/* Validar las apeadas y la conservación de las cartas del zapato de la
+ * banca. Devuelve true si todo cuadra; el detalle queda en resultado */
+bool validarPartida(const Jugador *jugadores, int numJugadores, const TablaApeadas *mesa,
+                    Banca *banca, ValidacionPartida *resultado);
+
+/* Validar tras cada turno (--validar) */
+void configurarValidacion(bool activa);
+bool validacionActiva(void);
+
+/* Validar el estado tras el turno de idJugador, sumar la medición a las
+ * estadísticas e informar del fallo si lo hay. Devuelve true si es válido */
+bool comprobarTurno(const Jugador *jugadores, int numJugadores, const TablaApeadas *mesa,
+                    Banca *banca, int idJugador);
+
+/* Validaciones hechas, fallos y tiempo medio (si hubo alguna) */
+void imprimirEstadisticasValidacion(void);
+
+/* Banco de pruebas: una partida sintética (manos, mesa de grupos y escaleras
+ * y banca del mismo zapato) validada numRondas veces, apeada a apeada y
+ * entera, y con errores inyectados que deben detectarse */
+bool ejecutarBancoValidador(int numRondas);
+
+#endif /* VALIDADOR_H */
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zobrist.h"
+#include "particion.h"
+
+#define LINEA_TRAZA_HASH 256
+
+int codigoZobrist(Carta carta) {
+    if (carta.esComodin) {
+        return NUM_PALOS * NUM_VALORES;
+    }
+
+    int palo = indicePaloParticion(carta.palo);
+    if (palo < 0 || carta.valor < 1 || carta.valor > NUM_VALORES) {
+        return -1;
+    }
+    return palo * NUM_VALORES + carta.valor - 1;
+}
+
+/* Cartas como multiconjunto: la clave de cada una es la de su número de copia */
+static uint64_t hashMulticonjunto(DominioZobrist dominio, const Carta *cartas, int numCartas) {
+    uint8_t copias[NUM_PALOS * NUM_VALORES + 1] = {0};
+    uint64_t hash = 0;
+
+    for (int i = 0; i < numCartas; i++) {
+        int codigo = codigoZobrist(cartas[i]);
+        if (codigo >= 0) {
+            hash ^= claveZobrist(dominio, codigo, copias[codigo]++);
+        }
+    }
+    return hash;
+}
+
+uint64_t hashApeada(const Apeada *apeada) {
+    if (apeada->esGrupo) {
+        return hashMulticonjunto(ZOBRIST_GRUPO, apeada->jugada.grupo.cartas, apeada->jugada.grupo.numCartas);
+    }
+
+    /* Escalera: cada carta con su posición */
+    const Escalera *escalera = &apeada->jugada.escalera;
+    uint64_t hash = 0;
+    for (int i = 0; i < escalera->numCartas; i++) {
+        int codigo = codigoZobrist(escalera->cartas[i]);
+        if (codigo >= 0) {
+            hash ^= claveZobrist(ZOBRIST_ESCALERA, codigo, i);
+        }
+    }
+    return hash;
+}
+
+uint64_t hashCartas(const Carta *cartas, int numCartas) {
+    return hashMulticonjunto(ZOBRIST_MANO, cartas, numCartas);
+}
+
+uint64_t hashPartida(const Jugador *jugadores, int numJugadores, uint64_t hashMesa, int cartasBanca) {
+    uint64_t hash = hashMesa ^ claveZobrist(ZOBRIST_JUGADOR, NUM_PALOS * NUM_VALORES + 1, cartasBanca);
+
+    /* La misma mano en otro asiento es otro estado */
+    for (int j = 0; j < numJugadores; j++) {
+        hash ^= mezclarZobrist(jugadores[j].mano.resumen.hash ^ claveZobrist(ZOBRIST_JUGADOR, 0, j));
+    }
+    return hash;
+}
+
+/* Siguiente línea de la traza con "Hash ", desde esa palabra y sin el salto
+ * de línea (las marcas de tiempo de juego.log quedan fuera). false al final */
+static bool siguienteHashTraza(FILE *archivo, char *linea, int *numLinea, char **hash) {
+    while (fgets(linea, LINEA_TRAZA_HASH, archivo) != NULL) {
+        (*numLinea)++;
+        char *inicio = strstr(linea, "Hash ");
+        if (inicio != NULL) {
+            inicio[strcspn(inicio, "\r\n")] = '\0';
+            *hash = inicio;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool compararTrazasHash(const char *rutaA, const char *rutaB) {
+    char lineaA[LINEA_TRAZA_HASH], lineaB[LINEA_TRAZA_HASH];
+    char *hashA, *hashB;
+    int numLineaA = 0, numLineaB = 0, turnos = 0;
+    FILE *a = fopen(rutaA, "r");
+    FILE *b = fopen(rutaB, "r");
+
+    if (a == NULL || b == NULL) {
+        printf("Error: No se pudo abrir la traza %s\n", a == NULL ? rutaA : rutaB);
+        if (a != NULL) fclose(a);
+        if (b != NULL) fclose(b);
+        return false;
+    }
+
+    bool coinciden = true;
+    for (;;) {
+        bool hayA = siguienteHashTraza(a, lineaA, &numLineaA, &hashA);
+        bool hayB = siguienteHashTraza(b, lineaB, &numLineaB, &hashB);
+
+        if (!hayA && !hayB) {
+            break;
+        }
+        if (hayA != hayB) {
+            printf("Las trazas coinciden en %d turnos, pero %s tiene más\n", turnos, hayA ? rutaA : rutaB);
+            coinciden = false;
+            break;
+        }
+        if (strcmp(hashA, hashB) != 0) {
+            printf("Primera diferencia en el turno %d:\n  %s:%d: %s\n  %s:%d: %s\n",
+                   turnos + 1, rutaA, numLineaA, hashA, rutaB, numLineaB, hashB);
+            coinciden = false;
+            break;
+        }
+        turnos++;
+    }
+
+    if (coinciden) {
+        printf("Las trazas coinciden: %d turnos con el mismo hash\n", turnos);
+    }
+    fclose(a);
+    fclose(b);
+    return coinciden;
+}
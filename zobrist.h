@@ -0,0 +1,65 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jugadores.h"
+
+/* Hashes de Zobrist del estado de la partida.
+ *
+ * Cada carta tiene una clave de 64 bits por dominio (mano, grupo, escalera)
+ * y por índice: en una mano y en un grupo el índice es el número de copia
+ * (la primera 7C, la segunda 7C...), así que el hash no depende del orden;
+ * en una escalera es la posición, porque ahí el lugar de un comodín cambia
+ * la carta que representa. Las claves salen de mezclar esos tres datos con
+ * una semilla fija, así que son las mismas en todas las ejecuciones y dos
+ * trazas se pueden comparar entre sí.
+ *
+ * El hash de una mano vive en su ResumenMazo y se actualiza con un XOR en
+ * cada carta que entra o sale (ver mazo.c). El de una mesa es la suma de los
+ * hashes de sus apeadas (sin importar el orden y sin que dos apeadas iguales
+ * se anulen) y lo mantiene la TablaApeadas: sumar una apeada al agregarla,
+ * restar la vieja y sumar la nueva al modificarla */
+
+#define SEMILLA_ZOBRIST 0x5EED2B0B15C0FFEEULL
+
+typedef enum {
+    ZOBRIST_MANO,
+    ZOBRIST_GRUPO,
+    ZOBRIST_ESCALERA,
+    ZOBRIST_JUGADOR     /* Para combinar los hashes de varias manos */
+} DominioZobrist;
+
+/* Mezclador de splitmix64 */
+static inline uint64_t mezclarZobrist(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/* Clave de la carta codificada (palo * 13 + valor - 1, 52 el comodín) en un
+ * dominio y con un índice (copia o posición) */
+static inline uint64_t claveZobrist(DominioZobrist dominio, int codigo, int indice) {
+    return mezclarZobrist(SEMILLA_ZOBRIST ^ ((uint64_t)dominio << 32) ^ ((uint64_t)codigo << 16) ^ (uint64_t)indice);
+}
+
+/* Código de una carta para las claves, o -1 si no es una carta válida */
+int codigoZobrist(Carta carta);
+
+/* Hash de una apeada (tipo y cartas; no cuenta quién la bajó) */
+uint64_t hashApeada(const Apeada *apeada);
+
+/* Hash de un conjunto de cartas como mano, recorriéndolas (O(n)) */
+uint64_t hashCartas(const Carta *cartas, int numCartas);
+
+/* Hash del estado de una partida: las manos de cada jugador (en su asiento),
+ * la mesa y las cartas de la banca */
+uint64_t hashPartida(const Jugador *jugadores, int numJugadores, uint64_t hashMesa, int cartasBanca);
+
+/* Comparar dos trazas de hashes por turno (las de --traza del torneo o las
+ * líneas "Hash" de juego.log) e informar del primer turno distinto.
+ * Devuelve true si coinciden */
+bool compararTrazasHash(const char *rutaA, const char *rutaB);
+
+#endif /* ZOBRIST_H */